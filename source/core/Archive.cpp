@@ -0,0 +1,113 @@
+#include "Archive.h"
+#include "compression/Lz4.h"
+
+#include <cstring>
+
+namespace Core
+{
+	bool Archive::Open(const char* filepath)
+	{
+		Close();
+		if(!m_Mapping.Open(filepath))
+			return false;
+
+		// everything the lookups trust is checked once here
+		const char* data = m_Mapping.GetData();
+		const uint64 size = m_Mapping.GetSize();
+		ArchiveHeader header;
+		if(size < sizeof(header))
+		{
+			Close();
+			return false;
+		}
+		memcpy(&header, data, sizeof(header));
+
+		const uint64 tocEnd = sizeof(header) + uint64(header.m_EntryCount) * sizeof(ArchiveEntry);
+		const bool valid = header.m_Magic == s_Magic && header.m_Version == s_Version && tocEnd <= size &&
+						   header.m_NamesOffset >= tocEnd && header.m_NamesOffset <= size &&
+						   header.m_NamesSize <= size - header.m_NamesOffset &&
+						   (header.m_NamesSize == 0 || data[header.m_NamesOffset + header.m_NamesSize - 1] == 0);
+		if(!valid)
+		{
+			Close();
+			return false;
+		}
+
+		const ArchiveEntry* entries = reinterpret_cast<const ArchiveEntry*>(&data[sizeof(header)]);
+		for(uint32 i = 0; i < header.m_EntryCount; ++i)
+		{
+			const ArchiveEntry& entry = entries[i];
+			const bool entryValid = entry.m_Offset <= size && entry.m_StoredSize <= size - entry.m_Offset &&
+									entry.m_NameOffset < header.m_NamesSize &&
+									entry.m_Compression <= Compression::Lz4 &&
+									(entry.m_Compression != Compression::None || entry.m_StoredSize == entry.m_Size) &&
+									(i == 0 || entries[i - 1].m_Hash < entry.m_Hash);
+			if(!entryValid)
+			{
+				Close();
+				return false;
+			}
+		}
+
+		m_Entries = entries;
+		m_EntryCount = header.m_EntryCount;
+		m_Names = &data[header.m_NamesOffset];
+		return true;
+	}
+
+	void Archive::Close()
+	{
+		m_Mapping.Close();
+		m_Entries = nullptr;
+		m_Names = nullptr;
+		m_EntryCount = 0;
+	}
+
+	const ArchiveEntry* Archive::Find(const HashString& name) const
+	{
+		const uint64 hash = name.GetHash();
+		uint32 first = 0;
+		uint32 count = m_EntryCount;
+		while(count > 0)
+		{
+			const uint32 half = count / 2;
+			if(m_Entries[first + half].m_Hash < hash)
+			{
+				first += half + 1;
+				count -= half + 1;
+			}
+			else
+				count = half;
+		}
+
+		return first < m_EntryCount && m_Entries[first].m_Hash == hash ? &m_Entries[first] : nullptr;
+	}
+
+	Span<const char> Archive::GetView(const HashString& name) const
+	{
+		const ArchiveEntry* entry = Find(name);
+		if(!entry || entry->m_Compression != Compression::None)
+			return Span<const char>();
+
+		return Span<const char>(&m_Mapping.GetData()[entry->m_Offset], entry->m_Size);
+	}
+
+	bool Archive::Read(const ArchiveEntry& entry, void* buffer, uint64 bufferSize) const
+	{
+		if(bufferSize < entry.m_Size)
+			return false;
+
+		const char* stored = &m_Mapping.GetData()[entry.m_Offset];
+		switch(entry.m_Compression)
+		{
+			case Compression::None:
+				memcpy(buffer, stored, entry.m_Size);
+				return true;
+			case Compression::Lz4:
+				return Lz4::Decompress(stored, entry.m_StoredSize, static_cast<char*>(buffer), entry.m_Size);
+			default:
+				return false;
+		}
+	}
+
+}; // namespace Core
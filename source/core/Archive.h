@@ -0,0 +1,85 @@
+#pragma once
+#include "Types.h"
+#include "MappedFile.h"
+#include "containers/Span.h"
+#include "String/HashString.h"
+
+namespace Core
+{
+	enum class Compression : uint8
+	{
+		None,
+		Lz4,
+	};
+
+	/*
+		.pak layout, little endian:
+			ArchiveHeader
+			ArchiveEntry[m_EntryCount]	sorted by hash so lookups are a binary search
+			names						zero terminated, ArchiveEntry::m_NameOffset points in here
+			data						every entry starts on m_DataAlignment
+	*/
+	struct ArchiveHeader
+	{
+		uint32 m_Magic;
+		uint32 m_Version;
+		uint32 m_EntryCount;
+		uint32 m_DataAlignment;
+		uint64 m_NamesOffset;
+		uint64 m_NamesSize;
+	};
+
+	struct ArchiveEntry
+	{
+		uint64 m_Hash; // HashString of the name
+		uint64 m_Offset;
+		uint64 m_StoredSize; // size in the pack, compressed or not
+		uint64 m_Size;
+		uint32 m_NameOffset;
+		Compression m_Compression;
+		uint8 m_Padding[3];
+	};
+
+	static_assert(sizeof(ArchiveHeader) == 32, "ArchiveHeader is part of the file format");
+	static_assert(sizeof(ArchiveEntry) == 40, "ArchiveEntry is part of the file format");
+
+	/*
+		Read only access to a .pak, the whole pack is mapped once so loading an entry costs no syscalls. Uncompressed
+		entries are handed out as views straight into the mapping, compressed ones are decompressed by Read. Views and
+		entries are only valid while the archive stays open. Packs are made with ArchiveBuilder.
+	*/
+	class Archive
+	{
+	public:
+		static constexpr uint32 s_Magic = 'P' | ('A' << 8) | ('K' << 16) | ('1' << 24);
+		static constexpr uint32 s_Version = 1;
+
+		Archive() = default;
+		~Archive() = default;
+
+		Archive(const Archive&) = delete;
+		Archive& operator=(const Archive&) = delete;
+
+		// false for missing files and anything that doesn't look like a valid pack.
+		bool Open(const char* filepath);
+		void Close();
+		bool IsOpen() const { return m_Mapping.IsOpen(); }
+
+		const ArchiveEntry* Find(const HashString& name) const;
+		// Zero copy, empty for missing and compressed entries.
+		Span<const char> GetView(const HashString& name) const;
+		// Copies or decompresses the entry, buffer needs entry.m_Size bytes.
+		bool Read(const ArchiveEntry& entry, void* buffer, uint64 bufferSize) const;
+
+		uint32 GetEntryCount() const { return m_EntryCount; }
+		const ArchiveEntry& GetEntry(uint32 index) const { return m_Entries[index]; }
+		const char* GetName(const ArchiveEntry& entry) const { return &m_Names[entry.m_NameOffset]; }
+
+	private:
+		MappedFile m_Mapping;
+		const ArchiveEntry* m_Entries = nullptr;
+		const char* m_Names = nullptr;
+		uint32 m_EntryCount = 0;
+	};
+
+}; // namespace Core
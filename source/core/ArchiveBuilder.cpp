@@ -0,0 +1,124 @@
+#include "ArchiveBuilder.h"
+#include "File.h"
+#include "FileWriter.h"
+#include "compression/Lz4.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace Core
+{
+	bool ArchiveBuilder::Add(const char* name, const void* data, uint64 size, Compression compression)
+	{
+		const uint64 hash = HashString(name).GetHash();
+		for(const Item& item : m_Items)
+		{
+			if(item.m_Hash == hash)
+				return false;
+		}
+
+		Item item;
+		item.m_Name = name;
+		item.m_Hash = hash;
+		item.m_Size = size;
+
+		if(compression == Compression::Lz4)
+		{
+			item.m_Data.resize(size);
+			const uint64 stored = Lz4::Compress(static_cast<const char*>(data), size, item.m_Data.data(), size);
+			if(stored > 0 && stored < size)
+			{
+				item.m_Data.resize(stored);
+				item.m_Compression = Compression::Lz4;
+			}
+		}
+
+		if(item.m_Compression == Compression::None)
+		{
+			const char* bytes = static_cast<const char*>(data);
+			item.m_Data.assign(bytes, bytes + size);
+		}
+
+		m_Items.push_back(std::move(item));
+		return true;
+	}
+
+	bool ArchiveBuilder::AddFile(const char* name, const char* filepath, Compression compression)
+	{
+		// File can't tell a missing file from an empty one
+		FILE* probe = fopen(filepath, "rb");
+		if(!probe)
+			return false;
+		fclose(probe);
+
+		File file(filepath, File::READ_MAPPED);
+		return Add(name, file.GetBuffer(), file.GetSize(), compression);
+	}
+
+	bool ArchiveBuilder::Save(const char* filepath, uint32 dataAlignment) const
+	{
+		if(dataAlignment == 0 || (dataAlignment & (dataAlignment - 1)) != 0)
+			return false;
+
+		std::vector<const Item*> sorted;
+		for(const Item& item : m_Items)
+			sorted.push_back(&item);
+		std::sort(sorted.begin(), sorted.end(), [](const Item* a, const Item* b) { return a->m_Hash < b->m_Hash; });
+
+		std::vector<ArchiveEntry> entries(sorted.size());
+		std::string names;
+		for(size_t i = 0; i < sorted.size(); ++i)
+		{
+			entries[i] = ArchiveEntry();
+			entries[i].m_Hash = sorted[i]->m_Hash;
+			entries[i].m_StoredSize = sorted[i]->m_Data.size();
+			entries[i].m_Size = sorted[i]->m_Size;
+			entries[i].m_NameOffset = static_cast<uint32>(names.size());
+			entries[i].m_Compression = sorted[i]->m_Compression;
+			names.append(sorted[i]->m_Name.c_str(), sorted[i]->m_Name.size() + 1);
+		}
+
+		ArchiveHeader header = {};
+		header.m_Magic = Archive::s_Magic;
+		header.m_Version = Archive::s_Version;
+		header.m_EntryCount = static_cast<uint32>(entries.size());
+		header.m_DataAlignment = dataAlignment;
+		header.m_NamesOffset = sizeof(header) + entries.size() * sizeof(ArchiveEntry);
+		header.m_NamesSize = names.size();
+
+		const uint64 mask = dataAlignment - 1;
+		const auto align = [mask](uint64 offset) { return (offset + mask) & ~mask; };
+		uint64 offset = align(header.m_NamesOffset + header.m_NamesSize);
+		for(ArchiveEntry& entry : entries)
+		{
+			entry.m_Offset = offset;
+			offset = align(offset + entry.m_StoredSize);
+		}
+
+		FileWriter writer;
+		if(!writer.Open(filepath))
+			return false;
+
+		writer.Write(&header, sizeof(header));
+		writer.Write(entries.data(), entries.size() * sizeof(ArchiveEntry));
+		writer.Write(names.data(), names.size());
+
+		const std::vector<char> padding(dataAlignment, 0);
+		for(size_t i = 0; i < sorted.size(); ++i)
+		{
+			writer.Write(padding.data(), entries[i].m_Offset - writer.GetSize());
+			writer.Write(sorted[i]->m_Data.data(), sorted[i]->m_Data.size());
+		}
+
+		return writer.Close();
+	}
+
+	uint64 ArchiveBuilder::GetStoredSize() const
+	{
+		uint64 size = 0;
+		for(const Item& item : m_Items)
+			size += item.m_Data.size();
+		return size;
+	}
+
+}; // namespace Core
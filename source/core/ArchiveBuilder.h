@@ -0,0 +1,41 @@
+#pragma once
+#include "Archive.h"
+
+#include <string>
+#include <vector>
+
+namespace Core
+{
+	/*
+		Collects entries in memory and writes them out as a .pak for Archive. Names are hashed with HashString, two
+		names with the same hash can't live in one pack so Add refuses the second one. Compression is a request,
+		entries that don't get smaller are stored as they are.
+	*/
+	class ArchiveBuilder
+	{
+	public:
+		// data is copied. false if the name, or its hash, is already in the pack.
+		bool Add(const char* name, const void* data, uint64 size, Compression compression = Compression::None);
+		bool AddFile(const char* name, const char* filepath, Compression compression = Compression::None);
+
+		// dataAlignment has to be a power of two, 4096 makes every entry page aligned.
+		bool Save(const char* filepath, uint32 dataAlignment = 64) const;
+
+		uint32 GetEntryCount() const { return static_cast<uint32>(m_Items.size()); }
+		// Bytes of entry data, after compression.
+		uint64 GetStoredSize() const;
+
+	private:
+		struct Item
+		{
+			std::string m_Name;
+			uint64 m_Hash = 0;
+			uint64 m_Size = 0;
+			Compression m_Compression = Compression::None;
+			std::vector<char> m_Data;
+		};
+
+		std::vector<Item> m_Items;
+	};
+
+}; // namespace Core
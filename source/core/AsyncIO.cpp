@@ -0,0 +1,201 @@
+#include "AsyncIO.h"
+#include "logger/Debug.h"
+
+#include <cstdio>
+#include <sys/stat.h>
+
+namespace Core
+{
+	namespace
+	{
+		// long and st_size are 32 bit on Windows, the 64 bit versions keep files past 2 GB working
+		bool GetSize(const char* path, uint64& size)
+		{
+#ifdef _WIN32
+			struct _stat64 info = {};
+			if(_stat64(path, &info) != 0)
+				return false;
+#else
+			struct stat info = {};
+			if(stat(path, &info) != 0)
+				return false;
+#endif
+			size = static_cast<uint64>(info.st_size);
+			return true;
+		}
+
+		bool Seek(FILE* file, uint64 offset)
+		{
+#ifdef _WIN32
+			return _fseeki64(file, static_cast<int64>(offset), SEEK_SET) == 0;
+#else
+			return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+		}
+	}; // namespace
+
+	std::unique_ptr<AsyncIO> AsyncIO::m_Instance;
+
+	AsyncIO::AsyncIO()
+		: m_Thread(&AsyncIO::ThreadMain, this)
+	{
+	}
+
+	AsyncIO::~AsyncIO()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Stop = true;
+		}
+		m_WorkReady.notify_all();
+		m_Thread.join();
+
+		// the thread is gone, whatever is left never started
+		for(std::deque<Pending>& queue : m_Queues)
+		{
+			for(Pending& pending : queue)
+			{
+				ReadResult result;
+				result.m_Status = IOStatus::Cancelled;
+				pending.m_Promise.set_value(result);
+			}
+			queue.clear();
+		}
+	}
+
+	void AsyncIO::Create() { m_Instance = std::make_unique<AsyncIO>(); }
+
+	AsyncIO& AsyncIO::Get() { return *m_Instance; }
+
+	void AsyncIO::Destroy() { m_Instance.reset(); }
+
+	std::future<ReadResult> AsyncIO::Read(ReadRequest request)
+	{
+		std::future<ReadResult> future;
+		ReadBatch(&request, 1, &future);
+		return future;
+	}
+
+	void AsyncIO::ReadBatch(ReadRequest* requests, uint32 count, std::future<ReadResult>* futures)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			for(uint32 i = 0; i < count; ++i)
+			{
+				ASSERT(requests[i].m_Priority < IOPriority::Count, "Invalid IOPriority");
+				std::deque<Pending>& queue = m_Queues[static_cast<int>(requests[i].m_Priority)];
+				queue.push_back({ std::move(requests[i]), std::promise<ReadResult>() });
+				if(futures)
+					futures[i] = queue.back().m_Promise.get_future();
+			}
+			m_Pending += count;
+		}
+		m_WorkReady.notify_one();
+	}
+
+	uint32 AsyncIO::DispatchCompletions()
+	{
+		std::vector<Completion> completions;
+		{
+			std::lock_guard<std::mutex> lock(m_CompletionMutex);
+			completions.swap(m_Completions);
+		}
+
+		const uint32 count = static_cast<uint32>(completions.size());
+		for(const Completion& completion : completions)
+			completion.m_Callback(completion.m_Result);
+
+		// hand the storage back so steady state dispatching doesn't allocate
+		completions.clear();
+		{
+			std::lock_guard<std::mutex> lock(m_CompletionMutex);
+			if(m_Completions.empty())
+				m_Completions.swap(completions);
+		}
+		return count;
+	}
+
+	uint32 AsyncIO::GetPendingCount() const
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		return m_Pending;
+	}
+
+	void AsyncIO::WaitIdle()
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_Idle.wait(lock, [this] { return m_Pending == 0; });
+	}
+
+	uint64 AsyncIO::GetFileSize(const char* path)
+	{
+		uint64 size = 0;
+		return GetSize(path, size) ? size : 0;
+	}
+
+	void AsyncIO::ThreadMain()
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		while(true)
+		{
+			m_WorkReady.wait(lock, [this] { return m_Stop || m_Pending > 0; });
+			if(m_Stop)
+				return;
+
+			std::deque<Pending>* queue = nullptr;
+			for(std::deque<Pending>& candidate : m_Queues)
+			{
+				if(!candidate.empty())
+				{
+					queue = &candidate;
+					break;
+				}
+			}
+
+			Pending pending = std::move(queue->front());
+			queue->pop_front();
+
+			lock.unlock();
+			const ReadResult result = Execute(pending.m_Request);
+			if(pending.m_Request.m_OnComplete)
+			{
+				std::lock_guard<std::mutex> completionLock(m_CompletionMutex);
+				m_Completions.push_back({ std::move(pending.m_Request.m_OnComplete), result });
+			}
+			lock.lock();
+
+			// the promise is set under the lock, a caller woken by the future sees the request counted as done
+			--m_Pending;
+			pending.m_Promise.set_value(result);
+			if(m_Pending == 0)
+				m_Idle.notify_all();
+		}
+	}
+
+	ReadResult AsyncIO::Execute(const ReadRequest& request)
+	{
+		ReadResult result;
+		FILE* file = fopen(request.m_Path.c_str(), "rb");
+		if(!file)
+		{
+			result.m_Status = IOStatus::NotFound;
+			return result;
+		}
+
+		// the data goes straight into the caller's buffer, stdio's own buffer would only add a copy
+		setvbuf(file, nullptr, _IONBF, 0);
+
+		GetSize(request.m_Path.c_str(), result.m_FileSize);
+
+		if(request.m_Offset < result.m_FileSize && Seek(file, request.m_Offset))
+		{
+			const uint64 remaining = result.m_FileSize - request.m_Offset;
+			const uint64 size = remaining < request.m_BufferSize ? remaining : request.m_BufferSize;
+			result.m_BytesRead = fread(request.m_Buffer, 1, static_cast<size_t>(size), file);
+		}
+
+		fclose(file);
+		return result;
+	}
+
+}; // namespace Core
@@ -0,0 +1,115 @@
+#pragma once
+#include "Types.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Core
+{
+	enum class IOPriority : uint8
+	{
+		High,
+		Normal,
+		Low,
+		Count
+	};
+
+	enum class IOStatus : uint8
+	{
+		Ok,
+		NotFound,
+		Cancelled,
+	};
+
+	struct ReadResult
+	{
+		IOStatus m_Status = IOStatus::Ok;
+		uint64 m_BytesRead = 0;
+		uint64 m_FileSize = 0; // larger than offset + m_BytesRead when the buffer was too small
+	};
+
+	struct ReadRequest
+	{
+		std::string m_Path;
+		void* m_Buffer = nullptr; // owned by the caller, has to stay alive until the request completes
+		uint64 m_BufferSize = 0;
+		uint64 m_Offset = 0;
+		IOPriority m_Priority = IOPriority::Normal;
+
+		// Called from DispatchCompletions, on whatever thread calls it. Optional.
+		std::function<void(const ReadResult&)> m_OnComplete;
+	};
+
+	/*
+		Reads files on a dedicated I/O thread so loading never stalls the caller. Requests are queued per priority,
+		high priority requests are picked first and requests of the same priority complete in submit order.
+		Completion is reported twice: the future is ready as soon as the data is in the buffer, callbacks are
+		queued and only run from DispatchCompletions so game code sees them at a point of its own choosing.
+		Destroying the service cancels everything that hasn't started yet.
+	*/
+	class AsyncIO
+	{
+	public:
+		AsyncIO();
+		~AsyncIO();
+
+		AsyncIO(const AsyncIO&) = delete;
+		AsyncIO& operator=(const AsyncIO&) = delete;
+
+		static void Create();
+		static AsyncIO& Get();
+		static void Destroy();
+
+		std::future<ReadResult> Read(ReadRequest request);
+		// Queues all requests under one lock, futures (optional) receives one entry per request.
+		void ReadBatch(ReadRequest* requests, uint32 count, std::future<ReadResult>* futures = nullptr);
+
+		// Runs the callbacks of finished requests, returns how many ran.
+		uint32 DispatchCompletions();
+
+		uint32 GetPendingCount() const;
+		// Blocks until every submitted request has finished, callbacks still need DispatchCompletions.
+		void WaitIdle();
+
+		// Size in bytes, 0 when the file doesn't exist. Cheap, for sizing buffers before a read.
+		static uint64 GetFileSize(const char* path);
+
+	private:
+		struct Pending
+		{
+			ReadRequest m_Request;
+			std::promise<ReadResult> m_Promise;
+		};
+
+		struct Completion
+		{
+			std::function<void(const ReadResult&)> m_Callback;
+			ReadResult m_Result;
+		};
+
+		void ThreadMain();
+		static ReadResult Execute(const ReadRequest& request);
+
+		mutable std::mutex m_Mutex;
+		std::condition_variable m_WorkReady;
+		std::condition_variable m_Idle;
+		std::deque<Pending> m_Queues[static_cast<int>(IOPriority::Count)];
+		uint32 m_Pending = 0; // queued and in flight
+		bool m_Stop = false;
+
+		std::mutex m_CompletionMutex;
+		std::vector<Completion> m_Completions;
+
+		std::thread m_Thread;
+
+		static std::unique_ptr<AsyncIO> m_Instance;
+	};
+
+}; // namespace Core
@@ -0,0 +1,315 @@
+#include "Fiber.h"
+#include "logger/Debug.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#if !defined(__x86_64__)
+#include <ucontext.h>
+#endif
+#endif
+
+#if !defined(_WIN32) && defined(__x86_64__)
+/*
+	core_fiber_switch(void** save, void* load): pushes the callee saved registers, MXCSR and the x87 control word on
+	the running stack, stores the stack pointer in *save and pops the same frame off the stack at load. Everything
+	else is caller saved in the System V ABI, so the compiler has already spilled it around the call.
+
+	A new stack starts with that frame laid out by Fiber::Create, returning into core_fiber_start which calls
+	r13(r12) on a 16 byte aligned stack.
+*/
+asm(R"(
+	.text
+	.globl core_fiber_switch
+	.hidden core_fiber_switch
+	.type core_fiber_switch, @function
+core_fiber_switch:
+	pushq %rbp
+	pushq %rbx
+	pushq %r12
+	pushq %r13
+	pushq %r14
+	pushq %r15
+	subq $8, %rsp
+	stmxcsr (%rsp)
+	fnstcw 4(%rsp)
+	movq %rsp, (%rdi)
+	movq %rsi, %rsp
+	ldmxcsr (%rsp)
+	fldcw 4(%rsp)
+	addq $8, %rsp
+	popq %r15
+	popq %r14
+	popq %r13
+	popq %r12
+	popq %rbx
+	popq %rbp
+	ret
+	.size core_fiber_switch, .-core_fiber_switch
+
+	.globl core_fiber_start
+	.hidden core_fiber_start
+	.type core_fiber_start, @function
+core_fiber_start:
+	movq %r12, %rdi
+	callq *%r13
+	ud2
+	.size core_fiber_start, .-core_fiber_start
+)");
+
+extern "C" void core_fiber_switch(void** save, void* load);
+extern "C" void core_fiber_start();
+#endif
+
+namespace Core
+{
+#ifndef _WIN32
+	namespace
+	{
+		uint64 GetPageSize()
+		{
+			static const uint64 pageSize = static_cast<uint64>(sysconf(_SC_PAGESIZE));
+			return pageSize;
+		}
+
+		// the guard page sits at the lowest address, stacks grow down towards it
+		void* AllocateStack(uint64 stackSize)
+		{
+			const uint64 pageSize = GetPageSize();
+			void* memory = mmap(nullptr, stackSize + pageSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+								-1, 0);
+			if(memory == MAP_FAILED)
+				return nullptr;
+
+			if(mprotect(memory, pageSize, PROT_NONE) != 0)
+			{
+				munmap(memory, stackSize + pageSize);
+				return nullptr;
+			}
+			return memory;
+		}
+
+		void FreeStack(void* stack, uint64 stackSize) { munmap(stack, stackSize + GetPageSize()); }
+
+	}; // namespace
+#endif
+
+	Fiber::~Fiber()
+	{
+		ASSERT(!m_IsThread, "Fiber destroyed while it still holds a thread");
+		Destroy();
+	}
+
+	void Fiber::Start(Fiber* fiber)
+	{
+		fiber->m_Entry(fiber);
+		ASSERT(false, "Fiber entry functions must never return");
+	}
+
+#ifdef _WIN32
+	void Fiber::ConvertThread()
+	{
+		ASSERT(!m_Context, "Fiber is already in use");
+		// a thread that already is a fiber stays one when it is reverted
+		m_OwnsThread = !IsThreadAFiber();
+		m_Context = m_OwnsThread ? ConvertThreadToFiberEx(this, FIBER_FLAG_FLOAT_SWITCH) : GetCurrentFiber();
+		m_IsThread = true;
+	}
+
+	void Fiber::RevertThread()
+	{
+		ASSERT(m_IsThread, "Fiber was not converted from a thread");
+		if(m_OwnsThread)
+			ConvertFiberToThread();
+		m_Context = nullptr;
+		m_IsThread = false;
+	}
+
+	bool Fiber::Create(uint32 stackSize, EntryFunction entry, void* userData)
+	{
+		ASSERT(!m_Context, "Fiber is already in use");
+		m_Entry = entry;
+		m_UserData = userData;
+
+		// the OS reserves the stack with its own guard page
+		m_Context = CreateFiberEx(stackSize, stackSize, FIBER_FLAG_FLOAT_SWITCH,
+								  [](void* fiber) { Start(static_cast<Fiber*>(fiber)); }, this);
+		m_StackSize = stackSize;
+		return m_Context != nullptr;
+	}
+
+	void Fiber::Destroy()
+	{
+		if(m_Context && !m_IsThread)
+			DeleteFiber(m_Context);
+		m_Context = nullptr;
+		m_StackSize = 0;
+	}
+
+	void Fiber::SwitchTo(Fiber& target) { SwitchToFiber(target.m_Context); }
+#else
+	void Fiber::ConvertThread()
+	{
+		ASSERT(!m_Stack, "Fiber is already in use");
+#if !defined(__x86_64__)
+		m_Context = new ucontext_t();
+#endif
+		m_IsThread = true;
+	}
+
+	void Fiber::RevertThread()
+	{
+		ASSERT(m_IsThread, "Fiber was not converted from a thread");
+#if !defined(__x86_64__)
+		delete static_cast<ucontext_t*>(m_Context);
+#endif
+		m_Context = nullptr;
+		m_IsThread = false;
+	}
+
+	bool Fiber::Create(uint32 stackSize, EntryFunction entry, void* userData)
+	{
+		ASSERT((!m_Stack && !m_IsThread), "Fiber is already in use");
+		const uint64 pageSize = GetPageSize();
+		m_StackSize = (stackSize + pageSize - 1) / pageSize * pageSize;
+		m_Stack = AllocateStack(m_StackSize);
+		if(!m_Stack)
+		{
+			m_StackSize = 0;
+			return false;
+		}
+		m_Entry = entry;
+		m_UserData = userData;
+
+		uint8* top = static_cast<uint8*>(m_Stack) + pageSize + m_StackSize;
+#if defined(__x86_64__)
+		/*
+			The frame core_fiber_switch pops, from the bottom: MXCSR and the x87 control word, r15, r14, r13, r12, rbx,
+			rbp and the return address. r13 is the function core_fiber_start calls, r12 its argument. The two zeros on
+			top keep the stack 16 byte aligned at that call.
+		*/
+		uint64* frame = reinterpret_cast<uint64*>(top) - 10;
+		frame[0] = 0x1F80ull | (0x037Full << 32);
+		frame[1] = 0;
+		frame[2] = 0;
+		frame[3] = reinterpret_cast<uint64>(&Fiber::Start);
+		frame[4] = reinterpret_cast<uint64>(this);
+		frame[5] = 0;
+		frame[6] = 0;
+		frame[7] = reinterpret_cast<uint64>(&core_fiber_start);
+		frame[8] = 0;
+		frame[9] = 0;
+		m_Context = frame;
+#else
+		ucontext_t* context = new ucontext_t();
+		getcontext(context);
+		context->uc_stack.ss_sp = static_cast<uint8*>(m_Stack) + pageSize;
+		context->uc_stack.ss_size = m_StackSize;
+		context->uc_link = nullptr;
+		// makecontext only passes ints along
+		void (*start)(uint32, uint32) = [](uint32 high, uint32 low) {
+			Start(reinterpret_cast<Fiber*>((static_cast<uint64>(high) << 32) | low));
+		};
+		const uint64 address = reinterpret_cast<uint64>(this);
+		makecontext(context, reinterpret_cast<void (*)()>(start), 2, static_cast<uint32>(address >> 32),
+					static_cast<uint32>(address));
+		m_Context = context;
+		(void)top;
+#endif
+		return true;
+	}
+
+	void Fiber::Destroy()
+	{
+		if(!m_Stack)
+			return;
+#if !defined(__x86_64__)
+		delete static_cast<ucontext_t*>(m_Context);
+#endif
+		FreeStack(m_Stack, m_StackSize);
+		m_Stack = nullptr;
+		m_Context = nullptr;
+		m_StackSize = 0;
+	}
+
+	void Fiber::SwitchTo(Fiber& target)
+	{
+#if defined(__x86_64__)
+		core_fiber_switch(&m_Context, target.m_Context);
+#else
+		swapcontext(static_cast<ucontext_t*>(m_Context), static_cast<ucontext_t*>(target.m_Context));
+#endif
+	}
+#endif
+
+	bool FiberPool::Init(uint32 fiberCount, uint32 stackSize, Fiber::EntryFunction entry, void* userData)
+	{
+		ASSERT(!m_Fibers, "FiberPool is already initialized");
+		m_Fibers.reset(new Fiber[fiberCount]);
+		m_FiberCount = fiberCount;
+		m_Free.reserve(fiberCount);
+		for(uint32 i = 0; i < fiberCount; ++i)
+		{
+			if(!m_Fibers[i].Create(stackSize, entry, userData))
+			{
+				m_Fibers.reset();
+				m_FiberCount = 0;
+				return false;
+			}
+		}
+
+		// handed out from the back, lowest index first
+		for(uint32 i = fiberCount; i > 0; --i)
+			m_Free.push_back(&m_Fibers[i - 1]);
+		return true;
+	}
+
+	void FiberPool::Destroy()
+	{
+		if(!m_Fibers)
+			return;
+
+		ASSERT(m_Free.size() == m_FiberCount, "FiberPool destroyed with fibers still in use");
+		m_Fibers.reset();
+		m_FiberCount = 0;
+		m_Free.clear();
+	}
+
+	Fiber* FiberPool::Acquire()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		if(m_Free.empty())
+		{
+			++m_Exhausted;
+			return nullptr;
+		}
+
+		Fiber* fiber = m_Free.back();
+		m_Free.pop_back();
+		const uint32 inUse = m_FiberCount - static_cast<uint32>(m_Free.size());
+		m_PeakInUse = inUse > m_PeakInUse ? inUse : m_PeakInUse;
+		return fiber;
+	}
+
+	void FiberPool::Release(Fiber* fiber)
+	{
+		ASSERT(GetIndex(fiber) < m_FiberCount, "Fiber does not belong to this pool");
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Free.push_back(fiber);
+	}
+
+	FiberPoolStats FiberPool::GetStats() const
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		FiberPoolStats stats;
+		stats.m_FiberCount = m_FiberCount;
+		stats.m_InUse = m_FiberCount - static_cast<uint32>(m_Free.size());
+		stats.m_PeakInUse = m_PeakInUse;
+		stats.m_Exhausted = m_Exhausted;
+		stats.m_StackSize = m_FiberCount > 0 ? m_Fibers[0].GetStackSize() : 0;
+		return stats;
+	}
+
+}; // namespace Core
@@ -0,0 +1,100 @@
+#pragma once
+#include "Types.h"
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Core
+{
+	/*
+		A context with its own stack that threads switch between by hand. Windows uses the OS fibers, Linux x86-64 a
+		small assembly switch that only saves the callee saved registers and the float control words, other
+		platforms fall back to ucontext.
+
+		A thread has to ConvertThread a Fiber for its own stack before it can switch to anything else. Fibers may be
+		resumed on a different thread than the one they were suspended on, code that runs across a switch must not
+		hold on to thread locals it read before it.
+	*/
+	class Fiber
+	{
+	public:
+		// Must never return, switch to another fiber instead.
+		using EntryFunction = void (*)(Fiber* fiber);
+
+		Fiber() = default;
+		~Fiber();
+
+		Fiber(const Fiber&) = delete;
+		Fiber& operator=(const Fiber&) = delete;
+
+		void ConvertThread();
+		void RevertThread();
+
+		/*
+			Allocates a stack of stackSize bytes rounded up to whole pages with an inaccessible guard page under it,
+			so running off the end faults instead of silently overwriting the memory next to it. The entry runs the
+			first time something switches to the fiber.
+		*/
+		bool Create(uint32 stackSize, EntryFunction entry, void* userData);
+		void Destroy();
+
+		// Suspends this fiber, which has to be the one running, and continues target. Returns once switched back to.
+		void SwitchTo(Fiber& target);
+
+		void* GetUserData() const { return m_UserData; }
+		uint64 GetStackSize() const { return m_StackSize; }
+
+	private:
+		static void Start(Fiber* fiber);
+
+		void* m_Context = nullptr;
+		void* m_Stack = nullptr; // guard page included
+		uint64 m_StackSize = 0;
+		EntryFunction m_Entry = nullptr;
+		void* m_UserData = nullptr;
+		bool m_IsThread = false;
+		bool m_OwnsThread = false; // Windows, the thread was not a fiber before ConvertThread
+	};
+
+	struct FiberPoolStats
+	{
+		uint32 m_FiberCount = 0;
+		uint32 m_InUse = 0;
+		uint32 m_PeakInUse = 0;
+		uint64 m_Exhausted = 0; // Acquire calls that found no free fiber
+		uint64 m_StackSize = 0;
+	};
+
+	// A fixed set of fibers that all start in the same entry function, handed out and taken back from any thread.
+	class FiberPool
+	{
+	public:
+		FiberPool() = default;
+		~FiberPool() { Destroy(); }
+
+		FiberPool(const FiberPool&) = delete;
+		FiberPool& operator=(const FiberPool&) = delete;
+
+		bool Init(uint32 fiberCount, uint32 stackSize, Fiber::EntryFunction entry, void* userData);
+		void Destroy();
+
+		// nullptr when every fiber is in use
+		Fiber* Acquire();
+		void Release(Fiber* fiber);
+
+		uint32 GetIndex(const Fiber* fiber) const { return static_cast<uint32>(fiber - m_Fibers.get()); }
+		uint32 GetFiberCount() const { return m_FiberCount; }
+		FiberPoolStats GetStats() const;
+
+	private:
+		std::unique_ptr<Fiber[]> m_Fibers;
+		uint32 m_FiberCount = 0;
+
+		mutable std::mutex m_Mutex;
+		std::vector<Fiber*> m_Free;
+		uint32 m_PeakInUse = 0;
+		uint64 m_Exhausted = 0;
+	};
+
+}; // namespace Core
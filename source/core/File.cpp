@@ -1,6 +1,8 @@
 #include "File.h"
+#include "memory/Allocator.h"
 
 #include <cstdio>
+#include <cstring>
 #include <cassert>
 #include <memory>
 
@@ -10,19 +12,8 @@ namespace Core
 
 	File::~File()
 	{
-		if(m_Mode == FileMode::WRITE_FILE)
-		{
-			char buff[128]{ 0 };
-			GetFlags(buff);
-
-			if(FILE* hFile = fopen(m_Filepath, buff))
-			{
-				fwrite(m_Buffer, 1, m_FileSize, hFile);
-				fclose(hFile);
-			}
-		}
-
-		delete m_Buffer;
+		Close();
+		GetAllocator(MemoryTag::Core)->Free(m_Buffer, m_AllocatedSize, alignof(char));
 		m_Buffer = nullptr;
 	}
 
@@ -30,99 +21,90 @@ namespace Core
 	{
 		m_Mode = mode;
 		m_Filepath = filepath;
-		if(m_Mode == FileMode::READ_FILE)
+		if(m_Mode == FileMode::READ_FILE || m_Mode == FileMode::READ_MAPPED)
 			OpenForRead();
-		else if(m_Mode == FileMode::WRITE_FILE)
+		else if(m_Mode & FileMode::WRITE_FILE)
 			OpenForWrite();
 		else
 			assert(!"Failed to open file!");
 	}
 
-	void File::Flush()
-	{
-		if(m_Mode == FileMode::WRITE_FILE)
-		{
-			char buff[128]{ 0 };
-			GetFlags(buff);
-
-			if(FILE* hFile = fopen(m_Filepath, buff))
-			{
-				fwrite(m_Buffer, 1, m_FileSize, hFile);
-			}
-		}
-	}
+	bool File::Flush() { return m_Writer.Flush(); }
 
-	void File::GetFlags(char* const fileMode)
-	{
-		int32 pos = 0;
-
-		if(m_Mode & FileMode::READ_FILE)
-		{
-			sprintf(&fileMode[pos], "r");
-			pos += sizeof(char);
-		}
-
-		if(m_Mode & FileMode::WRITE_FILE)
-		{
-			sprintf(&fileMode[pos], "w");
-			pos += sizeof(char);
-		}
-
-		if(m_Mode & FileMode::BINARY)
-		{
-			sprintf(&fileMode[pos], "b");
-			pos += sizeof(char);
-		}
-	}
+	bool File::Close() { return m_Writer.Close(); }
 
-	void File::Resize(const uint32 element_size, const uint32 nof_elements)
+	void File::Resize(const uint64 size)
 	{
-		if(m_FileSize + (element_size * nof_elements) > m_AllocatedSize)
+		if(size > m_AllocatedSize)
 		{
-			const uint32 newSize = static_cast<uint32>(static_cast<float>(m_FileSize + (element_size * nof_elements)) * 1.5f);
-			char* buffer = new char[newSize];
-			memcpy(&buffer[0], &m_Buffer[0], m_FileSize);
+			const uint64 newSize = size + size / 2;
+			IAllocator* allocator = GetAllocator(MemoryTag::Core);
+			char* buffer = static_cast<char*>(allocator->Allocate(newSize, alignof(char)));
+			if(m_FileSize > 0)
+				memcpy(&buffer[0], &m_Buffer[0], m_FileSize);
+			allocator->Free(m_Buffer, m_AllocatedSize, alignof(char));
 			m_AllocatedSize = newSize;
-			delete[] m_Buffer;
-			m_Buffer = nullptr;
 			m_Buffer = buffer;
 		}
 	}
 
-	void File::Write(const void* data, uint32 element_size, uint32 nof_elements)
+	void File::Write(const void* data, uint64 element_size, uint64 nof_elements)
 	{
-		Resize(element_size, nof_elements);
-		if(m_AllocatedSize > m_FileSize + (element_size * nof_elements))
-		{
-			memcpy(&m_Buffer[m_FileSize], data, (element_size * nof_elements));
-			m_FileSize += element_size * nof_elements;
-		}
-		else
-		{
-			assert(!"Failed to resize allocated size to above fileSize + element_size * nof_elements!");
-		}
+		m_Writer.Write(data, element_size * nof_elements);
 	}
 
 	void File::OpenForWrite()
 	{
-		constexpr int allocSize = 1024;
-		m_Buffer = new char[allocSize];
-		m_AllocatedSize = allocSize;
+		FileWriter::Options options;
+		options.m_Direct = (m_Mode & FileMode::DIRECT) != 0;
+		options.m_Sync = (m_Mode & FileMode::SYNC) != 0;
+		if(!m_Writer.Open(m_Filepath, options))
+			assert(!"Failed to open file for writing!");
 	}
 
 	void File::OpenForRead()
 	{
+		if((m_Mode & FileMode::MAPPED) && m_Mapping.Open(m_Filepath))
+		{
+			m_FileSize = m_Mapping.GetSize();
+			return;
+		}
+
 		if(FILE* hFile = fopen(m_Filepath, "rb"))
 		{
-			fseek(hFile, 0, SEEK_END);
-			m_FileSize = ftell(hFile);
-			rewind(hFile);
+			ReadBuffered(hFile);
+			fclose(hFile);
+		}
+	}
 
-			m_Buffer = new char[m_FileSize];
-			memset(m_Buffer, 0, m_FileSize);
+	void File::ReadBuffered(FILE* hFile)
+	{
+		// long is 32 bit on Windows, the 64 bit versions keep files past 2 GB working
+		int64 size = -1;
+#ifdef _WIN32
+		if(_fseeki64(hFile, 0, SEEK_END) == 0)
+			size = _ftelli64(hFile);
+#else
+		if(fseeko(hFile, 0, SEEK_END) == 0)
+			size = ftello(hFile);
+#endif
+
+		if(size >= 0)
+		{
+			rewind(hFile);
+			m_Buffer = static_cast<char*>(GetAllocator(MemoryTag::Core)->Allocate(size, alignof(char)));
+			m_AllocatedSize = static_cast<uint64>(size);
+			m_FileSize = fread(m_Buffer, 1, static_cast<size_t>(size), hFile);
+			return;
+		}
 
-			fread(m_Buffer, 1, m_FileSize, hFile);
-			fclose(hFile);
+		// pipes can't seek, read until they run dry
+		char chunk[4096];
+		while(const uint64 read = fread(chunk, 1, sizeof(chunk), hFile))
+		{
+			Resize(m_FileSize + read);
+			memcpy(&m_Buffer[m_FileSize], chunk, read);
+			m_FileSize += read;
 		}
 	}
 }; // namespace Core
@@ -1,5 +1,10 @@
 #pragma once
 #include "Types.h"
+#include "FileWriter.h"
+#include "MappedFile.h"
+#include "containers/Span.h"
+
+#include <cstdio>
 
 namespace Core
 {
@@ -15,33 +20,47 @@ namespace Core
 			APPEND = 4,
 			ATE = 8,
 			TRUNC = 16,
-			BINARY = 32
+			BINARY = 32,
+			MAPPED = 64,
+			DIRECT = 128, // write mode, skip the page cache, see FileWriter::Options
+			SYNC = 256,	  // write mode, Flush and Close wait for the data to reach the device
 
+			// READ_FILE without the copy, the contents are mapped straight from disk when the file allows it
+			READ_MAPPED = READ_FILE | MAPPED,
 		};
 
 		File(const char* filepath, FileMode mode = FileMode::READ_FILE);
 		File() = default;
 		~File();
 
+		File(const File&) = delete;
+		File& operator=(const File&) = delete;
+
 		void Open(const char* filepath, FileMode mode);
-		void Flush();
+		// Write mode streams to disk as it goes, these only push out what is still buffered. false if a write failed.
+		bool Flush();
+		bool Close();
 
-		uint32 GetSize() const { return m_FileSize; }
-		const char* const GetBuffer() const { return m_Buffer; }
-		void Write(const void* data, uint32 element_size, uint32 nof_elements);
+		uint64 GetSize() const { return m_Writer.IsOpen() ? m_Writer.GetSize() : m_FileSize; }
+		const char* const GetBuffer() const { return m_Mapping.IsOpen() ? m_Mapping.GetData() : m_Buffer; }
+		// The file contents, mapped or buffered. Only valid while this File is alive.
+		Span<const char> GetView() const { return Span<const char>(GetBuffer(), m_FileSize); }
+		bool IsMapped() const { return m_Mapping.IsOpen(); }
+		void Write(const void* data, uint64 element_size, uint64 nof_elements);
 
 	private:
-		void GetFlags(char* const fileMode);
-
-		void Resize(const uint32 element_size, const uint32 nof_elements);
+		void Resize(const uint64 size);
 
 		void OpenForWrite();
 		void OpenForRead();
+		void ReadBuffered(FILE* hFile);
 		const char* m_Filepath{ 0 };
 		FileMode m_Mode = FileMode::NONE;
 		char* m_Buffer = nullptr;
-		uint32 m_FileSize = 0;
-		uint32 m_AllocatedSize = 0;
+		uint64 m_FileSize = 0;
+		uint64 m_AllocatedSize = 0;
+		MappedFile m_Mapping;
+		FileWriter m_Writer;
 	};
 
 }; // namespace Core
@@ -0,0 +1,279 @@
+#include "FileWriter.h"
+#include "memory/Allocator.h"
+#include "logger/Debug.h"
+
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace Core
+{
+	namespace
+	{
+		// O_DIRECT wants the memory, the size and the file offset aligned, 4 KB covers every common block size
+		constexpr uint64 s_Alignment = 4096;
+	}; // namespace
+
+	FileWriter::~FileWriter() { Close(); }
+
+	bool FileWriter::Open(const char* filepath) { return Open(filepath, Options()); }
+
+	bool FileWriter::Open(const char* filepath, const Options& options)
+	{
+		Close();
+
+#ifdef _WIN32
+		// FILE_FLAG_NO_BUFFERING can't be switched off for the unaligned tail, write through is the closest fit
+		const DWORD flags = FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN |
+							(options.m_Direct ? FILE_FLAG_WRITE_THROUGH : 0);
+		HANDLE file = CreateFileA(filepath, GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, flags, nullptr);
+		if(file == INVALID_HANDLE_VALUE)
+			return false;
+
+		m_Handle = reinterpret_cast<intptr_t>(file);
+		m_Direct = options.m_Direct;
+#else
+		const int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+		int file = -1;
+		m_Direct = false;
+#ifdef O_DIRECT
+		if(options.m_Direct)
+		{
+			// tmpfs and some network file systems refuse O_DIRECT, those get cached writes
+			file = open(filepath, flags | O_DIRECT, 0644);
+			m_Direct = file >= 0;
+		}
+#endif
+		if(file < 0)
+			file = open(filepath, flags, 0644);
+		if(file < 0)
+			return false;
+
+		m_Handle = file;
+#endif
+
+		m_Sync = options.m_Sync;
+		m_BufferCount = std::max(options.m_BufferCount, 1u);
+		m_BufferSize = (std::max<uint64>(options.m_BufferSize, 1) + s_Alignment - 1) & ~(s_Alignment - 1);
+
+		IAllocator* allocator = GetAllocator(MemoryTag::Core);
+		m_Buffers = static_cast<Buffer*>(allocator->Allocate(sizeof(Buffer) * m_BufferCount, alignof(Buffer)));
+		for(uint32 i = 0; i < m_BufferCount; ++i)
+		{
+			m_Buffers[i] = Buffer();
+			m_Buffers[i].m_Data = static_cast<char*>(allocator->Allocate(m_BufferSize, s_Alignment));
+		}
+
+		m_Submitted = 0;
+		m_Completed = 0;
+		m_Written = 0;
+		m_FileOffset = 0;
+		m_Failed = false;
+		m_Stop = false;
+		m_Thread = std::thread(&FileWriter::ThreadMain, this);
+		return true;
+	}
+
+	void FileWriter::Write(const void* data, uint64 size)
+	{
+		ASSERT(IsOpen(), "Writing to a closed file!");
+		const char* source = static_cast<const char*>(data);
+		while(size > 0)
+		{
+			Buffer& buffer = m_Buffers[m_Submitted % m_BufferCount];
+			const uint64 count = std::min(size, m_BufferSize - buffer.m_Size);
+			memcpy(&buffer.m_Data[buffer.m_Size], source, count);
+			buffer.m_Size += count;
+			m_Written += count;
+			source += count;
+			size -= count;
+
+			if(buffer.m_Size == m_BufferSize)
+				Submit();
+		}
+	}
+
+	bool FileWriter::Flush()
+	{
+		if(!IsOpen())
+			return false;
+
+		// the thread is idle after this, the rest is written from here
+		WaitForDisk();
+
+		bool ok = true;
+		Buffer& buffer = m_Buffers[m_Submitted % m_BufferCount];
+		if(buffer.m_Size > 0)
+		{
+			// with O_DIRECT the aligned part goes out now and the tail stays in the buffer, it is written cached so
+			// it is on disk after the flush and written again with the rest once the buffer fills up
+			const uint64 aligned = m_Direct ? buffer.m_Size & ~(s_Alignment - 1) : buffer.m_Size;
+			const uint64 tail = buffer.m_Size - aligned;
+			ok = WriteAt(buffer.m_Data, aligned, m_FileOffset);
+			if(tail > 0)
+			{
+				ok = WriteTail(&buffer.m_Data[aligned], tail, m_FileOffset + aligned) && ok;
+				memmove(buffer.m_Data, &buffer.m_Data[aligned], tail);
+			}
+
+			m_FileOffset += aligned;
+			buffer.m_Size = tail;
+		}
+
+		if(m_Sync)
+			ok = Sync() && ok;
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Failed |= !ok;
+		return !m_Failed;
+	}
+
+	bool FileWriter::Close()
+	{
+		if(!IsOpen())
+			return true;
+
+		const bool ok = Flush();
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Stop = true;
+		}
+		m_WorkReady.notify_one();
+		m_Thread.join();
+
+#ifdef _WIN32
+		CloseHandle(reinterpret_cast<HANDLE>(m_Handle));
+#else
+		close(static_cast<int>(m_Handle));
+#endif
+		m_Handle = -1;
+
+		IAllocator* allocator = GetAllocator(MemoryTag::Core);
+		for(uint32 i = 0; i < m_BufferCount; ++i)
+			allocator->Free(m_Buffers[i].m_Data, m_BufferSize, s_Alignment);
+		allocator->Free(m_Buffers, sizeof(Buffer) * m_BufferCount, alignof(Buffer));
+		m_Buffers = nullptr;
+		return ok;
+	}
+
+	void FileWriter::Submit()
+	{
+		Buffer& buffer = m_Buffers[m_Submitted % m_BufferCount];
+		buffer.m_Offset = m_FileOffset;
+		m_FileOffset += buffer.m_Size;
+
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		++m_Submitted;
+		m_WorkReady.notify_one();
+
+		// the next buffer has to be on disk before it can be filled again
+		m_BufferFree.wait(lock, [this] { return m_Submitted - m_Completed < m_BufferCount; });
+		m_Buffers[m_Submitted % m_BufferCount].m_Size = 0;
+	}
+
+	void FileWriter::WaitForDisk()
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_BufferFree.wait(lock, [this] { return m_Completed == m_Submitted; });
+	}
+
+	void FileWriter::ThreadMain()
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		while(true)
+		{
+			m_WorkReady.wait(lock, [this] { return m_Stop || m_Completed != m_Submitted; });
+			if(m_Completed == m_Submitted)
+				return;
+
+			const Buffer& buffer = m_Buffers[m_Completed % m_BufferCount];
+			lock.unlock();
+			const bool ok = WriteAt(buffer.m_Data, buffer.m_Size, buffer.m_Offset);
+			lock.lock();
+
+			m_Failed |= !ok;
+			++m_Completed;
+			m_BufferFree.notify_one();
+		}
+	}
+
+#ifdef _WIN32
+	bool FileWriter::WriteAt(const char* data, uint64 size, uint64 offset)
+	{
+		HANDLE file = reinterpret_cast<HANDLE>(m_Handle);
+		while(size > 0)
+		{
+			OVERLAPPED overlapped = {};
+			overlapped.Offset = static_cast<DWORD>(offset);
+			overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+
+			DWORD written = 0;
+			const DWORD count = static_cast<DWORD>(std::min<uint64>(size, 1u << 30));
+			if(!WriteFile(file, data, count, &written, &overlapped) || written == 0)
+				return false;
+
+			data += written;
+			size -= written;
+			offset += written;
+		}
+		return true;
+	}
+
+	bool FileWriter::WriteTail(const char* data, uint64 size, uint64 offset) { return WriteAt(data, size, offset); }
+
+	bool FileWriter::Sync() { return FlushFileBuffers(reinterpret_cast<HANDLE>(m_Handle)) != 0; }
+#else
+	bool FileWriter::WriteAt(const char* data, uint64 size, uint64 offset)
+	{
+		const int file = static_cast<int>(m_Handle);
+		while(size > 0)
+		{
+			const ssize_t written = pwrite(file, data, size, static_cast<off_t>(offset));
+			if(written < 0 && errno == EINTR)
+				continue;
+			if(written <= 0)
+				return false;
+
+			data += written;
+			size -= written;
+			offset += written;
+		}
+		return true;
+	}
+
+	bool FileWriter::WriteTail(const char* data, uint64 size, uint64 offset)
+	{
+#ifdef O_DIRECT
+		// O_DIRECT is a property of the open file, the thread is idle so it can be dropped for one write
+		if(m_Direct)
+		{
+			const int file = static_cast<int>(m_Handle);
+			const int flags = fcntl(file, F_GETFL);
+			fcntl(file, F_SETFL, flags & ~O_DIRECT);
+			const bool ok = WriteAt(data, size, offset);
+			fcntl(file, F_SETFL, flags);
+			return ok;
+		}
+#endif
+		return WriteAt(data, size, offset);
+	}
+
+	bool FileWriter::Sync()
+	{
+#ifdef __APPLE__
+		return fsync(static_cast<int>(m_Handle)) == 0;
+#else
+		return fdatasync(static_cast<int>(m_Handle)) == 0;
+#endif
+	}
+#endif
+
+}; // namespace Core
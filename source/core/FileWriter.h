@@ -0,0 +1,88 @@
+#pragma once
+#include "Types.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace Core
+{
+	/*
+		Streams a file to disk through a fixed ring of write buffers. Write copies into the current buffer, full
+		buffers are handed to a background thread that writes them while the next one fills up, so memory use stays at
+		m_BufferCount * m_BufferSize however big the file gets. Write only blocks when every buffer is still waiting
+		for the disk. Flush pushes everything written so far to the OS (and to the device with m_Sync), Close does the
+		same and releases the file. Returns false from Close/Flush if any write failed along the way.
+	*/
+	class FileWriter
+	{
+	public:
+		struct Options
+		{
+			uint32 m_BufferSize = 1 << 20; // rounded up to a multiple of 4 KB
+			uint32 m_BufferCount = 4;
+			// Bypass the page cache (O_DIRECT, write through on Windows). Falls back to cached writes on file systems
+			// that don't support it.
+			bool m_Direct = false;
+			// fdatasync (FlushFileBuffers on Windows) on every Flush and on Close.
+			bool m_Sync = false;
+		};
+
+		FileWriter() = default;
+		~FileWriter();
+
+		FileWriter(const FileWriter&) = delete;
+		FileWriter& operator=(const FileWriter&) = delete;
+
+		// Creates or truncates the file.
+		bool Open(const char* filepath);
+		bool Open(const char* filepath, const Options& options);
+		void Write(const void* data, uint64 size);
+		bool Flush();
+		bool Close();
+
+		bool IsOpen() const { return m_Buffers != nullptr; }
+		bool IsDirect() const { return m_Direct; }
+		// Bytes written so far, flushed or not.
+		uint64 GetSize() const { return m_Written; }
+
+	private:
+		struct Buffer
+		{
+			char* m_Data = nullptr;
+			uint64 m_Size = 0;
+			uint64 m_Offset = 0; // where in the file the buffer goes
+		};
+
+		void Submit();
+		void WaitForDisk();
+		void ThreadMain();
+		bool WriteAt(const char* data, uint64 size, uint64 offset);
+		bool WriteTail(const char* data, uint64 size, uint64 offset);
+		bool Sync();
+
+		Buffer* m_Buffers = nullptr;
+		uint32 m_BufferCount = 0;
+		uint64 m_BufferSize = 0;
+		bool m_Direct = false;
+		bool m_Sync = false;
+
+		// buffer n of the file lives in m_Buffers[n % m_BufferCount], the writer fills m_Submitted and the thread
+		// writes everything from m_Completed up to it
+		uint64 m_Submitted = 0;
+		uint64 m_Completed = 0;
+		uint64 m_Written = 0;
+		uint64 m_FileOffset = 0; // offset of the buffer being filled
+		bool m_Failed = false;
+		bool m_Stop = false;
+
+		std::mutex m_Mutex;
+		std::condition_variable m_WorkReady;
+		std::condition_variable m_BufferFree;
+		std::thread m_Thread;
+
+		intptr_t m_Handle = -1;
+	};
+
+}; // namespace Core
@@ -0,0 +1,397 @@
+#include "JobSystem.h"
+#include "logger/Debug.h"
+
+namespace Core
+{
+	namespace
+	{
+		// which system the current thread belongs to and its slot in it
+		thread_local const JobSystem* t_System = nullptr;
+		thread_local uint32 t_ThreadIndex = JobSystem::s_NotAJobThread;
+		thread_local uint32 t_StealCursor = 0;
+		// the pool fiber the thread is running, null on its own stack. Never read after a fiber switch in the same
+		// function, the fiber may continue on another thread.
+		thread_local Fiber* t_CurrentFiber = nullptr;
+
+		// how many ranges ParallelFor makes per thread when it picks the grain size itself
+		constexpr uint32 s_RangesPerThread = 4;
+
+		// rounds a worker looks for work before it goes to sleep, jobs tend to come in bursts
+		constexpr uint32 s_SpinCount = 64;
+	};
+
+	std::unique_ptr<JobSystem> JobSystem::m_Instance;
+
+	JobSystem::JobSystem(uint32 threadCount, uint32 fiberCount, uint32 fiberStackSize)
+	{
+		const uint32 hardwareThreads = std::thread::hardware_concurrency();
+		m_ThreadCount = threadCount > 0 ? threadCount : (hardwareThreads > 0 ? hardwareThreads : 1);
+		m_Deques.reset(new Deque[m_ThreadCount]);
+		m_JobPool.Init(s_DequeCapacity);
+
+		ASSERT(t_System == nullptr, "This thread already belongs to a JobSystem");
+		t_System = this;
+		t_ThreadIndex = 0;
+
+		// without fibers if the stacks can't be had, jobs still run, just on the threads' own stacks
+		if(fiberCount > 0 && m_FiberPool.Init(fiberCount, fiberStackSize, &JobSystem::FiberMain, this))
+		{
+			m_FiberStates.reset(new FiberState[fiberCount]);
+			m_ThreadFibers.reset(new Fiber[m_ThreadCount]);
+			m_ThreadFibers[0].ConvertThread();
+		}
+		ASSERT((fiberCount == 0 || m_ThreadFibers), "Failed to create the fiber pool");
+
+		m_Workers.reserve(m_ThreadCount - 1);
+		for(uint32 i = 1; i < m_ThreadCount; ++i)
+			m_Workers.emplace_back(&JobSystem::WorkerMain, this, i);
+	}
+
+	JobSystem::~JobSystem()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_SleepMutex);
+			m_Stop.store(true);
+		}
+		m_WorkReady.notify_all();
+		for(std::thread& worker : m_Workers)
+			worker.join();
+
+		// the workers are gone, whatever is left still runs so no counter is left waiting
+		for(;;)
+		{
+			if(Fiber* fiber = TakeReadyFiber())
+				Resume(fiber, 0);
+			else if(Job* job = FindJob(0))
+				RunJob(job, 0);
+			else if(ProcessMainThreadJobs() == 0)
+				break;
+		}
+		ASSERT(m_WaitingCount.load() == 0, "JobSystem destroyed with jobs waiting on counters that never finish");
+
+		if(m_ThreadFibers)
+		{
+			m_FiberPool.Destroy();
+			m_ThreadFibers[0].RevertThread();
+		}
+		t_System = nullptr;
+		t_ThreadIndex = s_NotAJobThread;
+	}
+
+	void JobSystem::Create(uint32 threadCount, uint32 fiberCount, uint32 fiberStackSize)
+	{
+		m_Instance = std::make_unique<JobSystem>(threadCount, fiberCount, fiberStackSize);
+	}
+
+	JobSystem& JobSystem::Get() { return *m_Instance; }
+
+	void JobSystem::Destroy() { m_Instance.reset(); }
+
+	void JobSystem::Run(JobFunction job, JobCounter* counter)
+	{
+		if(counter)
+			counter->m_Count.fetch_add(1, std::memory_order_relaxed);
+		Job* created = CreateJob(std::move(job), counter);
+
+		// counted before it can be stolen so m_Queued never drops below zero
+		m_Queued.fetch_add(1);
+		const uint32 threadIndex = GetThreadIndex();
+		if(threadIndex == s_NotAJobThread)
+		{
+			std::lock_guard<std::mutex> lock(m_ExternalMutex);
+			m_ExternalJobs.push_back(created);
+			m_ExternalCount.fetch_add(1, std::memory_order_release);
+		}
+		else if(!m_Deques[threadIndex].Push(created))
+		{
+			m_Queued.fetch_sub(1);
+			Execute(created);
+			return;
+		}
+
+		// pairs with the sleeping worker checking m_Queued after counting itself in m_Sleeping
+		WakeWorker();
+	}
+
+	void JobSystem::RunOnMainThread(JobFunction job, JobCounter* counter)
+	{
+		if(counter)
+			counter->m_Count.fetch_add(1, std::memory_order_relaxed);
+		Job* created = CreateJob(std::move(job), counter);
+
+		std::lock_guard<std::mutex> lock(m_MainThreadMutex);
+		m_MainThreadJobs.push_back(created);
+	}
+
+	void JobSystem::Wait(const JobCounter& counter)
+	{
+		if(counter.IsDone())
+			return;
+
+		if(Fiber* fiber = GetCurrentFiber())
+		{
+			Suspend(fiber, counter);
+			return;
+		}
+
+		const uint32 threadIndex = GetThreadIndex();
+		while(!counter.IsDone())
+		{
+			if(threadIndex == 0 && ProcessMainThreadJobs() > 0)
+				continue;
+
+			Fiber* fiber = threadIndex != s_NotAJobThread ? TakeReadyFiber() : nullptr;
+			if(fiber)
+				Resume(fiber, threadIndex);
+			else if(Job* job = FindJob(threadIndex))
+				RunJob(job, threadIndex);
+			else
+				std::this_thread::yield();
+		}
+	}
+
+	uint32 JobSystem::ProcessMainThreadJobs()
+	{
+		ASSERT(IsMainThread(), "Main thread jobs can only run on the main thread");
+
+		uint32 count = 0;
+		for(;;)
+		{
+			Job* job = nullptr;
+			{
+				std::lock_guard<std::mutex> lock(m_MainThreadMutex);
+				if(m_MainThreadJobs.empty())
+					return count;
+				job = m_MainThreadJobs.front();
+				m_MainThreadJobs.pop_front();
+			}
+			Execute(job);
+			++count;
+		}
+	}
+
+	uint32 JobSystem::GetThreadIndex() const { return t_System == this ? t_ThreadIndex : s_NotAJobThread; }
+
+	uint32 JobSystem::GetGrainSize(uint32 count) const
+	{
+		const uint32 grain = count / (m_ThreadCount * s_RangesPerThread);
+		return grain > 0 ? grain : 1;
+	}
+
+	JobFiberStats JobSystem::GetFiberStats() const
+	{
+		JobFiberStats stats;
+		stats.m_Pool = m_FiberPool.GetStats();
+		stats.m_Switches = m_Switches.load(std::memory_order_relaxed);
+		stats.m_Suspends = m_Suspends.load(std::memory_order_relaxed);
+		stats.m_InlineJobs = m_InlineJobs.load(std::memory_order_relaxed);
+		return stats;
+	}
+
+	JobSystem::Job* JobSystem::CreateJob(JobFunction&& function, JobCounter* counter)
+	{
+		return new(m_JobPool.Allocate()) Job{ std::move(function), counter };
+	}
+
+	void JobSystem::Execute(Job* job)
+	{
+		job->m_Function();
+		JobCounter* counter = job->m_Counter;
+		job->~Job();
+		m_JobPool.Free(job);
+
+		// last, a waiter may return and destroy the counter as soon as it reads zero
+		if(counter && counter->m_Count.fetch_sub(1) == 1 && m_WaitingCount.load() > 0)
+			WakeWorker();
+	}
+
+	JobSystem::Job* JobSystem::FindJob(uint32 threadIndex)
+	{
+		Job* job = threadIndex < m_ThreadCount ? m_Deques[threadIndex].Pop() : nullptr;
+
+		if(!job && m_ExternalCount.load(std::memory_order_acquire) > 0)
+		{
+			std::lock_guard<std::mutex> lock(m_ExternalMutex);
+			if(!m_ExternalJobs.empty())
+			{
+				job = m_ExternalJobs.front();
+				m_ExternalJobs.pop_front();
+				m_ExternalCount.fetch_sub(1, std::memory_order_relaxed);
+			}
+		}
+
+		// start at a different victim every time so the thieves don't all line up behind the same deque
+		for(uint32 i = 0; !job && i < m_ThreadCount; ++i)
+		{
+			const uint32 victim = (t_StealCursor++) % m_ThreadCount;
+			if(victim != threadIndex)
+				job = m_Deques[victim].Steal();
+		}
+
+		if(job)
+			m_Queued.fetch_sub(1);
+		return job;
+	}
+
+	void JobSystem::RunJob(Job* job, uint32 threadIndex)
+	{
+		// only a thread's own stack starts fibers, jobs run inline anywhere else
+		if(!m_FiberStates || threadIndex == s_NotAJobThread || GetCurrentFiber())
+		{
+			Execute(job);
+			return;
+		}
+
+		Fiber* fiber = m_FiberPool.Acquire();
+		if(!fiber)
+		{
+			m_InlineJobs.fetch_add(1, std::memory_order_relaxed);
+			Execute(job);
+			return;
+		}
+
+		m_FiberStates[m_FiberPool.GetIndex(fiber)].m_Job = job;
+		Resume(fiber, threadIndex);
+	}
+
+	void JobSystem::WorkerMain(uint32 threadIndex)
+	{
+		t_System = this;
+		t_ThreadIndex = threadIndex;
+		t_StealCursor = threadIndex + 1;
+		if(m_ThreadFibers)
+			m_ThreadFibers[threadIndex].ConvertThread();
+
+		while(!m_Stop.load(std::memory_order_acquire))
+		{
+			Fiber* fiber = nullptr;
+			Job* job = nullptr;
+			for(uint32 spin = 0; !fiber && !job && spin < s_SpinCount; ++spin)
+			{
+				// parked fibers first, they are older work and hold on to their stacks
+				fiber = TakeReadyFiber();
+				job = fiber ? nullptr : FindJob(threadIndex);
+				if(!fiber && !job)
+					std::this_thread::yield();
+			}
+
+			if(fiber)
+			{
+				Resume(fiber, threadIndex);
+				continue;
+			}
+			if(job)
+			{
+				RunJob(job, threadIndex);
+				continue;
+			}
+
+			std::unique_lock<std::mutex> lock(m_SleepMutex);
+			m_Sleeping.fetch_add(1);
+			m_WorkReady.wait(lock, [this] { return m_Stop.load() || m_Queued.load() > 0 || HasReadyFiber(); });
+			m_Sleeping.fetch_sub(1);
+		}
+
+		if(m_ThreadFibers)
+			m_ThreadFibers[threadIndex].RevertThread();
+	}
+
+	void JobSystem::FiberMain(Fiber* fiber)
+	{
+		JobSystem* system = static_cast<JobSystem*>(fiber->GetUserData());
+		FiberState& state = system->m_FiberStates[system->m_FiberPool.GetIndex(fiber)];
+		for(;;)
+		{
+			system->Execute(state.m_Job);
+			state.m_Job = nullptr;
+			fiber->SwitchTo(*state.m_Return);
+		}
+	}
+
+	Fiber* JobSystem::GetCurrentFiber() const { return t_System == this ? t_CurrentFiber : nullptr; }
+
+	void JobSystem::Resume(Fiber* fiber, uint32 threadIndex)
+	{
+		FiberState& state = m_FiberStates[m_FiberPool.GetIndex(fiber)];
+		Fiber& thread = m_ThreadFibers[threadIndex];
+		state.m_Return = &thread;
+		state.m_WaitingOn = nullptr;
+
+		m_Switches.fetch_add(2, std::memory_order_relaxed);
+		t_CurrentFiber = fiber;
+		thread.SwitchTo(*fiber);
+		t_CurrentFiber = nullptr;
+
+		// the fiber is off its stack now, only from here on can another thread resume it or hand it out again
+		if(!state.m_WaitingOn)
+		{
+			m_FiberPool.Release(fiber);
+			return;
+		}
+
+		bool isDone = false;
+		{
+			// under the lock, nobody can resume the fiber and let its counter go out of scope in between
+			std::lock_guard<std::mutex> lock(m_WaitingMutex);
+			m_WaitingFibers.push_back(fiber);
+			m_WaitingCount.fetch_add(1);
+			isDone = state.m_WaitingOn->m_Count.load() == 0;
+		}
+		// finished before the fiber was in the list, Execute did not see it to wake anyone
+		if(isDone)
+			WakeWorker();
+	}
+
+	void JobSystem::Suspend(Fiber* fiber, const JobCounter& counter)
+	{
+		FiberState& state = m_FiberStates[m_FiberPool.GetIndex(fiber)];
+		state.m_WaitingOn = &counter;
+		m_Suspends.fetch_add(1, std::memory_order_relaxed);
+		fiber->SwitchTo(*state.m_Return);
+		// resumed once the counter is done, possibly on another thread
+	}
+
+	Fiber* JobSystem::TakeReadyFiber()
+	{
+		if(m_WaitingCount.load(std::memory_order_relaxed) == 0)
+			return nullptr;
+
+		std::lock_guard<std::mutex> lock(m_WaitingMutex);
+		for(size_t i = 0; i < m_WaitingFibers.size(); ++i)
+		{
+			Fiber* fiber = m_WaitingFibers[i];
+			if(m_FiberStates[m_FiberPool.GetIndex(fiber)].m_WaitingOn->IsDone())
+			{
+				m_WaitingFibers[i] = m_WaitingFibers.back();
+				m_WaitingFibers.pop_back();
+				m_WaitingCount.fetch_sub(1);
+				return fiber;
+			}
+		}
+		return nullptr;
+	}
+
+	bool JobSystem::HasReadyFiber()
+	{
+		if(m_WaitingCount.load() == 0)
+			return false;
+
+		std::lock_guard<std::mutex> lock(m_WaitingMutex);
+		for(Fiber* fiber : m_WaitingFibers)
+		{
+			if(m_FiberStates[m_FiberPool.GetIndex(fiber)].m_WaitingOn->m_Count.load() == 0)
+				return true;
+		}
+		return false;
+	}
+
+	void JobSystem::WakeWorker()
+	{
+		if(m_Sleeping.load() > 0)
+		{
+			std::lock_guard<std::mutex> lock(m_SleepMutex);
+			m_WorkReady.notify_one();
+		}
+	}
+
+}; // namespace Core
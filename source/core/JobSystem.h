@@ -0,0 +1,187 @@
+#pragma once
+#include "Types.h"
+#include "Fiber.h"
+#include "containers/WorkStealingDeque.h"
+#include "memory/PoolAllocator.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Core
+{
+	// Jobs still to finish. Run adds one for every job it is given and the job takes it off when it is done.
+	class JobCounter
+	{
+	public:
+		bool IsDone() const { return m_Count.load(std::memory_order_acquire) == 0; }
+		uint32 GetCount() const { return m_Count.load(std::memory_order_relaxed); }
+
+	private:
+		friend class JobSystem;
+		std::atomic<uint32> m_Count{ 0 };
+	};
+
+	struct JobFiberStats
+	{
+		FiberPoolStats m_Pool;
+		uint64 m_Switches = 0;	 // into a fiber and back out counts as two
+		uint64 m_Suspends = 0;	 // waits that parked their fiber
+		uint64 m_InlineJobs = 0; // jobs that ran on a thread's own stack because the pool was empty
+	};
+
+	/*
+		Runs jobs on one thread per hardware thread, the thread that creates the system is the main thread and works
+		too whenever it waits. Every thread has its own Chase-Lev deque: jobs are pushed to the deque of the thread
+		that runs them, taken back newest first while they are still warm in the cache, and idle threads steal the
+		oldest ones from the others. Workers sleep when there is nothing to steal.
+
+		Dependencies go through counters: pass the same JobCounter to a group of jobs and Wait on it. Wait runs other
+		jobs in the meantime, so waiting inside a job is fine and never blocks a worker.
+
+		Jobs queued with RunOnMainThread only ever run on the main thread, from ProcessMainThreadJobs or while it
+		waits, for the window and graphics API calls that have to stay there.
+
+		With a fiber pool every job runs on a fiber of its own. Wait inside such a job parks the fiber until the
+		counter is done and the thread goes on with other work, any thread picks the fiber up again afterwards. Jobs
+		that start while every fiber is taken run on the thread's own stack and help out while they wait, as
+		without fibers. Main thread jobs always run on the main thread's own stack.
+	*/
+	class JobSystem
+	{
+	public:
+		using JobFunction = std::function<void()>;
+
+		// threadCount includes the main thread, 0 makes it one per hardware thread. No fibers with a fiberCount of 0.
+		explicit JobSystem(uint32 threadCount = 0, uint32 fiberCount = 0, uint32 fiberStackSize = s_FiberStackSize);
+		~JobSystem();
+
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+
+		static void Create(uint32 threadCount = 0, uint32 fiberCount = 0, uint32 fiberStackSize = s_FiberStackSize);
+		static JobSystem& Get();
+		static void Destroy();
+
+		// counter is optional, it has to outlive the job
+		void Run(JobFunction job, JobCounter* counter = nullptr);
+		void RunOnMainThread(JobFunction job, JobCounter* counter = nullptr);
+
+		/*
+			Returns once counter reaches zero. Parks the fiber when called from a job running on one, otherwise runs
+			other jobs in the meantime, main thread jobs too on the main thread.
+		*/
+		void Wait(const JobCounter& counter);
+
+		// Runs what RunOnMainThread queued so far, returns how many ran. Main thread only.
+		uint32 ProcessMainThreadJobs();
+
+		/*
+			Calls function(begin, end) over ranges covering [0, count) and returns once all of them are done. The
+			calling thread takes the first range itself. A grainSize of 0 splits the work into a few ranges per
+			thread, enough for stealing to even out ranges that take longer than others.
+		*/
+		template <typename Function>
+		void ParallelFor(uint32 count, Function&& function, uint32 grainSize = 0);
+
+		uint32 GetThreadCount() const { return m_ThreadCount; }
+		// 0 on the main thread, 1 to GetThreadCount() - 1 on the workers and s_NotAJobThread anywhere else
+		uint32 GetThreadIndex() const;
+		bool IsMainThread() const { return GetThreadIndex() == 0; }
+		uint32 GetGrainSize(uint32 count) const;
+		JobFiberStats GetFiberStats() const;
+
+		static constexpr uint32 s_NotAJobThread = ~0u;
+		static constexpr uint32 s_FiberStackSize = 64 * 1024;
+
+	private:
+		struct Job
+		{
+			JobFunction m_Function;
+			JobCounter* m_Counter;
+		};
+
+		// pushes past this run right away on the pushing thread
+		static constexpr uint32 s_DequeCapacity = 4096;
+		using Deque = WorkStealingDeque<Job, s_DequeCapacity>;
+
+		// where a fiber's job is and what it goes back to when the job is done or waits
+		struct FiberState
+		{
+			Job* m_Job = nullptr;
+			Fiber* m_Return = nullptr;
+			const JobCounter* m_WaitingOn = nullptr;
+		};
+
+		Job* CreateJob(JobFunction&& function, JobCounter* counter);
+		void Execute(Job* job);
+		Job* FindJob(uint32 threadIndex);
+		void RunJob(Job* job, uint32 threadIndex);
+		void WorkerMain(uint32 threadIndex);
+
+		static void FiberMain(Fiber* fiber);
+		Fiber* GetCurrentFiber() const;
+		void Resume(Fiber* fiber, uint32 threadIndex);
+		void Suspend(Fiber* fiber, const JobCounter& counter);
+		Fiber* TakeReadyFiber();
+		bool HasReadyFiber();
+		void WakeWorker();
+
+		uint32 m_ThreadCount = 0;
+		std::unique_ptr<Deque[]> m_Deques;
+		std::vector<std::thread> m_Workers;
+		PoolAllocator<sizeof(Job)> m_JobPool;
+
+		// every thread's own stack as a fiber, the pool and the fibers parked in Wait
+		std::unique_ptr<Fiber[]> m_ThreadFibers;
+		FiberPool m_FiberPool;
+		std::unique_ptr<FiberState[]> m_FiberStates;
+		std::mutex m_WaitingMutex;
+		std::vector<Fiber*> m_WaitingFibers;
+		std::atomic<uint32> m_WaitingCount{ 0 };
+		std::atomic<uint64> m_Switches{ 0 };
+		std::atomic<uint64> m_Suspends{ 0 };
+		std::atomic<uint64> m_InlineJobs{ 0 };
+
+		// jobs from threads that have no deque
+		std::mutex m_ExternalMutex;
+		std::deque<Job*> m_ExternalJobs;
+		std::atomic<uint32> m_ExternalCount{ 0 };
+
+		std::mutex m_MainThreadMutex;
+		std::deque<Job*> m_MainThreadJobs;
+
+		// queued in the deques or external, what the workers sleep on together with the parked fibers
+		std::atomic<uint32> m_Queued{ 0 };
+		std::atomic<uint32> m_Sleeping{ 0 };
+		std::atomic<bool> m_Stop{ false };
+		std::mutex m_SleepMutex;
+		std::condition_variable m_WorkReady;
+
+		static std::unique_ptr<JobSystem> m_Instance;
+	};
+
+	template <typename Function>
+	void JobSystem::ParallelFor(uint32 count, Function&& function, uint32 grainSize)
+	{
+		if(count == 0)
+			return;
+
+		const uint32 grain = grainSize > 0 ? grainSize : GetGrainSize(count);
+		JobCounter counter;
+		for(uint32 begin = grain; begin < count; begin += grain)
+		{
+			const uint32 end = count - begin > grain ? begin + grain : count;
+			Run([&function, begin, end]() { function(begin, end); }, &counter);
+		}
+
+		function(0u, count > grain ? grain : count);
+		Wait(counter);
+	}
+
+}; // namespace Core
@@ -0,0 +1,103 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Core
+{
+	MappedFile::~MappedFile() { Close(); }
+
+#ifdef _WIN32
+	bool MappedFile::Open(const char* filepath)
+	{
+		Close();
+
+		HANDLE file = CreateFileA(filepath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+								  FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if(file == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER size = {};
+		if(GetFileType(file) != FILE_TYPE_DISK || !GetFileSizeEx(file, &size) || size.QuadPart == 0)
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		// the view keeps the mapping alive, both handles can go as soon as it exists
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		CloseHandle(file);
+		if(!mapping)
+			return false;
+
+		void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		CloseHandle(mapping);
+		if(!view)
+			return false;
+
+		m_Data = static_cast<const char*>(view);
+		m_Size = static_cast<uint64>(size.QuadPart);
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if(m_Data)
+			UnmapViewOfFile(m_Data);
+
+		m_Data = nullptr;
+		m_Size = 0;
+	}
+#else
+	bool MappedFile::Open(const char* filepath)
+	{
+		Close();
+
+		// check before opening, opening a fifo blocks until there is a writer and closing it again loses the data
+		struct stat info = {};
+		if(stat(filepath, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size == 0)
+			return false;
+
+		const int file = open(filepath, O_RDONLY | O_CLOEXEC);
+		if(file < 0)
+			return false;
+
+		// the file can change between the two calls, map what is there now
+		if(fstat(file, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size == 0)
+		{
+			close(file);
+			return false;
+		}
+
+		// the mapping holds its own reference to the file
+		void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+		close(file);
+		if(view == MAP_FAILED)
+			return false;
+
+		// files are read front to back, start the readahead now instead of faulting page by page
+		madvise(view, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+		madvise(view, static_cast<size_t>(info.st_size), MADV_WILLNEED);
+
+		m_Data = static_cast<const char*>(view);
+		m_Size = static_cast<uint64>(info.st_size);
+		return true;
+	}
+
+	void MappedFile::Close()
+	{
+		if(m_Data)
+			munmap(const_cast<char*>(m_Data), static_cast<size_t>(m_Size));
+
+		m_Data = nullptr;
+		m_Size = 0;
+	}
+#endif
+
+}; // namespace Core
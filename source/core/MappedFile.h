@@ -0,0 +1,32 @@
+#pragma once
+#include "Types.h"
+
+namespace Core
+{
+	/*
+		Read only view of a whole file mapped into the address space, pages are loaded by the OS on first touch.
+		Open fails for anything that isn't a regular, non empty file (pipes, devices, missing files), callers fall
+		back to buffered reads then. The mapping goes away with the object.
+	*/
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		bool Open(const char* filepath);
+		void Close();
+
+		bool IsOpen() const { return m_Data != nullptr; }
+		const char* GetData() const { return m_Data; }
+		uint64 GetSize() const { return m_Size; }
+
+	private:
+		const char* m_Data = nullptr;
+		uint64 m_Size = 0;
+	};
+
+}; // namespace Core
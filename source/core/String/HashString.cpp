@@ -1,5 +1,5 @@
 #include "HashString.h"
-#include "Core/utilities/utilities.h"
+#include "core/utilities/utilities.h"
 namespace Core
 {
 	HashString::HashString(const HashString& str)
@@ -10,7 +10,13 @@ namespace Core
 	{
 	}
 
-	HashString::HashString(const char* str) { m_Hash = Hash(str); }
+	HashString::HashString(const char* str)
+		: m_Hash(Hash(str))
+#ifdef _DEBUG
+		, m_DebugString(str)
+#endif
+	{
+	}
 
 	const char* HashString::debug_str() const
 	{
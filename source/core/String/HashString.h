@@ -1,5 +1,5 @@
 #pragma once
-#include "Core/Types.h"
+#include "core/Types.h"
 namespace Core
 {
     class HashString
@@ -9,6 +9,7 @@ namespace Core
         HashString( const char* str );
 
 		const char* debug_str() const;
+        uint64 GetHash() const { return m_Hash; }
 
         HashString& operator=( const HashString& str );
 
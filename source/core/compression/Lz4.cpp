@@ -0,0 +1,194 @@
+#include "Lz4.h"
+
+#include <cstring>
+
+namespace Core
+{
+	namespace Lz4
+	{
+		namespace
+		{
+			constexpr uint32 s_MinMatch = 4;
+			constexpr uint32 s_LastLiterals = 5; // the last 5 bytes are always literals
+			constexpr uint32 s_MatchLimit = 12;	 // no match starts in the last 12 bytes
+			constexpr uint32 s_MaxOffset = 65535;
+			constexpr uint32 s_HashBits = 12;
+
+			uint32 Read32(const uint8* data)
+			{
+				uint32 value;
+				memcpy(&value, data, sizeof(value));
+				return value;
+			}
+
+			uint32 HashSequence(uint32 sequence) { return (sequence * 2654435761u) >> (32 - s_HashBits); }
+
+			// 15 fits in the token, the rest follows as a run of 255s and a final byte
+			uint8* WriteLength(uint8* out, uint64 length)
+			{
+				for(length -= 15; length >= 255; length -= 255)
+					*out++ = 255;
+				*out++ = static_cast<uint8>(length);
+				return out;
+			}
+
+			bool ReadLength(const uint8*& in, const uint8* end, uint64& length)
+			{
+				uint8 byte;
+				do
+				{
+					if(in >= end)
+						return false;
+					byte = *in++;
+					length += byte;
+				} while(byte == 255);
+				return true;
+			}
+		}; // namespace
+
+		uint64 GetBound(uint64 size) { return size + size / 255 + 16; }
+
+		uint64 Compress(const char* source, uint64 size, char* destination, uint64 capacity)
+		{
+			if(size > 0x7FFFFFFF)
+				return 0;
+
+			const uint8* const begin = reinterpret_cast<const uint8*>(source);
+			const uint8* const end = begin + size;
+			uint8* out = reinterpret_cast<uint8*>(destination);
+			const uint8* const outEnd = out + capacity;
+
+			const uint8* anchor = begin;
+			if(size > s_MatchLimit)
+			{
+				// positions of the last sequence seen per hash, 0 is fine as a default since every candidate is
+				// compared before it is used
+				uint32 table[1 << s_HashBits] = {};
+				const uint8* const matchStartLimit = end - s_MatchLimit;
+				const uint8* const matchEndLimit = end - s_LastLiterals;
+
+				const uint8* in = begin;
+				while(in < matchStartLimit)
+				{
+					const uint32 sequence = Read32(in);
+					const uint32 hash = HashSequence(sequence);
+					const uint8* match = begin + table[hash];
+					table[hash] = static_cast<uint32>(in - begin);
+
+					if(match >= in || in - match > s_MaxOffset || Read32(match) != sequence)
+					{
+						++in;
+						continue;
+					}
+
+					// grow the match backwards into the pending literals, then forwards
+					while(in > anchor && match > begin && in[-1] == match[-1])
+					{
+						--in;
+						--match;
+					}
+
+					const uint8* matchEnd = in + s_MinMatch;
+					const uint8* matchCursor = match + s_MinMatch;
+					while(matchEnd < matchEndLimit && *matchEnd == *matchCursor)
+					{
+						++matchEnd;
+						++matchCursor;
+					}
+
+					const uint64 literals = static_cast<uint64>(in - anchor);
+					const uint64 matchLength = static_cast<uint64>(matchEnd - in) - s_MinMatch;
+					if(static_cast<uint64>(outEnd - out) < 1 + literals + literals / 255 + 2 + matchLength / 255 + 2)
+						return 0;
+
+					uint8* token = out++;
+					*token = static_cast<uint8>((literals < 15 ? literals : 15) << 4);
+					if(literals >= 15)
+						out = WriteLength(out, literals);
+					memcpy(out, anchor, literals);
+					out += literals;
+
+					const uint16 offset = static_cast<uint16>(in - match);
+					*out++ = static_cast<uint8>(offset);
+					*out++ = static_cast<uint8>(offset >> 8);
+
+					*token |= static_cast<uint8>(matchLength < 15 ? matchLength : 15);
+					if(matchLength >= 15)
+						out = WriteLength(out, matchLength);
+
+					in = matchEnd;
+					anchor = in;
+				}
+			}
+
+			// everything after the last match is one literal run
+			const uint64 literals = static_cast<uint64>(end - anchor);
+			if(static_cast<uint64>(outEnd - out) < 1 + literals + literals / 255 + 1)
+				return 0;
+
+			*out++ = static_cast<uint8>((literals < 15 ? literals : 15) << 4);
+			if(literals >= 15)
+				out = WriteLength(out, literals);
+			memcpy(out, anchor, literals);
+			out += literals;
+
+			return static_cast<uint64>(out - reinterpret_cast<uint8*>(destination));
+		}
+
+		bool Decompress(const char* source, uint64 size, char* destination, uint64 destinationSize)
+		{
+			const uint8* in = reinterpret_cast<const uint8*>(source);
+			const uint8* const end = in + size;
+			uint8* const outBegin = reinterpret_cast<uint8*>(destination);
+			uint8* out = outBegin;
+			uint8* const outEnd = out + destinationSize;
+
+			while(in < end)
+			{
+				const uint8 token = *in++;
+
+				uint64 literals = token >> 4;
+				if(literals == 15 && !ReadLength(in, end, literals))
+					return false;
+				if(literals > static_cast<uint64>(end - in) || literals > static_cast<uint64>(outEnd - out))
+					return false;
+
+				memcpy(out, in, literals);
+				out += literals;
+				in += literals;
+
+				// the last sequence has no match
+				if(in == end)
+					return out == outEnd;
+
+				if(end - in < 2)
+					return false;
+				const uint64 offset = in[0] | (in[1] << 8);
+				in += 2;
+				if(offset == 0 || offset > static_cast<uint64>(out - outBegin))
+					return false;
+
+				uint64 matchLength = token & 15;
+				if(matchLength == 15 && !ReadLength(in, end, matchLength))
+					return false;
+				matchLength += s_MinMatch;
+				if(matchLength > static_cast<uint64>(outEnd - out))
+					return false;
+
+				// matches may overlap the bytes they produce, only copy in bulk when they can't
+				const uint8* match = out - offset;
+				if(offset >= matchLength)
+					memcpy(out, match, matchLength);
+				else
+				{
+					for(uint64 i = 0; i < matchLength; ++i)
+						out[i] = match[i];
+				}
+				out += matchLength;
+			}
+
+			return false;
+		}
+
+	}; // namespace Lz4
+}; // namespace Core
@@ -0,0 +1,24 @@
+#pragma once
+#include "core/Types.h"
+
+namespace Core
+{
+	/*
+		LZ4 block format (https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md), compatible with
+		LZ4_compress_default / LZ4_decompress_safe so packs can be checked with the reference tools. The compressor is
+		the simple greedy one, the point is cheap decompression at load time, not the best ratio.
+	*/
+	namespace Lz4
+	{
+		// Worst case compressed size for size bytes of input.
+		uint64 GetBound(uint64 size);
+
+		// Returns the compressed size, 0 when it doesn't fit in capacity. Inputs are limited to 2 GB.
+		uint64 Compress(const char* source, uint64 size, char* destination, uint64 capacity);
+
+		// destinationSize is the exact decompressed size. false for corrupt or truncated input, never reads or
+		// writes out of bounds.
+		bool Decompress(const char* source, uint64 size, char* destination, uint64 destinationSize);
+
+	}; // namespace Lz4
+}; // namespace Core
@@ -1,32 +1,46 @@
 #pragma once
-#include "Core/Types.h"
+#include "core/Types.h"
 #include "logger/Debug.h"
 
 namespace Core
 {
+	/*
+		Fixed capacity array, the storage lives inside the object so it never touches the heap.
+	*/
 	template <typename T, uint32 ArrSize = 10>
 	class Array
 	{
 	public:
-		Array(const T(&list)[ArrSize]) {
-			m_Capacity = ArrSize;
+		Array(const T(&list)[ArrSize])
+		{
+			for(uint32 i = 0; i < ArrSize; ++i)
+				m_Data[i] = list[i];
 			m_Size = ArrSize;
-			m_Data = new T[m_Capacity];
-			memcpy(m_Data, &list[0], sizeof(T) * m_Capacity);
 		}
 
-		Array() { m_Data = new T[m_Capacity]; };
-		~Array()
+		Array() = default;
+		~Array() = default;
+
+		Array(const Array<T, ArrSize>& other) = default;
+		Array<T, ArrSize>& operator=(const Array<T, ArrSize>& other) = default;
+
+		T& operator[](uint32 index)
 		{
-			delete[] m_Data;
-			m_Data = nullptr;
-		};
+			ASSERT(index < ArrSize, "index has to be less than the capacity of the array");
+			return m_Data[index];
+		}
 
-		T& operator[](uint32 index) { return m_Data[index]; }
-		const T& operator[](uint32 index) const { return m_Data[index]; }
+		const T& operator[](uint32 index) const
+		{
+			ASSERT(index < ArrSize, "index has to be less than the capacity of the array");
+			return m_Data[index];
+		}
 
 		uint32 Size() const { return m_Size; }
-		uint32 Capacity() const { return m_Capacity; }
+		constexpr uint32 Capacity() const { return ArrSize; }
+
+		T* GetData() { return m_Data; }
+		const T* GetData() const { return m_Data; }
 
 		void DeleteAll()
 		{
@@ -37,21 +51,14 @@ namespace Core
 			}
 		}
 
-		Array<T>& operator=(const Array<T>& other)
-		{
-			m_Size = other.m_Size;
-			m_Capacity = other.m_Capacity;
-			m_Data = new T[m_Capacity];
-			memcpy(m_Data, other.m_Data, sizeof(T) * m_Size);
-			return *this;
-		}
-
 		void Add(const T& object)
 		{
-			ASSERT(m_Size != m_Capacity, "Array is full.");
+			ASSERT(m_Size != ArrSize, "Array is full.");
 			m_Data[m_Size++] = object;
 		}
 
+		void Clear() { m_Size = 0; }
+
 		typedef T* iterator;
 		typedef const T* const_iterator;
 		iterator begin() { return &m_Data[0]; }
@@ -60,9 +67,8 @@ namespace Core
 		const_iterator end() const { return &m_Data[m_Size]; }
 
 	private:
+		T m_Data[ArrSize]{};
 		uint32 m_Size = 0;
-		uint32 m_Capacity = ArrSize;
-		T* m_Data = nullptr;
 	};
 
 }; // namespace Core
@@ -1,11 +1,20 @@
 #pragma once
 #include "core/Types.h"
-#include "logger/debug.h"
+#include "core/containers/TypeTraits.h"
+#include "core/memory/Allocator.h"
+#include "logger/Debug.h"
 
+#include <cstring>
 #include <initializer_list>
+#include <new>
+#include <utility>
 
 namespace Core
 {
+	/*
+		Dynamic array on uninitialized storage. Memory comes from the allocator handed in, which has to outlive the
+		array, or else from the MemoryTag::Core heap allocator so it still shows up in the MemoryTracker.
+	*/
 	template <typename T>
 	class GrowingArray
 	{
@@ -13,35 +22,76 @@ namespace Core
 		~GrowingArray();
 
 		GrowingArray(std::initializer_list<T> list)
-			: m_Capacity(list.size())
-			, m_Data(new T[m_Capacity])
 		{
-			m_Size = list.size();
-			memset(m_Data, 0, sizeof(T) * m_Capacity);
-			memcpy(&m_Data[0], list.begin(), m_Size * sizeof(T));
+			Reserve((uint32)list.size());
+			for(const T& object : list)
+				new(&m_Data[m_Size++]) T(object);
 		}
 
-		GrowingArray(int32 size)
-			: m_Capacity(size)
-			, m_Data(new T[m_Capacity])
+		GrowingArray(int32 size) { Reserve(size); }
+
+		GrowingArray(int32 size, IAllocator* allocator)
+			: m_Allocator(allocator)
 		{
-			memset(m_Data, 0, sizeof(T) * m_Capacity);
+			Reserve(size);
 		}
 
-		GrowingArray()
-			: m_Data(new T[m_Capacity])
+		GrowingArray() { Reserve(10); }
+
+		// The copy allocates from the same allocator as other.
+		GrowingArray(const GrowingArray<T>& other)
+			: m_Allocator(other.m_Allocator)
 		{
-			memset(m_Data, 0, sizeof(T) * m_Capacity);
+			*this = other;
 		}
 
-		GrowingArray(const GrowingArray<T>& other) { *this = other; }
+		GrowingArray(GrowingArray<T>&& other) noexcept
+			: m_Size(other.m_Size)
+			, m_Capacity(other.m_Capacity)
+			, m_Data(other.m_Data)
+			, m_Allocator(other.m_Allocator)
+		{
+			other.m_Size = 0;
+			other.m_Capacity = 0;
+			other.m_Data = nullptr;
+		}
 
 		GrowingArray<T>& operator=(const GrowingArray<T>& other)
 		{
+			if(this == &other)
+				return *this;
+
+			Clear();
+			Reserve(other.m_Size);
+
+			if constexpr(std::is_trivially_copyable_v<T>)
+				memcpy(m_Data, other.m_Data, sizeof(T) * other.m_Size);
+			else
+			{
+				for(uint32 i = 0; i < other.m_Size; ++i)
+					new(&m_Data[i]) T(other.m_Data[i]);
+			}
+
+			m_Size = other.m_Size;
+			return *this;
+		}
+
+		GrowingArray<T>& operator=(GrowingArray<T>&& other) noexcept
+		{
+			if(this == &other)
+				return *this;
+
+			Clear();
+			Deallocate(m_Data, m_Capacity);
+
 			m_Size = other.m_Size;
 			m_Capacity = other.m_Capacity;
-			m_Data = new T[m_Capacity];
-			memcpy(&m_Data[0], &other.m_Data[0], sizeof(T) * m_Size);
+			m_Data = other.m_Data;
+			m_Allocator = other.m_Allocator;
+
+			other.m_Size = 0;
+			other.m_Capacity = 0;
+			other.m_Data = nullptr;
 			return *this;
 		}
 
@@ -50,28 +100,65 @@ namespace Core
 			ASSERT(index < m_Size, "index has to be less than the size of the array");
 			return m_Data[index];
 		}
-		
-		const T& operator[](uint32 index) const 
+
+		const T& operator[](uint32 index) const
 		{
 			ASSERT(index < m_Size, "index has to be less than the size of the array");
-			 return m_Data[index];
+			return m_Data[index];
 		}
 
 		uint32 Size() const { return m_Size; }
 		uint32 Capacity() const { return m_Capacity; }
+		bool Empty() const { return m_Size == 0; }
+		IAllocator* GetAllocator() const { return m_Allocator; }
 
-		void Add(const T& object)
-		{
-			if(m_Size + 1 > m_Capacity)
-				Grow();
+		T* GetData() { return m_Data; }
+		const T* GetData() const { return m_Data; }
 
-			m_Data[m_Size++] = object;
+		void Add(const T& object) { EmplaceBack(object); }
+		void Add(T&& object) { EmplaceBack(std::move(object)); }
+
+		template <typename... Args>
+		T& EmplaceBack(Args&&... args)
+		{
+			if(m_Size < m_Capacity)
+				return *new(&m_Data[m_Size++]) T(std::forward<Args>(args)...);
+
+			// args may reference an element in this array, so construct into the new block before relocating.
+			const uint32 capacity = m_Capacity > 0 ? m_Capacity * 2 : 10;
+			T* data = Allocate(capacity);
+			new(&data[m_Size]) T(std::forward<Args>(args)...);
+			Relocate(data, capacity);
+			return m_Data[m_Size++];
 		}
 
 		T& GetLast() { return m_Data[m_Size - 1]; }
 		T& GetFirst() { return m_Data[0]; }
 
-		void RemoveCyclicAtIndex(uint32 index) { m_Data[index--] = GetLast(); }
+		void RemoveLast()
+		{
+			ASSERT(m_Size > 0, "Can't remove from an empty array");
+			m_Data[--m_Size].~T();
+		}
+
+		void RemoveCyclicAtIndex(uint32 index)
+		{
+			ASSERT(index < m_Size, "index has to be less than the size of the array");
+			if(index != m_Size - 1)
+				m_Data[index] = std::move(GetLast());
+
+			RemoveLast();
+		}
+
+		void Clear()
+		{
+			if constexpr(!std::is_trivially_destructible_v<T>)
+			{
+				for(uint32 i = 0; i < m_Size; ++i)
+					m_Data[i].~T();
+			}
+			m_Size = 0;
+		}
 
 		void DeleteAll()
 		{
@@ -82,36 +169,72 @@ namespace Core
 			}
 		}
 
+		void Reserve(uint32 capacity)
+		{
+			if(capacity > m_Capacity)
+				Reallocate(capacity);
+		}
+
+		void ShrinkToFit()
+		{
+			if(m_Size != m_Capacity)
+				Reallocate(m_Size);
+		}
+
 		typedef T* iterator;
 		typedef const T* const_iterator;
 		iterator begin() { return &m_Data[0]; }
 		const_iterator begin() const { return &m_Data[0]; }
-		iterator end() { return &m_Data[m_Size - 1]; }
-		const_iterator end() const { return &m_Data[m_Size - 1]; }
+		iterator end() { return &m_Data[m_Size]; }
+		const_iterator end() const { return &m_Data[m_Size]; }
 
 	private:
-		void Grow()
-		{
-			m_Capacity *= 2;
-			T* data = new T[m_Capacity];
+		void Reallocate(uint32 capacity) { Relocate(capacity > 0 ? Allocate(capacity) : nullptr, capacity); }
 
-			memcpy(data, m_Data, sizeof(T) * m_Size);
+		// Moves the live elements into data (capacity slots, >= m_Size) and releases the old block.
+		void Relocate(T* data, uint32 capacity)
+		{
+			if constexpr(IsTriviallyRelocatable<T>::value)
+			{
+				if(m_Size > 0)
+					memcpy((void*)data, (const void*)m_Data, sizeof(T) * m_Size);
+			}
+			else
+			{
+				for(uint32 i = 0; i < m_Size; ++i)
+				{
+					new(&data[i]) T(std::move_if_noexcept(m_Data[i]));
+					m_Data[i].~T();
+				}
+			}
 
-			delete[] m_Data;
+			Deallocate(m_Data, m_Capacity);
 			m_Data = data;
+			m_Capacity = capacity;
+		}
+
+		IAllocator* GetHeap() const { return m_Allocator ? m_Allocator : Core::GetAllocator(MemoryTag::Core); }
+
+		T* Allocate(uint32 count) { return static_cast<T*>(GetHeap()->Allocate(sizeof(T) * count, alignof(T))); }
+
+		void Deallocate(T* data, uint32 capacity)
+		{
+			if(data)
+				GetHeap()->Free(data, sizeof(T) * capacity, alignof(T));
 		}
 
 		uint32 m_Size = 0;
-		uint32 m_Capacity = 10;
+		uint32 m_Capacity = 0;
 		T* m_Data = nullptr;
+		IAllocator* m_Allocator = nullptr;
 	};
 
 	template <typename T>
 	GrowingArray<T>::~GrowingArray()
 	{
-		delete[] m_Data;
+		Clear();
+		Deallocate(m_Data, m_Capacity);
 		m_Data = nullptr;
-		m_Size = 0;
 		m_Capacity = 0;
 	}
 
@@ -0,0 +1,379 @@
+#pragma once
+#include "core/Types.h"
+#include "core/String/HashString.h"
+#include "core/memory/Allocator.h"
+#include "core/utilities/utilities.h"
+#include "logger/Debug.h"
+
+#include <cstring>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace Core
+{
+	template <typename K>
+	struct Hasher
+	{
+		uint64 operator()(const K& key) const
+		{
+			static_assert(std::is_integral_v<K> || std::is_enum_v<K> || std::is_pointer_v<K>,
+						  "No Core::Hasher for this key type, specialize Core::Hasher<K>");
+
+			// the map spreads the bits itself (fibonacci hashing), so plain values are good enough here
+			if constexpr(std::is_pointer_v<K>)
+				return (uint64)(uint64_ptr)key;
+			else
+				return (uint64)key;
+		}
+	};
+
+	template <>
+	struct Hasher<std::string>
+	{
+		uint64 operator()(const std::string& key) const { return Hash(key); }
+	};
+
+	// HashString already carries its hash, hand that out instead of hashing the string again
+	template <>
+	struct Hasher<HashString>
+	{
+		uint64 operator()(const HashString& key) const { return key.GetHash(); }
+	};
+
+	/*
+		Flat open addressing map using Robin Hood probing. Every slot keeps how far it sits from its home bucket, on
+		insert an entry that is further from home steals the slot of one that is closer. That keeps probe lengths short
+		and lets Find stop early. Remove shifts the following entries back one step instead of leaving tombstones.
+
+		Pointers / references to values are invalidated when the map grows or an entry is removed. Storage comes from the
+		IAllocator handed in, or else from the MemoryTag::Core heap allocator.
+	*/
+	template <typename K, typename V, typename H = Hasher<K>>
+	class HashMap
+	{
+	public:
+		struct Pair
+		{
+			template <typename KArg, typename... Args,
+					  typename = std::enable_if_t<!std::is_same_v<std::decay_t<KArg>, Pair>>>
+			Pair(KArg&& key_, Args&&... args)
+				: key(std::forward<KArg>(key_))
+				, value(std::forward<Args>(args)...)
+			{
+			}
+
+			K key;
+			V value;
+		};
+
+		HashMap() = default;
+		HashMap(uint32 capacity) { Reserve(capacity); }
+		HashMap(uint32 capacity, IAllocator* allocator)
+			: m_Allocator(allocator)
+		{
+			Reserve(capacity);
+		}
+		~HashMap();
+
+		HashMap(const HashMap& other)
+			: m_Allocator(other.m_Allocator)
+		{
+			*this = other;
+		}
+		HashMap(HashMap&& other) noexcept { *this = std::move(other); }
+
+		HashMap& operator=(const HashMap& other)
+		{
+			if(this == &other)
+				return *this;
+
+			Clear();
+			Reserve(other.m_Size);
+			for(const Pair& pair : other)
+				InsertNew(H()(pair.key), Pair(pair.key, pair.value));
+			return *this;
+		}
+
+		HashMap& operator=(HashMap&& other) noexcept
+		{
+			if(this == &other)
+				return *this;
+
+			Release();
+			m_Pairs = other.m_Pairs;
+			m_Distances = other.m_Distances;
+			m_Size = other.m_Size;
+			m_Capacity = other.m_Capacity;
+			m_Shift = other.m_Shift;
+			m_Allocator = other.m_Allocator;
+
+			other.m_Pairs = nullptr;
+			other.m_Distances = nullptr;
+			other.m_Size = 0;
+			other.m_Capacity = 0;
+			other.m_Shift = 64;
+			return *this;
+		}
+
+		// Inserts the value or overwrites the one already stored at key.
+		V& Insert(const K& key, const V& value)
+		{
+			const uint64 hash = H()(key);
+			const uint32 index = FindIndex(key, hash);
+			if(index != InvalidIndex)
+				return m_Pairs[index].value = value;
+
+			return AddNew(hash, Pair(key, value));
+		}
+
+		// Constructs a value at key, does nothing and returns the stored value if the key already exists.
+		template <typename... Args>
+		V& Emplace(const K& key, Args&&... args)
+		{
+			const uint64 hash = H()(key);
+			const uint32 index = FindIndex(key, hash);
+			if(index != InvalidIndex)
+				return m_Pairs[index].value;
+
+			return AddNew(hash, Pair(key, std::forward<Args>(args)...));
+		}
+
+		V& operator[](const K& key) { return Emplace(key); }
+
+		V* Find(const K& key)
+		{
+			const uint32 index = FindIndex(key, H()(key));
+			return index != InvalidIndex ? &m_Pairs[index].value : nullptr;
+		}
+
+		const V* Find(const K& key) const { return const_cast<HashMap*>(this)->Find(key); }
+
+		bool Contains(const K& key) const { return Find(key) != nullptr; }
+
+		bool Remove(const K& key)
+		{
+			uint32 index = FindIndex(key, H()(key));
+			if(index == InvalidIndex)
+				return false;
+
+			m_Pairs[index].~Pair();
+
+			// backward shift, pull every displaced follower one step closer to home
+			const uint32 mask = m_Capacity - 1;
+			uint32 next = (index + 1) & mask;
+			while(m_Distances[next] > 1)
+			{
+				new(&m_Pairs[index]) Pair(std::move(m_Pairs[next]));
+				m_Pairs[next].~Pair();
+				m_Distances[index] = m_Distances[next] - 1;
+				index = next;
+				next = (next + 1) & mask;
+			}
+
+			m_Distances[index] = 0;
+			--m_Size;
+			return true;
+		}
+
+		void Clear()
+		{
+			for(uint32 i = 0; i < m_Capacity; ++i)
+			{
+				if(m_Distances[i] != 0)
+				{
+					m_Pairs[i].~Pair();
+					m_Distances[i] = 0;
+				}
+			}
+			m_Size = 0;
+		}
+
+		// Makes room for count entries without growing past the load factor.
+		void Reserve(uint32 count)
+		{
+			uint32 capacity = 16;
+			while(capacity * 7 < count * 8)
+				capacity *= 2;
+
+			if(capacity > m_Capacity)
+				Rehash(capacity);
+		}
+
+		uint32 Size() const { return m_Size; }
+		uint32 Capacity() const { return m_Capacity; }
+		bool Empty() const { return m_Size == 0; }
+
+		template <typename Pointer, typename Reference>
+		class Iterator
+		{
+		public:
+			Iterator(const HashMap* map, uint32 index)
+				: m_Map(map)
+				, m_Index(index)
+			{
+				SkipEmpty();
+			}
+
+			Reference operator*() const { return m_Map->m_Pairs[m_Index]; }
+			Pointer operator->() const { return &m_Map->m_Pairs[m_Index]; }
+
+			Iterator& operator++()
+			{
+				++m_Index;
+				SkipEmpty();
+				return *this;
+			}
+
+			bool operator==(const Iterator& other) const { return m_Index == other.m_Index; }
+			bool operator!=(const Iterator& other) const { return m_Index != other.m_Index; }
+
+		private:
+			void SkipEmpty()
+			{
+				while(m_Index < m_Map->m_Capacity && m_Map->m_Distances[m_Index] == 0)
+					++m_Index;
+			}
+
+			const HashMap* m_Map = nullptr;
+			uint32 m_Index = 0;
+		};
+
+		typedef Iterator<Pair*, Pair&> iterator;
+		typedef Iterator<const Pair*, const Pair&> const_iterator;
+		iterator begin() { return iterator(this, 0); }
+		const_iterator begin() const { return const_iterator(this, 0); }
+		iterator end() { return iterator(this, m_Capacity); }
+		const_iterator end() const { return const_iterator(this, m_Capacity); }
+
+	private:
+		static constexpr uint32 InvalidIndex = ~0u;
+
+		uint32 HomeIndex(uint64 hash) const
+		{
+			// fibonacci hashing, spreads the 32 bit murmur hashes and plain integers over the whole table
+			return (uint32)((hash * 11400714819323198485ull) >> m_Shift);
+		}
+
+		uint32 FindIndex(const K& key, uint64 hash) const
+		{
+			if(m_Size == 0)
+				return InvalidIndex;
+
+			const uint32 mask = m_Capacity - 1;
+			uint32 index = HomeIndex(hash);
+			for(uint32 distance = 1; distance <= m_Distances[index]; ++distance)
+			{
+				if(m_Distances[index] == distance && m_Pairs[index].key == key)
+					return index;
+				index = (index + 1) & mask;
+			}
+			return InvalidIndex;
+		}
+
+		// The pair is built before growing since key / value may live inside the table that is about to move.
+		V& AddNew(uint64 hash, Pair&& pair)
+		{
+			if((m_Size + 1) * 8 > m_Capacity * 7)
+				Rehash(m_Capacity > 0 ? m_Capacity * 2 : 16);
+
+			return m_Pairs[InsertNew(hash, std::move(pair))].value;
+		}
+
+		// Places a key that is known not to be in the map, returns the slot it ended up in.
+		uint32 InsertNew(uint64 hash, Pair&& pair)
+		{
+			const uint32 mask = m_Capacity - 1;
+			uint32 index = HomeIndex(hash);
+			uint32 distance = 1;
+			uint32 result = InvalidIndex;
+
+			while(m_Distances[index] != 0)
+			{
+				if(m_Distances[index] < distance)
+				{
+					// rich slot, take it and carry the previous owner further down
+					std::swap(pair, m_Pairs[index]);
+					std::swap(distance, m_Distances[index]);
+					if(result == InvalidIndex)
+						result = index;
+				}
+				index = (index + 1) & mask;
+				++distance;
+			}
+
+			new(&m_Pairs[index]) Pair(std::move(pair));
+			m_Distances[index] = distance;
+			++m_Size;
+			return result == InvalidIndex ? index : result;
+		}
+
+		void Rehash(uint32 capacity)
+		{
+			Pair* pairs = m_Pairs;
+			uint32* distances = m_Distances;
+			const uint32 oldCapacity = m_Capacity;
+
+			m_Pairs = static_cast<Pair*>(AllocateBlock(sizeof(Pair) * capacity, alignof(Pair)));
+			m_Distances = static_cast<uint32*>(AllocateBlock(sizeof(uint32) * capacity, alignof(uint32)));
+			memset(m_Distances, 0, sizeof(uint32) * capacity);
+			m_Capacity = capacity;
+			m_Size = 0;
+
+			m_Shift = 64;
+			for(uint32 c = capacity; c > 1; c >>= 1)
+				--m_Shift;
+
+			for(uint32 i = 0; i < oldCapacity; ++i)
+			{
+				if(distances[i] == 0)
+					continue;
+
+				InsertNew(H()(pairs[i].key), std::move(pairs[i]));
+				pairs[i].~Pair();
+			}
+
+			FreeBlock(pairs, sizeof(Pair) * oldCapacity, alignof(Pair));
+			FreeBlock(distances, sizeof(uint32) * oldCapacity, alignof(uint32));
+		}
+
+		void Release()
+		{
+			if(!m_Pairs)
+				return;
+
+			Clear();
+			FreeBlock(m_Pairs, sizeof(Pair) * m_Capacity, alignof(Pair));
+			FreeBlock(m_Distances, sizeof(uint32) * m_Capacity, alignof(uint32));
+			m_Pairs = nullptr;
+			m_Distances = nullptr;
+			m_Capacity = 0;
+			m_Shift = 64;
+		}
+
+		IAllocator* GetHeap() const { return m_Allocator ? m_Allocator : GetAllocator(MemoryTag::Core); }
+
+		void* AllocateBlock(uint64 size, uint64 alignment) { return GetHeap()->Allocate(size, alignment); }
+
+		void FreeBlock(void* data, uint64 size, uint64 alignment)
+		{
+			if(data)
+				GetHeap()->Free(data, size, alignment);
+		}
+
+		Pair* m_Pairs = nullptr;
+		uint32* m_Distances = nullptr; // 0 means empty, otherwise 1 + steps from the home slot
+		uint32 m_Size = 0;
+		uint32 m_Capacity = 0;
+		uint32 m_Shift = 64;
+		IAllocator* m_Allocator = nullptr;
+	};
+
+	template <typename K, typename V, typename H>
+	HashMap<K, V, H>::~HashMap()
+	{
+		Release();
+	}
+
+}; // namespace Core
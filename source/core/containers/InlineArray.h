@@ -0,0 +1,239 @@
+#pragma once
+#include "core/Types.h"
+#include "core/containers/TypeTraits.h"
+#include "core/memory/Allocator.h"
+#include "logger/Debug.h"
+
+#include <cstring>
+#include <initializer_list>
+#include <new>
+#include <utility>
+
+namespace Core
+{
+	/*
+		Array with room for InlineSize elements inside the object itself. It only touches the heap once it grows past
+		InlineSize, after that it behaves like a GrowingArray. Use it for the small lists that get built every frame.
+		Spilled storage comes from the allocator handed in, which has to outlive the array, or else from the
+		MemoryTag::Core heap allocator.
+	*/
+	template <typename T, uint32 InlineSize>
+	class InlineArray
+	{
+		static_assert(InlineSize > 0, "InlineArray needs room for at least one element, use GrowingArray instead");
+
+	public:
+		InlineArray() = default;
+		explicit InlineArray(IAllocator* allocator)
+			: m_Allocator(allocator)
+		{
+		}
+		~InlineArray();
+
+		InlineArray(std::initializer_list<T> list)
+		{
+			Reserve((uint32)list.size());
+			for(const T& object : list)
+				new(&m_Data[m_Size++]) T(object);
+		}
+
+		// The copy spills into the same allocator as other.
+		InlineArray(const InlineArray& other)
+			: m_Allocator(other.m_Allocator)
+		{
+			*this = other;
+		}
+
+		InlineArray(InlineArray&& other) noexcept
+			: m_Allocator(other.m_Allocator)
+		{
+			*this = std::move(other);
+		}
+
+		InlineArray& operator=(const InlineArray& other)
+		{
+			if(this == &other)
+				return *this;
+
+			Clear();
+			Reserve(other.m_Size);
+			for(uint32 i = 0; i < other.m_Size; ++i)
+				new(&m_Data[i]) T(other.m_Data[i]);
+
+			m_Size = other.m_Size;
+			return *this;
+		}
+
+		InlineArray& operator=(InlineArray&& other) noexcept
+		{
+			if(this == &other)
+				return *this;
+
+			Clear();
+
+			if(!other.IsInline())
+			{
+				// steal the heap block, our own block (if any) is released first
+				Release();
+				m_Data = other.m_Data;
+				m_Capacity = other.m_Capacity;
+				m_Size = other.m_Size;
+				m_Allocator = other.m_Allocator;
+
+				other.m_Data = other.Inline();
+				other.m_Capacity = InlineSize;
+				other.m_Size = 0;
+				return *this;
+			}
+
+			Reserve(other.m_Size);
+			for(uint32 i = 0; i < other.m_Size; ++i)
+				new(&m_Data[i]) T(std::move(other.m_Data[i]));
+
+			m_Size = other.m_Size;
+			other.Clear();
+			return *this;
+		}
+
+		T& operator[](uint32 index)
+		{
+			ASSERT(index < m_Size, "index has to be less than the size of the array");
+			return m_Data[index];
+		}
+
+		const T& operator[](uint32 index) const
+		{
+			ASSERT(index < m_Size, "index has to be less than the size of the array");
+			return m_Data[index];
+		}
+
+		uint32 Size() const { return m_Size; }
+		uint32 Capacity() const { return m_Capacity; }
+		bool Empty() const { return m_Size == 0; }
+		bool IsInline() const { return m_Data == Inline(); }
+		IAllocator* GetAllocator() const { return m_Allocator; }
+
+		T* GetData() { return m_Data; }
+		const T* GetData() const { return m_Data; }
+
+		void Add(const T& object) { EmplaceBack(object); }
+		void Add(T&& object) { EmplaceBack(std::move(object)); }
+
+		template <typename... Args>
+		T& EmplaceBack(Args&&... args)
+		{
+			if(m_Size < m_Capacity)
+				return *new(&m_Data[m_Size++]) T(std::forward<Args>(args)...);
+
+			// args may reference an element in this array, so construct into the new block before relocating.
+			const uint32 capacity = m_Capacity * 2;
+			T* data = Allocate(capacity);
+			new(&data[m_Size]) T(std::forward<Args>(args)...);
+			Relocate(data, capacity);
+			return m_Data[m_Size++];
+		}
+
+		// Grows or shrinks to size, new elements are value initialized.
+		void Resize(uint32 size)
+		{
+			Reserve(size);
+			while(m_Size < size)
+				new(&m_Data[m_Size++]) T();
+			while(m_Size > size)
+				RemoveLast();
+		}
+
+		T& GetLast() { return m_Data[m_Size - 1]; }
+		T& GetFirst() { return m_Data[0]; }
+
+		void RemoveLast()
+		{
+			ASSERT(m_Size > 0, "Can't remove from an empty array");
+			m_Data[--m_Size].~T();
+		}
+
+		void RemoveCyclicAtIndex(uint32 index)
+		{
+			ASSERT(index < m_Size, "index has to be less than the size of the array");
+			if(index != m_Size - 1)
+				m_Data[index] = std::move(GetLast());
+
+			RemoveLast();
+		}
+
+		void Clear()
+		{
+			if constexpr(!std::is_trivially_destructible_v<T>)
+			{
+				for(uint32 i = 0; i < m_Size; ++i)
+					m_Data[i].~T();
+			}
+			m_Size = 0;
+		}
+
+		void Reserve(uint32 capacity)
+		{
+			if(capacity > m_Capacity)
+				Relocate(Allocate(capacity), capacity);
+		}
+
+		typedef T* iterator;
+		typedef const T* const_iterator;
+		iterator begin() { return m_Data; }
+		const_iterator begin() const { return m_Data; }
+		iterator end() { return m_Data + m_Size; }
+		const_iterator end() const { return m_Data + m_Size; }
+
+	private:
+		T* Inline() { return reinterpret_cast<T*>(m_Inline); }
+		const T* Inline() const { return reinterpret_cast<const T*>(m_Inline); }
+
+		IAllocator* GetHeap() const { return m_Allocator ? m_Allocator : Core::GetAllocator(MemoryTag::Core); }
+
+		T* Allocate(uint32 capacity)
+		{
+			return static_cast<T*>(GetHeap()->Allocate(sizeof(T) * capacity, alignof(T)));
+		}
+
+		void Release()
+		{
+			if(!IsInline())
+				GetHeap()->Free(m_Data, sizeof(T) * m_Capacity, alignof(T));
+		}
+
+		void Relocate(T* data, uint32 capacity)
+		{
+			if constexpr(IsTriviallyRelocatable<T>::value)
+			{
+				if(m_Size > 0)
+					memcpy((void*)data, (const void*)m_Data, sizeof(T) * m_Size);
+			}
+			else
+			{
+				for(uint32 i = 0; i < m_Size; ++i)
+				{
+					new(&data[i]) T(std::move_if_noexcept(m_Data[i]));
+					m_Data[i].~T();
+				}
+			}
+
+			Release();
+			m_Data = data;
+			m_Capacity = capacity;
+		}
+
+		alignas(T) uint8 m_Inline[sizeof(T) * InlineSize];
+		T* m_Data = Inline();
+		uint32 m_Size = 0;
+		uint32 m_Capacity = InlineSize;
+		IAllocator* m_Allocator = nullptr;
+	};
+
+	template <typename T, uint32 InlineSize>
+	InlineArray<T, InlineSize>::~InlineArray()
+	{
+		Clear();
+		Release();
+	}
+
+}; // namespace Core
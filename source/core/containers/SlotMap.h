@@ -0,0 +1,155 @@
+#pragma once
+#include "core/Types.h"
+#include "core/containers/GrowingArray.h"
+#include "logger/Debug.h"
+
+#include <utility>
+
+namespace Core
+{
+	/*
+		32 bit handle into a SlotMap, low bits are the slot index and the high bits the generation of that slot.
+		A handle goes stale when its object is removed, the slot generation moves on so Get returns nullptr.
+		A value of 0 is never handed out and can be used as "no object".
+	*/
+	struct SlotHandle
+	{
+		static constexpr uint32 IndexBits = 20;
+		static constexpr uint32 IndexMask = (1u << IndexBits) - 1;
+		static constexpr uint32 GenerationMask = (1u << (32 - IndexBits)) - 1;
+
+		uint32 GetIndex() const { return m_Value & IndexMask; }
+		uint32 GetGeneration() const { return m_Value >> IndexBits; }
+		bool IsValid() const { return m_Value != 0; }
+
+		bool operator==(const SlotHandle& other) const { return m_Value == other.m_Value; }
+		bool operator!=(const SlotHandle& other) const { return m_Value != other.m_Value; }
+
+		uint32 m_Value = 0;
+	};
+
+	/*
+		Objects are stored densely so iterating the map walks contiguous memory, insert and remove are O(1).
+		Removing swaps the last object into the hole, so raw pointers / dense order are not stable, handles are.
+	*/
+	template <typename T>
+	class SlotMap
+	{
+	public:
+		SlotMap() = default;
+		SlotMap(uint32 capacity)
+			: m_Values(capacity)
+			, m_DenseToSlot(capacity)
+			, m_Slots(capacity)
+		{
+		}
+
+		SlotHandle Add(const T& object) { return Emplace(object); }
+		SlotHandle Add(T&& object) { return Emplace(std::move(object)); }
+
+		template <typename... Args>
+		SlotHandle Emplace(Args&&... args)
+		{
+			uint32 slotIndex = m_FreeHead;
+			if(slotIndex == InvalidIndex)
+			{
+				slotIndex = m_Slots.Size();
+				ASSERT(slotIndex <= SlotHandle::IndexMask, "SlotMap is out of handle indices");
+				m_Slots.Add(Slot());
+			}
+			else
+			{
+				m_FreeHead = m_Slots[slotIndex].m_Next;
+			}
+
+			Slot& slot = m_Slots[slotIndex];
+			slot.m_Next = m_Values.Size();
+
+			m_Values.EmplaceBack(std::forward<Args>(args)...);
+			m_DenseToSlot.Add(slotIndex);
+
+			return MakeHandle(slotIndex, slot.m_Generation);
+		}
+
+		bool Remove(SlotHandle handle)
+		{
+			if(!Contains(handle))
+				return false;
+
+			const uint32 slotIndex = handle.GetIndex();
+			Slot& slot = m_Slots[slotIndex];
+			const uint32 dense = slot.m_Next;
+			const uint32 last = m_Values.Size() - 1;
+
+			// the last object moves into the hole, point its slot at the new position
+			m_Slots[m_DenseToSlot[last]].m_Next = dense;
+			m_Values.RemoveCyclicAtIndex(dense);
+			m_DenseToSlot.RemoveCyclicAtIndex(dense);
+
+			slot.m_Generation = (slot.m_Generation + 1) & SlotHandle::GenerationMask;
+			if(slot.m_Generation == 0)
+				slot.m_Generation = 1;
+
+			slot.m_Next = m_FreeHead;
+			m_FreeHead = slotIndex;
+			return true;
+		}
+
+		bool Contains(SlotHandle handle) const
+		{
+			const uint32 slotIndex = handle.GetIndex();
+			return handle.IsValid() && slotIndex < m_Slots.Size() &&
+				   m_Slots[slotIndex].m_Generation == handle.GetGeneration() && m_Slots[slotIndex].m_Next < m_Values.Size() &&
+				   m_DenseToSlot[m_Slots[slotIndex].m_Next] == slotIndex;
+		}
+
+		T* Get(SlotHandle handle) { return Contains(handle) ? &m_Values[m_Slots[handle.GetIndex()].m_Next] : nullptr; }
+		const T* Get(SlotHandle handle) const { return const_cast<SlotMap*>(this)->Get(handle); }
+
+		// Handle of the object currently stored at dense position index, for use while iterating.
+		SlotHandle GetHandle(uint32 index) const
+		{
+			const uint32 slotIndex = m_DenseToSlot[index];
+			return MakeHandle(slotIndex, m_Slots[slotIndex].m_Generation);
+		}
+
+		void Clear()
+		{
+			for(uint32 i = m_Values.Size(); i > 0; --i)
+				Remove(GetHandle(i - 1));
+		}
+
+		uint32 Size() const { return m_Values.Size(); }
+		bool Empty() const { return m_Values.Empty(); }
+
+		T* GetData() { return m_Values.GetData(); }
+		const T* GetData() const { return m_Values.GetData(); }
+
+		typedef T* iterator;
+		typedef const T* const_iterator;
+		iterator begin() { return m_Values.begin(); }
+		const_iterator begin() const { return m_Values.begin(); }
+		iterator end() { return m_Values.end(); }
+		const_iterator end() const { return m_Values.end(); }
+
+	private:
+		static constexpr uint32 InvalidIndex = ~0u;
+
+		struct Slot
+		{
+			uint32 m_Next = 0; // dense index while alive, next free slot once removed
+			uint32 m_Generation = 1;
+		};
+
+		static SlotHandle MakeHandle(uint32 slotIndex, uint32 generation)
+		{
+			return SlotHandle{ (generation << SlotHandle::IndexBits) | slotIndex };
+		}
+
+		GrowingArray<T> m_Values;
+		GrowingArray<uint32> m_DenseToSlot;
+		GrowingArray<Slot> m_Slots;
+		uint32 m_FreeHead = InvalidIndex;
+	};
+
+}; // namespace Core
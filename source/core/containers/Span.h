@@ -0,0 +1,47 @@
+#pragma once
+#include "core/Types.h"
+#include "logger/Debug.h"
+
+namespace Core
+{
+	/*
+		Non owning view of contiguous memory, the std::span we don't have in C++17. Whoever hands one out decides how
+		long the memory lives, a Span is never valid past its owner.
+	*/
+	template <typename T>
+	class Span
+	{
+	public:
+		Span() = default;
+		Span(T* data, uint64 size)
+			: m_Data(data)
+			, m_Size(size)
+		{
+		}
+
+		T& operator[](uint64 index) const
+		{
+			ASSERT(index < m_Size, "index has to be less than the size of the span");
+			return m_Data[index];
+		}
+
+		uint64 Size() const { return m_Size; }
+		bool Empty() const { return m_Size == 0; }
+		T* GetData() const { return m_Data; }
+
+		Span<T> SubSpan(uint64 offset, uint64 size) const
+		{
+			ASSERT(offset + size <= m_Size, "sub span has to be inside the span");
+			return Span<T>(m_Data + offset, size);
+		}
+
+		typedef T* iterator;
+		iterator begin() const { return m_Data; }
+		iterator end() const { return m_Data + m_Size; }
+
+	private:
+		T* m_Data = nullptr;
+		uint64 m_Size = 0;
+	};
+
+}; // namespace Core
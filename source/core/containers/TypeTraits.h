@@ -0,0 +1,24 @@
+#pragma once
+#include <type_traits>
+
+namespace Core
+{
+	template <typename T>
+	class GrowingArray;
+
+	/*
+		A type is trivially relocatable when moving it to a new address and forgetting the old bytes is the same as
+		move constructing + destroying it. Every trivially copyable type is, and so is anything that only owns its
+		memory through a pointer (GrowingArray). Containers use this to grow with a single memcpy.
+	*/
+	template <typename T>
+	struct IsTriviallyRelocatable : std::is_trivially_copyable<T>
+	{
+	};
+
+	template <typename T>
+	struct IsTriviallyRelocatable<GrowingArray<T>> : std::true_type
+	{
+	};
+
+}; // namespace Core
@@ -0,0 +1,103 @@
+#pragma once
+#include "core/Types.h"
+
+#include <atomic>
+
+namespace Core
+{
+	/*
+		Chase-Lev work-stealing deque of pointers, with the memory orders from Le, Pop, Cohen and Zappa Nardelli,
+		"Correct and Efficient Work-Stealing for Weak Memory Models" (2013). The owning thread pushes and pops at the
+		bottom like a stack, any other thread steals from the top. Push and Pop are wait free for the owner, only the
+		race for the last element and stealing use a compare-exchange.
+
+		The ring has a fixed Capacity instead of growing, Push returns false when it is full and the caller runs the
+		work itself.
+	*/
+	template <typename T, uint32 Capacity>
+	class WorkStealingDeque
+	{
+		static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity has to be a power of two");
+
+	public:
+		WorkStealingDeque()
+		{
+			for(std::atomic<T*>& slot : m_Slots)
+				slot.store(nullptr, std::memory_order_relaxed);
+		}
+
+		WorkStealingDeque(const WorkStealingDeque&) = delete;
+		WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+		// Owner only.
+		bool Push(T* item)
+		{
+			const int64 bottom = m_Bottom.load(std::memory_order_relaxed);
+			const int64 top = m_Top.load(std::memory_order_acquire);
+			if(bottom - top >= int64(Capacity))
+				return false;
+
+			m_Slots[bottom & s_Mask].store(item, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+			return true;
+		}
+
+		// Owner only, the most recently pushed item or nullptr.
+		T* Pop()
+		{
+			const int64 bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+			m_Bottom.store(bottom, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64 top = m_Top.load(std::memory_order_relaxed);
+
+			if(top > bottom)
+			{
+				// was already empty
+				m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+				return nullptr;
+			}
+
+			T* item = m_Slots[bottom & s_Mask].load(std::memory_order_relaxed);
+			if(top == bottom)
+			{
+				// the last one, a thief may be taking it right now
+				if(!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+					item = nullptr;
+				m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+			}
+			return item;
+		}
+
+		// Any thread, the oldest item or nullptr when empty or another thread won the race for it.
+		T* Steal()
+		{
+			int64 top = m_Top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			const int64 bottom = m_Bottom.load(std::memory_order_acquire);
+			if(top >= bottom)
+				return nullptr;
+
+			T* item = m_Slots[top & s_Mask].load(std::memory_order_relaxed);
+			if(!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				return nullptr;
+			return item;
+		}
+
+		// A snapshot, only exact on the owning thread while nobody steals.
+		uint32 Size() const
+		{
+			const int64 size = m_Bottom.load(std::memory_order_relaxed) - m_Top.load(std::memory_order_relaxed);
+			return size > 0 ? uint32(size) : 0;
+		}
+
+	private:
+		static constexpr int64 s_Mask = int64(Capacity) - 1;
+
+		// top and bottom on their own cache lines, thieves hammer top while the owner works on bottom
+		alignas(64) std::atomic<int64> m_Top{ 0 };
+		alignas(64) std::atomic<int64> m_Bottom{ 0 };
+		alignas(64) std::atomic<T*> m_Slots[Capacity];
+	};
+
+}; // namespace Core
@@ -0,0 +1,41 @@
+#include "Frustum.h"
+#include <cmath>
+
+namespace Core
+{
+	Frustum Frustum::FromViewProjection(const Matrix44f& viewProjection)
+	{
+		// clip = p * m, so each clip component is p dotted with a column
+		const Matrix44f& m = viewProjection;
+		const Vector4f x(m[0], m[4], m[8], m[12]);
+		const Vector4f y(m[1], m[5], m[9], m[13]);
+		const Vector4f z(m[2], m[6], m[10], m[14]);
+		const Vector4f w(m[3], m[7], m[11], m[15]);
+
+		Frustum frustum;
+		frustum.m_Planes[0] = w + x;
+		frustum.m_Planes[1] = w - x;
+		frustum.m_Planes[2] = w + y;
+		frustum.m_Planes[3] = w - y;
+		frustum.m_Planes[4] = z;
+		frustum.m_Planes[5] = w - z;
+
+		for(Vector4f& plane : frustum.m_Planes)
+		{
+			const float length = sqrtf(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+			if(length > 0.f)
+				plane = plane * (1.f / length);
+		}
+		return frustum;
+	}
+
+	bool Frustum::IsSphereVisible(const Vector3f& center, float radius) const
+	{
+		for(const Vector4f& plane : m_Planes)
+		{
+			if(plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w < -radius)
+				return false;
+		}
+		return true;
+	}
+}; // namespace Core
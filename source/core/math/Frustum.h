@@ -0,0 +1,22 @@
+#pragma once
+#include "core/Types.h"
+#include "Matrix44.h"
+#include "Vector3.h"
+#include "Vector4.h"
+
+namespace Core
+{
+	/*
+		Six planes (xyz normal pointing inwards, w distance) pulled out of a view projection matrix, row vector
+		convention like the rest of the math and Vulkan's 0..1 depth range. In world space when given the camera's
+		view projection, in model space when given world * view projection.
+	*/
+	struct Frustum
+	{
+		static Frustum FromViewProjection(const Matrix44f& viewProjection);
+
+		bool IsSphereVisible(const Vector3f& center, float radius) const;
+
+		Vector4f m_Planes[6]; // left, right, bottom, top, near, far
+	};
+}; // namespace Core
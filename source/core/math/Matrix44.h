@@ -5,6 +5,7 @@
 #include <cassert>
 #include <xmmintrin.h>
 #include <math.h>
+#include <type_traits>
 #include <utility>
 
 namespace Core
@@ -80,7 +81,7 @@ namespace Core
 		Matrix44<T>& operator*=(const Matrix44<T>& matrix);
 
 		union {
-			__declspec(align(16)) T m_Matrix[16];
+			alignas(16) T m_Matrix[16];
 			T mat[4][4];
 			Vector4<T> rows[4];
 			struct
@@ -102,17 +103,32 @@ namespace Core
 	template <typename T>
 	Matrix44<T>& Matrix44<T>::operator+=(const Matrix44<T>& matrix)
 	{
-		for(int i = 0; i < 16; ++i)
-			m_Matrix[i] += matrix[i];
+		if constexpr(std::is_same_v<T, float>)
+		{
+			for(int i = 0; i < 16; i += 4)
+				_mm_store_ps(&m_Matrix[i], _mm_add_ps(_mm_load_ps(&m_Matrix[i]), _mm_load_ps(&matrix[i])));
+		}
+		else
+		{
+			for(int i = 0; i < 16; ++i)
+				m_Matrix[i] += matrix[i];
+		}
 		return *this;
 	}
 
 	template <typename T>
 	Matrix44<T>& Matrix44<T>::operator-=(const Matrix44<T>& matrix)
 	{
-		for(int i = 0; i < 16; ++i)
-			m_Matrix[i] -= matrix[i];
-
+		if constexpr(std::is_same_v<T, float>)
+		{
+			for(int i = 0; i < 16; i += 4)
+				_mm_store_ps(&m_Matrix[i], _mm_sub_ps(_mm_load_ps(&m_Matrix[i]), _mm_load_ps(&matrix[i])));
+		}
+		else
+		{
+			for(int i = 0; i < 16; ++i)
+				m_Matrix[i] -= matrix[i];
+		}
 		return *this;
 	}
 
@@ -142,9 +158,16 @@ namespace Core
 	template <typename T>
 	Matrix44<T>& Matrix44<T>::operator=(const Matrix44<T>& aMatrix)
 	{
-		for(unsigned short i = 0; i < 16; ++i)
-			m_Matrix[i] = aMatrix[i];
-
+		if constexpr(std::is_same_v<T, float>)
+		{
+			for(int i = 0; i < 16; i += 4)
+				_mm_store_ps(&m_Matrix[i], _mm_load_ps(&aMatrix[i]));
+		}
+		else
+		{
+			for(unsigned short i = 0; i < 16; ++i)
+				m_Matrix[i] = aMatrix[i];
+		}
 		return *this;
 	}
 
@@ -223,6 +246,20 @@ namespace Core
 	Matrix44<T> Transpose(const Matrix44<T>& mat)
 	{
 		Matrix44<T> result(mat);
+		if constexpr(std::is_same_v<T, float>)
+		{
+			__m128 r0 = _mm_load_ps(&mat[0]);
+			__m128 r1 = _mm_load_ps(&mat[4]);
+			__m128 r2 = _mm_load_ps(&mat[8]);
+			__m128 r3 = _mm_load_ps(&mat[12]);
+			_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+			_mm_store_ps(&result[0], r0);
+			_mm_store_ps(&result[4], r1);
+			_mm_store_ps(&result[8], r2);
+			_mm_store_ps(&result[12], r3);
+			return result;
+		}
+
 		std::swap(result[1], result[4]);
 		std::swap(result[2], result[8]);
 		std::swap(result[3], result[12]);
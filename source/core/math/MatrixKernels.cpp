@@ -0,0 +1,190 @@
+#include "MatrixKernels.h"
+
+#include <xmmintrin.h>
+#if defined(__AVX__)
+#include <immintrin.h>
+#endif
+
+namespace Core
+{
+	namespace Math
+	{
+		namespace
+		{
+			// lane order x, y, z, w like the math libraries write it, _MM_SHUFFLE wants it backwards
+			template <int X, int Y, int Z, int W>
+			__m128 Swizzle(__m128 v)
+			{
+				return _mm_shuffle_ps(v, v, _MM_SHUFFLE(W, Z, Y, X));
+			}
+
+			template <int X, int Y, int Z, int W>
+			__m128 Shuffle(__m128 a, __m128 b)
+			{
+				return _mm_shuffle_ps(a, b, _MM_SHUFFLE(W, Z, Y, X));
+			}
+
+			/*
+				The 4x4 inverse works on 2x2 blocks stored in one register as (m00, m01, m10, m11).
+				A# is the adjugate of A, for 2x2 blocks A * A# = |A| * I.
+			*/
+
+			// A * B
+			__m128 Mat2Mul(__m128 a, __m128 b)
+			{
+				return _mm_add_ps(_mm_mul_ps(a, Swizzle<0, 3, 0, 3>(b)),
+								  _mm_mul_ps(Swizzle<1, 0, 3, 2>(a), Swizzle<2, 1, 2, 1>(b)));
+			}
+
+			// A# * B
+			__m128 Mat2AdjMul(__m128 a, __m128 b)
+			{
+				return _mm_sub_ps(_mm_mul_ps(Swizzle<3, 3, 0, 0>(a), b),
+								  _mm_mul_ps(Swizzle<1, 1, 2, 2>(a), Swizzle<2, 3, 0, 1>(b)));
+			}
+
+			// A * B#
+			__m128 Mat2MulAdj(__m128 a, __m128 b)
+			{
+				return _mm_sub_ps(_mm_mul_ps(a, Swizzle<3, 0, 3, 0>(b)),
+								  _mm_mul_ps(Swizzle<1, 0, 3, 2>(a), Swizzle<2, 1, 2, 1>(b)));
+			}
+
+			__m128 Sum4(__m128 v)
+			{
+				const __m128 pairs = _mm_add_ps(v, _mm_movehl_ps(v, v));
+				return Swizzle<0, 0, 0, 0>(_mm_add_ps(pairs, Swizzle<1, 1, 1, 1>(pairs)));
+			}
+
+			struct Blocks
+			{
+				__m128 a, b, c, d;	 // top left, top right, bottom left, bottom right
+				__m128 detA, detB, detC, detD;
+				__m128 dc, ab;		 // D# * C, A# * B
+				__m128 det;			 // determinant of the whole matrix in every lane
+			};
+
+			Blocks Decompose(const Matrix44f& m)
+			{
+				const __m128 r0 = _mm_load_ps(&m[0]);
+				const __m128 r1 = _mm_load_ps(&m[4]);
+				const __m128 r2 = _mm_load_ps(&m[8]);
+				const __m128 r3 = _mm_load_ps(&m[12]);
+
+				Blocks blocks;
+				blocks.a = _mm_movelh_ps(r0, r1);
+				blocks.b = _mm_movehl_ps(r1, r0);
+				blocks.c = _mm_movelh_ps(r2, r3);
+				blocks.d = _mm_movehl_ps(r3, r2);
+
+				// |A| |B| |C| |D| in one go
+				const __m128 detSub = _mm_sub_ps(_mm_mul_ps(Shuffle<0, 2, 0, 2>(r0, r2), Shuffle<1, 3, 1, 3>(r1, r3)),
+												 _mm_mul_ps(Shuffle<1, 3, 1, 3>(r0, r2), Shuffle<0, 2, 0, 2>(r1, r3)));
+				blocks.detA = Swizzle<0, 0, 0, 0>(detSub);
+				blocks.detB = Swizzle<1, 1, 1, 1>(detSub);
+				blocks.detC = Swizzle<2, 2, 2, 2>(detSub);
+				blocks.detD = Swizzle<3, 3, 3, 3>(detSub);
+
+				blocks.dc = Mat2AdjMul(blocks.d, blocks.c);
+				blocks.ab = Mat2AdjMul(blocks.a, blocks.b);
+
+				// |M| = |A||D| + |B||C| - tr((A#B)(D#C))
+				const __m128 trace = Sum4(_mm_mul_ps(blocks.ab, Swizzle<0, 2, 1, 3>(blocks.dc)));
+				const __m128 detAD = _mm_mul_ps(blocks.detA, blocks.detD);
+				blocks.det = _mm_sub_ps(_mm_add_ps(detAD, _mm_mul_ps(blocks.detB, blocks.detC)), trace);
+				return blocks;
+			}
+		}; // namespace
+
+		float Inverse(const Matrix44f& m, Matrix44f& out)
+		{
+			const Blocks blocks = Decompose(m);
+			const float determinant = _mm_cvtss_f32(blocks.det);
+			if(determinant == 0.f)
+				return determinant;
+
+			// the inverse is 1/|M| * | X  Y |, built from the adjugates of the blocks
+			//                         | Z  W |
+			__m128 x = _mm_sub_ps(_mm_mul_ps(blocks.detD, blocks.a), Mat2Mul(blocks.b, blocks.dc));
+			__m128 w = _mm_sub_ps(_mm_mul_ps(blocks.detA, blocks.d), Mat2Mul(blocks.c, blocks.ab));
+			__m128 y = _mm_sub_ps(_mm_mul_ps(blocks.detB, blocks.c), Mat2MulAdj(blocks.d, blocks.ab));
+			__m128 z = _mm_sub_ps(_mm_mul_ps(blocks.detC, blocks.b), Mat2MulAdj(blocks.a, blocks.dc));
+
+			// the adjugate sign pattern is folded into the reciprocal
+			const __m128 reciprocal = _mm_div_ps(_mm_setr_ps(1.f, -1.f, -1.f, 1.f), blocks.det);
+			x = _mm_mul_ps(x, reciprocal);
+			y = _mm_mul_ps(y, reciprocal);
+			z = _mm_mul_ps(z, reciprocal);
+			w = _mm_mul_ps(w, reciprocal);
+
+			// adjugate shuffle and the block to row shuffle in one step
+			_mm_store_ps(&out[0], Shuffle<3, 1, 3, 1>(x, y));
+			_mm_store_ps(&out[4], Shuffle<2, 0, 2, 0>(x, y));
+			_mm_store_ps(&out[8], Shuffle<3, 1, 3, 1>(z, w));
+			_mm_store_ps(&out[12], Shuffle<2, 0, 2, 0>(z, w));
+			return determinant;
+		}
+
+		float Determinant(const Matrix44f& m) { return _mm_cvtss_f32(Decompose(m).det); }
+
+		void Multiply(const Matrix44f& a, const Matrix44f& b, Matrix44f& out)
+		{
+			const __m128 r0 = _mm_load_ps(&a[0]);
+			const __m128 r1 = _mm_load_ps(&a[4]);
+			const __m128 r2 = _mm_load_ps(&a[8]);
+			const __m128 r3 = _mm_load_ps(&a[12]);
+
+			// all of b is read before out is written, out may alias b
+			__m128 rows[4];
+			for(int i = 0; i < 4; ++i)
+			{
+				const __m128 c0 = _mm_set1_ps(b[i * 4 + 0]);
+				const __m128 c1 = _mm_set1_ps(b[i * 4 + 1]);
+				const __m128 c2 = _mm_set1_ps(b[i * 4 + 2]);
+				const __m128 c3 = _mm_set1_ps(b[i * 4 + 3]);
+				rows[i] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(r0, c0), _mm_mul_ps(r1, c1)),
+									 _mm_add_ps(_mm_mul_ps(r2, c2), _mm_mul_ps(r3, c3)));
+			}
+
+			for(int i = 0; i < 4; ++i)
+				_mm_store_ps(&out[i * 4], rows[i]);
+		}
+
+		Vector4f Transform(const Vector4f& v, const Matrix44f& m)
+		{
+			// summed in the same order as Dot so the result matches v * m exactly
+			__m128 result = _mm_mul_ps(Swizzle<0, 0, 0, 0>(v.simd), _mm_load_ps(&m[0]));
+			result = _mm_add_ps(result, _mm_mul_ps(Swizzle<1, 1, 1, 1>(v.simd), _mm_load_ps(&m[4])));
+			result = _mm_add_ps(result, _mm_mul_ps(Swizzle<2, 2, 2, 2>(v.simd), _mm_load_ps(&m[8])));
+			result = _mm_add_ps(result, _mm_mul_ps(Swizzle<3, 3, 3, 3>(v.simd), _mm_load_ps(&m[12])));
+			return result;
+		}
+
+		void TransformBatch(const Matrix44f& m, const Vector4f* in, Vector4f* out, uint32 count)
+		{
+			uint32 i = 0;
+
+#if defined(__AVX__)
+			// two vectors per register, every row is duplicated into both halves
+			const __m256 r0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&m[0]));
+			const __m256 r1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&m[4]));
+			const __m256 r2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&m[8]));
+			const __m256 r3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(&m[12]));
+
+			for(; i + 2 <= count; i += 2)
+			{
+				const __m256 v = _mm256_loadu_ps(in[i].vector);
+				__m256 result = _mm256_mul_ps(_mm256_permute_ps(v, 0x00), r0);
+				result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_permute_ps(v, 0x55), r1));
+				result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_permute_ps(v, 0xAA), r2));
+				result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_permute_ps(v, 0xFF), r3));
+				_mm256_storeu_ps(out[i].vector, result);
+			}
+#endif
+
+			for(; i < count; ++i)
+				out[i] = Transform(in[i], m);
+		}
+
+	}; // namespace Math
+}; // namespace Core
@@ -0,0 +1,28 @@
+#pragma once
+#include "core/Types.h"
+#include "Matrix44.h"
+#include "Vector4.h"
+
+namespace Core
+{
+	/*
+		SSE versions of the heavier Matrix44f operations, the cheap ones (copy, add, sub, transpose) are inlined in
+		Matrix44.h. Matrices are row major and vectors are row vectors like in Matrix44.h, so Transform(v, m) gives the
+		same result as v * m. in and out may point at the same matrix. Checked against the scalar code in
+		unit_test/tests.cpp.
+	*/
+	namespace Math
+	{
+		// General inverse, returns the determinant. out is left untouched when the determinant is 0.
+		float Inverse(const Matrix44f& m, Matrix44f& out);
+		float Determinant(const Matrix44f& m);
+
+		// Same product as a * b without the temporaries.
+		void Multiply(const Matrix44f& a, const Matrix44f& b, Matrix44f& out);
+
+		Vector4f Transform(const Vector4f& v, const Matrix44f& m);
+		// out[i] = in[i] * m for count vectors, uses AVX when the build targets it.
+		void TransformBatch(const Matrix44f& m, const Vector4f* in, Vector4f* out, uint32 count);
+
+	}; // namespace Math
+}; // namespace Core
@@ -2,44 +2,152 @@
 #include <cmath>
 namespace Core
 {
+	namespace
+	{
+		// Hamilton product, one lane of a at a time against a shuffled and sign flipped b
+		Simd::Float4 Multiply(Simd::Float4 a, Simd::Float4 b)
+		{
+			Simd::Float4 r = Simd::Mul(Simd::Swizzle<3, 3, 3, 3>(a), b);
+			r = Simd::MulAdd(Simd::Mul(Simd::Swizzle<0, 0, 0, 0>(a), Simd::Set(1.f, -1.f, 1.f, -1.f)),
+							 Simd::Swizzle<3, 2, 1, 0>(b), r);
+			r = Simd::MulAdd(Simd::Mul(Simd::Swizzle<1, 1, 1, 1>(a), Simd::Set(1.f, 1.f, -1.f, -1.f)),
+							 Simd::Swizzle<2, 3, 0, 1>(b), r);
+			r = Simd::MulAdd(Simd::Mul(Simd::Swizzle<2, 2, 2, 2>(a), Simd::Set(-1.f, 1.f, 1.f, -1.f)),
+							 Simd::Swizzle<1, 0, 3, 2>(b), r);
+			return r;
+		}
+
+		// v + 2w(q x v) + 2q x (q x v), the w of v comes through untouched
+		Simd::Float4 Rotate(Simd::Float4 q, Simd::Float4 v)
+		{
+			const Simd::Float4 t = Simd::Mul(Simd::Cross3(q, v), Simd::Splat(2.f));
+			return Simd::Add(Simd::MulAdd(Simd::Swizzle<3, 3, 3, 3>(q), t, v), Simd::Cross3(q, t));
+		}
+
+		Simd::Float4 Normalized(Simd::Float4 q) { return Simd::Div(q, Simd::Sqrt(Simd::Dot4(q, q))); }
+
+		/*
+			Slerp weights for both ends, the sign of cosine picks the shorter way around. Close to parallel the angle
+			can't be recovered from the cosine so it falls back to linear weights, callers normalize the result.
+		*/
+		void SlerpWeights(float cosine, float t, float& fromWeight, float& toWeight)
+		{
+			const float sign = cosine < 0.f ? -1.f : 1.f;
+			cosine *= sign;
+			if(cosine > 0.9995f)
+			{
+				fromWeight = 1.f - t;
+				toWeight = t * sign;
+				return;
+			}
+
+			const float angle = acosf(cosine);
+			const float sine = sinf(angle);
+			fromWeight = sinf((1.f - t) * angle) / sine;
+			toWeight = sign * sinf(t * angle) / sine;
+		}
+
+		// four quaternions as separate x, y, z and w registers
+		struct QuaternionSoA
+		{
+			Simd::Float4 x, y, z, w;
+		};
+
+		QuaternionSoA Load4(const Quaternion* quats)
+		{
+			QuaternionSoA soa = { quats[0].simd, quats[1].simd, quats[2].simd, quats[3].simd };
+			Simd::Transpose4(soa.x, soa.y, soa.z, soa.w);
+			return soa;
+		}
+
+		void Store4(QuaternionSoA soa, Quaternion* quats)
+		{
+			Simd::Transpose4(soa.x, soa.y, soa.z, soa.w);
+			quats[0].simd = soa.x;
+			quats[1].simd = soa.y;
+			quats[2].simd = soa.z;
+			quats[3].simd = soa.w;
+		}
+
+		Simd::Float4 Dot4(const QuaternionSoA& a, const QuaternionSoA& b)
+		{
+			Simd::Float4 sum = Simd::Mul(a.x, b.x);
+			sum = Simd::MulAdd(a.y, b.y, sum);
+			sum = Simd::MulAdd(a.z, b.z, sum);
+			return Simd::MulAdd(a.w, b.w, sum);
+		}
+
+		QuaternionSoA Normalized4(const QuaternionSoA& q)
+		{
+			const Simd::Float4 length = Simd::Sqrt(Dot4(q, q));
+			return { Simd::Div(q.x, length), Simd::Div(q.y, length), Simd::Div(q.z, length), Simd::Div(q.w, length) };
+		}
+
+		// from * fromWeight + to * toWeight, normalized
+		QuaternionSoA Blend4(const QuaternionSoA& from, const QuaternionSoA& to, Simd::Float4 fromWeight,
+							 Simd::Float4 toWeight)
+		{
+			const QuaternionSoA blend = {
+				Simd::MulAdd(from.x, fromWeight, Simd::Mul(to.x, toWeight)),
+				Simd::MulAdd(from.y, fromWeight, Simd::Mul(to.y, toWeight)),
+				Simd::MulAdd(from.z, fromWeight, Simd::Mul(to.z, toWeight)),
+				Simd::MulAdd(from.w, fromWeight, Simd::Mul(to.w, toWeight)),
+			};
+			return Normalized4(blend);
+		}
+
+		// the same arithmetic as the 4 wide version in ToMatrixBatch, one object
+		void ToMatrix(float qx, float qy, float qz, float qw, Matrix44f& out)
+		{
+			const float x2 = qx + qx;
+			const float y2 = qy + qy;
+			const float z2 = qz + qz;
+			const float xx = qx * x2, yy = qy * y2, zz = qz * z2;
+			const float xy = qx * y2, xz = qx * z2, yz = qy * z2;
+			const float wx = qw * x2, wy = qw * y2, wz = qw * z2;
+
+			out.rows[0] = Vector4f(1.f - (yy + zz), xy + wz, xz - wy, 0.f);
+			out.rows[1] = Vector4f(xy - wz, 1.f - (xx + zz), yz + wx, 0.f);
+			out.rows[2] = Vector4f(xz + wy, yz - wx, 1.f - (xx + yy), 0.f);
+			out.rows[3] = Vector4f(0.f, 0.f, 0.f, 1.f);
+		}
+	}; // namespace
 
 	Quaternion::Quaternion()
-		: v(0, 0, 0)
-		, w(1.f)
+		: simd(Simd::Set(0.f, 0.f, 0.f, 1.f))
+	{
+	}
+
+	Quaternion::Quaternion(float x_, float y_, float z_, float w_)
+		: simd(Simd::Set(x_, y_, z_, w_))
 	{
 	}
 
 	Quaternion::Quaternion(const Core::Vector3f& aNormal, float anAngle)
-		: v(aNormal * sinf(anAngle * 0.5f))
-		, w(cosf(anAngle * 0.5f))
 	{
+		const float s = sinf(anAngle * 0.5f);
+		simd = Simd::Set(aNormal.x * s, aNormal.y * s, aNormal.z * s, cosf(anAngle * 0.5f));
 	}
 
 	Quaternion Quaternion::Inverted() const
 	{
-		Quaternion q;
-
-		q.w = w;
-		q.v.x = -v.x;
-		q.v.y = -v.y;
-		q.v.z = -v.z;
-
-		return q;
+		return Simd::Mul(simd, Simd::Set(-1.f, -1.f, -1.f, 1.f));
 	}
 
 	Quaternion Quaternion::operator*(const Quaternion& aQuaternion) const
 	{
-		Quaternion r;
-		r.w = w * aQuaternion.w - Dot(v, aQuaternion.v);
-		r.v = v * aQuaternion.w + aQuaternion.v * w + Cross(v, aQuaternion.v);
-
-		return r;
+		return Multiply(simd, aQuaternion.simd);
 	}
 
 	Core::Vector3f Quaternion::operator*(const Core::Vector3f& aVector) const
 	{
-		Core::Vector3f vcV = Cross(v, aVector);
-		return aVector + vcV * (2.f * w) + Cross(v, vcV) * 2.f;
+		const Core::Vector4f rotated = Rotate(simd, Simd::Set(aVector.x, aVector.y, aVector.z, 0.f));
+		return Core::Vector3f(rotated.x, rotated.y, rotated.z);
+	}
+
+	Core::Vector4f Quaternion::operator*(const Core::Vector4f& aVector) const
+	{
+		return Rotate(simd, aVector.simd);
 	}
 
 	Quaternion Quaternion::operator^(float aT) const
@@ -56,58 +164,174 @@ namespace Core
 
 	Quaternion Quaternion::Slerp(const Quaternion& other, float aT) const
 	{
-		return ((other * Inverted()) ^ aT) * (*this);
+		return Core::Slerp(*this, other, aT);
 	}
 
-	Core::Matrix44f Quaternion::ConvertToRotationMatrix()
+	Core::Matrix44f Quaternion::ConvertToRotationMatrix() const
 	{
-		float qx = v.x;
-		float qy = v.y;
-		float qz = v.z;
-		float qw = w;
-
-		const float n = 1.f / sqrt(
-			(qx*qx) +
-			(qy*qy) +
-			(qz*qz) +
-			(qw*qw));
-
-		qx *= n;
-		qy *= n;
-		qz *= n;
-		qw *= n;
+		const Quaternion q = GetNormalized(*this);
 
 		Core::Matrix44f matrix;
-		matrix[0] = 1.0f - 2.0f*qy*qy - 2.0f*qz*qz;
-		matrix[1] = 2.0f*qx*qy - 2.0f*qz*qw;
-		matrix[2] = 2.0f*qx*qz + 2.0f*qy*qw, 0.0f;
-		matrix[3] = 2.0f*qx*qy + 2.0f*qz*qw;
-
-		matrix[4] = 1.0f - 2.0f*qx*qx - 2.0f*qz*qz;
-		matrix[5] = 2.0f*qy*qz - 2.0f*qx*qw;
-		matrix[6] = 0.0f;
-		matrix[7] = 2.0f*qx*qz - 2.0f*qy*qw;
-
-		matrix[8] = 2.0f*qy*qz + 2.0f*qx*qw;
-		matrix[9] = 1.0f - 2.0f*qx*qx - 2.0f*qy*qy;
-		matrix[10] = 0.0f;
-
-		matrix.rows[3] = Core::Vector4f(0.f, 0.f, 0.f, 1.0f);
-				
+		ToMatrix(q.x, q.y, q.z, q.w, matrix);
 		return matrix;
 	}
 
 	void Quaternion::ToAxisAngle(Core::Vector3f& aVectorAxisOut, float& anAngleOut) const
 	{
-		if (aVectorAxisOut.Length2() < 0.0001f)
+		Core::Vector3f axis(x, y, z);
+		if (axis.Length2() < 0.0001f)
 		{
 			aVectorAxisOut = Core::Vector3f(1.f, 0, 0);
 		}
 		else
 		{
-			aVectorAxisOut = GetNormalized(v);
+			aVectorAxisOut = GetNormalized(axis);
 		}
 
-		anAngleOut = acos(w) * 2.f;
+		anAngleOut = acosf(fmaxf(-1.f, fminf(1.f, w))) * 2.f;
+	}
+
+	float Dot(const Quaternion& a, const Quaternion& b) { return Simd::GetX(Simd::Dot4(a.simd, b.simd)); }
+
+	Quaternion GetNormalized(const Quaternion& quat) { return Normalized(quat.simd); }
+
+	void Normalize(Quaternion& quat) { quat.simd = Normalized(quat.simd); }
+
+	Quaternion Nlerp(const Quaternion& from, const Quaternion& to, float t)
+	{
+		const Simd::Float4 toWeight = Simd::CopySign(Simd::Splat(t), Simd::Dot4(from.simd, to.simd));
+		return Normalized(Simd::MulAdd(from.simd, Simd::Splat(1.f - t), Simd::Mul(to.simd, toWeight)));
+	}
+
+	Quaternion Slerp(const Quaternion& from, const Quaternion& to, float t)
+	{
+		float fromWeight;
+		float toWeight;
+		SlerpWeights(Dot(from, to), t, fromWeight, toWeight);
+		return Normalized(Simd::MulAdd(from.simd, Simd::Splat(fromWeight), Simd::Mul(to.simd, Simd::Splat(toWeight))));
 	}
-}
+
+	namespace Math
+	{
+		void NormalizeBatch(const Quaternion* in, Quaternion* out, uint32 count)
+		{
+			uint32 i = 0;
+			for(; i + 4 <= count; i += 4)
+				Store4(Normalized4(Load4(in + i)), out + i);
+
+			for(; i < count; ++i)
+				out[i] = GetNormalized(in[i]);
+		}
+
+		void MultiplyBatch(const Quaternion* a, const Quaternion* b, Quaternion* out, uint32 count)
+		{
+			uint32 i = 0;
+			for(; i + 4 <= count; i += 4)
+			{
+				const QuaternionSoA l = Load4(a + i);
+				const QuaternionSoA r = Load4(b + i);
+
+				QuaternionSoA product;
+				product.x = Simd::MulAdd(l.w, r.x, Simd::MulAdd(l.x, r.w, Simd::Mul(l.y, r.z)));
+				product.x = Simd::Sub(product.x, Simd::Mul(l.z, r.y));
+				product.y = Simd::MulAdd(l.w, r.y, Simd::MulAdd(l.y, r.w, Simd::Mul(l.z, r.x)));
+				product.y = Simd::Sub(product.y, Simd::Mul(l.x, r.z));
+				product.z = Simd::MulAdd(l.w, r.z, Simd::MulAdd(l.z, r.w, Simd::Mul(l.x, r.y)));
+				product.z = Simd::Sub(product.z, Simd::Mul(l.y, r.x));
+				product.w = Simd::Sub(Simd::Sub(Simd::Mul(l.w, r.w), Simd::Mul(l.x, r.x)),
+									  Simd::Add(Simd::Mul(l.y, r.y), Simd::Mul(l.z, r.z)));
+				Store4(product, out + i);
+			}
+
+			for(; i < count; ++i)
+				out[i] = a[i] * b[i];
+		}
+
+		void NlerpBatch(const Quaternion* from, const Quaternion* to, float t, Quaternion* out, uint32 count)
+		{
+			const Simd::Float4 fromWeight = Simd::Splat(1.f - t);
+			const Simd::Float4 toWeight = Simd::Splat(t);
+
+			uint32 i = 0;
+			for(; i + 4 <= count; i += 4)
+			{
+				const QuaternionSoA a = Load4(from + i);
+				const QuaternionSoA b = Load4(to + i);
+				Store4(Blend4(a, b, fromWeight, Simd::CopySign(toWeight, Dot4(a, b))), out + i);
+			}
+
+			for(; i < count; ++i)
+				out[i] = Nlerp(from[i], to[i], t);
+		}
+
+		void SlerpBatch(const Quaternion* from, const Quaternion* to, float t, Quaternion* out, uint32 count)
+		{
+			uint32 i = 0;
+			for(; i + 4 <= count; i += 4)
+			{
+				const QuaternionSoA a = Load4(from + i);
+				const QuaternionSoA b = Load4(to + i);
+
+				// the blend is wide, acos / sin per lane stay scalar
+				float cosines[4];
+				float fromWeights[4];
+				float toWeights[4];
+				Simd::Store(cosines, Dot4(a, b));
+				for(int lane = 0; lane < 4; ++lane)
+					SlerpWeights(cosines[lane], t, fromWeights[lane], toWeights[lane]);
+
+				Store4(Blend4(a, b, Simd::Load(fromWeights), Simd::Load(toWeights)), out + i);
+			}
+
+			for(; i < count; ++i)
+				out[i] = Slerp(from[i], to[i], t);
+		}
+
+		void ToMatrixBatch(const Quaternion* in, Matrix44f* out, uint32 count)
+		{
+			const Simd::Float4 one = Simd::Splat(1.f);
+			const Simd::Float4 zero = Simd::Zero();
+			const Simd::Float4 lastRow = Simd::Set(0.f, 0.f, 0.f, 1.f);
+
+			uint32 i = 0;
+			for(; i + 4 <= count; i += 4)
+			{
+				const QuaternionSoA q = Load4(in + i);
+				const Simd::Float4 x2 = Simd::Add(q.x, q.x);
+				const Simd::Float4 y2 = Simd::Add(q.y, q.y);
+				const Simd::Float4 z2 = Simd::Add(q.z, q.z);
+				const Simd::Float4 xx = Simd::Mul(q.x, x2);
+				const Simd::Float4 yy = Simd::Mul(q.y, y2);
+				const Simd::Float4 zz = Simd::Mul(q.z, z2);
+				const Simd::Float4 xy = Simd::Mul(q.x, y2);
+				const Simd::Float4 xz = Simd::Mul(q.x, z2);
+				const Simd::Float4 yz = Simd::Mul(q.y, z2);
+				const Simd::Float4 wx = Simd::Mul(q.w, x2);
+				const Simd::Float4 wy = Simd::Mul(q.w, y2);
+				const Simd::Float4 wz = Simd::Mul(q.w, z2);
+
+				// each register holds one element for all four matrices, transposing a row's columns gives that row
+				Simd::Float4 rows[3][4] = {
+					{ Simd::Sub(one, Simd::Add(yy, zz)), Simd::Add(xy, wz), Simd::Sub(xz, wy), zero },
+					{ Simd::Sub(xy, wz), Simd::Sub(one, Simd::Add(xx, zz)), Simd::Add(yz, wx), zero },
+					{ Simd::Add(xz, wy), Simd::Sub(yz, wx), Simd::Sub(one, Simd::Add(xx, yy)), zero },
+				};
+
+				for(int row = 0; row < 3; ++row)
+				{
+					Simd::Float4* r = rows[row];
+					Simd::Transpose4(r[0], r[1], r[2], r[3]);
+					for(int j = 0; j < 4; ++j)
+						out[i + j].rows[row].simd = r[j];
+				}
+
+				for(int j = 0; j < 4; ++j)
+					out[i + j].rows[3].simd = lastRow;
+			}
+
+			for(; i < count; ++i)
+				ToMatrix(in[i].x, in[i].y, in[i].z, in[i].w, out[i]);
+		}
+	}; // namespace Math
+
+}; // namespace Core
@@ -1,33 +1,77 @@
 #pragma once
+#include "core/Types.h"
+#include "Simd.h"
 #include "Vector3.h"
+#include "Vector4.h"
 #include "Matrix44.h"
 namespace Core
 {
+	/*
+		Rotation quaternion (x, y, z, w) kept in one 16 byte SIMD register, xyz is the axis scaled by sin(angle / 2)
+		and w is cos(angle / 2). a * b rotates by b first and then by a. ConvertToRotationMatrix gives the row major
+		matrix Matrix44f and TransformBatch use, so v * q.ConvertToRotationMatrix() rotates v like q * v does.
+	*/
 	class Quaternion
 	{
 	public:
 		Quaternion();
+		Quaternion(float x_, float y_, float z_, float w_);
 		Quaternion(const Core::Vector3f& aNormal, float anAngle);
+		Quaternion(Simd::Float4 simd_)
+			: simd(simd_)
+		{
+		}
 
 		Quaternion Inverted() const;
 
 		Quaternion operator*(const Quaternion& aQuaternion) const;
-		
+
 		Core::Vector3f operator*(const Core::Vector3f& aVector) const;
+		Core::Vector4f operator*(const Core::Vector4f& aVector) const;
 		Quaternion operator^(float aT) const;
 
 		Quaternion Slerp(const Quaternion& other, float aT) const;
 
-		Core::Matrix44f ConvertToRotationMatrix();
-		void operator-=(const Core::Quaternion& quat)
-		{
-			v -= quat.v;
-			w -= w;
-		}
+		Core::Matrix44f ConvertToRotationMatrix() const;
+		Core::Vector4f GetVector4() const { return Core::Vector4f(simd); }
+
+		void operator-=(const Core::Quaternion& quat) { simd = Simd::Sub(simd, quat.simd); }
+
+		union {
+			struct
+			{
+				float x;
+				float y;
+				float z;
+				float w;
+			};
+			float data[4];
+			Simd::Float4 simd;
+		};
+
 	private:
 		void ToAxisAngle(Core::Vector3f& aVectorAxisOut, float& anAngleOut) const;
-		Core::Vector3f v;
-		float w;
 	};
 
-}
\ No newline at end of file
+	float Dot(const Quaternion& a, const Quaternion& b);
+	Quaternion GetNormalized(const Quaternion& quat);
+	void Normalize(Quaternion& quat);
+
+	// Both take the shorter way around. Nlerp is the cheap one and does not move at a constant angular speed.
+	Quaternion Nlerp(const Quaternion& from, const Quaternion& to, float t);
+	Quaternion Slerp(const Quaternion& from, const Quaternion& to, float t);
+
+	/*
+		Array versions, four quaternions at a time in SoA form. in and out may be the same array.
+		ToMatrixBatch expects unit quaternions, NormalizeBatch first if they have drifted.
+	*/
+	namespace Math
+	{
+		void NormalizeBatch(const Quaternion* in, Quaternion* out, uint32 count);
+		void MultiplyBatch(const Quaternion* a, const Quaternion* b, Quaternion* out, uint32 count);
+		void NlerpBatch(const Quaternion* from, const Quaternion* to, float t, Quaternion* out, uint32 count);
+		void SlerpBatch(const Quaternion* from, const Quaternion* to, float t, Quaternion* out, uint32 count);
+		void ToMatrixBatch(const Quaternion* in, Matrix44f* out, uint32 count);
+	}; // namespace Math
+
+}; // namespace Core
@@ -0,0 +1,181 @@
+#pragma once
+
+/*
+	Thin wrapper over the 4 wide float registers of the target, the math types are written against this instead of
+	raw intrinsics. SSE on x64, NEON on 64 bit ARM. Dot4 adds the lanes left to right like the scalar code does, so
+	results match the scalar templates bit for bit.
+*/
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+#define CORE_SIMD_NEON 1
+#include <arm_neon.h>
+#else
+#define CORE_SIMD_SSE 1
+#include <xmmintrin.h>
+#include <emmintrin.h>
+#if defined(__FMA__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#endif
+
+namespace Core
+{
+	namespace Simd
+	{
+#if defined(CORE_SIMD_SSE)
+		typedef __m128 Float4;
+
+		inline Float4 Zero() { return _mm_setzero_ps(); }
+		inline Float4 Set(float x, float y, float z, float w) { return _mm_setr_ps(x, y, z, w); }
+		inline Float4 Splat(float value) { return _mm_set1_ps(value); }
+		inline Float4 Load(const float* data) { return _mm_loadu_ps(data); }
+		inline void Store(float* data, Float4 v) { _mm_storeu_ps(data, v); }
+		inline float GetX(Float4 v) { return _mm_cvtss_f32(v); }
+
+		inline Float4 Add(Float4 a, Float4 b) { return _mm_add_ps(a, b); }
+		inline Float4 Sub(Float4 a, Float4 b) { return _mm_sub_ps(a, b); }
+		inline Float4 Mul(Float4 a, Float4 b) { return _mm_mul_ps(a, b); }
+		inline Float4 Div(Float4 a, Float4 b) { return _mm_div_ps(a, b); }
+		inline Float4 Sqrt(Float4 v) { return _mm_sqrt_ps(v); }
+
+		// products summed as ((x + y) + z) + w, returned in every lane
+		inline Float4 Dot4(Float4 a, Float4 b)
+		{
+			const Float4 m = _mm_mul_ps(a, b);
+			Float4 sum = _mm_add_ss(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 1, 1, 1)));
+			sum = _mm_add_ss(sum, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 2, 2, 2)));
+			sum = _mm_add_ss(sum, _mm_shuffle_ps(m, m, _MM_SHUFFLE(3, 3, 3, 3)));
+			return _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(0, 0, 0, 0));
+		}
+
+		// pairwise sum (x + z) + (y + w), shorter dependency chain but the rounding differs from the scalar code
+		inline Float4 Dot4Fast(Float4 a, Float4 b)
+		{
+			const Float4 m = _mm_mul_ps(a, b);
+			const Float4 pairs = _mm_add_ps(m, _mm_movehl_ps(m, m));
+			return _mm_add_ps(_mm_shuffle_ps(pairs, pairs, _MM_SHUFFLE(0, 0, 0, 0)),
+							  _mm_shuffle_ps(pairs, pairs, _MM_SHUFFLE(1, 1, 1, 1)));
+		}
+
+		// xyz cross product, w ends up as 0
+		inline Float4 Cross3(Float4 a, Float4 b)
+		{
+			const Float4 aYZX = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+			const Float4 bYZX = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+			const Float4 c = _mm_sub_ps(_mm_mul_ps(a, bYZX), _mm_mul_ps(aYZX, b));
+			return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+		}
+
+		// rsqrt estimate (12 bits) refined with one Newton-Raphson step, ~22 bits
+		inline Float4 RsqrtFast(Float4 v)
+		{
+			const Float4 estimate = _mm_rsqrt_ps(v);
+			const Float4 muls = _mm_mul_ps(_mm_mul_ps(v, estimate), estimate);
+			return _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), estimate), _mm_sub_ps(_mm_set1_ps(3.f), muls));
+		}
+
+		inline Float4 SetW(Float4 v, float w)
+		{
+			const Float4 zw = _mm_unpackhi_ps(v, _mm_set1_ps(w)); // z, new w, old w, new w
+			return _mm_shuffle_ps(v, zw, _MM_SHUFFLE(1, 0, 1, 0));
+		}
+		// lane order x, y, z, w, _MM_SHUFFLE wants it backwards
+		template <int X, int Y, int Z, int W>
+		inline Float4 Swizzle(Float4 v)
+		{
+			return _mm_shuffle_ps(v, v, _MM_SHUFFLE(W, Z, Y, X));
+		}
+
+		// a * b + c, a single rounding when the build targets FMA
+		inline Float4 MulAdd(Float4 a, Float4 b, Float4 c)
+		{
+#if defined(__FMA__) || defined(__AVX2__)
+			return _mm_fmadd_ps(a, b, c);
+#else
+			return _mm_add_ps(_mm_mul_ps(a, b), c);
+#endif
+		}
+
+		// magnitude of the first argument with the sign bits of the second
+		inline Float4 CopySign(Float4 magnitude, Float4 sign)
+		{
+			const Float4 mask = _mm_set1_ps(-0.f);
+			return _mm_or_ps(_mm_andnot_ps(mask, magnitude), _mm_and_ps(mask, sign));
+		}
+
+		// rows to columns, four xyzw values become the x, y, z and w of four objects
+		inline void Transpose4(Float4& a, Float4& b, Float4& c, Float4& d) { _MM_TRANSPOSE4_PS(a, b, c, d); }
+#elif defined(CORE_SIMD_NEON)
+		typedef float32x4_t Float4;
+
+		inline Float4 Zero() { return vdupq_n_f32(0.f); }
+		inline Float4 Set(float x, float y, float z, float w)
+		{
+			const float data[4] = { x, y, z, w };
+			return vld1q_f32(data);
+		}
+		inline Float4 Splat(float value) { return vdupq_n_f32(value); }
+		inline Float4 Load(const float* data) { return vld1q_f32(data); }
+		inline void Store(float* data, Float4 v) { vst1q_f32(data, v); }
+		inline float GetX(Float4 v) { return vgetq_lane_f32(v, 0); }
+
+		inline Float4 Add(Float4 a, Float4 b) { return vaddq_f32(a, b); }
+		inline Float4 Sub(Float4 a, Float4 b) { return vsubq_f32(a, b); }
+		inline Float4 Mul(Float4 a, Float4 b) { return vmulq_f32(a, b); }
+		inline Float4 Div(Float4 a, Float4 b) { return vdivq_f32(a, b); }
+		inline Float4 Sqrt(Float4 v) { return vsqrtq_f32(v); }
+
+		inline Float4 Dot4(Float4 a, Float4 b)
+		{
+			const Float4 m = vmulq_f32(a, b);
+			const float sum = ((vgetq_lane_f32(m, 0) + vgetq_lane_f32(m, 1)) + vgetq_lane_f32(m, 2)) + vgetq_lane_f32(m, 3);
+			return vdupq_n_f32(sum);
+		}
+
+		inline Float4 Dot4Fast(Float4 a, Float4 b) { return vdupq_n_f32(vaddvq_f32(vmulq_f32(a, b))); }
+
+		inline Float4 Cross3(Float4 a, Float4 b)
+		{
+			// NEON has no cheap yzx swizzle, going through memory is as fast as the lane juggling
+			float l[4], r[4];
+			vst1q_f32(l, a);
+			vst1q_f32(r, b);
+			return Set(l[1] * r[2] - l[2] * r[1], l[2] * r[0] - l[0] * r[2], l[0] * r[1] - l[1] * r[0], 0.f);
+		}
+
+		inline Float4 RsqrtFast(Float4 v)
+		{
+			// the NEON estimate is only 8 bits, two steps to get close to the SSE version
+			Float4 estimate = vrsqrteq_f32(v);
+			estimate = vmulq_f32(estimate, vrsqrtsq_f32(vmulq_f32(v, estimate), estimate));
+			return vmulq_f32(estimate, vrsqrtsq_f32(vmulq_f32(v, estimate), estimate));
+		}
+
+		inline Float4 SetW(Float4 v, float w) { return vsetq_lane_f32(w, v, 3); }
+		template <int X, int Y, int Z, int W>
+		inline Float4 Swizzle(Float4 v)
+		{
+			return Set(vgetq_lane_f32(v, X), vgetq_lane_f32(v, Y), vgetq_lane_f32(v, Z), vgetq_lane_f32(v, W));
+		}
+
+		inline Float4 MulAdd(Float4 a, Float4 b, Float4 c) { return vfmaq_f32(c, a, b); }
+
+		inline Float4 CopySign(Float4 magnitude, Float4 sign)
+		{
+			return vbslq_f32(vdupq_n_u32(0x80000000u), sign, magnitude);
+		}
+
+		inline void Transpose4(Float4& a, Float4& b, Float4& c, Float4& d)
+		{
+			const Float4 t0 = vzip1q_f32(a, c);
+			const Float4 t1 = vzip2q_f32(a, c);
+			const Float4 t2 = vzip1q_f32(b, d);
+			const Float4 t3 = vzip2q_f32(b, d);
+			a = vzip1q_f32(t0, t2);
+			b = vzip2q_f32(t0, t2);
+			c = vzip1q_f32(t1, t3);
+			d = vzip2q_f32(t1, t3);
+		}
+#endif
+	}; // namespace Simd
+}; // namespace Core
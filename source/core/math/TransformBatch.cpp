@@ -0,0 +1,218 @@
+#include "TransformBatch.h"
+#include "TransformBatchKernels.h"
+#include "core/utilities/Cpu.h"
+#include "logger/Debug.h"
+
+namespace Core
+{
+	namespace TransformKernels
+	{
+		namespace
+		{
+			struct ScalarLanes
+			{
+				typedef float Type;
+				static constexpr uint32 Width = 1;
+
+				static Type Load(const float* data) { return *data; }
+				static Type Splat(float value) { return value; }
+				static Type Add(Type a, Type b) { return a + b; }
+				static Type Sub(Type a, Type b) { return a - b; }
+				static Type Mul(Type a, Type b) { return a * b; }
+				static Type MulAdd(Type a, Type b, Type c) { return a * b + c; }
+
+				static void Store(const Type (&m)[16], float* out)
+				{
+					for(int i = 0; i < 16; ++i)
+						out[i] = m[i];
+				}
+			};
+		}; // namespace
+
+		void ComposeScalar(const Streams& streams, uint32 begin, uint32 end, const float* viewProjection, float* world,
+						   float* worldViewProjection)
+		{
+			Compose<ScalarLanes>(streams, begin, end, viewProjection, world, worldViewProjection);
+		}
+
+	}; // namespace TransformKernels
+
+	TransformBatch::TransformBatch()
+		: m_Path(GetBestPath())
+	{
+	}
+
+	TransformBatch::TransformBatch(uint32 capacity, IAllocator* allocator)
+		: m_PositionX(capacity, allocator)
+		, m_PositionY(capacity, allocator)
+		, m_PositionZ(capacity, allocator)
+		, m_RotationX(capacity, allocator)
+		, m_RotationY(capacity, allocator)
+		, m_RotationZ(capacity, allocator)
+		, m_RotationW(capacity, allocator)
+		, m_ScaleX(capacity, allocator)
+		, m_ScaleY(capacity, allocator)
+		, m_ScaleZ(capacity, allocator)
+		, m_Path(GetBestPath())
+	{
+	}
+
+	uint32 TransformBatch::Add(const Vector4f& position, const Quaternion& rotation, const Vector4f& scale)
+	{
+		const uint32 index = Size();
+		m_PositionX.Add(position.x);
+		m_PositionY.Add(position.y);
+		m_PositionZ.Add(position.z);
+		m_RotationX.Add(rotation.x);
+		m_RotationY.Add(rotation.y);
+		m_RotationZ.Add(rotation.z);
+		m_RotationW.Add(rotation.w);
+		m_ScaleX.Add(scale.x);
+		m_ScaleY.Add(scale.y);
+		m_ScaleZ.Add(scale.z);
+		return index;
+	}
+
+	void TransformBatch::RemoveCyclicAtIndex(uint32 index)
+	{
+		m_PositionX.RemoveCyclicAtIndex(index);
+		m_PositionY.RemoveCyclicAtIndex(index);
+		m_PositionZ.RemoveCyclicAtIndex(index);
+		m_RotationX.RemoveCyclicAtIndex(index);
+		m_RotationY.RemoveCyclicAtIndex(index);
+		m_RotationZ.RemoveCyclicAtIndex(index);
+		m_RotationW.RemoveCyclicAtIndex(index);
+		m_ScaleX.RemoveCyclicAtIndex(index);
+		m_ScaleY.RemoveCyclicAtIndex(index);
+		m_ScaleZ.RemoveCyclicAtIndex(index);
+	}
+
+	void TransformBatch::Clear()
+	{
+		m_PositionX.Clear();
+		m_PositionY.Clear();
+		m_PositionZ.Clear();
+		m_RotationX.Clear();
+		m_RotationY.Clear();
+		m_RotationZ.Clear();
+		m_RotationW.Clear();
+		m_ScaleX.Clear();
+		m_ScaleY.Clear();
+		m_ScaleZ.Clear();
+	}
+
+	void TransformBatch::SetPosition(uint32 index, const Vector4f& position)
+	{
+		m_PositionX[index] = position.x;
+		m_PositionY[index] = position.y;
+		m_PositionZ[index] = position.z;
+	}
+
+	void TransformBatch::SetRotation(uint32 index, const Quaternion& rotation)
+	{
+		m_RotationX[index] = rotation.x;
+		m_RotationY[index] = rotation.y;
+		m_RotationZ[index] = rotation.z;
+		m_RotationW[index] = rotation.w;
+	}
+
+	void TransformBatch::SetScale(uint32 index, const Vector4f& scale)
+	{
+		m_ScaleX[index] = scale.x;
+		m_ScaleY[index] = scale.y;
+		m_ScaleZ[index] = scale.z;
+	}
+
+	Vector4f TransformBatch::GetPosition(uint32 index) const
+	{
+		return { m_PositionX[index], m_PositionY[index], m_PositionZ[index], 1.f };
+	}
+
+	Quaternion TransformBatch::GetRotation(uint32 index) const
+	{
+		return { m_RotationX[index], m_RotationY[index], m_RotationZ[index], m_RotationW[index] };
+	}
+
+	Vector4f TransformBatch::GetScale(uint32 index) const
+	{
+		return { m_ScaleX[index], m_ScaleY[index], m_ScaleZ[index], 0.f };
+	}
+
+	void TransformBatch::ComposeWorld(Matrix44f* world) const
+	{
+		ASSERT(world != nullptr, "TransformBatch needs somewhere to write the matrices");
+		Compose(nullptr, &(*world)[0], nullptr);
+	}
+
+	void TransformBatch::ComposeWorldViewProjection(const Matrix44f& viewProjection, Matrix44f* world,
+													Matrix44f* worldViewProjection) const
+	{
+		ASSERT(worldViewProjection != nullptr, "TransformBatch needs somewhere to write the matrices");
+		Compose(&viewProjection[0], world ? &(*world)[0] : nullptr, &(*worldViewProjection)[0]);
+	}
+
+	void TransformBatch::Compose(const float* viewProjection, float* world, float* worldViewProjection) const
+	{
+		const TransformKernels::Streams streams = {
+			m_PositionX.GetData(), m_PositionY.GetData(), m_PositionZ.GetData(), m_RotationX.GetData(),
+			m_RotationY.GetData(), m_RotationZ.GetData(), m_RotationW.GetData(), m_ScaleX.GetData(),
+			m_ScaleY.GetData(),	   m_ScaleZ.GetData(),
+		};
+
+		const uint32 count = Size();
+		uint32 done = 0;
+#if defined(CORE_TRANSFORM_BATCH_X86)
+		if(m_Path == Path::AVX2)
+			done = TransformKernels::ComposeAvx2(streams, count, viewProjection, world, worldViewProjection);
+		else if(m_Path == Path::SSE)
+			done = TransformKernels::ComposeSse(streams, count, viewProjection, world, worldViewProjection);
+#endif
+		TransformKernels::ComposeScalar(streams, done, count, viewProjection, world, worldViewProjection);
+	}
+
+	void TransformBatch::SetPath(Path path)
+	{
+		ASSERT(IsSupported(path), "This CPU can't run the requested TransformBatch path");
+		m_Path = path;
+	}
+
+	bool TransformBatch::IsSupported(Path path)
+	{
+		switch(path)
+		{
+			case Path::Scalar:
+				return true;
+#if defined(CORE_TRANSFORM_BATCH_X86)
+			case Path::SSE:
+				return true; // part of x64
+			case Path::AVX2:
+				return GetCpuFeatures().m_AVX2 && GetCpuFeatures().m_FMA;
+#endif
+			default:
+				return false;
+		}
+	}
+
+	TransformBatch::Path TransformBatch::GetBestPath()
+	{
+		static const Path best = IsSupported(Path::AVX2) ? Path::AVX2
+								 : IsSupported(Path::SSE) ? Path::SSE
+														  : Path::Scalar;
+		return best;
+	}
+
+	const char* TransformBatch::GetPathName(Path path)
+	{
+		switch(path)
+		{
+			case Path::Scalar:
+				return "Scalar";
+			case Path::SSE:
+				return "SSE";
+			case Path::AVX2:
+				return "AVX2";
+		}
+		return "Unknown";
+	}
+
+}; // namespace Core
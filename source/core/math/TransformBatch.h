@@ -0,0 +1,78 @@
+#pragma once
+#include "core/Types.h"
+#include "core/containers/GrowingArray.h"
+#include "Matrix44.h"
+#include "Quaternion.h"
+#include "Vector4.h"
+
+namespace Core
+{
+	/*
+		Position, rotation and scale for many objects stored as separate float streams (SoA), so the compose kernels
+		can work on 4 (SSE) or 8 (AVX2) objects per instruction. Rotations are expected to be unit quaternions.
+		The widest path the CPU supports is picked at runtime, SetPath is there for tests and benchmarks.
+		Objects are stored densely, RemoveCyclicAtIndex moves the last object into the hole like GrowingArray does.
+	*/
+	class TransformBatch
+	{
+	public:
+		enum class Path : uint8
+		{
+			Scalar,
+			SSE,
+			AVX2,
+		};
+
+		TransformBatch();
+		// the streams come from allocator, see GrowingArray
+		TransformBatch(uint32 capacity, IAllocator* allocator = nullptr);
+
+		uint32 Add(const Vector4f& position, const Quaternion& rotation, const Vector4f& scale);
+		void RemoveCyclicAtIndex(uint32 index);
+		void Clear();
+
+		void SetPosition(uint32 index, const Vector4f& position);
+		void SetRotation(uint32 index, const Quaternion& rotation);
+		void SetScale(uint32 index, const Vector4f& scale);
+
+		Vector4f GetPosition(uint32 index) const;
+		Quaternion GetRotation(uint32 index) const;
+		Vector4f GetScale(uint32 index) const;
+
+		uint32 Size() const { return m_PositionX.Size(); }
+
+		// world[i] = scale * rotation * translation for every object, row major like Matrix44f.
+		void ComposeWorld(Matrix44f* world) const;
+
+		/*
+			worldViewProjection[i] = world[i] followed by viewProjection, the same as viewProjection * world[i] with
+			the Matrix44f operator and what the vertex shader gets from mul(mul(pos, world), viewProj).
+			world can be nullptr when only the combined matrices are needed.
+		*/
+		void ComposeWorldViewProjection(const Matrix44f& viewProjection, Matrix44f* world,
+										Matrix44f* worldViewProjection) const;
+
+		void SetPath(Path path);
+		Path GetPath() const { return m_Path; }
+
+		static bool IsSupported(Path path);
+		static Path GetBestPath();
+		static const char* GetPathName(Path path);
+
+	private:
+		void Compose(const float* viewProjection, float* world, float* worldViewProjection) const;
+
+		GrowingArray<float> m_PositionX;
+		GrowingArray<float> m_PositionY;
+		GrowingArray<float> m_PositionZ;
+		GrowingArray<float> m_RotationX;
+		GrowingArray<float> m_RotationY;
+		GrowingArray<float> m_RotationZ;
+		GrowingArray<float> m_RotationW;
+		GrowingArray<float> m_ScaleX;
+		GrowingArray<float> m_ScaleY;
+		GrowingArray<float> m_ScaleZ;
+		Path m_Path = Path::Scalar;
+	};
+
+}; // namespace Core
@@ -0,0 +1,83 @@
+/*
+	Built for AVX2 + FMA no matter what the rest of the project targets, only called once GetCpuFeatures says the
+	CPU has both. MSVC hands out the intrinsics without any switch, GCC and clang need the target pragma.
+*/
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2,fma"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+#endif
+
+#include "TransformBatchKernels.h"
+
+#if defined(CORE_TRANSFORM_BATCH_X86)
+#include <immintrin.h>
+
+namespace Core
+{
+	namespace TransformKernels
+	{
+		namespace
+		{
+			struct Avx2Lanes
+			{
+				typedef __m256 Type;
+				static constexpr uint32 Width = 8;
+
+				static Type Load(const float* data) { return _mm256_loadu_ps(data); }
+				static Type Splat(float value) { return _mm256_set1_ps(value); }
+				static Type Add(Type a, Type b) { return _mm256_add_ps(a, b); }
+				static Type Sub(Type a, Type b) { return _mm256_sub_ps(a, b); }
+				static Type Mul(Type a, Type b) { return _mm256_mul_ps(a, b); }
+				static Type MulAdd(Type a, Type b, Type c) { return _mm256_fmadd_ps(a, b, c); }
+
+				/*
+					element registers to 8 row major matrices. The unpack / shuffle pair transposes 4x4 inside each
+					128 bit half, the low halves are objects 0-3 and the high halves objects 4-7.
+				*/
+				static void Store(const Type (&m)[16], float* out)
+				{
+					for(int row = 0; row < 4; ++row)
+					{
+						const __m256 t0 = _mm256_unpacklo_ps(m[row * 4 + 0], m[row * 4 + 1]);
+						const __m256 t1 = _mm256_unpackhi_ps(m[row * 4 + 0], m[row * 4 + 1]);
+						const __m256 t2 = _mm256_unpacklo_ps(m[row * 4 + 2], m[row * 4 + 3]);
+						const __m256 t3 = _mm256_unpackhi_ps(m[row * 4 + 2], m[row * 4 + 3]);
+						const __m256 r0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+						const __m256 r1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+						const __m256 r2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+						const __m256 r3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+
+						float* target = out + row * 4;
+						_mm_storeu_ps(target + 0 * 16, _mm256_castps256_ps128(r0));
+						_mm_storeu_ps(target + 1 * 16, _mm256_castps256_ps128(r1));
+						_mm_storeu_ps(target + 2 * 16, _mm256_castps256_ps128(r2));
+						_mm_storeu_ps(target + 3 * 16, _mm256_castps256_ps128(r3));
+						_mm_storeu_ps(target + 4 * 16, _mm256_extractf128_ps(r0, 1));
+						_mm_storeu_ps(target + 5 * 16, _mm256_extractf128_ps(r1, 1));
+						_mm_storeu_ps(target + 6 * 16, _mm256_extractf128_ps(r2, 1));
+						_mm_storeu_ps(target + 7 * 16, _mm256_extractf128_ps(r3, 1));
+					}
+				}
+			};
+		}; // namespace
+
+		uint32 ComposeAvx2(const Streams& streams, uint32 count, const float* viewProjection, float* world,
+						   float* worldViewProjection)
+		{
+			const uint32 done = Compose<Avx2Lanes>(streams, 0, count, viewProjection, world, worldViewProjection);
+			// clear the upper ymm halves before going back to SSE code
+			_mm256_zeroupper();
+			return done;
+		}
+
+	}; // namespace TransformKernels
+}; // namespace Core
+#endif
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
@@ -0,0 +1,128 @@
+#pragma once
+#include "core/Types.h"
+
+/*
+	Internal to TransformBatch. The compose kernel is written once against a small lanes interface (Load, Splat,
+	Add, Sub, Mul, MulAdd and a transposing Store) and compiled in one translation unit per instruction set.
+	TransformBatchAvx2.cpp is the only file built for AVX2 and it only sees raw floats, an inline Matrix44f
+	function compiled there could otherwise be the copy the linker keeps for the whole program. The kernel is in
+	an unnamed namespace for the same reason.
+*/
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define CORE_TRANSFORM_BATCH_X86 1
+#endif
+
+namespace Core
+{
+	namespace TransformKernels
+	{
+		struct Streams
+		{
+			const float* m_PositionX;
+			const float* m_PositionY;
+			const float* m_PositionZ;
+			const float* m_RotationX;
+			const float* m_RotationY;
+			const float* m_RotationZ;
+			const float* m_RotationW;
+			const float* m_ScaleX;
+			const float* m_ScaleY;
+			const float* m_ScaleZ;
+		};
+
+		/*
+			world and worldViewProjection point at 16 floats per object and either may be nullptr. The wide kernels
+			return the index they stopped at, what is left is less than a register and goes through ComposeScalar.
+		*/
+		void ComposeScalar(const Streams& streams, uint32 begin, uint32 end, const float* viewProjection, float* world,
+						   float* worldViewProjection);
+#if defined(CORE_TRANSFORM_BATCH_X86)
+		uint32 ComposeSse(const Streams& streams, uint32 count, const float* viewProjection, float* world,
+						  float* worldViewProjection);
+		uint32 ComposeAvx2(const Streams& streams, uint32 count, const float* viewProjection, float* world,
+						   float* worldViewProjection);
+#endif
+
+		namespace
+		{
+			// one object per lane, m[row * 4 + column] holds that element for every lane
+			template <typename Lanes>
+			uint32 Compose(const Streams& s, uint32 begin, uint32 end, const float* viewProjection, float* world,
+						   float* worldViewProjection)
+			{
+				typedef typename Lanes::Type Lane;
+				const Lane one = Lanes::Splat(1.f);
+				const Lane zero = Lanes::Splat(0.f);
+
+				uint32 i = begin;
+				for(; i + Lanes::Width <= end; i += Lanes::Width)
+				{
+					const Lane qx = Lanes::Load(s.m_RotationX + i);
+					const Lane qy = Lanes::Load(s.m_RotationY + i);
+					const Lane qz = Lanes::Load(s.m_RotationZ + i);
+					const Lane qw = Lanes::Load(s.m_RotationW + i);
+
+					const Lane x2 = Lanes::Add(qx, qx);
+					const Lane y2 = Lanes::Add(qy, qy);
+					const Lane z2 = Lanes::Add(qz, qz);
+					const Lane xx = Lanes::Mul(qx, x2);
+					const Lane yy = Lanes::Mul(qy, y2);
+					const Lane zz = Lanes::Mul(qz, z2);
+					const Lane xy = Lanes::Mul(qx, y2);
+					const Lane xz = Lanes::Mul(qx, z2);
+					const Lane yz = Lanes::Mul(qy, z2);
+					const Lane wx = Lanes::Mul(qw, x2);
+					const Lane wy = Lanes::Mul(qw, y2);
+					const Lane wz = Lanes::Mul(qw, z2);
+
+					const Lane sx = Lanes::Load(s.m_ScaleX + i);
+					const Lane sy = Lanes::Load(s.m_ScaleY + i);
+					const Lane sz = Lanes::Load(s.m_ScaleZ + i);
+
+					Lane m[16];
+					m[0] = Lanes::Mul(Lanes::Sub(one, Lanes::Add(yy, zz)), sx);
+					m[1] = Lanes::Mul(Lanes::Add(xy, wz), sx);
+					m[2] = Lanes::Mul(Lanes::Sub(xz, wy), sx);
+					m[3] = zero;
+					m[4] = Lanes::Mul(Lanes::Sub(xy, wz), sy);
+					m[5] = Lanes::Mul(Lanes::Sub(one, Lanes::Add(xx, zz)), sy);
+					m[6] = Lanes::Mul(Lanes::Add(yz, wx), sy);
+					m[7] = zero;
+					m[8] = Lanes::Mul(Lanes::Add(xz, wy), sz);
+					m[9] = Lanes::Mul(Lanes::Sub(yz, wx), sz);
+					m[10] = Lanes::Mul(Lanes::Sub(one, Lanes::Add(xx, yy)), sz);
+					m[11] = zero;
+					m[12] = Lanes::Load(s.m_PositionX + i);
+					m[13] = Lanes::Load(s.m_PositionY + i);
+					m[14] = Lanes::Load(s.m_PositionZ + i);
+					m[15] = one;
+
+					if(world)
+						Lanes::Store(m, world + i * 16);
+
+					if(worldViewProjection)
+					{
+						// the w column of the world matrix is (0, 0, 0, 1), only the last row picks up row 3
+						Lane r[16];
+						for(int row = 0; row < 4; ++row)
+						{
+							for(int column = 0; column < 4; ++column)
+							{
+								Lane sum = Lanes::Mul(m[row * 4 + 0], Lanes::Splat(viewProjection[column]));
+								sum = Lanes::MulAdd(m[row * 4 + 1], Lanes::Splat(viewProjection[4 + column]), sum);
+								sum = Lanes::MulAdd(m[row * 4 + 2], Lanes::Splat(viewProjection[8 + column]), sum);
+								if(row == 3)
+									sum = Lanes::Add(sum, Lanes::Splat(viewProjection[12 + column]));
+								r[row * 4 + column] = sum;
+							}
+						}
+						Lanes::Store(r, worldViewProjection + i * 16);
+					}
+				}
+				return i;
+			}
+		}; // namespace
+
+	}; // namespace TransformKernels
+}; // namespace Core
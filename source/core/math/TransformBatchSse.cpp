@@ -0,0 +1,51 @@
+#include "TransformBatchKernels.h"
+
+#if defined(CORE_TRANSFORM_BATCH_X86)
+#include <xmmintrin.h>
+
+namespace Core
+{
+	namespace TransformKernels
+	{
+		namespace
+		{
+			struct SseLanes
+			{
+				typedef __m128 Type;
+				static constexpr uint32 Width = 4;
+
+				static Type Load(const float* data) { return _mm_loadu_ps(data); }
+				static Type Splat(float value) { return _mm_set1_ps(value); }
+				static Type Add(Type a, Type b) { return _mm_add_ps(a, b); }
+				static Type Sub(Type a, Type b) { return _mm_sub_ps(a, b); }
+				static Type Mul(Type a, Type b) { return _mm_mul_ps(a, b); }
+				static Type MulAdd(Type a, Type b, Type c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+
+				// element registers to 4 row major matrices, one 4x4 transpose per row
+				static void Store(const Type (&m)[16], float* out)
+				{
+					for(int row = 0; row < 4; ++row)
+					{
+						Type a = m[row * 4 + 0];
+						Type b = m[row * 4 + 1];
+						Type c = m[row * 4 + 2];
+						Type d = m[row * 4 + 3];
+						_MM_TRANSPOSE4_PS(a, b, c, d);
+						_mm_storeu_ps(out + 0 * 16 + row * 4, a);
+						_mm_storeu_ps(out + 1 * 16 + row * 4, b);
+						_mm_storeu_ps(out + 2 * 16 + row * 4, c);
+						_mm_storeu_ps(out + 3 * 16 + row * 4, d);
+					}
+				}
+			};
+		}; // namespace
+
+		uint32 ComposeSse(const Streams& streams, uint32 count, const float* viewProjection, float* world,
+						  float* worldViewProjection)
+		{
+			return Compose<SseLanes>(streams, 0, count, viewProjection, world, worldViewProjection);
+		}
+
+	}; // namespace TransformKernels
+}; // namespace Core
+#endif
@@ -1,5 +1,8 @@
 #pragma once
+#include "Simd.h"
+
 #include <cassert>
+#include <math.h>
 
 namespace Core
 {
@@ -119,6 +122,108 @@ namespace Core
 		}
 	};
 
+	/*
+		float version kept in a SIMD register. Same interface and memory layout as the generic template, the operations
+		produce the same bits as the scalar code apart from FastNormalize which trades accuracy for speed.
+	*/
+	template <>
+	class Vector4<float>
+	{
+	public:
+		Vector4() {}
+		~Vector4() = default;
+
+		constexpr Vector4( float x_, float y_, float z_, float w_ = 1 )
+			: x( x_ )
+			, y( y_ )
+			, z( z_ )
+			, w( w_ )
+		{
+		}
+
+		Vector4( const float vec[4] )
+			: simd( Simd::Load( vec ) )
+		{
+		}
+
+		Vector4( Simd::Float4 simd_ )
+			: simd( simd_ )
+		{
+		}
+
+		union {
+			struct
+			{
+				float x;
+				float y;
+				float z;
+				float w;
+			};
+			float vector[4]{ 0, 0, 0, 0 };
+			Simd::Float4 simd;
+		};
+
+		float Length() const
+		{
+			return Simd::GetX( Simd::Sqrt( Simd::Dot4( simd, simd ) ) );
+		};
+
+		float Length2() const
+		{
+			return Simd::GetX( Simd::Dot4( simd, simd ) );
+		};
+
+		Vector4<float>& operator+=( const Vector4<float>& vec )
+		{
+			simd = Simd::Add( simd, vec.simd );
+			return *this;
+		}
+
+		Vector4<float>& operator-=( const Vector4<float>& vec )
+		{
+			simd = Simd::Sub( simd, vec.simd );
+			return *this;
+		}
+
+		Vector4<float>& operator*=( const Vector4<float>& vec )
+		{
+			simd = Simd::Mul( simd, vec.simd );
+			return *this;
+		}
+
+		Vector4<float>& operator/=( const Vector4<float>& vec )
+		{
+			assert( vec.x != 0 && vec.y != 0 && vec.z != 0 && vec.w != 0 && "Can't divide by Zero" );
+			simd = Simd::Div( simd, vec.simd );
+			return *this;
+		}
+
+		Vector4<float>& operator+=( const float scale )
+		{
+			simd = Simd::Add( simd, Simd::Splat( scale ) );
+			return *this;
+		}
+
+		Vector4<float>& operator-=( const float scale )
+		{
+			simd = Simd::Sub( simd, Simd::Splat( scale ) );
+			return *this;
+		}
+
+		Vector4<float>& operator*=( const float scale )
+		{
+			simd = Simd::Mul( simd, Simd::Splat( scale ) );
+			return *this;
+		}
+
+		Vector4<float>& operator/=( const float scale )
+		{
+			assert( scale != 0 && "Can't divide by Zero" );
+			simd = Simd::Div( simd, Simd::Splat( scale ) );
+			return *this;
+		}
+	};
+
 	template <typename T>
 	Vector4<T> operator+( const Vector4<T>& first, const Vector4<T>& second )
 	{
@@ -193,5 +298,79 @@ namespace Core
 		return { ( first.y * second.z ) - ( first.z * second.y ), ( first.z * second.x ) - ( first.x * second.z ), ( first.x * second.y ) - ( first.y * second.x ), 1 };
 	}
 
+	inline Vector4<float> operator+( const Vector4<float>& first, const Vector4<float>& second )
+	{
+		return Simd::Add( first.simd, second.simd );
+	}
+
+	inline Vector4<float> operator-( const Vector4<float>& first, const Vector4<float>& second )
+	{
+		return Simd::Sub( first.simd, second.simd );
+	}
+
+	inline Vector4<float> operator*( const Vector4<float>& first, const Vector4<float>& second )
+	{
+		return Simd::Mul( first.simd, second.simd );
+	}
+
+	inline Vector4<float> operator/( const Vector4<float>& first, const Vector4<float>& second )
+	{
+		assert( second.x != 0 && second.y != 0 && second.z != 0 && second.w != 0 && "Can't divide by Zero" );
+		return Simd::Div( first.simd, second.simd );
+	}
+
+	inline Vector4<float> operator+( const Vector4<float>& vector, const float scale )
+	{
+		return Simd::Add( vector.simd, Simd::Splat( scale ) );
+	}
+
+	inline Vector4<float> operator-( const Vector4<float>& vector, const float scale )
+	{
+		return Simd::Sub( vector.simd, Simd::Splat( scale ) );
+	}
+
+	inline Vector4<float> operator*( const Vector4<float>& vector, const float scale )
+	{
+		return Simd::Mul( vector.simd, Simd::Splat( scale ) );
+	}
+
+	inline Vector4<float> operator/( const Vector4<float>& vector, const float scale )
+	{
+		assert( scale != 0 && "Can't divide by Zero" );
+		return Simd::Div( vector.simd, Simd::Splat( scale ) );
+	}
+
+	inline float Dot( const Vector4<float>& first, const Vector4<float>& second )
+	{
+		return Simd::GetX( Simd::Dot4( first.simd, second.simd ) );
+	}
+
+	// w is set to 1 like the generic version
+	inline const Vector4<float> Cross( const Vector4<float>& first, const Vector4<float>& second )
+	{
+		return Simd::SetW( Simd::Cross3( first.simd, second.simd ), 1.f );
+	}
+
+	inline const Vector4<float> GetNormalized( const Vector4<float>& vec )
+	{
+		return Simd::Div( vec.simd, Simd::Sqrt( Simd::Dot4( vec.simd, vec.simd ) ) );
+	}
+
+	inline void Normalize( Vector4<float>& vec )
+	{
+		vec = GetNormalized( vec );
+	}
+
+	// Multiplies by an approximate reciprocal square root, relative error is around 1e-6 and a zero vector gives NaN.
+	inline const Vector4<float> GetFastNormalized( const Vector4<float>& vec )
+	{
+		return Simd::Mul( vec.simd, Simd::RsqrtFast( Simd::Dot4Fast( vec.simd, vec.simd ) ) );
+	}
+
+	inline void FastNormalize( Vector4<float>& vec )
+	{
+		vec = GetFastNormalized( vec );
+	}
+
 	using Vector4f = Vector4<float>;
 }; // namespace Core
\ No newline at end of file
@@ -0,0 +1,59 @@
+#include "Allocator.h"
+#include "MemoryTracker.h"
+
+#include <new>
+
+namespace Core
+{
+	const char* GetMemoryTagName(MemoryTag tag)
+	{
+		switch(tag)
+		{
+			case MemoryTag::Core:
+				return "Core";
+			case MemoryTag::Graphics:
+				return "Graphics";
+			case MemoryTag::Input:
+				return "Input";
+			case MemoryTag::Logger:
+				return "Logger";
+			case MemoryTag::Game:
+				return "Game";
+			default:
+				return "Unknown";
+		}
+	}
+
+	void* HeapAllocator::Allocate(uint64 size, uint64 alignment)
+	{
+		void* data = alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__
+						 ? ::operator new(size, std::align_val_t(alignment))
+						 : ::operator new(size);
+
+		MemoryTracker::Track(m_Tag, size);
+		return data;
+	}
+
+	void HeapAllocator::Free(void* data, uint64 size, uint64 alignment)
+	{
+		if(!data)
+			return;
+
+		MemoryTracker::Untrack(m_Tag, size);
+		if(alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+			::operator delete(data, std::align_val_t(alignment));
+		else
+			::operator delete(data);
+	}
+
+	IAllocator* GetAllocator(MemoryTag tag)
+	{
+		static HeapAllocator allocators[] = { HeapAllocator(MemoryTag::Core), HeapAllocator(MemoryTag::Graphics),
+											  HeapAllocator(MemoryTag::Input), HeapAllocator(MemoryTag::Logger),
+											  HeapAllocator(MemoryTag::Game) };
+		static_assert(sizeof(allocators) / sizeof(allocators[0]) == (uint32)MemoryTag::Count,
+					  "Every MemoryTag needs an allocator");
+		return &allocators[(uint32)tag];
+	}
+
+}; // namespace Core
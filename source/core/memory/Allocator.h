@@ -0,0 +1,73 @@
+#pragma once
+#include "core/Types.h"
+
+#include <new>
+#include <utility>
+
+namespace Core
+{
+	// Which module an allocation is charged to in the MemoryTracker
+	enum class MemoryTag : uint8
+	{
+		Core,
+		Graphics,
+		Input,
+		Logger,
+		Game,
+		Count
+	};
+
+	const char* GetMemoryTagName(MemoryTag tag);
+
+	/*
+		Minimal allocator interface the containers can be handed. Free gets the size and alignment back so allocators do
+		not have to keep headers in front of every block.
+	*/
+	class IAllocator
+	{
+	public:
+		virtual ~IAllocator() = default;
+
+		virtual void* Allocate(uint64 size, uint64 alignment) = 0;
+		virtual void Free(void* data, uint64 size, uint64 alignment) = 0;
+	};
+
+	// General heap, every byte is reported to the MemoryTracker under m_Tag
+	class HeapAllocator : public IAllocator
+	{
+	public:
+		HeapAllocator(MemoryTag tag)
+			: m_Tag(tag)
+		{
+		}
+
+		void* Allocate(uint64 size, uint64 alignment) override;
+		void Free(void* data, uint64 size, uint64 alignment) override;
+
+		MemoryTag GetTag() const { return m_Tag; }
+
+	private:
+		MemoryTag m_Tag = MemoryTag::Core;
+	};
+
+	// Shared heap allocator for a module, lives for the whole program
+	IAllocator* GetAllocator(MemoryTag tag);
+
+	// new / delete through the allocator of a module. Delete has to get the exact type that was created, not a base.
+	template <typename T, typename... Args>
+	T* New(MemoryTag tag, Args&&... args)
+	{
+		return new(GetAllocator(tag)->Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+	}
+
+	template <typename T>
+	void Delete(MemoryTag tag, T* object)
+	{
+		if(!object)
+			return;
+
+		object->~T();
+		GetAllocator(tag)->Free(object, sizeof(T), alignof(T));
+	}
+
+}; // namespace Core
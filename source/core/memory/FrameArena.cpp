@@ -0,0 +1,61 @@
+#include "FrameArena.h"
+
+#include "logger/Debug.h"
+
+namespace Core
+{
+	constexpr uint64 s_ArenaAlignment = 64;
+
+	FrameArena::~FrameArena() { Destroy(); }
+
+	void FrameArena::Init(uint64 bytesPerFrame, IAllocator* allocator)
+	{
+		Destroy();
+
+		// keep every region cache line aligned so frames never share a line
+		m_FrameSize = (bytesPerFrame + s_ArenaAlignment - 1) & ~(s_ArenaAlignment - 1);
+		m_Allocator = allocator ? allocator : GetAllocator(MemoryTag::Core);
+		m_Memory = static_cast<int8*>(m_Allocator->Allocate(m_FrameSize * FrameCount, s_ArenaAlignment));
+		m_Offset = 0;
+		m_HighWaterMark = 0;
+		m_FrameIndex = 0;
+	}
+
+	void FrameArena::Destroy()
+	{
+		if(!m_Memory)
+			return;
+
+		m_Allocator->Free(m_Memory, m_FrameSize * FrameCount, s_ArenaAlignment);
+		m_Memory = nullptr;
+		m_Allocator = nullptr;
+		m_FrameSize = 0;
+		m_Offset = 0;
+	}
+
+	void FrameArena::BeginFrame(uint32 frameIndex)
+	{
+		ASSERT(frameIndex < FrameCount, "frameIndex is out of range for the FrameArena");
+		m_FrameIndex = frameIndex;
+		m_Offset = 0;
+	}
+
+	void* FrameArena::Alloc(uint64 size, uint64 alignment)
+	{
+		ASSERT((alignment & (alignment - 1)) == 0, "alignment has to be a power of two");
+
+		const uint64 start = (m_Offset + alignment - 1) & ~(alignment - 1);
+		if(start + size > m_FrameSize)
+		{
+			ASSERT(false, "FrameArena is out of memory for this frame, raise the budget passed to Init");
+			return nullptr;
+		}
+
+		m_Offset = start + size;
+		if(m_Offset > m_HighWaterMark)
+			m_HighWaterMark = m_Offset;
+
+		return m_Memory + (m_FrameSize * m_FrameIndex) + start;
+	}
+
+}; // namespace Core
@@ -0,0 +1,69 @@
+#pragma once
+#include "core/Types.h"
+#include "core/memory/Allocator.h"
+
+#include <new>
+#include <type_traits>
+
+namespace Core
+{
+	/*
+		Linear allocator for data that only lives for one frame. There is one region per frame in flight (matching the
+		two command buffers the renderer cycles between), BeginFrame rewinds the region for that frame so nothing is
+		ever freed one by one. Memory is taken once in Init, after that Alloc never touches the general heap.
+	*/
+	class FrameArena
+	{
+	public:
+		static constexpr uint32 FrameCount = 2;
+
+		FrameArena() = default;
+		~FrameArena();
+
+		FrameArena(const FrameArena&) = delete;
+		FrameArena& operator=(const FrameArena&) = delete;
+
+		// the regions come from allocator, or the MemoryTag::Core heap allocator without one
+		void Init(uint64 bytesPerFrame, IAllocator* allocator = nullptr);
+		void Destroy();
+
+		// Rewinds the region used by frameIndex, everything allocated the last time that frame ran is gone.
+		void BeginFrame(uint32 frameIndex);
+
+		// Returns nullptr (and asserts) when the frame budget is exhausted.
+		void* Alloc(uint64 size, uint64 alignment = 16);
+
+		// Default constructs count objects, their destructors are never run so T has to be trivially destructible.
+		template <typename T>
+		T* Alloc(uint32 count = 1);
+
+		uint64 GetUsed() const { return m_Offset; }
+		uint64 GetCapacity() const { return m_FrameSize; }
+		uint64 GetHighWaterMark() const { return m_HighWaterMark; }
+		uint32 GetFrameIndex() const { return m_FrameIndex; }
+
+	private:
+		int8* m_Memory = nullptr;
+		IAllocator* m_Allocator = nullptr; // what m_Memory came from
+		uint64 m_FrameSize = 0;
+		uint64 m_Offset = 0;
+		uint64 m_HighWaterMark = 0;
+		uint32 m_FrameIndex = 0;
+	};
+
+	template <typename T>
+	T* FrameArena::Alloc(uint32 count)
+	{
+		static_assert(std::is_trivially_destructible_v<T>, "FrameArena never runs destructors");
+
+		T* data = static_cast<T*>(Alloc(sizeof(T) * count, alignof(T)));
+		if(!data)
+			return nullptr;
+
+		for(uint32 i = 0; i < count; ++i)
+			new(&data[i]) T;
+
+		return data;
+	}
+
+}; // namespace Core
@@ -0,0 +1,279 @@
+#include "GpuMemoryAllocator.h"
+#include "logger/Debug.h"
+
+namespace Core
+{
+	namespace
+	{
+		uint32 CountBits(uint32 value)
+		{
+			uint32 count = 0;
+			for(; value != 0; value &= value - 1)
+				++count;
+			return count;
+		}
+	}; // namespace
+
+	float GpuMemoryStats::GetFragmentation() const
+	{
+		const uint64 free = GetFreeBytes();
+		if(free == 0)
+			return 0.f;
+		return 1.f - static_cast<float>(m_LargestFreeRange) / static_cast<float>(free);
+	}
+
+	GpuMemoryAllocator::~GpuMemoryAllocator()
+	{
+		if(m_Backend)
+			Destroy();
+	}
+
+	void GpuMemoryAllocator::Init(IGpuMemoryBackend* backend, const GpuMemoryProperties& properties, uint64 blockSize)
+	{
+		ASSERT(!m_Backend, "GpuMemoryAllocator is already initialized");
+		ASSERT(properties.m_TypeCount <= GpuMemoryProperties::MaxTypes, "Too many memory types");
+		ASSERT((properties.m_BufferImageGranularity > 0 &&
+				(properties.m_BufferImageGranularity & (properties.m_BufferImageGranularity - 1)) == 0),
+			   "bufferImageGranularity has to be a power of two");
+
+		m_Backend = backend;
+		m_Properties = properties;
+		m_BlockSize = blockSize;
+	}
+
+	void GpuMemoryAllocator::Destroy()
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		for(MemoryType& type : m_Types)
+		{
+			for(Block& block : type.m_Blocks)
+			{
+				if(block.m_Memory == 0)
+					continue;
+				ASSERT(block.m_Ranges.IsEmpty(), "Destroying the GpuMemoryAllocator with live allocations");
+				m_Backend->FreeBlock(block.m_Memory);
+			}
+			ASSERT(type.m_DedicatedCount == 0, "Destroying the GpuMemoryAllocator with live dedicated allocations");
+			type = MemoryType();
+		}
+		m_Backend = nullptr;
+	}
+
+	GpuAllocation GpuMemoryAllocator::Allocate(const GpuAllocationDesc& desc)
+	{
+		ASSERT(m_Backend != nullptr, "GpuMemoryAllocator is not initialized");
+		ASSERT(desc.m_Size > 0, "Allocating nothing");
+
+		uint64 size = desc.m_Size;
+		uint64 alignment = desc.m_Alignment > 0 ? desc.m_Alignment : 1;
+		if(desc.m_Resource == GpuAllocationDesc::Resource::OptimalImage)
+		{
+			// whole pages of the granularity, whatever is placed next to the image can't end up on one of them
+			const uint64 granularity = m_Properties.m_BufferImageGranularity;
+			alignment = alignment > granularity ? alignment : granularity;
+			size = (size + granularity - 1) & ~(granularity - 1);
+		}
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		uint32 typeBits = desc.m_MemoryTypeBits;
+		for(;;)
+		{
+			const int32 memoryType = FindMemoryType(typeBits, desc.m_RequiredFlags, desc.m_PreferredFlags);
+			if(memoryType < 0)
+				return GpuAllocation();
+
+			const GpuAllocation allocation = AllocateFromType(memoryType, size, alignment, desc.m_Dedicated);
+			if(allocation.IsValid())
+				return allocation;
+
+			typeBits &= ~(1u << memoryType);
+		}
+	}
+
+	void GpuMemoryAllocator::Free(const GpuAllocation& allocation)
+	{
+		if(!allocation.IsValid())
+			return;
+
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		MemoryType& type = m_Types[allocation.m_MemoryType];
+		if(allocation.IsDedicated())
+		{
+			m_Backend->FreeBlock(allocation.m_Memory);
+			--type.m_DedicatedCount;
+			type.m_DedicatedBytes -= allocation.m_Size;
+			return;
+		}
+
+		Block& block = type.m_Blocks[allocation.m_Block];
+		ASSERT(block.m_Memory == allocation.m_Memory, "Allocation does not belong to its block");
+		block.m_Ranges.Free(allocation.m_Range);
+		if(!block.m_Ranges.IsEmpty())
+			return;
+
+		for(uint32 i = 0; i < type.m_Blocks.size(); ++i)
+		{
+			const Block& other = type.m_Blocks[i];
+			if(i != allocation.m_Block && other.m_Memory != 0 && other.m_Ranges.IsEmpty())
+			{
+				// there is an empty block already, one is enough to keep around
+				m_Backend->FreeBlock(block.m_Memory);
+				block.m_Memory = 0;
+				block.m_Mapped = nullptr;
+				block.m_Ranges.Init(0);
+				return;
+			}
+		}
+	}
+
+	int32 GpuMemoryAllocator::FindMemoryType(uint32 typeBits, uint32 requiredFlags, uint32 preferredFlags) const
+	{
+		int32 best = -1;
+		uint32 bestPreferred = 0;
+		uint32 bestOther = 0;
+		for(uint32 i = 0; i < m_Properties.m_TypeCount; ++i)
+		{
+			const uint32 flags = m_Properties.m_Types[i].m_Flags;
+			if((typeBits & (1u << i)) == 0 || (flags & requiredFlags) != requiredFlags)
+				continue;
+
+			// host visible memory nobody asked for is often slower to read or smaller, so fewer extras wins
+			const uint32 preferred = CountBits(flags & preferredFlags);
+			const uint32 other = CountBits(flags & ~(requiredFlags | preferredFlags));
+			if(best < 0 || preferred > bestPreferred || (preferred == bestPreferred && other < bestOther))
+			{
+				best = static_cast<int32>(i);
+				bestPreferred = preferred;
+				bestOther = other;
+			}
+		}
+		return best;
+	}
+
+	uint64 GpuMemoryAllocator::GetBlockSize(uint32 memoryType) const
+	{
+		const uint32 heap = m_Properties.m_Types[memoryType].m_Heap;
+		const uint64 heapSize = heap < m_Properties.m_HeapCount ? m_Properties.m_HeapSizes[heap] : 0;
+		if(heapSize == 0 || heapSize > (1ull << 30))
+			return m_BlockSize;
+		return heapSize / 8 < m_BlockSize ? heapSize / 8 : m_BlockSize;
+	}
+
+	GpuMemoryStats GpuMemoryAllocator::GetStats() const
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		GpuMemoryStats stats;
+		for(uint32 i = 0; i < m_Properties.m_TypeCount; ++i)
+			AddStats(i, stats);
+		return stats;
+	}
+
+	GpuMemoryStats GpuMemoryAllocator::GetStats(uint32 memoryType) const
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		GpuMemoryStats stats;
+		AddStats(memoryType, stats);
+		return stats;
+	}
+
+	GpuAllocation GpuMemoryAllocator::AllocateFromType(uint32 memoryType, uint64 size, uint64 alignment,
+													   bool dedicated)
+	{
+		MemoryType& type = m_Types[memoryType];
+		const uint64 blockSize = GetBlockSize(memoryType);
+		if(dedicated || size > blockSize / 2)
+			return AllocateDedicated(memoryType, size);
+
+		auto allocateFrom = [&](uint32 blockIndex) {
+			Block& block = type.m_Blocks[blockIndex];
+			GpuAllocation allocation;
+			allocation.m_Range = block.m_Ranges.Allocate(size, alignment);
+			if(!allocation.m_Range.IsValid())
+				return allocation;
+
+			allocation.m_Memory = block.m_Memory;
+			allocation.m_Offset = allocation.m_Range.m_Offset;
+			allocation.m_Size = size;
+			allocation.m_Mapped = block.m_Mapped ? block.m_Mapped + allocation.m_Offset : nullptr;
+			allocation.m_MemoryType = memoryType;
+			allocation.m_Block = blockIndex;
+			return allocation;
+		};
+
+		uint32 unusedSlot = ~0u;
+		for(uint32 i = 0; i < type.m_Blocks.size(); ++i)
+		{
+			if(type.m_Blocks[i].m_Memory == 0)
+			{
+				unusedSlot = unusedSlot == ~0u ? i : unusedSlot;
+				continue;
+			}
+
+			const GpuAllocation allocation = allocateFrom(i);
+			if(allocation.IsValid())
+				return allocation;
+		}
+
+		const uint64 memory = m_Backend->AllocateBlock(memoryType, blockSize);
+		if(memory != 0)
+		{
+			if(unusedSlot == ~0u)
+			{
+				unusedSlot = static_cast<uint32>(type.m_Blocks.size());
+				type.m_Blocks.emplace_back();
+			}
+
+			Block& block = type.m_Blocks[unusedSlot];
+			block.m_Memory = memory;
+			block.m_Mapped = nullptr;
+			if(m_Properties.m_Types[memoryType].m_Flags & GpuMemoryProperties::HostVisible)
+				block.m_Mapped = static_cast<int8*>(m_Backend->MapBlock(memory));
+			block.m_Ranges.Init(blockSize);
+
+			const GpuAllocation allocation = allocateFrom(unusedSlot);
+			if(allocation.IsValid())
+				return allocation;
+		}
+
+		// the heap may still have room for exactly this much
+		return AllocateDedicated(memoryType, size);
+	}
+
+	GpuAllocation GpuMemoryAllocator::AllocateDedicated(uint32 memoryType, uint64 size)
+	{
+		GpuAllocation allocation;
+		allocation.m_Memory = m_Backend->AllocateBlock(memoryType, size);
+		if(allocation.m_Memory == 0)
+			return allocation;
+
+		allocation.m_Size = size;
+		allocation.m_MemoryType = memoryType;
+		if(m_Properties.m_Types[memoryType].m_Flags & GpuMemoryProperties::HostVisible)
+			allocation.m_Mapped = m_Backend->MapBlock(allocation.m_Memory);
+
+		MemoryType& type = m_Types[memoryType];
+		++type.m_DedicatedCount;
+		type.m_DedicatedBytes += size;
+		return allocation;
+	}
+
+	void GpuMemoryAllocator::AddStats(uint32 memoryType, GpuMemoryStats& stats) const
+	{
+		const MemoryType& type = m_Types[memoryType];
+		for(const Block& block : type.m_Blocks)
+		{
+			if(block.m_Memory == 0)
+				continue;
+
+			++stats.m_BlockCount;
+			stats.m_AllocationCount += block.m_Ranges.GetAllocationCount();
+			stats.m_BlockBytes += block.m_Ranges.GetSize();
+			stats.m_UsedBytes += block.m_Ranges.GetUsed();
+			const uint64 largest = block.m_Ranges.GetLargestFreeRange();
+			stats.m_LargestFreeRange = largest > stats.m_LargestFreeRange ? largest : stats.m_LargestFreeRange;
+		}
+		stats.m_DedicatedCount += type.m_DedicatedCount;
+		stats.m_DedicatedBytes += type.m_DedicatedBytes;
+	}
+
+}; // namespace Core
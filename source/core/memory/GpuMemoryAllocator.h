@@ -0,0 +1,172 @@
+#pragma once
+#include "core/Types.h"
+#include "core/memory/TlsfAllocator.h"
+
+#include <mutex>
+#include <vector>
+
+namespace Core
+{
+	// What the device reports about its memory, VkPhysicalDeviceMemoryProperties without the Vulkan types
+	struct GpuMemoryProperties
+	{
+		static constexpr uint32 MaxTypes = 32;
+		static constexpr uint32 MaxHeaps = 16;
+
+		// the bits match VkMemoryPropertyFlagBits so Vulkan flags can be passed straight through
+		enum Flags : uint32
+		{
+			DeviceLocal = 0x1,
+			HostVisible = 0x2,
+			HostCoherent = 0x4,
+			HostCached = 0x8,
+		};
+
+		struct Type
+		{
+			uint32 m_Flags = 0;
+			uint32 m_Heap = 0;
+		};
+
+		Type m_Types[MaxTypes];
+		uint32 m_TypeCount = 0;
+		uint64 m_HeapSizes[MaxHeaps] = {};
+		uint32 m_HeapCount = 0;
+		// linear and optimal resources closer than this may alias, VkPhysicalDeviceLimits::bufferImageGranularity
+		uint64 m_BufferImageGranularity = 1;
+	};
+
+	// Where device memory really comes from, vkAllocateMemory in the renderer and a mock in the tests
+	class IGpuMemoryBackend
+	{
+	public:
+		virtual ~IGpuMemoryBackend() = default;
+
+		// 0 when there is no memory left, the handle is a VkDeviceMemory for Vulkan
+		virtual uint64 AllocateBlock(uint32 memoryType, uint64 size) = 0;
+		virtual void FreeBlock(uint64 block) = 0;
+		// only called for host visible types, the block stays mapped until it is freed
+		virtual void* MapBlock(uint64 block) = 0;
+	};
+
+	struct GpuAllocationDesc
+	{
+		enum class Resource : uint8
+		{
+			Linear, // buffers and linearly tiled images
+			OptimalImage,
+		};
+
+		uint64 m_Size = 0;
+		uint64 m_Alignment = 1;
+		uint32 m_MemoryTypeBits = ~0u; // VkMemoryRequirements::memoryTypeBits
+		uint32 m_RequiredFlags = 0;
+		uint32 m_PreferredFlags = 0;
+		Resource m_Resource = Resource::Linear;
+		bool m_Dedicated = false; // a block of its own, for render targets and anything large and long lived
+	};
+
+	struct GpuAllocation
+	{
+		static constexpr uint32 DedicatedBlock = ~0u;
+
+		uint64 m_Memory = 0; // the backend's block handle, 0 when the allocation failed
+		uint64 m_Offset = 0;
+		uint64 m_Size = 0;
+		void* m_Mapped = nullptr; // at m_Offset, only for host visible memory
+		uint32 m_MemoryType = 0;
+		uint32 m_Block = DedicatedBlock;
+		TlsfAllocation m_Range;
+
+		bool IsValid() const { return m_Memory != 0; }
+		bool IsDedicated() const { return m_Block == DedicatedBlock; }
+	};
+
+	struct GpuMemoryStats
+	{
+		uint32 m_BlockCount = 0;
+		uint32 m_AllocationCount = 0; // placed in blocks
+		uint32 m_DedicatedCount = 0;
+		uint64 m_BlockBytes = 0;
+		uint64 m_UsedBytes = 0; // of m_BlockBytes
+		uint64 m_DedicatedBytes = 0;
+		uint64 m_LargestFreeRange = 0;
+
+		uint64 GetFreeBytes() const { return m_BlockBytes - m_UsedBytes; }
+		// 0 while the free memory in the blocks is one range, towards 1 the more it is split up
+		float GetFragmentation() const;
+	};
+
+	/*
+		Sub-allocates GPU memory so a buffer or image costs a range in a large block instead of a device allocation of
+		its own, drivers allow only a few thousand of those. Every memory type gets its own list of blocks, ranges in a
+		block come from a TlsfAllocator.
+
+		The memory type is the one from m_MemoryTypeBits that has all the required flags and most of the preferred
+		ones, with the fewest flags nobody asked for. When its heap is out of memory the next best type is tried.
+		Allocations above half a block get a block of their own, the same as m_Dedicated, and so does anything that
+		fits no block when no new block can be had.
+
+		Optimally tiled images are aligned to and rounded up to bufferImageGranularity, so they never share a page
+		with a buffer. Host visible blocks are mapped once for their whole lifetime. Empty blocks are given back except
+		for one per type, so an allocation moving back and forth does not allocate device memory every time.
+
+		All functions can be called from any thread.
+	*/
+	class GpuMemoryAllocator
+	{
+	public:
+		static constexpr uint64 DefaultBlockSize = 64ull << 20;
+
+		GpuMemoryAllocator() = default;
+		~GpuMemoryAllocator();
+
+		GpuMemoryAllocator(const GpuMemoryAllocator&) = delete;
+		GpuMemoryAllocator& operator=(const GpuMemoryAllocator&) = delete;
+
+		// heaps of 1 GiB or less get blocks of an eighth of the heap when that is below blockSize
+		void Init(IGpuMemoryBackend* backend, const GpuMemoryProperties& properties,
+				  uint64 blockSize = DefaultBlockSize);
+		// everything has to be freed already
+		void Destroy();
+
+		// invalid when no memory type fits or every one that does is out of memory
+		GpuAllocation Allocate(const GpuAllocationDesc& desc);
+		void Free(const GpuAllocation& allocation);
+
+		// -1 when none of typeBits has all of requiredFlags
+		int32 FindMemoryType(uint32 typeBits, uint32 requiredFlags, uint32 preferredFlags) const;
+
+		uint64 GetBlockSize(uint32 memoryType) const;
+		const GpuMemoryProperties& GetProperties() const { return m_Properties; }
+
+		GpuMemoryStats GetStats() const;
+		GpuMemoryStats GetStats(uint32 memoryType) const;
+
+	private:
+		struct Block
+		{
+			uint64 m_Memory = 0; // 0 while the slot is unused
+			int8* m_Mapped = nullptr;
+			TlsfAllocator m_Ranges;
+		};
+
+		struct MemoryType
+		{
+			std::vector<Block> m_Blocks; // allocations keep their block's index, freed slots are reused
+			uint32 m_DedicatedCount = 0;
+			uint64 m_DedicatedBytes = 0;
+		};
+
+		GpuAllocation AllocateFromType(uint32 memoryType, uint64 size, uint64 alignment, bool dedicated);
+		GpuAllocation AllocateDedicated(uint32 memoryType, uint64 size);
+		void AddStats(uint32 memoryType, GpuMemoryStats& stats) const;
+
+		IGpuMemoryBackend* m_Backend = nullptr;
+		GpuMemoryProperties m_Properties;
+		uint64 m_BlockSize = DefaultBlockSize;
+		MemoryType m_Types[GpuMemoryProperties::MaxTypes];
+		mutable std::mutex m_Mutex;
+	};
+
+}; // namespace Core
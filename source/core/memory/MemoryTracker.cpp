@@ -0,0 +1,98 @@
+#include "MemoryTracker.h"
+
+#include <atomic>
+
+namespace Core
+{
+	namespace
+	{
+		struct TagCounters
+		{
+			std::atomic<uint64> m_LiveBytes{ 0 };
+			std::atomic<uint64> m_PeakBytes{ 0 };
+			std::atomic<uint64> m_TotalAllocations{ 0 };
+			std::atomic<uint64> m_LiveAllocations{ 0 };
+
+			// only touched by Update, which runs on the main thread
+			uint64 m_LastTotal = 0;
+			float m_AllocationsPerSecond = 0.f;
+		};
+
+		TagCounters s_Counters[(uint32)MemoryTag::Count];
+
+		MemoryStats Read(const TagCounters& counters)
+		{
+			MemoryStats stats;
+			stats.m_LiveBytes = counters.m_LiveBytes.load(std::memory_order_relaxed);
+			stats.m_PeakBytes = counters.m_PeakBytes.load(std::memory_order_relaxed);
+			stats.m_TotalAllocations = counters.m_TotalAllocations.load(std::memory_order_relaxed);
+			stats.m_LiveAllocations = counters.m_LiveAllocations.load(std::memory_order_relaxed);
+			stats.m_AllocationsPerSecond = counters.m_AllocationsPerSecond;
+			return stats;
+		}
+	}; // namespace
+
+	void MemoryTracker::Track(MemoryTag tag, uint64 size)
+	{
+		TagCounters& counters = s_Counters[(uint32)tag];
+		const uint64 live = counters.m_LiveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+		counters.m_TotalAllocations.fetch_add(1, std::memory_order_relaxed);
+		counters.m_LiveAllocations.fetch_add(1, std::memory_order_relaxed);
+
+		uint64 peak = counters.m_PeakBytes.load(std::memory_order_relaxed);
+		while(live > peak && !counters.m_PeakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+		{
+		}
+	}
+
+	void MemoryTracker::Untrack(MemoryTag tag, uint64 size)
+	{
+		TagCounters& counters = s_Counters[(uint32)tag];
+		counters.m_LiveBytes.fetch_sub(size, std::memory_order_relaxed);
+		counters.m_LiveAllocations.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	void MemoryTracker::Update(float deltaTime)
+	{
+		if(deltaTime <= 0.f)
+			return;
+
+		for(TagCounters& counters : s_Counters)
+		{
+			const uint64 total = counters.m_TotalAllocations.load(std::memory_order_relaxed);
+			counters.m_AllocationsPerSecond = (float)(total - counters.m_LastTotal) / deltaTime;
+			counters.m_LastTotal = total;
+		}
+	}
+
+	MemoryStats MemoryTracker::GetStats(MemoryTag tag) { return Read(s_Counters[(uint32)tag]); }
+
+	MemoryStats MemoryTracker::GetTotal()
+	{
+		MemoryStats total;
+		for(const TagCounters& counters : s_Counters)
+		{
+			const MemoryStats stats = Read(counters);
+			total.m_LiveBytes += stats.m_LiveBytes;
+			total.m_PeakBytes += stats.m_PeakBytes;
+			total.m_TotalAllocations += stats.m_TotalAllocations;
+			total.m_LiveAllocations += stats.m_LiveAllocations;
+			total.m_AllocationsPerSecond += stats.m_AllocationsPerSecond;
+		}
+		return total;
+	}
+
+	void MemoryTracker::Reset()
+	{
+		for(TagCounters& counters : s_Counters)
+		{
+			counters.m_LiveBytes = 0;
+			counters.m_PeakBytes = 0;
+			counters.m_TotalAllocations = 0;
+			counters.m_LiveAllocations = 0;
+			counters.m_LastTotal = 0;
+			counters.m_AllocationsPerSecond = 0.f;
+		}
+	}
+
+}; // namespace Core
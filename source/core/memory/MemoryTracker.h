@@ -0,0 +1,36 @@
+#pragma once
+#include "core/Types.h"
+#include "core/memory/Allocator.h"
+
+namespace Core
+{
+	struct MemoryStats
+	{
+		uint64 m_LiveBytes = 0;
+		uint64 m_PeakBytes = 0;
+		uint64 m_TotalAllocations = 0;
+		uint64 m_LiveAllocations = 0;
+		float m_AllocationsPerSecond = 0.f; // measured between the last two calls to Update
+	};
+
+	/*
+		Per tag heap usage, fed by the allocators. Counters are atomics so it can be called from any thread and it does
+		not need to be created before the first allocation. Call Update once a frame to refresh the allocation rates.
+	*/
+	class MemoryTracker
+	{
+	public:
+		static void Track(MemoryTag tag, uint64 size);
+		static void Untrack(MemoryTag tag, uint64 size);
+
+		static void Update(float deltaTime);
+
+		static MemoryStats GetStats(MemoryTag tag);
+		// Sum over all tags, m_PeakBytes is the sum of the per tag peaks which did not necessarily happen at once.
+		static MemoryStats GetTotal();
+
+		// Clears every counter, only meant for tests.
+		static void Reset();
+	};
+
+}; // namespace Core
@@ -0,0 +1,156 @@
+#pragma once
+#include "core/Types.h"
+#include "core/memory/Allocator.h"
+#include "logger/Debug.h"
+
+#include <atomic>
+
+namespace Core
+{
+	/*
+		Fixed size block allocator. All blocks come from a single chunk taken from the upstream allocator in Init, free
+		blocks are kept on an intrusive lock-free stack so Allocate / Free can be called from any thread without locking.
+		The head packs the index of the first free block with a counter that changes on every pop, which keeps a stale
+		compare-exchange from succeeding when a block was popped and pushed back in between (ABA).
+
+		When the pool runs dry requests fall through to the upstream allocator, Free tells the two apart by address.
+	*/
+	template <uint32 BlockSize, uint32 BlockAlignment = 16>
+	class PoolAllocator : public IAllocator
+	{
+		static_assert(BlockSize >= sizeof(uint32), "Blocks have to fit the free list link");
+		static_assert((BlockAlignment & (BlockAlignment - 1)) == 0, "BlockAlignment has to be a power of two");
+
+	public:
+		static constexpr uint32 Stride = (BlockSize + BlockAlignment - 1) & ~(BlockAlignment - 1);
+
+		PoolAllocator() = default;
+		PoolAllocator(uint32 blockCount, IAllocator* upstream = GetAllocator(MemoryTag::Core)) { Init(blockCount, upstream); }
+		~PoolAllocator() override { Destroy(); }
+
+		PoolAllocator(const PoolAllocator&) = delete;
+		PoolAllocator& operator=(const PoolAllocator&) = delete;
+
+		void Init(uint32 blockCount, IAllocator* upstream = GetAllocator(MemoryTag::Core))
+		{
+			ASSERT(!m_Memory, "PoolAllocator is already initialized");
+			ASSERT((blockCount > 0 && blockCount < InvalidIndex), "PoolAllocator needs a block count in range");
+
+			m_Upstream = upstream;
+			m_BlockCount = blockCount;
+			m_Memory = static_cast<uint8*>(m_Upstream->Allocate((uint64)Stride * blockCount, BlockAlignment));
+
+			for(uint32 i = 0; i < blockCount; ++i)
+				Link(i).store(i + 1 < blockCount ? i + 1 : InvalidIndex, std::memory_order_relaxed);
+
+			m_Head.store(0, std::memory_order_release);
+			m_FreeCount.store(blockCount, std::memory_order_relaxed);
+		}
+
+		// Every block has to be returned before this is called.
+		void Destroy()
+		{
+			if(!m_Memory)
+				return;
+
+			ASSERT(m_FreeCount.load() == m_BlockCount, "PoolAllocator destroyed with blocks still in use");
+			m_Upstream->Free(m_Memory, (uint64)Stride * m_BlockCount, BlockAlignment);
+			m_Memory = nullptr;
+			m_BlockCount = 0;
+			m_Head.store(InvalidIndex);
+			m_FreeCount.store(0);
+		}
+
+		void* Allocate(uint64 size, uint64 alignment) override
+		{
+			ASSERT((size <= BlockSize && alignment <= BlockAlignment), "Request does not fit the pool blocks");
+			(void)size; // only read by the assert
+			(void)alignment;
+
+			if(void* block = Pop())
+				return block;
+
+			// overflow blocks are full sized too, so Free does not need the original request
+			m_Overflow.fetch_add(1, std::memory_order_relaxed);
+			return m_Upstream->Allocate(BlockSize, BlockAlignment);
+		}
+
+		void* Allocate() { return Allocate(BlockSize, BlockAlignment); }
+
+		void Free(void* data, uint64 /*size*/, uint64 /*alignment*/) override
+		{
+			if(!data)
+				return;
+
+			if(Owns(data))
+				Push(data);
+			else
+				m_Upstream->Free(data, BlockSize, BlockAlignment);
+		}
+
+		void Free(void* data) { Free(data, BlockSize, BlockAlignment); }
+
+		bool Owns(const void* data) const
+		{
+			const uint8* block = static_cast<const uint8*>(data);
+			return block >= m_Memory && block < m_Memory + (uint64)Stride * m_BlockCount;
+		}
+
+		uint32 GetBlockCount() const { return m_BlockCount; }
+		uint32 GetFreeCount() const { return m_FreeCount.load(std::memory_order_relaxed); }
+		// How many requests had to go to the upstream allocator because the pool was empty.
+		uint32 GetOverflowCount() const { return m_Overflow.load(std::memory_order_relaxed); }
+
+	private:
+		static constexpr uint32 InvalidIndex = ~0u;
+
+		std::atomic<uint32>& Link(uint32 index)
+		{
+			return *reinterpret_cast<std::atomic<uint32>*>(m_Memory + (uint64)Stride * index);
+		}
+
+		void* Pop()
+		{
+			uint64 head = m_Head.load(std::memory_order_acquire);
+			for(;;)
+			{
+				const uint32 index = (uint32)head;
+				if(index == InvalidIndex)
+					return nullptr;
+
+				// the link may already be overwritten by another thread that won the race, the counter makes the CAS fail then
+				const uint32 next = Link(index).load(std::memory_order_relaxed);
+				const uint64 desired = (((head >> 32) + 1) << 32) | next;
+				if(m_Head.compare_exchange_weak(head, desired, std::memory_order_acquire, std::memory_order_acquire))
+				{
+					m_FreeCount.fetch_sub(1, std::memory_order_relaxed);
+					return m_Memory + (uint64)Stride * index;
+				}
+			}
+		}
+
+		void Push(void* data)
+		{
+			const uint32 index = (uint32)((static_cast<uint8*>(data) - m_Memory) / Stride);
+			ASSERT(static_cast<uint8*>(data) == m_Memory + (uint64)Stride * index, "Pointer is not the start of a pool block");
+
+			uint64 head = m_Head.load(std::memory_order_relaxed);
+			for(;;)
+			{
+				Link(index).store((uint32)head, std::memory_order_relaxed);
+				const uint64 desired = (head & 0xFFFFFFFF00000000ull) | index;
+				if(m_Head.compare_exchange_weak(head, desired, std::memory_order_release, std::memory_order_relaxed))
+					break;
+			}
+			m_FreeCount.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		uint8* m_Memory = nullptr;
+		IAllocator* m_Upstream = nullptr;
+		uint32 m_BlockCount = 0;
+		std::atomic<uint64> m_Head{ InvalidIndex }; // high 32 bits ABA counter, low 32 bits first free block
+		std::atomic<uint32> m_FreeCount{ 0 };
+		std::atomic<uint32> m_Overflow{ 0 };
+	};
+
+}; // namespace Core
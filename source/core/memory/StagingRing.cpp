@@ -0,0 +1,72 @@
+#include "StagingRing.h"
+#include "logger/Debug.h"
+
+namespace Core
+{
+	void StagingRing::Init(uint64 size)
+	{
+		m_Pending.clear();
+		m_Size = size;
+		m_Head = 0;
+		m_Tail = 0;
+		m_Used = 0;
+		m_OpenBytes = 0;
+	}
+
+	uint64 StagingRing::Allocate(uint64 size, uint64 alignment)
+	{
+		ASSERT((alignment > 0 && (alignment & (alignment - 1)) == 0), "Alignment has to be a power of two");
+		if(size > m_Size || m_Used == m_Size)
+			return InvalidOffset;
+
+		// nothing in flight, start at the front so the largest allocation fits
+		if(m_Used == 0)
+		{
+			m_Head = 0;
+			m_Tail = 0;
+		}
+
+		uint64 offset = (m_Head + alignment - 1) & ~(alignment - 1);
+		if(m_Head >= m_Tail)
+		{
+			// free from the head to the end and from the front to the tail
+			if(offset + size > m_Size)
+			{
+				if(size > m_Tail)
+					return InvalidOffset;
+				offset = 0;
+			}
+		}
+		else if(offset + size > m_Tail)
+		{
+			return InvalidOffset;
+		}
+
+		const uint64 bytes = offset >= m_Head ? offset + size - m_Head : m_Size - m_Head + size;
+		m_Used += bytes;
+		m_OpenBytes += bytes;
+		m_Head = offset + size;
+		return offset;
+	}
+
+	void StagingRing::EndSubmission(uint64 submission)
+	{
+		if(m_OpenBytes == 0)
+			return;
+
+		ASSERT((m_Pending.empty() || m_Pending.back().m_Id < submission), "Submission ids have to go up");
+		m_Pending.push_back({ submission, m_Head, m_OpenBytes });
+		m_OpenBytes = 0;
+	}
+
+	void StagingRing::Retire(uint64 completedSubmission)
+	{
+		while(!m_Pending.empty() && m_Pending.front().m_Id <= completedSubmission)
+		{
+			m_Used -= m_Pending.front().m_Bytes;
+			m_Tail = m_Pending.front().m_End;
+			m_Pending.pop_front();
+		}
+	}
+
+}; // namespace Core
@@ -0,0 +1,55 @@
+#pragma once
+#include "core/Types.h"
+
+#include <deque>
+
+namespace Core
+{
+	/*
+		Ring of offsets into a staging buffer the CPU writes and the GPU reads from later. Allocations are grouped
+		into submissions, the whole group is given back at once when Retire hears the GPU is done with it, oldest
+		first. Like TlsfAllocator it never touches the memory itself.
+
+		An allocation that does not fit before the end of the ring starts over at 0, the end is skipped and given
+		back with the allocation.
+	*/
+	class StagingRing
+	{
+	public:
+		static constexpr uint64 InvalidOffset = ~0ull;
+
+		StagingRing() = default;
+		explicit StagingRing(uint64 size) { Init(size); }
+
+		void Init(uint64 size);
+
+		// InvalidOffset when there is no room until older submissions are retired. alignment is a power of two.
+		uint64 Allocate(uint64 size, uint64 alignment = 1);
+
+		// everything allocated since the last EndSubmission belongs to submission, ids have to go up
+		void EndSubmission(uint64 submission);
+		// the GPU is done with every submission up to and including this one
+		void Retire(uint64 completedSubmission);
+
+		bool HasOpenAllocations() const { return m_OpenBytes > 0; }
+		uint64 GetSize() const { return m_Size; }
+		uint64 GetUsed() const { return m_Used; } // with the skipped ends
+		uint32 GetPendingSubmissionCount() const { return static_cast<uint32>(m_Pending.size()); }
+
+	private:
+		struct Submission
+		{
+			uint64 m_Id = 0;
+			uint64 m_End = 0; // the head after its last allocation
+			uint64 m_Bytes = 0;
+		};
+
+		std::deque<Submission> m_Pending;
+		uint64 m_Size = 0;
+		uint64 m_Head = 0;
+		uint64 m_Tail = 0;
+		uint64 m_Used = 0; // from m_Tail to m_Head around the end
+		uint64 m_OpenBytes = 0; // not part of a submission yet
+	};
+
+}; // namespace Core
@@ -0,0 +1,274 @@
+#include "TlsfAllocator.h"
+#include "logger/Debug.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace Core
+{
+	namespace
+	{
+		// value has to be non zero
+		uint32 HighestBit(uint64 value)
+		{
+#ifdef _MSC_VER
+			unsigned long index = 0;
+			_BitScanReverse64(&index, value);
+			return index;
+#else
+			return 63 - __builtin_clzll(value);
+#endif
+		}
+
+		uint32 LowestBit(uint64 value)
+		{
+#ifdef _MSC_VER
+			unsigned long index = 0;
+			_BitScanForward64(&index, value);
+			return index;
+#else
+			return __builtin_ctzll(value);
+#endif
+		}
+	}; // namespace
+
+	void TlsfAllocator::Init(uint64 size)
+	{
+		m_Nodes.clear();
+		m_UnusedNodes = TlsfAllocation::InvalidNode;
+		m_FirstLevelBitmap = 0;
+		for(uint32 firstLevel = 0; firstLevel < s_FirstLevelCount; ++firstLevel)
+		{
+			m_SecondLevelBitmap[firstLevel] = 0;
+			for(uint32 secondLevel = 0; secondLevel < s_SecondLevelCount; ++secondLevel)
+				m_FreeLists[firstLevel][secondLevel] = TlsfAllocation::InvalidNode;
+		}
+
+		m_Size = size;
+		m_Used = 0;
+		m_AllocationCount = 0;
+		m_FreeRangeCount = 0;
+		if(size == 0)
+			return;
+
+		const uint32 node = CreateNode();
+		m_Nodes[node].m_Offset = 0;
+		m_Nodes[node].m_Size = size;
+		InsertFree(node);
+	}
+
+	TlsfAllocation TlsfAllocator::Allocate(uint64 size, uint64 alignment)
+	{
+		ASSERT((alignment > 0 && (alignment & (alignment - 1)) == 0), "Alignment has to be a power of two");
+		size = size > 0 ? size : 1;
+
+		// a range this much larger fits size wherever alignment puts its start
+		const uint32 node = FindFree(size + alignment - 1);
+		if(node == TlsfAllocation::InvalidNode)
+			return TlsfAllocation();
+		RemoveFree(node);
+
+		// free ranges never sit next to each other, so the padding can't be merged into the one before
+		const uint64 offset = m_Nodes[node].m_Offset;
+		const uint64 padding = ((offset + alignment - 1) & ~(alignment - 1)) - offset;
+		if(padding > 0)
+			InsertFree(SplitFront(node, padding));
+
+		uint32 allocated = node;
+		if(m_Nodes[node].m_Size > size)
+		{
+			allocated = SplitFront(node, size);
+			InsertFree(node);
+		}
+
+		m_Nodes[allocated].m_Free = false;
+		m_Used += size;
+		++m_AllocationCount;
+
+		TlsfAllocation allocation;
+		allocation.m_Offset = m_Nodes[allocated].m_Offset;
+		allocation.m_Node = allocated;
+		return allocation;
+	}
+
+	void TlsfAllocator::Free(const TlsfAllocation& allocation)
+	{
+		ASSERT((allocation.IsValid() && allocation.m_Node < m_Nodes.size() && !m_Nodes[allocation.m_Node].m_Free),
+			   "Freeing something that is not allocated");
+
+		uint32 node = allocation.m_Node;
+		m_Used -= m_Nodes[node].m_Size;
+		--m_AllocationCount;
+
+		const uint32 next = m_Nodes[node].m_NextPhysical;
+		if(next != TlsfAllocation::InvalidNode && m_Nodes[next].m_Free)
+		{
+			RemoveFree(next);
+			m_Nodes[node].m_Size += m_Nodes[next].m_Size;
+			m_Nodes[node].m_NextPhysical = m_Nodes[next].m_NextPhysical;
+			if(m_Nodes[node].m_NextPhysical != TlsfAllocation::InvalidNode)
+				m_Nodes[m_Nodes[node].m_NextPhysical].m_PrevPhysical = node;
+			ReleaseNode(next);
+		}
+
+		const uint32 prev = m_Nodes[node].m_PrevPhysical;
+		if(prev != TlsfAllocation::InvalidNode && m_Nodes[prev].m_Free)
+		{
+			RemoveFree(prev);
+			m_Nodes[prev].m_Size += m_Nodes[node].m_Size;
+			m_Nodes[prev].m_NextPhysical = m_Nodes[node].m_NextPhysical;
+			if(m_Nodes[prev].m_NextPhysical != TlsfAllocation::InvalidNode)
+				m_Nodes[m_Nodes[prev].m_NextPhysical].m_PrevPhysical = prev;
+			ReleaseNode(node);
+			node = prev;
+		}
+
+		InsertFree(node);
+	}
+
+	uint64 TlsfAllocator::GetLargestFreeRange() const
+	{
+		if(m_FirstLevelBitmap == 0)
+			return 0;
+
+		// the largest range is in the highest list in use, but a list holds a span of sizes
+		const uint32 firstLevel = HighestBit(m_FirstLevelBitmap);
+		const uint32 secondLevel = HighestBit(m_SecondLevelBitmap[firstLevel]);
+		uint64 largest = 0;
+		for(uint32 node = m_FreeLists[firstLevel][secondLevel]; node != TlsfAllocation::InvalidNode;
+			node = m_Nodes[node].m_NextFree)
+			largest = m_Nodes[node].m_Size > largest ? m_Nodes[node].m_Size : largest;
+		return largest;
+	}
+
+	void TlsfAllocator::GetListIndex(uint64 size, uint32& firstLevel, uint32& secondLevel)
+	{
+		// below s_SecondLevelCount every size has a list of its own
+		if(size < s_SecondLevelCount)
+		{
+			firstLevel = 0;
+			secondLevel = static_cast<uint32>(size);
+			return;
+		}
+
+		const uint32 highest = HighestBit(size);
+		firstLevel = highest - s_SecondLevelBits + 1;
+		secondLevel = static_cast<uint32>(size >> (highest - s_SecondLevelBits)) ^ s_SecondLevelCount;
+	}
+
+	uint32 TlsfAllocator::CreateNode()
+	{
+		if(m_UnusedNodes != TlsfAllocation::InvalidNode)
+		{
+			const uint32 node = m_UnusedNodes;
+			m_UnusedNodes = m_Nodes[node].m_NextFree;
+			m_Nodes[node] = Node();
+			return node;
+		}
+
+		m_Nodes.emplace_back();
+		return static_cast<uint32>(m_Nodes.size() - 1);
+	}
+
+	void TlsfAllocator::ReleaseNode(uint32 node)
+	{
+		m_Nodes[node].m_NextFree = m_UnusedNodes;
+		m_UnusedNodes = node;
+	}
+
+	void TlsfAllocator::InsertFree(uint32 node)
+	{
+		uint32 firstLevel = 0;
+		uint32 secondLevel = 0;
+		GetListIndex(m_Nodes[node].m_Size, firstLevel, secondLevel);
+
+		const uint32 head = m_FreeLists[firstLevel][secondLevel];
+		m_Nodes[node].m_Free = true;
+		m_Nodes[node].m_PrevFree = TlsfAllocation::InvalidNode;
+		m_Nodes[node].m_NextFree = head;
+		if(head != TlsfAllocation::InvalidNode)
+			m_Nodes[head].m_PrevFree = node;
+		m_FreeLists[firstLevel][secondLevel] = node;
+
+		m_FirstLevelBitmap |= 1ull << firstLevel;
+		m_SecondLevelBitmap[firstLevel] |= 1u << secondLevel;
+		++m_FreeRangeCount;
+	}
+
+	void TlsfAllocator::RemoveFree(uint32 node)
+	{
+		Node& removed = m_Nodes[node];
+		if(removed.m_PrevFree != TlsfAllocation::InvalidNode)
+			m_Nodes[removed.m_PrevFree].m_NextFree = removed.m_NextFree;
+		if(removed.m_NextFree != TlsfAllocation::InvalidNode)
+			m_Nodes[removed.m_NextFree].m_PrevFree = removed.m_PrevFree;
+
+		uint32 firstLevel = 0;
+		uint32 secondLevel = 0;
+		GetListIndex(removed.m_Size, firstLevel, secondLevel);
+		if(m_FreeLists[firstLevel][secondLevel] == node)
+		{
+			m_FreeLists[firstLevel][secondLevel] = removed.m_NextFree;
+			if(removed.m_NextFree == TlsfAllocation::InvalidNode)
+			{
+				m_SecondLevelBitmap[firstLevel] &= ~(1u << secondLevel);
+				if(m_SecondLevelBitmap[firstLevel] == 0)
+					m_FirstLevelBitmap &= ~(1ull << firstLevel);
+			}
+		}
+
+		removed.m_Free = false;
+		removed.m_PrevFree = TlsfAllocation::InvalidNode;
+		removed.m_NextFree = TlsfAllocation::InvalidNode;
+		--m_FreeRangeCount;
+	}
+
+	uint32 TlsfAllocator::FindFree(uint64 size) const
+	{
+		// round up to the next step, everything in that list and above is then large enough
+		if(size >= s_SecondLevelCount)
+		{
+			const uint64 step = 1ull << (HighestBit(size) - s_SecondLevelBits);
+			if(size > ~0ull - step)
+				return TlsfAllocation::InvalidNode;
+			size += step - 1;
+		}
+
+		uint32 firstLevel = 0;
+		uint32 secondLevel = 0;
+		GetListIndex(size, firstLevel, secondLevel);
+
+		uint32 secondLevelMap = m_SecondLevelBitmap[firstLevel] & (~0u << secondLevel);
+		if(secondLevelMap == 0)
+		{
+			const uint64 firstLevelMap =
+				firstLevel + 1 < 64 ? m_FirstLevelBitmap & (~0ull << (firstLevel + 1)) : 0;
+			if(firstLevelMap == 0)
+				return TlsfAllocation::InvalidNode;
+
+			firstLevel = LowestBit(firstLevelMap);
+			secondLevelMap = m_SecondLevelBitmap[firstLevel];
+		}
+
+		return m_FreeLists[firstLevel][LowestBit(secondLevelMap)];
+	}
+
+	uint32 TlsfAllocator::SplitFront(uint32 node, uint64 size)
+	{
+		// CreateNode can move m_Nodes, no references across it
+		const uint32 front = CreateNode();
+		m_Nodes[front].m_Offset = m_Nodes[node].m_Offset;
+		m_Nodes[front].m_Size = size;
+		m_Nodes[front].m_PrevPhysical = m_Nodes[node].m_PrevPhysical;
+		m_Nodes[front].m_NextPhysical = node;
+		if(m_Nodes[front].m_PrevPhysical != TlsfAllocation::InvalidNode)
+			m_Nodes[m_Nodes[front].m_PrevPhysical].m_NextPhysical = front;
+
+		m_Nodes[node].m_Offset += size;
+		m_Nodes[node].m_Size -= size;
+		m_Nodes[node].m_PrevPhysical = front;
+		return front;
+	}
+
+}; // namespace Core
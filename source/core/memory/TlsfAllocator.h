@@ -0,0 +1,89 @@
+#pragma once
+#include "core/Types.h"
+
+#include <vector>
+
+namespace Core
+{
+	struct TlsfAllocation
+	{
+		static constexpr uint32 InvalidNode = ~0u;
+
+		uint64 m_Offset = 0;
+		uint32 m_Node = InvalidNode; // what Free needs back
+
+		bool IsValid() const { return m_Node != InvalidNode; }
+	};
+
+	/*
+		Two level segregated fit over a range of offsets, it never touches the memory it hands out so it can manage
+		GPU memory, a file or anything else addressed by offset. Free ranges are kept in lists by size class, the
+		first level a power of two and the second level splitting that into 32 steps, with a bitmap per level.
+		Allocate and Free are O(1): finding a list is two bit scans, neighbours are merged through the physical
+		links kept with every range.
+
+		Every range from the first level up is at least as large as anything its class is asked for, so there is
+		no searching within a list. That costs at most 1/32 of a range when a request falls just over a step.
+	*/
+	class TlsfAllocator
+	{
+	public:
+		TlsfAllocator() = default;
+		explicit TlsfAllocator(uint64 size) { Init(size); }
+
+		void Init(uint64 size);
+
+		// alignment has to be a power of two. Invalid when no free range fits.
+		TlsfAllocation Allocate(uint64 size, uint64 alignment = 1);
+		void Free(const TlsfAllocation& allocation);
+
+		uint64 GetSize() const { return m_Size; }
+		uint64 GetUsed() const { return m_Used; }
+		uint64 GetFree() const { return m_Size - m_Used; }
+		uint32 GetAllocationCount() const { return m_AllocationCount; }
+		uint32 GetFreeRangeCount() const { return m_FreeRangeCount; }
+		bool IsEmpty() const { return m_AllocationCount == 0; }
+
+		// the largest single allocation that would still fit without alignment padding
+		uint64 GetLargestFreeRange() const;
+
+	private:
+		static constexpr uint32 s_SecondLevelBits = 5;
+		static constexpr uint32 s_SecondLevelCount = 1 << s_SecondLevelBits;
+		static constexpr uint32 s_FirstLevelCount = 64 - s_SecondLevelBits + 1;
+
+		struct Node
+		{
+			uint64 m_Offset = 0;
+			uint64 m_Size = 0;
+			uint32 m_PrevPhysical = TlsfAllocation::InvalidNode;
+			uint32 m_NextPhysical = TlsfAllocation::InvalidNode;
+			uint32 m_PrevFree = TlsfAllocation::InvalidNode; // also links the unused nodes
+			uint32 m_NextFree = TlsfAllocation::InvalidNode;
+			bool m_Free = false;
+		};
+
+		static void GetListIndex(uint64 size, uint32& firstLevel, uint32& secondLevel);
+
+		uint32 CreateNode();
+		void ReleaseNode(uint32 node);
+		void InsertFree(uint32 node);
+		void RemoveFree(uint32 node);
+		uint32 FindFree(uint64 size) const;
+		// splits the first size bytes of node off into a new node before it, returns the new node
+		uint32 SplitFront(uint32 node, uint64 size);
+
+		std::vector<Node> m_Nodes;
+		uint32 m_UnusedNodes = TlsfAllocation::InvalidNode;
+
+		uint64 m_FirstLevelBitmap = 0;
+		uint32 m_SecondLevelBitmap[s_FirstLevelCount] = {};
+		uint32 m_FreeLists[s_FirstLevelCount][s_SecondLevelCount];
+
+		uint64 m_Size = 0;
+		uint64 m_Used = 0;
+		uint32 m_AllocationCount = 0;
+		uint32 m_FreeRangeCount = 0;
+	};
+
+}; // namespace Core
@@ -0,0 +1,38 @@
+#include "UniformRing.h"
+#include "logger/Debug.h"
+
+namespace Core
+{
+	void UniformRing::Init(uint64 bytesPerFrame, uint64 alignment)
+	{
+		ASSERT((alignment > 0 && (alignment & (alignment - 1)) == 0), "Alignment has to be a power of two");
+
+		// every region starts aligned, so the offsets in it are the same for all frames
+		m_FrameSize = (bytesPerFrame + alignment - 1) & ~(alignment - 1);
+		m_Alignment = alignment;
+		m_Offset = 0;
+		m_HighWaterMark = 0;
+		m_FrameIndex = 0;
+	}
+
+	void UniformRing::BeginFrame(uint32 frameIndex)
+	{
+		ASSERT(frameIndex < FrameCount, "frameIndex is out of range for the UniformRing");
+		m_FrameIndex = frameIndex;
+		m_Offset = 0;
+	}
+
+	uint64 UniformRing::Allocate(uint64 size)
+	{
+		const uint64 start = (m_Offset + m_Alignment - 1) & ~(m_Alignment - 1);
+		if(start + size > m_FrameSize)
+			return InvalidOffset;
+
+		m_Offset = start + size;
+		if(m_Offset > m_HighWaterMark)
+			m_HighWaterMark = m_Offset;
+
+		return m_FrameSize * m_FrameIndex + start;
+	}
+
+}; // namespace Core
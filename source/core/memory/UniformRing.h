@@ -0,0 +1,48 @@
+#pragma once
+#include "core/Types.h"
+
+namespace Core
+{
+	/*
+		Offsets into a buffer of constants the GPU reads through dynamic offsets. The buffer has a region per frame
+		in flight and BeginFrame rewinds the region for that frame, the same as FrameArena, so what the CPU writes
+		for one frame never lands in a range the GPU may still be reading for another. Every allocation is aligned
+		to minUniformBufferOffsetAlignment so its offset can be passed straight to vkCmdBindDescriptorSets. Like
+		StagingRing it never touches the memory itself.
+	*/
+	class UniformRing
+	{
+	public:
+		static constexpr uint32 FrameCount = 2;
+		static constexpr uint64 InvalidOffset = ~0ull;
+
+		UniformRing() = default;
+
+		// bytesPerFrame is rounded up to alignment, which is a power of two
+		void Init(uint64 bytesPerFrame, uint64 alignment);
+
+		// The GPU has to be done with everything written for frameIndex the last time around.
+		void BeginFrame(uint32 frameIndex);
+
+		/*
+			From the start of the buffer. Running out is not an error here, it returns InvalidOffset when the frame
+			budget is exhausted and the caller decides what to skip. GetHighWaterMark tells how much was needed.
+		*/
+		uint64 Allocate(uint64 size);
+
+		uint64 GetSize() const { return m_FrameSize * FrameCount; }
+		uint64 GetFrameSize() const { return m_FrameSize; }
+		uint64 GetAlignment() const { return m_Alignment; }
+		uint64 GetUsed() const { return m_Offset; }
+		uint64 GetHighWaterMark() const { return m_HighWaterMark; }
+		uint32 GetFrameIndex() const { return m_FrameIndex; }
+
+	private:
+		uint64 m_FrameSize = 0;
+		uint64 m_Alignment = 1;
+		uint64 m_Offset = 0; // into the current frame's region
+		uint64 m_HighWaterMark = 0;
+		uint32 m_FrameIndex = 0;
+	};
+
+}; // namespace Core
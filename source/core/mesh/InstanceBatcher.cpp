@@ -0,0 +1,185 @@
+#include "InstanceBatcher.h"
+
+#include "LodSelection.h"
+#include "core/JobSystem.h"
+#include "logger/Debug.h"
+
+#include <cmath>
+
+namespace Core
+{
+	namespace
+	{
+		// the bounding sphere moved to world space, its radius grows with the largest axis scale
+		struct WorldBounds
+		{
+			Vector3f m_Center;
+			float m_Radius;
+			float m_Scale;
+		};
+
+		WorldBounds TransformBounds(const Vector3f& center, float radius, const Matrix44f& world)
+		{
+			float maxScale = 0.f;
+			for(int row = 0; row < 3; ++row)
+			{
+				const float* r = &world[row * 4];
+				maxScale = fmaxf(maxScale, r[0] * r[0] + r[1] * r[1] + r[2] * r[2]);
+			}
+			maxScale = sqrtf(maxScale);
+
+			const Vector4f worldCenter = Vector4f(center.x, center.y, center.z, 1.f) * world;
+			return { Vector3f(worldCenter.x, worldCenter.y, worldCenter.z), radius * maxScale, maxScale };
+		}
+	}; // namespace
+
+	uint32 InstanceBatcher::AddMesh(const InstancedMesh& mesh)
+	{
+		const uint32 index = static_cast<uint32>(m_Meshes.size());
+		BatchedMesh batched;
+		batched.m_BoundsCenter = mesh.m_BoundsCenter;
+		batched.m_BoundsRadius = mesh.m_BoundsRadius;
+		batched.m_FirstLod = static_cast<uint32>(m_Lods.size());
+		batched.m_LodCount = static_cast<uint32>(mesh.m_Lods.Size());
+		m_Meshes.push_back(batched);
+		m_Lods.insert(m_Lods.end(), mesh.m_Lods.begin(), mesh.m_Lods.end());
+		m_FirstBucket.push_back(static_cast<uint32>(m_BucketBatch.size()));
+
+		// a mesh without a LOD chain is still drawn, as its only LOD
+		const uint32 lodCount = mesh.m_Lods.Empty() ? 1 : static_cast<uint32>(mesh.m_Lods.Size());
+		for(uint32 lod = 0; lod < lodCount; ++lod)
+		{
+			InstanceBatch bucket;
+			bucket.m_Mesh = index;
+			bucket.m_Lod = lod;
+			m_BucketBatch.push_back(bucket);
+		}
+		return index;
+	}
+
+	Span<const MeshLod> InstanceBatcher::GetLods(uint32 mesh) const
+	{
+		ASSERT(mesh < m_Meshes.size(), "Unknown mesh");
+		const BatchedMesh& batched = m_Meshes[mesh];
+		return Span<const MeshLod>(m_Lods.data() + batched.m_FirstLod, batched.m_LodCount);
+	}
+
+	uint32 InstanceBatcher::AddInstance(uint32 mesh)
+	{
+		ASSERT(mesh < m_Meshes.size(), "Unknown mesh");
+		m_InstanceMesh.Add(mesh);
+		m_InstanceLod.Add(0);
+		return m_InstanceMesh.Size() - 1;
+	}
+
+	void InstanceBatcher::RemoveCyclicAtIndex(uint32 index)
+	{
+		m_InstanceMesh.RemoveCyclicAtIndex(index);
+		m_InstanceLod.RemoveCyclicAtIndex(index);
+	}
+
+	void InstanceBatcher::Clear()
+	{
+		m_InstanceMesh.Clear();
+		m_InstanceLod.Clear();
+	}
+
+	Span<const InstanceBatch> InstanceBatcher::Build(JobSystem& jobs, const Matrix44f* world, const Frustum& frustum,
+													 const Vector3f& cameraPosition, float lodScale,
+													 Matrix44f* instances)
+	{
+		m_Batches.clear();
+		const uint32 instanceCount = m_InstanceMesh.Size();
+		if(instanceCount == 0)
+			return Span<const InstanceBatch>(m_Batches.data(), 0);
+
+		/*
+			A counting sort over partitions of the instances: every partition classifies its instances and counts
+			them per bucket, the counts turn into the output offset of each partition within each bucket, and then
+			every partition writes its matrices from there. No two threads ever write the same slot and the output
+			is the same whatever the thread count.
+		*/
+		const uint32 bucketCount = static_cast<uint32>(m_BucketBatch.size());
+		const uint32 grain = jobs.GetGrainSize(instanceCount);
+		const uint32 partitionSize = grain > s_MinInstancesPerPartition ? grain : s_MinInstancesPerPartition;
+		const uint32 partitionCount = (instanceCount + partitionSize - 1) / partitionSize;
+		m_InstanceBucket.resize(instanceCount);
+		m_PartitionOffsets.assign(partitionCount * bucketCount, 0);
+
+		jobs.ParallelFor(
+			partitionCount,
+			[&](uint32 begin, uint32 end) {
+				for(uint32 partition = begin; partition < end; ++partition)
+				{
+					uint32* counts = &m_PartitionOffsets[partition * bucketCount];
+					const uint32 first = partition * partitionSize;
+					const uint32 last = first + partitionSize < instanceCount ? first + partitionSize : instanceCount;
+					for(uint32 i = first; i < last; ++i)
+					{
+						const uint32 meshIndex = m_InstanceMesh[i];
+						const BatchedMesh& mesh = m_Meshes[meshIndex];
+						const WorldBounds bounds = TransformBounds(mesh.m_BoundsCenter, mesh.m_BoundsRadius, world[i]);
+						if(!frustum.IsSphereVisible(bounds.m_Center, bounds.m_Radius))
+						{
+							m_InstanceBucket[i] = s_Culled;
+							continue;
+						}
+
+						const float pixelsPerUnit = Mesh::GetPixelsPerUnit(bounds.m_Center, bounds.m_Radius,
+																		   bounds.m_Scale, cameraPosition, lodScale);
+						const Span<const MeshLod> lods(m_Lods.data() + mesh.m_FirstLod, mesh.m_LodCount);
+						const uint32 lod = Mesh::SelectLod(lods, pixelsPerUnit, m_InstanceLod[i]);
+						m_InstanceLod[i] = static_cast<uint8>(lod);
+
+						const uint32 bucket = m_FirstBucket[meshIndex] + lod;
+						m_InstanceBucket[i] = bucket;
+						++counts[bucket];
+					}
+				}
+			},
+			1);
+
+		// bucket major, so a batch's instances are contiguous and come out in instance order
+		uint32 offset = 0;
+		for(uint32 bucket = 0; bucket < bucketCount; ++bucket)
+		{
+			const uint32 bucketStart = offset;
+			for(uint32 partition = 0; partition < partitionCount; ++partition)
+			{
+				uint32& slot = m_PartitionOffsets[partition * bucketCount + bucket];
+				const uint32 count = slot;
+				slot = offset;
+				offset += count;
+			}
+
+			if(offset == bucketStart)
+				continue;
+
+			InstanceBatch batch = m_BucketBatch[bucket];
+			batch.m_FirstInstance = bucketStart;
+			batch.m_InstanceCount = offset - bucketStart;
+			m_Batches.push_back(batch);
+		}
+
+		jobs.ParallelFor(
+			partitionCount,
+			[&](uint32 begin, uint32 end) {
+				for(uint32 partition = begin; partition < end; ++partition)
+				{
+					uint32* next = &m_PartitionOffsets[partition * bucketCount];
+					const uint32 first = partition * partitionSize;
+					const uint32 last = first + partitionSize < instanceCount ? first + partitionSize : instanceCount;
+					for(uint32 i = first; i < last; ++i)
+					{
+						const uint32 bucket = m_InstanceBucket[i];
+						if(bucket != s_Culled)
+							instances[next[bucket]++] = world[i];
+					}
+				}
+			},
+			1);
+
+		return Span<const InstanceBatch>(m_Batches.data(), m_Batches.size());
+	}
+
+}; // namespace Core
@@ -0,0 +1,98 @@
+#pragma once
+#include "core/Types.h"
+#include "core/containers/GrowingArray.h"
+#include "core/containers/Span.h"
+#include "core/math/Frustum.h"
+#include "core/math/Matrix44.h"
+#include "core/math/Vector3.h"
+#include "MeshFormat.h"
+
+#include <vector>
+
+namespace Core
+{
+	class JobSystem;
+
+	// What the batcher needs from a mesh, the bounding sphere is in model space. AddMesh copies m_Lods.
+	struct InstancedMesh
+	{
+		Vector3f m_BoundsCenter;
+		float m_BoundsRadius = 0.f;
+		Span<const MeshLod> m_Lods;
+	};
+
+	// The instances m_FirstInstance to m_FirstInstance + m_InstanceCount of the output all draw m_Lod of m_Mesh.
+	struct InstanceBatch
+	{
+		uint32 m_Mesh = 0;
+		uint32 m_Lod = 0;
+		uint32 m_FirstInstance = 0;
+		uint32 m_InstanceCount = 0;
+	};
+
+	/*
+		Groups the copies of every mesh by LOD, so each group can go out as one instanced draw however many copies
+		there are. Instances are stored densely in the same order as the TransformBatch that holds their transforms,
+		RemoveCyclicAtIndex moves the last instance into the hole the same way.
+	*/
+	class InstanceBatcher
+	{
+	public:
+		InstanceBatcher() = default;
+		// the per instance arrays come from allocator, see GrowingArray
+		explicit InstanceBatcher(IAllocator* allocator)
+			: m_InstanceMesh(0, allocator)
+			, m_InstanceLod(0, allocator)
+		{
+		}
+
+		uint32 AddMesh(const InstancedMesh& mesh);
+		uint32 GetMeshCount() const { return static_cast<uint32>(m_Meshes.size()); }
+		// the batcher's copy of mesh's LOD table, valid until the next AddMesh
+		Span<const MeshLod> GetLods(uint32 mesh) const;
+
+		uint32 AddInstance(uint32 mesh);
+		void RemoveCyclicAtIndex(uint32 index);
+		void Clear();
+
+		uint32 GetInstanceCount() const { return m_InstanceMesh.Size(); }
+		uint32 GetMesh(uint32 instance) const { return m_InstanceMesh[instance]; }
+		uint32 GetLod(uint32 instance) const { return m_InstanceLod[instance]; }
+
+		/*
+			Culls every instance's bounds against frustum and picks its LOD with Mesh::SelectLod, the hysteresis is
+			kept per instance. The world matrices of the visible ones are written to instances, batch after batch
+			and in instance order within one. world and instances hold GetInstanceCount() matrices. Runs on all of
+			jobs' threads, the returned batches are sorted by mesh then LOD and valid until the next Build.
+		*/
+		Span<const InstanceBatch> Build(JobSystem& jobs, const Matrix44f* world, const Frustum& frustum,
+										const Vector3f& cameraPosition, float lodScale, Matrix44f* instances);
+
+	private:
+		// below this the partitions cost more to hand out than to run
+		static constexpr uint32 s_MinInstancesPerPartition = 1024;
+		static constexpr uint32 s_Culled = ~0u;
+
+		struct BatchedMesh
+		{
+			Vector3f m_BoundsCenter;
+			float m_BoundsRadius = 0.f;
+			uint32 m_FirstLod = 0; // into m_Lods
+			uint32 m_LodCount = 0;
+		};
+
+		std::vector<BatchedMesh> m_Meshes;
+		std::vector<MeshLod> m_Lods; // every mesh's LOD table back to back
+		std::vector<uint32> m_FirstBucket; // per mesh, a bucket for each of its LODs follows
+		std::vector<InstanceBatch> m_BucketBatch; // per bucket, only m_Mesh and m_Lod are used
+
+		GrowingArray<uint32> m_InstanceMesh;
+		GrowingArray<uint8> m_InstanceLod; // kept between Builds for the hysteresis
+
+		// Build scratch, kept so a frame doesn't allocate once the scene stops growing
+		std::vector<uint32> m_InstanceBucket;
+		std::vector<uint32> m_PartitionOffsets; // partition major, a count and then an output offset per bucket
+		std::vector<InstanceBatch> m_Batches;
+	};
+
+}; // namespace Core
@@ -0,0 +1,68 @@
+#include "LodSelection.h"
+
+#include <cmath>
+
+namespace Core
+{
+	namespace Mesh
+	{
+		namespace
+		{
+			// keeps the scale finite when the camera is inside the bounds
+			constexpr float s_MinDistance = 1e-3f;
+		};
+
+		float GetLodScale(const Matrix44f& projection, float viewportHeight)
+		{
+			// the y scale of the projection is 1 / tan(fov / 2), the sign only flips the image
+			return fabsf(projection[5]) * viewportHeight * 0.5f;
+		}
+
+		float GetPixelsPerUnit(const Vector3f& center, float radius, const Matrix44f& world,
+							   const Vector3f& cameraPosition, float lodScale)
+		{
+			float maxScale = 0.f;
+			for(int row = 0; row < 3; ++row)
+			{
+				const float* r = &world[row * 4];
+				maxScale = fmaxf(maxScale, sqrtf(r[0] * r[0] + r[1] * r[1] + r[2] * r[2]));
+			}
+
+			const Vector4f worldCenter = Vector4f(center.x, center.y, center.z, 1.f) * world;
+			return GetPixelsPerUnit(Vector3f(worldCenter.x, worldCenter.y, worldCenter.z), radius * maxScale,
+									maxScale, cameraPosition, lodScale);
+		}
+
+		float GetPixelsPerUnit(const Vector3f& worldCenter, float worldRadius, float scale,
+							   const Vector3f& cameraPosition, float lodScale)
+		{
+			Vector3f toCenter = worldCenter - cameraPosition;
+			const float distance = fmaxf(toCenter.Length() - worldRadius, s_MinDistance);
+			return lodScale * scale / distance;
+		}
+
+		uint32 SelectLod(Span<const MeshLod> lods, float pixelsPerUnit, uint32 currentLod, float pixelThreshold,
+						 float hysteresis)
+		{
+			if(lods.Size() == 0)
+				return 0;
+
+			// errors only grow along the chain, the last LOD under each limit wins
+			uint32 allowed = 0;
+			uint32 settled = 0;
+			for(uint32 i = 1; i < lods.Size(); ++i)
+			{
+				const float pixels = lods[i].m_Error * pixelsPerUnit;
+				if(pixels <= pixelThreshold)
+					allowed = i;
+				if(pixels <= pixelThreshold * (1.f - hysteresis))
+					settled = i;
+			}
+
+			if(allowed <= currentLod)
+				return allowed;
+			return currentLod > settled ? currentLod : settled;
+		}
+
+	}; // namespace Mesh
+}; // namespace Core
@@ -0,0 +1,36 @@
+#pragma once
+#include "core/Types.h"
+#include "core/containers/Span.h"
+#include "core/math/Matrix44.h"
+#include "core/math/Vector3.h"
+#include "MeshFormat.h"
+
+namespace Core
+{
+	namespace Mesh
+	{
+		// Pixels one unit covers at distance 1 in front of the camera, for the projection of a viewport this high.
+		float GetLodScale(const Matrix44f& projection, float viewportHeight);
+
+		/*
+			Pixels one model space unit of a mesh covers on screen, for SelectLod. center and radius are the
+			mesh's bounding sphere in model space. Measured at the sphere's nearest point, so inside it the
+			result is as large as it gets and the finest LOD wins.
+		*/
+		float GetPixelsPerUnit(const Vector3f& center, float radius, const Matrix44f& world,
+							   const Vector3f& cameraPosition, float lodScale);
+
+		// The same for bounds already moved to world space, scale is the largest axis scale of the world matrix.
+		float GetPixelsPerUnit(const Vector3f& worldCenter, float worldRadius, float scale,
+							   const Vector3f& cameraPosition, float lodScale);
+
+		/*
+			The coarsest LOD whose error covers at most pixelThreshold pixels. Going coarser than currentLod needs
+			the error to be a further hysteresis fraction below the threshold, so a mesh sitting right at the
+			switching distance doesn't pop back and forth every frame. Going finer happens right away.
+		*/
+		uint32 SelectLod(Span<const MeshLod> lods, float pixelsPerUnit, uint32 currentLod, float pixelThreshold = 1.f,
+						 float hysteresis = 0.25f);
+
+	}; // namespace Mesh
+}; // namespace Core
@@ -0,0 +1,438 @@
+#include "MeshFormat.h"
+#include "Quantize.h"
+#include "core/containers/HashMap.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+namespace Core
+{
+	uint32 GetVertexFormatSize(VertexFormat format)
+	{
+		switch(format)
+		{
+			case VertexFormat::Float4:
+				return 16;
+			case VertexFormat::Half4:
+			case VertexFormat::Snorm16x4:
+				return 8;
+			case VertexFormat::Oct16:
+			case VertexFormat::Unorm8x4:
+				return 4;
+			default:
+				return 0;
+		}
+	}
+
+	namespace Mesh
+	{
+		namespace
+		{
+			uint32 Align(uint32 value, uint32 alignment) { return (value + alignment - 1) & ~(alignment - 1); }
+
+			// which formats make sense for which attribute
+			bool IsSupported(VertexAttribute attribute, VertexFormat format)
+			{
+				switch(attribute)
+				{
+					case VertexAttribute::Position:
+						return format == VertexFormat::Float4 || format == VertexFormat::Half4 ||
+							   format == VertexFormat::Snorm16x4;
+					case VertexAttribute::Normal:
+						return format == VertexFormat::Float4 || format == VertexFormat::Oct16;
+					case VertexAttribute::Color:
+						return format == VertexFormat::Float4 || format == VertexFormat::Unorm8x4;
+					default:
+						return false;
+				}
+			}
+
+			void EncodeAttribute(VertexFormat format, const Vector4f& value, char* out)
+			{
+				switch(format)
+				{
+					case VertexFormat::Float4:
+					{
+						const float values[4] = { value.x, value.y, value.z, value.w };
+						memcpy(out, values, sizeof(values));
+						break;
+					}
+					case VertexFormat::Half4:
+					{
+						const uint16 values[4] = { Quantize::FloatToHalf(value.x), Quantize::FloatToHalf(value.y),
+												   Quantize::FloatToHalf(value.z), Quantize::FloatToHalf(value.w) };
+						memcpy(out, values, sizeof(values));
+						break;
+					}
+					case VertexFormat::Snorm16x4:
+					{
+						const int16 values[4] = { Quantize::ToSnorm16(value.x), Quantize::ToSnorm16(value.y),
+												  Quantize::ToSnorm16(value.z), Quantize::ToSnorm16(value.w) };
+						memcpy(out, values, sizeof(values));
+						break;
+					}
+					case VertexFormat::Oct16:
+					{
+						int16 values[2];
+						Quantize::OctEncode(Vector3f(value.x, value.y, value.z), values);
+						memcpy(out, values, sizeof(values));
+						break;
+					}
+					case VertexFormat::Unorm8x4:
+					{
+						const uint8 values[4] = { Quantize::ToUnorm8(value.x), Quantize::ToUnorm8(value.y),
+												  Quantize::ToUnorm8(value.z), Quantize::ToUnorm8(value.w) };
+						memcpy(out, values, sizeof(values));
+						break;
+					}
+				}
+			}
+
+			Vector4f DecodeAttribute(VertexFormat format, const char* data)
+			{
+				switch(format)
+				{
+					case VertexFormat::Float4:
+					{
+						float values[4];
+						memcpy(values, data, sizeof(values));
+						return Vector4f(values[0], values[1], values[2], values[3]);
+					}
+					case VertexFormat::Half4:
+					{
+						uint16 values[4];
+						memcpy(values, data, sizeof(values));
+						return Vector4f(Quantize::HalfToFloat(values[0]), Quantize::HalfToFloat(values[1]),
+										Quantize::HalfToFloat(values[2]), Quantize::HalfToFloat(values[3]));
+					}
+					case VertexFormat::Snorm16x4:
+					{
+						int16 values[4];
+						memcpy(values, data, sizeof(values));
+						return Vector4f(Quantize::FromSnorm16(values[0]), Quantize::FromSnorm16(values[1]),
+										Quantize::FromSnorm16(values[2]), Quantize::FromSnorm16(values[3]));
+					}
+					case VertexFormat::Oct16:
+					{
+						int16 values[2];
+						memcpy(values, data, sizeof(values));
+						const Vector3f normal = Quantize::OctDecode(values);
+						return Vector4f(normal.x, normal.y, normal.z, 0.f);
+					}
+					case VertexFormat::Unorm8x4:
+					{
+						uint8 values[4];
+						memcpy(values, data, sizeof(values));
+						return Vector4f(Quantize::FromUnorm8(values[0]), Quantize::FromUnorm8(values[1]),
+										Quantize::FromUnorm8(values[2]), Quantize::FromUnorm8(values[3]));
+					}
+					default:
+						return Vector4f(0.f, 0.f, 0.f, 0.f);
+				}
+			}
+
+			uint64 HashBytes(const char* data, uint32 size)
+			{
+				uint64 hash = 14695981039346656037ull;
+				for(uint32 i = 0; i < size; ++i)
+					hash = (hash ^ static_cast<uint8>(data[i])) * 1099511628211ull;
+				return hash;
+			}
+		}; // namespace
+
+		std::vector<char> Encode(const MeshVertex* vertices, uint32 count) { return Encode(vertices, count, {}); }
+
+		std::vector<char> Encode(const MeshVertex* vertices, uint32 count, const EncodeOptions& options)
+		{
+			const VertexFormat formats[] = { options.m_Position, options.m_Normal, options.m_Color };
+			MeshHeader header = {};
+			header.m_Magic = s_Magic;
+			header.m_Version = s_Version;
+			header.m_AttributeCount = static_cast<uint8>(VertexAttribute::Count);
+			for(uint8 i = 0; i < header.m_AttributeCount; ++i)
+			{
+				if(!IsSupported(static_cast<VertexAttribute>(i), formats[i]))
+					return std::vector<char>();
+
+				header.m_Attributes[i].m_Attribute = static_cast<VertexAttribute>(i);
+				header.m_Attributes[i].m_Format = formats[i];
+				header.m_Attributes[i].m_Offset = static_cast<uint16>(header.m_VertexStride);
+				header.m_VertexStride += GetVertexFormatSize(formats[i]);
+			}
+			header.m_VertexStride = Align(header.m_VertexStride, 4);
+
+			float low[3] = { 0.f, 0.f, 0.f };
+			float high[3] = { 0.f, 0.f, 0.f };
+			for(uint32 i = 0; i < count; ++i)
+			{
+				const Vector4f& vertex = vertices[i].position;
+				const float position[3] = { vertex.x, vertex.y, vertex.z };
+				for(int axis = 0; axis < 3; ++axis)
+				{
+					low[axis] = i == 0 || position[axis] < low[axis] ? position[axis] : low[axis];
+					high[axis] = i == 0 || position[axis] > high[axis] ? position[axis] : high[axis];
+				}
+			}
+
+			// snorm positions use the whole range inside the bounds, the other formats store model space as is
+			float center[3] = { 0.f, 0.f, 0.f };
+			float extent[3] = { 1.f, 1.f, 1.f };
+			for(int axis = 0; axis < 3; ++axis)
+			{
+				header.m_BoundsCenter[axis] = (low[axis] + high[axis]) * 0.5f;
+				if(options.m_Position == VertexFormat::Snorm16x4)
+				{
+					center[axis] = header.m_BoundsCenter[axis];
+					const float half = (high[axis] - low[axis]) * 0.5f;
+					extent[axis] = half > 0.f ? half : 1.f;
+				}
+			}
+			memcpy(header.m_PositionCenter, center, sizeof(center));
+			memcpy(header.m_PositionExtent, extent, sizeof(extent));
+
+			for(uint32 i = 0; i < count; ++i)
+			{
+				const Vector4f& vertex = vertices[i].position;
+				Vector3f offset(vertex.x - header.m_BoundsCenter[0], vertex.y - header.m_BoundsCenter[1],
+								vertex.z - header.m_BoundsCenter[2]);
+				header.m_BoundsRadius = fmaxf(header.m_BoundsRadius, offset.Length());
+			}
+
+			// quantize, then weld on the quantized bytes so vertices that only differed below the precision merge
+			std::vector<char> unique;
+			std::vector<uint32> indices(count);
+			HashMap<uint64, uint32> firstWithHash(count);
+			std::vector<char> packed(header.m_VertexStride, 0);
+			for(uint32 i = 0; i < count; ++i)
+			{
+				const MeshVertex& vertex = vertices[i];
+				Vector4f position = vertex.position;
+				if(options.m_Position == VertexFormat::Snorm16x4)
+				{
+					position = Vector4f((position.x - center[0]) / extent[0], (position.y - center[1]) / extent[1],
+										(position.z - center[2]) / extent[2], 1.f);
+				}
+
+				EncodeAttribute(formats[0], position, &packed[header.m_Attributes[0].m_Offset]);
+				EncodeAttribute(formats[1], vertex.normal, &packed[header.m_Attributes[1].m_Offset]);
+				EncodeAttribute(formats[2], vertex.color, &packed[header.m_Attributes[2].m_Offset]);
+
+				// a hash collision only costs a missed weld
+				const uint64 hash = HashBytes(packed.data(), header.m_VertexStride);
+				const uint32* existing = firstWithHash.Find(hash);
+				if(existing &&
+				   memcmp(&unique[*existing * header.m_VertexStride], packed.data(), header.m_VertexStride) == 0)
+				{
+					indices[i] = *existing;
+					continue;
+				}
+
+				const uint32 index = static_cast<uint32>(unique.size() / header.m_VertexStride);
+				if(!existing)
+					firstWithHash.Insert(hash, index);
+				unique.insert(unique.end(), packed.begin(), packed.end());
+				indices[i] = index;
+			}
+
+			header.m_VertexCount = static_cast<uint32>(unique.size() / header.m_VertexStride);
+			header.m_IndexCount = count;
+			header.m_IndexSize = header.m_VertexCount <= 0x10000 ? 2 : 4;
+			header.m_VertexOffset = Align(sizeof(MeshHeader), 16);
+			header.m_IndexOffset = Align(header.m_VertexOffset + static_cast<uint32>(unique.size()), 4);
+			header.m_LodCount = 1;
+			header.m_Lods[0].m_IndexCount = count;
+
+			std::vector<char> file(header.m_IndexOffset + header.m_IndexCount * header.m_IndexSize, 0);
+			memcpy(file.data(), &header, sizeof(header));
+			if(!unique.empty())
+				memcpy(&file[header.m_VertexOffset], unique.data(), unique.size());
+
+			for(uint32 i = 0; i < count; ++i)
+			{
+				char* out = &file[header.m_IndexOffset + i * header.m_IndexSize];
+				if(header.m_IndexSize == 2)
+				{
+					const uint16 index = static_cast<uint16>(indices[i]);
+					memcpy(out, &index, sizeof(index));
+				}
+				else
+					memcpy(out, &indices[i], sizeof(uint32));
+			}
+			return file;
+		}
+
+		ParseResult MeshView::Parse(Span<const char> data)
+		{
+			*this = MeshView();
+
+			// the magic and version come first in every version of the header, whatever its size
+			uint32 magic = 0;
+			if(data.Size() >= sizeof(magic))
+				memcpy(&magic, data.GetData(), sizeof(magic));
+			if(magic != s_Magic)
+				return ParseResult::NotAMesh;
+
+			uint16 version = 0;
+			if(data.Size() < offsetof(MeshHeader, m_Version) + sizeof(version))
+				return ParseResult::Corrupt;
+			memcpy(&version, data.GetData() + offsetof(MeshHeader, m_Version), sizeof(version));
+			if(version != s_Version)
+				return ParseResult::WrongVersion;
+
+			if(data.Size() < sizeof(MeshHeader))
+				return ParseResult::Corrupt;
+
+			MeshHeader header;
+			memcpy(&header, data.GetData(), sizeof(header));
+			if((header.m_IndexSize != 2 && header.m_IndexSize != 4) || header.m_AttributeCount > 4 ||
+			   header.m_VertexStride == 0)
+				return ParseResult::Corrupt;
+
+			for(uint8 i = 0; i < header.m_AttributeCount; ++i)
+			{
+				const MeshAttribute& attribute = header.m_Attributes[i];
+				const uint32 size = GetVertexFormatSize(attribute.m_Format);
+				if(size == 0 || attribute.m_Offset + size > header.m_VertexStride ||
+				   !IsSupported(attribute.m_Attribute, attribute.m_Format))
+					return ParseResult::Corrupt;
+			}
+
+			const uint64 vertexBytes = uint64(header.m_VertexCount) * header.m_VertexStride;
+			const uint64 indexBytes = uint64(header.m_IndexCount) * header.m_IndexSize;
+			if(header.m_VertexOffset + vertexBytes > data.Size() || header.m_IndexOffset + indexBytes > data.Size())
+				return ParseResult::Corrupt;
+
+			// LOD 0 starts the index buffer, the meshlets index into it
+			if(header.m_LodCount == 0 || header.m_LodCount > s_MaxLods || header.m_Lods[0].m_IndexOffset != 0)
+				return ParseResult::Corrupt;
+			for(uint32 i = 0; i < header.m_LodCount; ++i)
+			{
+				const MeshLod& lod = header.m_Lods[i];
+				if(lod.m_IndexCount % 3 != 0 || uint64(lod.m_IndexOffset) + lod.m_IndexCount > header.m_IndexCount)
+					return ParseResult::Corrupt;
+			}
+
+			const uint64 meshletBytes = uint64(header.m_MeshletCount) * sizeof(Meshlet);
+			const uint64 meshletVertexBytes = uint64(header.m_MeshletVertexCount) * sizeof(uint32);
+			const uint64 meshletTriangleBytes = uint64(header.m_MeshletTriangleCount) * 3;
+			if(header.m_MeshletCount > 0 &&
+			   (header.m_MeshletOffset % 4 != 0 ||
+				header.m_MeshletOffset + meshletBytes + meshletVertexBytes + meshletTriangleBytes > data.Size()))
+				return ParseResult::Corrupt;
+
+			m_Header = header;
+			m_Vertices = data.SubSpan(header.m_VertexOffset, vertexBytes);
+			m_Indices = data.SubSpan(header.m_IndexOffset, indexBytes);
+			if(header.m_MeshletCount > 0)
+			{
+				const char* meshlets = data.GetData() + header.m_MeshletOffset;
+				m_Meshlets = Span<const Meshlet>(reinterpret_cast<const Meshlet*>(meshlets), header.m_MeshletCount);
+				m_MeshletVertices = Span<const uint32>(reinterpret_cast<const uint32*>(meshlets + meshletBytes),
+													   header.m_MeshletVertexCount);
+				m_MeshletTriangles =
+					Span<const uint8>(reinterpret_cast<const uint8*>(meshlets + meshletBytes + meshletVertexBytes),
+									  header.m_MeshletTriangleCount * 3);
+			}
+
+			// the GPU doesn't check, a bad index would read outside the vertex buffer
+			if(!ValidateIndices())
+			{
+				*this = MeshView();
+				return ParseResult::Corrupt;
+			}
+			return ParseResult::Ok;
+		}
+
+		bool MeshView::ValidateIndices() const
+		{
+			for(uint32 i = 0; i < m_Header.m_IndexCount; ++i)
+			{
+				if(GetIndex(i) >= m_Header.m_VertexCount)
+					return false;
+			}
+
+			for(const Meshlet& meshlet : m_Meshlets)
+			{
+				if(meshlet.m_VertexCount > s_MaxMeshletVertices || meshlet.m_TriangleCount > s_MaxMeshletTriangles ||
+				   uint64(meshlet.m_VertexOffset) + meshlet.m_VertexCount > m_MeshletVertices.Size() ||
+				   (uint64(meshlet.m_TriangleOffset) + meshlet.m_TriangleCount) * 3 > m_MeshletTriangles.Size() ||
+				   (uint64(meshlet.m_TriangleOffset) + meshlet.m_TriangleCount) * 3 > m_Header.m_Lods[0].m_IndexCount)
+					return false;
+
+				for(uint32 i = 0; i < meshlet.m_VertexCount; ++i)
+				{
+					if(m_MeshletVertices[meshlet.m_VertexOffset + i] >= m_Header.m_VertexCount)
+						return false;
+				}
+
+				for(uint32 i = 0; i < meshlet.m_TriangleCount * 3u; ++i)
+				{
+					if(m_MeshletTriangles[meshlet.m_TriangleOffset * 3 + i] >= meshlet.m_VertexCount)
+						return false;
+				}
+			}
+			return true;
+		}
+
+		const MeshAttribute* MeshView::FindAttribute(VertexAttribute attribute) const
+		{
+			for(uint8 i = 0; i < m_Header.m_AttributeCount; ++i)
+			{
+				if(m_Header.m_Attributes[i].m_Attribute == attribute)
+					return &m_Header.m_Attributes[i];
+			}
+			return nullptr;
+		}
+
+		MeshVertex MeshView::DecodeVertex(uint32 index) const
+		{
+			MeshVertex vertex;
+			vertex.position = Vector4f(0.f, 0.f, 0.f, 1.f);
+			vertex.color = Vector4f(1.f, 1.f, 1.f, 1.f);
+			vertex.normal = Vector4f(0.f, 0.f, 1.f, 0.f);
+
+			const char* data = &m_Vertices[index * m_Header.m_VertexStride];
+			for(uint8 i = 0; i < m_Header.m_AttributeCount; ++i)
+			{
+				const MeshAttribute& attribute = m_Header.m_Attributes[i];
+				const Vector4f value = DecodeAttribute(attribute.m_Format, &data[attribute.m_Offset]);
+				if(attribute.m_Attribute == VertexAttribute::Position)
+					vertex.position = value * GetDequantizeMatrix();
+				else if(attribute.m_Attribute == VertexAttribute::Normal)
+					vertex.normal = value;
+				else if(attribute.m_Attribute == VertexAttribute::Color)
+					vertex.color = value;
+			}
+			return vertex;
+		}
+
+		uint32 MeshView::GetIndex(uint32 index) const
+		{
+			if(m_Header.m_IndexSize == 2)
+			{
+				uint16 value;
+				memcpy(&value, &m_Indices[index * 2], sizeof(value));
+				return value;
+			}
+
+			uint32 value;
+			memcpy(&value, &m_Indices[index * 4], sizeof(value));
+			return value;
+		}
+
+		Matrix44f MeshView::GetDequantizeMatrix() const
+		{
+			const MeshAttribute* position = FindAttribute(VertexAttribute::Position);
+			if(!position || position->m_Format != VertexFormat::Snorm16x4)
+				return Matrix44f::CreateScaleMatrix(1.f, 1.f, 1.f, 1.f);
+
+			const float* extent = m_Header.m_PositionExtent;
+			Matrix44f dequantize = Matrix44f::CreateScaleMatrix(extent[0], extent[1], extent[2], 1.f);
+			dequantize.SetTranslation(m_Header.m_PositionCenter[0], m_Header.m_PositionCenter[1],
+									  m_Header.m_PositionCenter[2], 1.f);
+			return dequantize;
+		}
+
+	}; // namespace Mesh
+}; // namespace Core
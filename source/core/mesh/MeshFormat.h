@@ -0,0 +1,186 @@
+#pragma once
+#include "core/Types.h"
+#include "core/containers/Span.h"
+#include "core/math/Matrix44.h"
+#include "core/math/Vector4.h"
+
+#include <vector>
+
+namespace Core
+{
+	enum class VertexAttribute : uint8
+	{
+		Position,
+		Normal,
+		Color,
+		Count
+	};
+
+	// How an attribute is stored, each one maps to a single VkFormat (see graphics/VertexLayout.h).
+	enum class VertexFormat : uint8
+	{
+		Float4,	   // 16 bytes, R32G32B32A32_SFLOAT
+		Half4,	   // 8 bytes, R16G16B16A16_SFLOAT
+		Snorm16x4, // 8 bytes, R16G16B16A16_SNORM, positions are rescaled by the mesh bounds
+		Oct16,	   // 4 bytes, R16G16_SNORM octahedral unit vector
+		Unorm8x4,  // 4 bytes, R8G8B8A8_UNORM
+	};
+
+	uint32 GetVertexFormatSize(VertexFormat format);
+
+	struct MeshAttribute
+	{
+		VertexAttribute m_Attribute;
+		VertexFormat m_Format;
+		uint16 m_Offset;
+	};
+
+	// A range of the index buffer drawing the whole mesh at one level of detail.
+	struct MeshLod
+	{
+		uint32 m_IndexOffset;
+		uint32 m_IndexCount;
+		float m_Error; // how far the surface is from LOD 0 at most, in model space units, 0 for LOD 0 itself
+	};
+
+	/*
+		.mesh layout, little endian:
+			MeshHeader
+			vertices	at m_VertexOffset, m_VertexCount * m_VertexStride bytes, interleaved
+			indices		at m_IndexOffset, m_IndexCount uint16 or uint32 depending on m_IndexSize, every LOD's
+						triangles one after the other starting with LOD 0, all of them use the same vertices
+			meshlets	at m_MeshletOffset, optional (m_MeshletCount == 0 without):
+						m_MeshletCount Meshlet
+						m_MeshletVertexCount uint32, mesh vertex indices
+						m_MeshletTriangleCount * 3 uint8, indices into the meshlet's vertices
+
+		Snorm16 positions are stored relative to the bounds, position = stored * m_PositionExtent + m_PositionCenter.
+		GetDequantizeMatrix folds that into the world matrix so shaders never see it. Meshlets only cover LOD 0.
+	*/
+	struct MeshHeader
+	{
+		uint32 m_Magic;
+		uint16 m_Version;
+		uint8 m_IndexSize;
+		uint8 m_AttributeCount;
+		uint32 m_VertexCount;
+		uint32 m_IndexCount;
+		uint32 m_VertexStride;
+		uint32 m_VertexOffset;
+		uint32 m_IndexOffset;
+		uint32 m_MeshletCount;
+		float m_PositionCenter[3];
+		float m_PositionExtent[3];
+		MeshAttribute m_Attributes[4]; // the first m_AttributeCount are used
+		uint32 m_MeshletOffset;
+		uint32 m_MeshletVertexCount;
+		uint32 m_MeshletTriangleCount;
+		uint32 m_LodCount;
+		MeshLod m_Lods[8];		 // the first m_LodCount are used, finest first
+		float m_BoundsCenter[3]; // sphere around every vertex, model space
+		float m_BoundsRadius;
+	};
+
+	static_assert(sizeof(MeshHeader) == 200, "MeshHeader is part of the file format");
+
+	/*
+		A cluster of at most 64 vertices and 124 triangles, small enough for one mesh shader workgroup. The index
+		buffer is stored in meshlet order too, so triangles [m_TriangleOffset, m_TriangleOffset + m_TriangleCount) of
+		it are this meshlet and a plain indexed draw can skip the culled ones. Bounds are in model space.
+	*/
+	struct Meshlet
+	{
+		uint32 m_VertexOffset;	 // first entry in the meshlet vertex table
+		uint32 m_TriangleOffset; // first triangle, in the meshlet triangle table and in the index buffer
+		uint16 m_VertexCount;
+		uint16 m_TriangleCount;
+		float m_Center[3];
+		float m_Radius;
+		float m_ConeAxis[3];
+		float m_ConeCutoff; // sin of the cone's half angle, 1 when the normals spread too far to ever cull
+	};
+
+	static_assert(sizeof(Meshlet) == 44, "Meshlet is part of the file format");
+
+	// The vertex layout of the old .mdl files, three float4 per vertex and no indices.
+	struct MeshVertex
+	{
+		Vector4f position;
+		Vector4f color;
+		Vector4f normal;
+	};
+
+	namespace Mesh
+	{
+		static constexpr uint32 s_Magic = 'M' | ('S' << 8) | ('H' << 16) | ('1' << 24);
+		// Bumped on every layout change while the magic stays the same, so Parse reports an older file as
+		// WrongVersion and it gets cooked again instead of being taken for a legacy .mdl.
+		static constexpr uint16 s_Version = 3;
+		static constexpr uint32 s_MaxMeshletVertices = 64;
+		static constexpr uint32 s_MaxMeshletTriangles = 124;
+		static constexpr uint32 s_MaxLods = 8;
+
+		struct EncodeOptions
+		{
+			VertexFormat m_Position = VertexFormat::Snorm16x4; // or Half4 / Float4
+			VertexFormat m_Normal = VertexFormat::Oct16;	   // or Float4
+			VertexFormat m_Color = VertexFormat::Unorm8x4;	   // or Float4
+		};
+
+		/*
+			Quantizes the vertices, welds the ones that end up identical and builds the index buffer, 16 bit indices
+			when the vertex count allows. Returns the whole .mesh file with a single LOD and without meshlets, see
+			MeshSimplifier::AddLods and AddMeshlets.
+		*/
+		std::vector<char> Encode(const MeshVertex* vertices, uint32 count, const EncodeOptions& options);
+		std::vector<char> Encode(const MeshVertex* vertices, uint32 count);
+
+		enum class ParseResult : uint8
+		{
+			Ok,
+			NotAMesh,	  // no magic, e.g. a legacy .mdl
+			WrongVersion, // a .mesh cooked for another version of the format, it has to be cooked again
+			Corrupt,	  // the magic and version match but the header or the data it points at don't
+		};
+
+		/*
+			Read only access to a .mesh in memory, Parse checks that everything the header points at is inside data.
+			Nothing is copied, the view is only valid as long as the data it was parsed from. The view is left empty
+			unless Parse returns Ok.
+		*/
+		class MeshView
+		{
+		public:
+			ParseResult Parse(Span<const char> data);
+
+			const MeshHeader& GetHeader() const { return m_Header; }
+			Span<const char> GetVertexData() const { return m_Vertices; }
+			Span<const char> GetIndexData() const { return m_Indices; }
+			const MeshAttribute* FindAttribute(VertexAttribute attribute) const;
+			Span<const MeshLod> GetLods() const { return Span<const MeshLod>(m_Header.m_Lods, m_Header.m_LodCount); }
+
+			// empty when the mesh was cooked without meshlets
+			Span<const Meshlet> GetMeshlets() const { return m_Meshlets; }
+			Span<const uint32> GetMeshletVertices() const { return m_MeshletVertices; }
+			Span<const uint8> GetMeshletTriangles() const { return m_MeshletTriangles; }
+
+			// Back to floats, for tools and tests. Positions come out in model space.
+			MeshVertex DecodeVertex(uint32 index) const;
+			uint32 GetIndex(uint32 index) const;
+
+			// Snorm16 positions to model space, row vector convention like the rest of the math.
+			Matrix44f GetDequantizeMatrix() const;
+
+		private:
+			bool ValidateIndices() const;
+
+			MeshHeader m_Header = {};
+			Span<const char> m_Vertices;
+			Span<const char> m_Indices;
+			Span<const Meshlet> m_Meshlets;
+			Span<const uint32> m_MeshletVertices;
+			Span<const uint8> m_MeshletTriangles;
+		};
+
+	}; // namespace Mesh
+}; // namespace Core
@@ -0,0 +1,455 @@
+#include "MeshOptimizer.h"
+#include "MeshFormat.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Core
+{
+	namespace MeshOptimizer
+	{
+		namespace
+		{
+			// FIFO cache, m_Time is when each vertex last went in
+			struct FifoCache
+			{
+				FifoCache(uint32 vertexCount, uint32 size)
+					: m_Time(vertexCount, 0)
+					, m_Size(size)
+				{
+				}
+
+				// returns true on a miss
+				bool Touch(uint32 vertex)
+				{
+					if(m_Time[vertex] != 0 && m_Now - m_Time[vertex] < m_Size)
+						return false;
+					m_Time[vertex] = ++m_Now;
+					return true;
+				}
+
+				void Reset() { m_Now += m_Size + 1; }
+
+				std::vector<uint32> m_Time;
+				uint32 m_Size;
+				uint32 m_Now = 0;
+			};
+
+			// Forsyth's tuned constants, the scoring cache is larger than the hardware one on purpose
+			constexpr int32 s_ScoreCacheSize = 32;
+			constexpr float s_CacheDecayPower = 1.5f;
+			constexpr float s_LastTriangleScore = 0.75f;
+			constexpr float s_ValenceBoostScale = 2.f;
+			constexpr float s_ValenceBoostPower = 0.5f;
+
+			float VertexScore(int32 cachePosition, uint32 remainingTriangles)
+			{
+				if(remainingTriangles == 0)
+					return -1.f;
+
+				float score = 0.f;
+				if(cachePosition >= 0)
+				{
+					// the three of the last triangle get a fixed score so the next one doesn't just reuse them
+					if(cachePosition < 3)
+						score = s_LastTriangleScore;
+					else
+					{
+						const float scaler = 1.f / (s_ScoreCacheSize - 3);
+						score = powf(1.f - (cachePosition - 3) * scaler, s_CacheDecayPower);
+					}
+				}
+
+				// vertices with few triangles left are finished first so they leave the cache for good
+				return score + s_ValenceBoostScale * powf(static_cast<float>(remainingTriangles), -s_ValenceBoostPower);
+			}
+
+			uint32 CountMisses(const uint32* indices, uint32 begin, uint32 end, FifoCache& cache)
+			{
+				uint32 misses = 0;
+				for(uint32 i = begin; i < end; ++i)
+					misses += cache.Touch(indices[i]) ? 1 : 0;
+				return misses;
+			}
+		};
+
+		CacheStats AnalyzeVertexCache(const uint32* indices, uint32 indexCount, uint32 vertexCount, uint32 cacheSize)
+		{
+			CacheStats stats;
+			if(indexCount < 3 || vertexCount == 0)
+				return stats;
+
+			FifoCache cache(vertexCount, cacheSize);
+			std::vector<bool> referenced(vertexCount, false);
+			uint32 referencedCount = 0;
+			for(uint32 i = 0; i < indexCount; ++i)
+			{
+				stats.m_Misses += cache.Touch(indices[i]) ? 1 : 0;
+				if(!referenced[indices[i]])
+				{
+					referenced[indices[i]] = true;
+					++referencedCount;
+				}
+			}
+
+			stats.m_Acmr = static_cast<float>(stats.m_Misses) / (indexCount / 3);
+			stats.m_Atvr = static_cast<float>(stats.m_Misses) / referencedCount;
+			return stats;
+		}
+
+		float AnalyzeVertexFetch(const uint32* indices, uint32 indexCount, uint32 vertexCount, uint32 vertexStride)
+		{
+			constexpr uint32 lineSize = 64;
+			constexpr uint32 lineCount = 128; // an 8 KB cache in front of the vertex buffer
+			if(indexCount == 0 || vertexStride == 0)
+				return 0.f;
+
+			const uint64 bufferSize = uint64(vertexCount) * vertexStride;
+			FifoCache lines(static_cast<uint32>((bufferSize + lineSize - 1) / lineSize), lineCount);
+			std::vector<bool> referenced(vertexCount, false);
+			uint64 fetched = 0;
+			uint64 needed = 0;
+			for(uint32 i = 0; i < indexCount; ++i)
+			{
+				const uint32 vertex = indices[i];
+				if(!referenced[vertex])
+				{
+					referenced[vertex] = true;
+					needed += vertexStride;
+				}
+
+				const uint64 begin = uint64(vertex) * vertexStride;
+				for(uint64 line = begin / lineSize; line <= (begin + vertexStride - 1) / lineSize; ++line)
+					fetched += lines.Touch(static_cast<uint32>(line)) ? lineSize : 0;
+			}
+			return static_cast<float>(static_cast<double>(fetched) / needed);
+		}
+
+		void OptimizeVertexCache(uint32* indices, uint32 indexCount, uint32 vertexCount)
+		{
+			const uint32 triangleCount = indexCount / 3;
+			if(triangleCount == 0)
+				return;
+
+			// triangles of each vertex, packed
+			std::vector<uint32> remaining(vertexCount, 0);
+			for(uint32 i = 0; i < triangleCount * 3; ++i)
+				++remaining[indices[i]];
+
+			std::vector<uint32> firstTriangle(vertexCount + 1, 0);
+			for(uint32 v = 0; v < vertexCount; ++v)
+				firstTriangle[v + 1] = firstTriangle[v] + remaining[v];
+
+			std::vector<uint32> vertexTriangles(triangleCount * 3);
+			std::vector<uint32> fill(firstTriangle.begin(), firstTriangle.end() - 1);
+			for(uint32 t = 0; t < triangleCount; ++t)
+			{
+				for(uint32 k = 0; k < 3; ++k)
+					vertexTriangles[fill[indices[t * 3 + k]]++] = t;
+			}
+
+			std::vector<float> vertexScore(vertexCount);
+			for(uint32 v = 0; v < vertexCount; ++v)
+				vertexScore[v] = VertexScore(-1, remaining[v]);
+
+			std::vector<float> triangleScore(triangleCount);
+			for(uint32 t = 0; t < triangleCount; ++t)
+			{
+				triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] +
+								   vertexScore[indices[t * 3 + 2]];
+			}
+
+			std::vector<bool> emitted(triangleCount, false);
+			std::vector<uint32> output;
+			output.reserve(triangleCount * 3);
+
+			// the cache holds up to s_ScoreCacheSize vertices plus the three being added
+			uint32 cache[s_ScoreCacheSize + 3];
+			uint32 cacheCount = 0;
+			uint32 newCache[s_ScoreCacheSize + 3];
+
+			uint32 cursor = 0; // everything before has been emitted, where the fallback search starts
+			int64 best = -1;
+			while(output.size() < triangleCount * 3)
+			{
+				if(best < 0)
+				{
+					// nothing in the cache has triangles left, take the next one in input order
+					while(emitted[cursor])
+						++cursor;
+					best = cursor;
+				}
+
+				const uint32 triangle = static_cast<uint32>(best);
+				emitted[triangle] = true;
+				const uint32* corners = &indices[triangle * 3];
+
+				// the triangle goes to the front of the LRU cache, everything else moves back
+				uint32 newCount = 0;
+				for(uint32 k = 0; k < 3; ++k)
+				{
+					const uint32 vertex = corners[k];
+					output.push_back(vertex);
+					newCache[newCount++] = vertex;
+
+					// this triangle is done, take it out of the vertex's list
+					uint32* begin = &vertexTriangles[firstTriangle[vertex]];
+					uint32* end = begin + remaining[vertex];
+					*std::find(begin, end, triangle) = end[-1];
+					--remaining[vertex];
+				}
+
+				for(uint32 i = 0; i < cacheCount; ++i)
+				{
+					const uint32 vertex = cache[i];
+					if(vertex != corners[0] && vertex != corners[1] && vertex != corners[2])
+						newCache[newCount++] = vertex;
+				}
+
+				cacheCount = newCount < s_ScoreCacheSize ? newCount : s_ScoreCacheSize;
+				memcpy(cache, newCache, cacheCount * sizeof(uint32));
+
+				// rescore what is in the cache and pick the best triangle touching it
+				float bestScore = -1.f;
+				best = -1;
+				for(uint32 i = 0; i < newCount; ++i)
+				{
+					const uint32 vertex = newCache[i];
+					const int32 position = i < cacheCount ? static_cast<int32>(i) : -1; // past the end fell out
+
+					const float score = VertexScore(position, remaining[vertex]);
+					const float delta = score - vertexScore[vertex];
+					vertexScore[vertex] = score;
+
+					const uint32* triangles = &vertexTriangles[firstTriangle[vertex]];
+					for(uint32 j = 0; j < remaining[vertex]; ++j)
+					{
+						const uint32 t = triangles[j];
+						triangleScore[t] += delta;
+						if(i < cacheCount && triangleScore[t] > bestScore)
+						{
+							bestScore = triangleScore[t];
+							best = t;
+						}
+					}
+				}
+			}
+
+			memcpy(indices, output.data(), output.size() * sizeof(uint32));
+		}
+
+		void OptimizeOverdraw(uint32* indices, uint32 indexCount, const Vector3f* positions, uint32 vertexCount,
+							  float threshold)
+		{
+			const uint32 triangleCount = indexCount / 3;
+			if(triangleCount == 0)
+				return;
+
+			// hard boundaries, where the cache optimised order starts over and all three vertices miss
+			std::vector<uint32> hard;
+			FifoCache cache(vertexCount, 16);
+			for(uint32 t = 0; t < triangleCount; ++t)
+			{
+				if(CountMisses(indices, t * 3, t * 3 + 3, cache) == 3)
+					hard.push_back(t);
+			}
+			hard.push_back(triangleCount);
+			if(hard.front() != 0)
+				hard.insert(hard.begin(), 0);
+
+			/*
+				Soft boundaries split the hard clusters further, wherever restarting the cache costs less than
+				threshold. Smaller clusters sort better but every split costs a few extra misses.
+			*/
+			std::vector<uint32> clusters;
+			for(size_t c = 0; c + 1 < hard.size(); ++c)
+			{
+				const uint32 begin = hard[c];
+				const uint32 end = hard[c + 1];
+				cache.Reset();
+				const float clusterAcmr =
+					static_cast<float>(CountMisses(indices, begin * 3, end * 3, cache)) / (end - begin);
+
+				clusters.push_back(begin);
+				cache.Reset();
+				uint32 misses = 0;
+				uint32 start = begin;
+				for(uint32 t = begin; t < end; ++t)
+				{
+					misses += CountMisses(indices, t * 3, t * 3 + 3, cache);
+					const float acmr = static_cast<float>(misses) / (t + 1 - start);
+					if(t + 1 < end && acmr <= clusterAcmr * threshold)
+					{
+						clusters.push_back(t + 1);
+						start = t + 1;
+						misses = 0;
+						cache.Reset();
+					}
+				}
+			}
+			clusters.push_back(triangleCount);
+
+			// the mesh centre, area weighted so a dense patch doesn't drag it
+			Vector3f meshCenter(0.f, 0.f, 0.f);
+			float meshArea = 0.f;
+			for(uint32 t = 0; t < triangleCount; ++t)
+			{
+				const Vector3f& a = positions[indices[t * 3]];
+				const Vector3f& b = positions[indices[t * 3 + 1]];
+				const Vector3f& c = positions[indices[t * 3 + 2]];
+				Vector3f normal = Cross(b - a, c - a);
+				const float area = normal.Length();
+				meshCenter += (a + b + c) * (area / 3.f);
+				meshArea += area;
+			}
+			if(meshArea > 0.f)
+				meshCenter /= meshArea;
+
+			// clusters whose surface faces away from the centre are likely in front, draw those first
+			struct Cluster
+			{
+				uint32 m_Begin;
+				uint32 m_End;
+				float m_Key;
+			};
+
+			std::vector<Cluster> sorted;
+			sorted.reserve(clusters.size() - 1);
+			for(size_t c = 0; c + 1 < clusters.size(); ++c)
+			{
+				Vector3f center(0.f, 0.f, 0.f);
+				Vector3f normal(0.f, 0.f, 0.f);
+				float area = 0.f;
+				for(uint32 t = clusters[c]; t < clusters[c + 1]; ++t)
+				{
+					const Vector3f& a = positions[indices[t * 3]];
+					const Vector3f& b = positions[indices[t * 3 + 1]];
+					const Vector3f& v = positions[indices[t * 3 + 2]];
+					Vector3f faceNormal = Cross(b - a, v - a);
+					const float faceArea = faceNormal.Length();
+					center += (a + b + v) * (faceArea / 3.f);
+					normal += faceNormal;
+					area += faceArea;
+				}
+
+				float key = 0.f;
+				const float normalLength = normal.Length();
+				if(area > 0.f && normalLength > 0.f)
+					key = Dot(center / area - meshCenter, normal / normalLength);
+				sorted.push_back({ clusters[c], clusters[c + 1], key });
+			}
+
+			std::stable_sort(sorted.begin(), sorted.end(),
+							 [](const Cluster& a, const Cluster& b) { return a.m_Key > b.m_Key; });
+
+			std::vector<uint32> output;
+			output.reserve(triangleCount * 3);
+			for(const Cluster& cluster : sorted)
+				output.insert(output.end(), indices + cluster.m_Begin * 3, indices + cluster.m_End * 3);
+			memcpy(indices, output.data(), output.size() * sizeof(uint32));
+		}
+
+		uint32 OptimizeVertexFetch(char* vertices, uint32* indices, uint32 indexCount, uint32 vertexCount,
+								   uint32 vertexStride)
+		{
+			constexpr uint32 unused = ~0u;
+			std::vector<uint32> remap(vertexCount, unused);
+			uint32 next = 0;
+			for(uint32 i = 0; i < indexCount; ++i)
+			{
+				uint32& target = remap[indices[i]];
+				if(target == unused)
+					target = next++;
+				indices[i] = target;
+			}
+
+			std::vector<char> reordered(uint64(next) * vertexStride);
+			for(uint32 v = 0; v < vertexCount; ++v)
+			{
+				if(remap[v] != unused)
+				{
+					const uint64 from = uint64(v) * vertexStride;
+					memcpy(&reordered[uint64(remap[v]) * vertexStride], &vertices[from], vertexStride);
+				}
+			}
+			if(!reordered.empty())
+				memcpy(vertices, reordered.data(), reordered.size());
+			return next;
+		}
+
+		namespace
+		{
+			// LOD 0 only, it is the one that gets drawn up close
+			MeshStats Analyze(const std::vector<uint32>& indices, const MeshHeader& header)
+			{
+				const uint32 count = header.m_Lods[0].m_IndexCount;
+				const uint32 vertexCount = header.m_VertexCount;
+				MeshStats stats;
+				stats.m_Cache = AnalyzeVertexCache(indices.data(), count, vertexCount);
+				stats.m_Overfetch = AnalyzeVertexFetch(indices.data(), count, vertexCount, header.m_VertexStride);
+				return stats;
+			}
+		};
+
+		bool OptimizeMesh(std::vector<char>& meshFile, float overdrawThreshold, MeshStats* before, MeshStats* after)
+		{
+			Mesh::MeshView mesh;
+			if(mesh.Parse(Span<const char>(meshFile.data(), meshFile.size())) != Mesh::ParseResult::Ok)
+				return false;
+
+			MeshHeader header = mesh.GetHeader();
+			std::vector<uint32> indices(header.m_IndexCount);
+			std::vector<Vector3f> positions(header.m_VertexCount);
+			for(uint32 i = 0; i < header.m_IndexCount; ++i)
+				indices[i] = mesh.GetIndex(i);
+			for(uint32 v = 0; v < header.m_VertexCount; ++v)
+			{
+				const Vector4f position = mesh.DecodeVertex(v).position;
+				positions[v] = Vector3f(position.x, position.y, position.z);
+			}
+
+			if(before)
+				*before = Analyze(indices, header);
+
+			// every LOD on its own, they are drawn on their own
+			for(uint32 i = 0; i < header.m_LodCount; ++i)
+			{
+				uint32* lodIndices = &indices[header.m_Lods[i].m_IndexOffset];
+				const uint32 lodIndexCount = header.m_Lods[i].m_IndexCount;
+				OptimizeVertexCache(lodIndices, lodIndexCount, header.m_VertexCount);
+				OptimizeOverdraw(lodIndices, lodIndexCount, positions.data(), header.m_VertexCount, overdrawThreshold);
+			}
+
+			// LOD 0 comes first in the index buffer so the vertices end up in its order, the coarser LODs reuse a
+			// subset of them. The view points into meshFile, nothing reads it past this point
+			char* vertices = &meshFile[header.m_VertexOffset];
+			header.m_VertexCount = OptimizeVertexFetch(vertices, indices.data(), header.m_IndexCount,
+													   header.m_VertexCount, header.m_VertexStride);
+
+			if(after)
+				*after = Analyze(indices, header);
+
+			// meshlets point at the old order, AddMeshlets has to run again
+			header.m_MeshletCount = 0;
+			header.m_MeshletOffset = 0;
+			header.m_MeshletVertexCount = 0;
+			header.m_MeshletTriangleCount = 0;
+
+			memcpy(meshFile.data(), &header, sizeof(header));
+			for(uint32 i = 0; i < header.m_IndexCount; ++i)
+			{
+				char* out = &meshFile[header.m_IndexOffset + uint64(i) * header.m_IndexSize];
+				if(header.m_IndexSize == 2)
+				{
+					const uint16 index = static_cast<uint16>(indices[i]);
+					memcpy(out, &index, sizeof(index));
+				}
+				else
+					memcpy(out, &indices[i], sizeof(uint32));
+			}
+			return true;
+		}
+
+	}; // namespace MeshOptimizer
+}; // namespace Core
@@ -0,0 +1,64 @@
+#pragma once
+#include "core/Types.h"
+#include "core/math/Vector3.h"
+
+#include <vector>
+
+namespace Core
+{
+	/*
+		Offline index and vertex reordering, run by the MeshCooker tool after Mesh::Encode has welded the vertices
+		and MeshSimplifier::AddLods has built the LODs, before Mesh::AddMeshlets.
+		The order the passes are meant to run in: OptimizeVertexCache, OptimizeOverdraw, OptimizeVertexFetch.
+		None of them change the set of triangles or the winding, only the order things are stored in.
+	*/
+	namespace MeshOptimizer
+	{
+		struct CacheStats
+		{
+			uint32 m_Misses = 0;
+			float m_Acmr = 0.f; // transformed vertices per triangle, 3 is the worst, 0.5 the best a regular grid gets
+			float m_Atvr = 0.f; // transformed vertices per referenced vertex, 1 is ideal
+		};
+
+		// Simulates a FIFO post-transform cache like the one most GPUs have.
+		CacheStats AnalyzeVertexCache(const uint32* indices, uint32 indexCount, uint32 vertexCount,
+									  uint32 cacheSize = 16);
+
+		// Bytes read through 64 byte lines divided by the size of the referenced vertices, 1 is ideal.
+		float AnalyzeVertexFetch(const uint32* indices, uint32 indexCount, uint32 vertexCount, uint32 vertexStride);
+
+		// Tom Forsyth's linear-speed vertex cache optimisation, reorders the triangles in place.
+		void OptimizeVertexCache(uint32* indices, uint32 indexCount, uint32 vertexCount);
+
+		/*
+			Reorders clusters of an already cache optimised index buffer so the triangles facing outwards come first,
+			which cuts overdraw from most view directions (Sander, Nehab, Barczak 2007). threshold is how much worse
+			the ACMR may get, 1.05 allows 5%.
+		*/
+		void OptimizeOverdraw(uint32* indices, uint32 indexCount, const Vector3f* positions, uint32 vertexCount,
+							  float threshold = 1.05f);
+
+		/*
+			Moves the vertices into the order the indices first use them and remaps the indices to match, so the
+			vertex fetch walks the buffer forwards. Vertices nothing references are dropped, returns the new count.
+		*/
+		uint32 OptimizeVertexFetch(char* vertices, uint32* indices, uint32 indexCount, uint32 vertexCount,
+								   uint32 vertexStride);
+
+		struct MeshStats
+		{
+			CacheStats m_Cache;
+			float m_Overfetch = 0.f;
+		};
+
+		/*
+			Runs all three passes on a .mesh file produced by Mesh::Encode, in place, every LOD separately. before and
+			after are optional and describe LOD 0. Any meshlets are dropped, build them afterwards. Returns false when
+			the data does not parse as a .mesh.
+		*/
+		bool OptimizeMesh(std::vector<char>& meshFile, float overdrawThreshold = 1.05f, MeshStats* before = nullptr,
+						  MeshStats* after = nullptr);
+
+	}; // namespace MeshOptimizer
+}; // namespace Core
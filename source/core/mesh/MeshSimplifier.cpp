@@ -0,0 +1,429 @@
+#include "MeshSimplifier.h"
+#include "MeshFormat.h"
+#include "core/containers/HashMap.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace Core
+{
+	namespace MeshSimplifier
+	{
+		namespace
+		{
+			// open borders weigh more than faces so the outline survives longer than the inside
+			constexpr double s_BorderWeight = 10.0;
+
+			// a collapse may turn a triangle by up to about 75 degrees
+			constexpr float s_MaxNormalChange = 0.25f;
+
+			// Summed squared distances to a set of weighted planes, a symmetric 4x4 matrix stored as its upper half.
+			struct Quadric
+			{
+				void AddPlane(const Vector3f& normal, float distance, double weight)
+				{
+					const double plane[4] = { normal.x, normal.y, normal.z, distance };
+					int k = 0;
+					for(int i = 0; i < 4; ++i)
+					{
+						for(int j = i; j < 4; ++j)
+							m_A[k++] += weight * plane[i] * plane[j];
+					}
+					m_Weight += weight;
+				}
+
+				void Add(const Quadric& other)
+				{
+					for(int k = 0; k < 10; ++k)
+						m_A[k] += other.m_A[k];
+					m_Weight += other.m_Weight;
+				}
+
+				// squared distance, the weights make it an average over the planes
+				double Evaluate(const Vector3f& position) const
+				{
+					const double p[4] = { position.x, position.y, position.z, 1.0 };
+					double sum = 0.0;
+					int k = 0;
+					for(int i = 0; i < 4; ++i)
+					{
+						for(int j = i; j < 4; ++j)
+							sum += (i == j ? 1.0 : 2.0) * m_A[k++] * p[i] * p[j];
+					}
+					return m_Weight > 0.0 ? fabs(sum) / m_Weight : 0.0;
+				}
+
+				double m_A[10] = {}; // xx xy xz xw yy yz yw zz zw ww
+				double m_Weight = 0.0;
+			};
+
+			enum class VertexKind : uint8
+			{
+				Manifold, // can move onto any neighbour
+				Border,	  // on one open border, can only move along it
+				Locked,	  // attribute seam, non manifold or where borders meet
+			};
+
+			struct Collapse
+			{
+				uint32 m_From;
+				uint32 m_To;
+				double m_Error;
+			};
+
+			uint64 EdgeKey(uint32 from, uint32 to) { return (uint64(from) << 32) | to; }
+
+			// how many triangles use each directed edge, between positions rather than vertices
+			void CountEdges(const std::vector<uint32>& indices, uint32 indexCount, const std::vector<uint32>& position,
+							HashMap<uint64, uint32>& edges)
+			{
+				for(uint32 i = 0; i < indexCount; ++i)
+				{
+					const uint32 from = position[indices[i]];
+					const uint32 to = position[indices[i - i % 3 + (i + 1) % 3]];
+					if(from == to)
+						continue;
+
+					uint32* count = edges.Find(EdgeKey(from, to));
+					if(count)
+						++*count;
+					else
+						edges.Insert(EdgeKey(from, to), 1);
+				}
+			}
+
+			void WriteIndex(std::vector<char>& file, const MeshHeader& header, uint32 i, uint32 index)
+			{
+				char* out = &file[header.m_IndexOffset + uint64(i) * header.m_IndexSize];
+				if(header.m_IndexSize == 2)
+				{
+					const uint16 value = static_cast<uint16>(index);
+					memcpy(out, &value, sizeof(value));
+				}
+				else
+					memcpy(out, &index, sizeof(index));
+			}
+		}; // namespace
+
+		uint32 Simplify(uint32* destination, const uint32* indices, uint32 indexCount, const Vector3f* positions,
+						uint32 vertexCount, uint32 targetIndexCount, float targetError, float* resultError)
+		{
+			std::vector<uint32> result(indices, indices + indexCount);
+			uint32 count = indexCount - indexCount % 3;
+			double maxError = 0.0;
+
+			// one representative vertex per position, welding kept apart what differs in normal or colour
+			std::vector<bool> referenced(vertexCount, false);
+			for(uint32 i = 0; i < count; ++i)
+				referenced[result[i]] = true;
+
+			std::vector<uint32> sorted;
+			sorted.reserve(vertexCount);
+			for(uint32 v = 0; v < vertexCount; ++v)
+			{
+				if(referenced[v])
+					sorted.push_back(v);
+			}
+			std::sort(sorted.begin(), sorted.end(), [&](uint32 a, uint32 b) {
+				const Vector3f& p = positions[a];
+				const Vector3f& q = positions[b];
+				if(p.x != q.x)
+					return p.x < q.x;
+				if(p.y != q.y)
+					return p.y < q.y;
+				if(p.z != q.z)
+					return p.z < q.z;
+				return a < b;
+			});
+
+			std::vector<uint32> position(vertexCount);
+			std::vector<uint32> wedgeCount(vertexCount, 0);
+			for(uint32 i = 0; i < sorted.size(); ++i)
+			{
+				const uint32 v = sorted[i];
+				const bool same = i > 0 && positions[sorted[i - 1]].x == positions[v].x &&
+								  positions[sorted[i - 1]].y == positions[v].y &&
+								  positions[sorted[i - 1]].z == positions[v].z;
+				position[v] = same ? position[sorted[i - 1]] : v;
+				++wedgeCount[position[v]];
+			}
+
+			// classify the positions, each edge of a closed manifold is used once in each direction
+			HashMap<uint64, uint32> edges(count);
+			CountEdges(result, count, position, edges);
+
+			std::vector<uint8> borderEdges(vertexCount, 0);
+			std::vector<bool> nonManifold(vertexCount, false);
+			for(const auto& edge : edges)
+			{
+				const uint32 from = static_cast<uint32>(edge.key >> 32);
+				const uint32 to = static_cast<uint32>(edge.key);
+				const uint32* reverse = edges.Find(EdgeKey(to, from));
+				if(edge.value > 1 || (reverse && *reverse > 1))
+					nonManifold[from] = nonManifold[to] = true;
+				else if(!reverse)
+				{
+					borderEdges[from] = static_cast<uint8>(std::min(borderEdges[from] + 1, 3));
+					borderEdges[to] = static_cast<uint8>(std::min(borderEdges[to] + 1, 3));
+				}
+			}
+
+			std::vector<VertexKind> kind(vertexCount, VertexKind::Locked);
+			for(uint32 v : sorted)
+			{
+				if(position[v] != v || wedgeCount[v] > 1 || nonManifold[v])
+					continue;
+				if(borderEdges[v] == 0)
+					kind[v] = VertexKind::Manifold;
+				else if(borderEdges[v] == 2)
+					kind[v] = VertexKind::Border;
+			}
+
+			// plane of every triangle weighted by its area, plus a plane standing on every border edge
+			std::vector<Quadric> quadrics(vertexCount);
+			for(uint32 t = 0; t < count; t += 3)
+			{
+				const uint32 corners[3] = { position[result[t]], position[result[t + 1]], position[result[t + 2]] };
+				const Vector3f& a = positions[corners[0]];
+				Vector3f normal = Cross(positions[corners[1]] - a, positions[corners[2]] - a);
+				const float length = normal.Length();
+				if(length <= 0.f)
+					continue;
+
+				normal /= length;
+				Quadric plane;
+				plane.AddPlane(normal, -Dot(normal, a), length * 0.5);
+				for(uint32 corner : corners)
+					quadrics[corner].Add(plane);
+
+				for(uint32 k = 0; k < 3; ++k)
+				{
+					const uint32 from = corners[k];
+					const uint32 to = corners[(k + 1) % 3];
+					if(from == to || edges.Find(EdgeKey(to, from)))
+						continue;
+
+					Vector3f edge = positions[to] - positions[from];
+					Vector3f side = Cross(edge, normal);
+					const float sideLength = side.Length();
+					if(sideLength <= 0.f)
+						continue;
+
+					side /= sideLength;
+					const float edgeLength = edge.Length();
+					Quadric border;
+					border.AddPlane(side, -Dot(side, positions[from]), s_BorderWeight * edgeLength * edgeLength);
+					quadrics[from].Add(border);
+					quadrics[to].Add(border);
+				}
+			}
+
+			const double errorLimit = double(targetError) * targetError;
+			std::vector<uint32> firstTriangle(vertexCount + 1);
+			std::vector<uint32> vertexTriangles;
+			std::vector<uint32> collapseTo(vertexCount);
+			std::vector<bool> touched(vertexCount);
+			std::vector<Collapse> collapses;
+
+			// passes of independent collapses, cheapest first, until the target or the error limit is reached
+			while(count > targetIndexCount)
+			{
+				std::fill(firstTriangle.begin(), firstTriangle.end(), 0);
+				for(uint32 i = 0; i < count; ++i)
+					++firstTriangle[result[i] + 1];
+				for(uint32 v = 0; v < vertexCount; ++v)
+					firstTriangle[v + 1] += firstTriangle[v];
+
+				vertexTriangles.resize(count);
+				std::vector<uint32> fill(firstTriangle.begin(), firstTriangle.end() - 1);
+				for(uint32 i = 0; i < count; ++i)
+					vertexTriangles[fill[result[i]]++] = i / 3;
+
+				HashMap<uint64, uint32> currentEdges(count);
+				CountEdges(result, count, position, currentEdges);
+
+				collapses.clear();
+				for(uint32 i = 0; i < count; ++i)
+				{
+					const uint32 v0 = result[i];
+					const uint32 v1 = result[i - i % 3 + (i + 1) % 3];
+					const uint32 p0 = position[v0];
+					const uint32 p1 = position[v1];
+					const bool border = !currentEdges.Find(EdgeKey(p1, p0));
+
+					// interior edges show up once from each side
+					if(p0 == p1 || (!border && p0 > p1))
+						continue;
+
+					Quadric merged = quadrics[p0];
+					merged.Add(quadrics[p1]);
+
+					Collapse best = { 0, 0, -1.0 };
+					const uint32 ends[2] = { v0, v1 };
+					for(int k = 0; k < 2; ++k)
+					{
+						const uint32 from = ends[k];
+						const uint32 to = ends[1 - k];
+						const VertexKind fromKind = kind[position[from]];
+						if(fromKind == VertexKind::Locked || (fromKind == VertexKind::Border && !border))
+							continue;
+
+						const double error = merged.Evaluate(positions[to]);
+						if(best.m_Error < 0.0 || error < best.m_Error)
+							best = { from, to, error };
+					}
+
+					if(best.m_Error >= 0.0)
+						collapses.push_back(best);
+				}
+
+				std::sort(collapses.begin(), collapses.end(),
+						  [](const Collapse& a, const Collapse& b) { return a.m_Error < b.m_Error; });
+
+				// most collapses remove two triangles, don't overshoot the target by much
+				const uint32 limit = (count - targetIndexCount) / 6 + 1;
+				std::fill(touched.begin(), touched.end(), false);
+				for(uint32 v = 0; v < vertexCount; ++v)
+					collapseTo[v] = v;
+
+				uint32 collapsed = 0;
+				for(const Collapse& collapse : collapses)
+				{
+					if(collapse.m_Error > errorLimit || collapsed == limit)
+						break;
+
+					const uint32 from = collapse.m_From;
+					const uint32 target = position[collapse.m_To];
+					if(touched[from] || touched[target])
+						continue;
+
+					// the fan of from has to stay as it is this pass, and no triangle of it may flip
+					bool valid = true;
+					for(uint32 j = firstTriangle[from]; j < firstTriangle[from + 1] && valid; ++j)
+					{
+						const uint32* corners = &result[vertexTriangles[j] * 3];
+						bool hasTarget = false;
+						for(uint32 k = 0; k < 3; ++k)
+						{
+							valid = valid && !touched[position[corners[k]]];
+							hasTarget = hasTarget || position[corners[k]] == target;
+						}
+						if(!valid || hasTarget)
+							continue;
+
+						Vector3f p[3];
+						for(uint32 k = 0; k < 3; ++k)
+							p[k] = positions[position[corners[k]]];
+						Vector3f before = Cross(p[1] - p[0], p[2] - p[0]);
+						for(uint32 k = 0; k < 3; ++k)
+							p[k] = corners[k] == from ? positions[target] : p[k];
+						Vector3f after = Cross(p[1] - p[0], p[2] - p[0]);
+						valid = Dot(before, after) > s_MaxNormalChange * before.Length() * after.Length();
+					}
+					if(!valid)
+						continue;
+
+					for(uint32 j = firstTriangle[from]; j < firstTriangle[from + 1]; ++j)
+					{
+						const uint32* corners = &result[vertexTriangles[j] * 3];
+						for(uint32 k = 0; k < 3; ++k)
+							touched[position[corners[k]]] = true;
+					}
+
+					collapseTo[from] = collapse.m_To;
+					quadrics[target].Add(quadrics[from]);
+					maxError = std::max(maxError, collapse.m_Error);
+					++collapsed;
+				}
+
+				if(collapsed == 0)
+					break;
+
+				// triangles that lost an edge are gone
+				uint32 kept = 0;
+				for(uint32 t = 0; t < count; t += 3)
+				{
+					const uint32 a = collapseTo[result[t]];
+					const uint32 b = collapseTo[result[t + 1]];
+					const uint32 c = collapseTo[result[t + 2]];
+					if(position[a] == position[b] || position[b] == position[c] || position[c] == position[a])
+						continue;
+
+					result[kept++] = a;
+					result[kept++] = b;
+					result[kept++] = c;
+				}
+				count = kept;
+			}
+
+			if(count > 0)
+				memcpy(destination, result.data(), count * sizeof(uint32));
+			if(resultError)
+				*resultError = static_cast<float>(sqrt(maxError));
+			return count;
+		}
+
+		bool AddLods(std::vector<char>& meshFile, const LodOptions& options)
+		{
+			Mesh::MeshView mesh;
+			if(mesh.Parse(Span<const char>(meshFile.data(), meshFile.size())) != Mesh::ParseResult::Ok)
+				return false;
+
+			MeshHeader header = mesh.GetHeader();
+			const uint32 baseCount = header.m_Lods[0].m_IndexCount;
+			std::vector<uint32> indices(baseCount);
+			for(uint32 i = 0; i < baseCount; ++i)
+				indices[i] = mesh.GetIndex(i);
+
+			std::vector<Vector3f> positions(header.m_VertexCount);
+			for(uint32 v = 0; v < header.m_VertexCount; ++v)
+			{
+				const Vector4f position = mesh.DecodeVertex(v).position;
+				positions[v] = Vector3f(position.x, position.y, position.z);
+			}
+
+			const uint32 lodCount = std::min(std::max(options.m_LodCount, 1u), Mesh::s_MaxLods);
+			const float errorBudget = options.m_ErrorBudget * header.m_BoundsRadius;
+			header.m_LodCount = 1;
+			header.m_Lods[0].m_Error = 0.f;
+
+			std::vector<uint32> lod(baseCount);
+			while(header.m_LodCount < lodCount)
+			{
+				const MeshLod previous = header.m_Lods[header.m_LodCount - 1];
+				const uint32 target = static_cast<uint32>(previous.m_IndexCount / 3 * options.m_Ratio) * 3;
+
+				// always from LOD 0 so the error is measured against the real surface
+				float error = 0.f;
+				const uint32 count = Simplify(lod.data(), indices.data(), baseCount, positions.data(),
+											  header.m_VertexCount, target, errorBudget, &error);
+
+				// the budget ran out before this one got much smaller, the previous LOD is as coarse as it gets
+				if(count == 0 || count > previous.m_IndexCount * 0.9f)
+					break;
+
+				MeshLod& next = header.m_Lods[header.m_LodCount++];
+				next.m_IndexOffset = static_cast<uint32>(indices.size());
+				next.m_IndexCount = count;
+				next.m_Error = std::max(error, previous.m_Error);
+				indices.insert(indices.end(), lod.begin(), lod.begin() + count);
+			}
+
+			// the index buffer grows in place, meshlets after it are dropped and AddMeshlets has to run again
+			header.m_IndexCount = static_cast<uint32>(indices.size());
+			header.m_MeshletCount = 0;
+			header.m_MeshletOffset = 0;
+			header.m_MeshletVertexCount = 0;
+			header.m_MeshletTriangleCount = 0;
+
+			meshFile.resize(header.m_IndexOffset);
+			meshFile.resize(header.m_IndexOffset + uint64(header.m_IndexCount) * header.m_IndexSize, 0);
+			memcpy(meshFile.data(), &header, sizeof(header));
+			for(uint32 i = 0; i < header.m_IndexCount; ++i)
+				WriteIndex(meshFile, header, i, indices[i]);
+			return true;
+		}
+
+	}; // namespace MeshSimplifier
+}; // namespace Core
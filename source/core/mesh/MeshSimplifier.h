@@ -0,0 +1,42 @@
+#pragma once
+#include "core/Types.h"
+#include "core/math/Vector3.h"
+
+#include <vector>
+
+namespace Core
+{
+	/*
+		Offline level of detail generation, run by the MeshCooker tool between Mesh::Encode and
+		MeshOptimizer::OptimizeMesh. Coarser LODs only drop triangles and reuse the vertices of LOD 0, so every LOD
+		shares one vertex buffer.
+	*/
+	namespace MeshSimplifier
+	{
+		/*
+			Quadric error metric edge collapse (Garland, Heckbert 1997), every collapse moves a vertex onto one of
+			its neighbours. Stops when the index count reaches targetIndexCount or the next collapse would move the
+			surface further than targetError, in the units of positions. Vertices on attribute seams (several
+			vertices at one position) stay where they are, open borders only collapse along themselves.
+			destination needs room for indexCount indices and may be indices. Returns the new index count, the
+			largest error is written to resultError when it isn't null.
+		*/
+		uint32 Simplify(uint32* destination, const uint32* indices, uint32 indexCount, const Vector3f* positions,
+						uint32 vertexCount, uint32 targetIndexCount, float targetError, float* resultError = nullptr);
+
+		struct LodOptions
+		{
+			uint32 m_LodCount = 4;		// including LOD 0, at most Mesh::s_MaxLods
+			float m_Ratio = 0.5f;		// triangles each LOD keeps of the one before
+			float m_ErrorBudget = 0.02f; // largest error of the coarsest LOD, relative to the mesh's bounding radius
+		};
+
+		/*
+			Replaces the LODs of a .mesh with a chain simplified from LOD 0, in place. The chain ends early when the
+			error budget stops a LOD from getting meaningfully smaller. Meshlets are dropped, build them afterwards.
+			Returns false when the data does not parse as a .mesh.
+		*/
+		bool AddLods(std::vector<char>& meshFile, const LodOptions& options);
+
+	}; // namespace MeshSimplifier
+}; // namespace Core
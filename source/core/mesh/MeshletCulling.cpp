@@ -0,0 +1,64 @@
+#include "MeshletCulling.h"
+
+#include <cmath>
+
+namespace Core
+{
+	namespace Mesh
+	{
+		MeshletBounds TransformBounds(const Meshlet& meshlet, const Matrix44f& world)
+		{
+			MeshletBounds bounds;
+			const float* c = meshlet.m_Center;
+			const Vector4f center = Vector4f(c[0], c[1], c[2], 1.f) * world;
+			bounds.m_Center = Vector3f(center.x, center.y, center.z);
+
+			// the largest axis scale keeps the sphere conservative
+			float scale[3];
+			for(int row = 0; row < 3; ++row)
+			{
+				const float* r = &world[row * 4];
+				scale[row] = sqrtf(r[0] * r[0] + r[1] * r[1] + r[2] * r[2]);
+			}
+			const float maxScale = fmaxf(scale[0], fmaxf(scale[1], scale[2]));
+			const float minScale = fminf(scale[0], fminf(scale[1], scale[2]));
+			bounds.m_Radius = meshlet.m_Radius * maxScale;
+
+			// a non uniform scale bends the normals, the cone no longer holds them
+			bounds.m_ConeAxis = Vector3f(0.f, 0.f, 0.f);
+			bounds.m_ConeCutoff = 1.f;
+			if(meshlet.m_ConeCutoff < 1.f && maxScale - minScale <= maxScale * 1e-3f)
+			{
+				const Vector4f axis =
+					Vector4f(meshlet.m_ConeAxis[0], meshlet.m_ConeAxis[1], meshlet.m_ConeAxis[2], 0.f) * world;
+				bounds.m_ConeAxis = Vector3f(axis.x, axis.y, axis.z) / maxScale;
+				bounds.m_ConeCutoff = meshlet.m_ConeCutoff;
+			}
+			return bounds;
+		}
+
+		bool IsBackfacing(const MeshletBounds& bounds, const Vector3f& cameraPosition)
+		{
+			if(bounds.m_ConeCutoff >= 1.f)
+				return false;
+
+			// the radius makes up for the cone's apex not being at the centre
+			Vector3f toCenter = bounds.m_Center - cameraPosition;
+			return Dot(toCenter, bounds.m_ConeAxis) >= bounds.m_ConeCutoff * toCenter.Length() + bounds.m_Radius;
+		}
+
+		uint32 CullMeshlets(Span<const Meshlet> meshlets, const Matrix44f& world, const Frustum& frustum,
+							const Vector3f& cameraPosition, uint32* visible)
+		{
+			uint32 count = 0;
+			for(uint32 i = 0; i < meshlets.Size(); ++i)
+			{
+				const MeshletBounds bounds = TransformBounds(meshlets[i], world);
+				if(frustum.IsSphereVisible(bounds.m_Center, bounds.m_Radius) && !IsBackfacing(bounds, cameraPosition))
+					visible[count++] = i;
+			}
+			return count;
+		}
+
+	}; // namespace Mesh
+}; // namespace Core
@@ -0,0 +1,36 @@
+#pragma once
+#include "core/Types.h"
+#include "core/containers/Span.h"
+#include "core/math/Frustum.h"
+#include "core/math/Matrix44.h"
+#include "core/math/Vector3.h"
+#include "MeshFormat.h"
+
+namespace Core
+{
+	namespace Mesh
+	{
+		// The meshlet's bounds in world space, the cone is only kept when world has a uniform scale.
+		struct MeshletBounds
+		{
+			Vector3f m_Center;
+			float m_Radius;
+			Vector3f m_ConeAxis;
+			float m_ConeCutoff;
+		};
+
+		MeshletBounds TransformBounds(const Meshlet& meshlet, const Matrix44f& world);
+
+		// True when every triangle in the cone faces away from cameraPosition.
+		bool IsBackfacing(const MeshletBounds& bounds, const Vector3f& cameraPosition);
+
+		/*
+			CPU reference for the meshlet culling that will move to a compute shader: frustum test against the
+			bounding sphere, then the normal cone against the camera. frustum and cameraPosition are in world space.
+			Writes the indices of the visible meshlets, in order, and returns how many there are.
+		*/
+		uint32 CullMeshlets(Span<const Meshlet> meshlets, const Matrix44f& world, const Frustum& frustum,
+							const Vector3f& cameraPosition, uint32* visible);
+
+	}; // namespace Mesh
+}; // namespace Core
@@ -0,0 +1,279 @@
+#include "Meshlets.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace Core
+{
+	namespace Mesh
+	{
+		namespace
+		{
+			constexpr uint8 s_NotInMeshlet = 0xFF;
+
+			uint32 Align(uint32 value, uint32 alignment) { return (value + alignment - 1) & ~(alignment - 1); }
+
+			void ComputeBounds(Meshlet& meshlet, const MeshletData& data, const Vector3f* positions,
+							   const std::vector<Vector3f>& triangleNormals, const uint32* triangles)
+			{
+				const uint32* vertices = &data.m_Vertices[meshlet.m_VertexOffset];
+				Vector3f low = positions[vertices[0]];
+				Vector3f high = low;
+				for(uint32 i = 1; i < meshlet.m_VertexCount; ++i)
+				{
+					const Vector3f& p = positions[vertices[i]];
+					low = Vector3f(fminf(low.x, p.x), fminf(low.y, p.y), fminf(low.z, p.z));
+					high = Vector3f(fmaxf(high.x, p.x), fmaxf(high.y, p.y), fmaxf(high.z, p.z));
+				}
+
+				const Vector3f center = (low + high) * 0.5f;
+				float radius = 0.f;
+				for(uint32 i = 0; i < meshlet.m_VertexCount; ++i)
+				{
+					Vector3f offset = positions[vertices[i]] - center;
+					radius = fmaxf(radius, offset.Length());
+				}
+
+				meshlet.m_Center[0] = center.x;
+				meshlet.m_Center[1] = center.y;
+				meshlet.m_Center[2] = center.z;
+				meshlet.m_Radius = radius;
+
+				// the cone holds every triangle normal, degenerate triangles have none and don't count
+				Vector3f axis(0.f, 0.f, 0.f);
+				for(uint32 t = 0; t < meshlet.m_TriangleCount; ++t)
+					axis += triangleNormals[triangles[t]];
+
+				meshlet.m_ConeAxis[0] = meshlet.m_ConeAxis[1] = meshlet.m_ConeAxis[2] = 0.f;
+				meshlet.m_ConeCutoff = 1.f;
+				const float axisLength = axis.Length();
+				if(axisLength <= 0.f)
+					return;
+
+				axis /= axisLength;
+				float minDot = 1.f;
+				for(uint32 t = 0; t < meshlet.m_TriangleCount; ++t)
+				{
+					const Vector3f& normal = triangleNormals[triangles[t]];
+					if(normal.x != 0.f || normal.y != 0.f || normal.z != 0.f)
+						minDot = fminf(minDot, Dot(normal, axis));
+				}
+
+				meshlet.m_ConeAxis[0] = axis.x;
+				meshlet.m_ConeAxis[1] = axis.y;
+				meshlet.m_ConeAxis[2] = axis.z;
+
+				// past about 84 degrees the cone would almost never cull anything
+				if(minDot > 0.1f)
+					meshlet.m_ConeCutoff = sqrtf(1.f - minDot * minDot);
+			}
+		};
+
+		MeshletData BuildMeshlets(uint32* indices, uint32 indexCount, const Vector3f* positions,
+								  const Vector3f* normals, uint32 vertexCount)
+		{
+			MeshletData data;
+			const uint32 triangleCount = indexCount / 3;
+			if(triangleCount == 0)
+				return data;
+
+			// unit face normals, flipped to the side the vertex normals are on when there are any
+			std::vector<Vector3f> triangleNormals(triangleCount);
+			for(uint32 t = 0; t < triangleCount; ++t)
+			{
+				const uint32* corners = &indices[t * 3];
+				const Vector3f& a = positions[corners[0]];
+				Vector3f normal = Cross(positions[corners[1]] - a, positions[corners[2]] - a);
+				const float length = normal.Length();
+				if(length <= 0.f)
+					continue;
+
+				normal /= length;
+				if(normals && Dot(normal, normals[corners[0]] + normals[corners[1]] + normals[corners[2]]) < 0.f)
+					normal *= -1.f;
+				triangleNormals[t] = normal;
+			}
+
+			// triangles of each vertex, packed
+			std::vector<uint32> firstTriangle(vertexCount + 1, 0);
+			for(uint32 i = 0; i < triangleCount * 3; ++i)
+				++firstTriangle[indices[i] + 1];
+			for(uint32 v = 0; v < vertexCount; ++v)
+				firstTriangle[v + 1] += firstTriangle[v];
+
+			std::vector<uint32> vertexTriangles(triangleCount * 3);
+			std::vector<uint32> fill(firstTriangle.begin(), firstTriangle.end() - 1);
+			for(uint32 t = 0; t < triangleCount; ++t)
+			{
+				for(uint32 k = 0; k < 3; ++k)
+					vertexTriangles[fill[indices[t * 3 + k]]++] = t;
+			}
+
+			std::vector<bool> emitted(triangleCount, false);
+			std::vector<uint8> localIndex(vertexCount, s_NotInMeshlet);
+			std::vector<uint32> order; // triangles in meshlet order
+			order.reserve(triangleCount);
+
+			Meshlet meshlet = {};
+			Vector3f normalSum(0.f, 0.f, 0.f);
+			uint32 cursor = 0;
+
+			auto newVertices = [&](uint32 triangle) {
+				const uint32* corners = &indices[triangle * 3];
+				uint32 count = 0;
+				for(uint32 k = 0; k < 3; ++k)
+				{
+					// a degenerate triangle can name the same new vertex twice
+					const bool repeat = (k > 0 && corners[k] == corners[0]) || (k > 1 && corners[k] == corners[1]);
+					count += localIndex[corners[k]] == s_NotInMeshlet && !repeat ? 1 : 0;
+				}
+				return count;
+			};
+
+			auto flush = [&]() {
+				ComputeBounds(meshlet, data, positions, triangleNormals, &order[meshlet.m_TriangleOffset]);
+				data.m_Meshlets.push_back(meshlet);
+				for(uint32 i = 0; i < meshlet.m_VertexCount; ++i)
+					localIndex[data.m_Vertices[meshlet.m_VertexOffset + i]] = s_NotInMeshlet;
+
+				meshlet = {};
+				meshlet.m_VertexOffset = static_cast<uint32>(data.m_Vertices.size());
+				meshlet.m_TriangleOffset = static_cast<uint32>(order.size());
+				normalSum = Vector3f(0.f, 0.f, 0.f);
+			};
+
+			while(order.size() < triangleCount)
+			{
+				// best connected triangle: fewest new vertices first, then the one facing the meshlet's way
+				int64 best = -1;
+				float bestScore = 0.f;
+				const float normalLength = normalSum.Length();
+				const Vector3f direction = normalLength > 0.f ? normalSum / normalLength : normalSum;
+				for(uint32 i = 0; i < meshlet.m_VertexCount; ++i)
+				{
+					const uint32 vertex = data.m_Vertices[meshlet.m_VertexOffset + i];
+					for(uint32 j = firstTriangle[vertex]; j < firstTriangle[vertex + 1]; ++j)
+					{
+						const uint32 t = vertexTriangles[j];
+						if(emitted[t])
+							continue;
+
+						const uint32 added = newVertices(t);
+						if(meshlet.m_VertexCount + added > s_MaxMeshletVertices)
+							continue;
+
+						const float score = added + 0.25f * (1.f - Dot(triangleNormals[t], direction));
+						if(best < 0 || score < bestScore)
+						{
+							best = t;
+							bestScore = score;
+						}
+					}
+				}
+
+				if(best < 0)
+				{
+					// nothing connected fits, continue with the next triangle in index order
+					while(emitted[cursor])
+						++cursor;
+					const uint32 added = newVertices(cursor);
+					if(meshlet.m_TriangleCount > 0 && meshlet.m_VertexCount + added > s_MaxMeshletVertices)
+					{
+						flush();
+						continue;
+					}
+					best = cursor;
+				}
+
+				const uint32 triangle = static_cast<uint32>(best);
+				emitted[triangle] = true;
+				order.push_back(triangle);
+				normalSum += triangleNormals[triangle];
+				for(uint32 k = 0; k < 3; ++k)
+				{
+					const uint32 vertex = indices[triangle * 3 + k];
+					if(localIndex[vertex] == s_NotInMeshlet)
+					{
+						localIndex[vertex] = static_cast<uint8>(meshlet.m_VertexCount++);
+						data.m_Vertices.push_back(vertex);
+					}
+					data.m_Triangles.push_back(localIndex[vertex]);
+				}
+
+				// a full set of vertices can still take triangles between them, that is decided above
+				if(++meshlet.m_TriangleCount == s_MaxMeshletTriangles)
+					flush();
+			}
+
+			if(meshlet.m_TriangleCount > 0)
+				flush();
+
+			std::vector<uint32> reordered;
+			reordered.reserve(triangleCount * 3);
+			for(uint32 triangle : order)
+				reordered.insert(reordered.end(), &indices[triangle * 3], &indices[triangle * 3] + 3);
+			memcpy(indices, reordered.data(), reordered.size() * sizeof(uint32));
+			return data;
+		}
+
+		bool AddMeshlets(std::vector<char>& meshFile)
+		{
+			MeshView mesh;
+			if(mesh.Parse(Span<const char>(meshFile.data(), meshFile.size())) != ParseResult::Ok)
+				return false;
+
+			// LOD 0 starts the index buffer, the coarser LODs are left alone
+			MeshHeader header = mesh.GetHeader();
+			const uint32 indexCount = header.m_Lods[0].m_IndexCount;
+			std::vector<uint32> indices(indexCount);
+			for(uint32 i = 0; i < indexCount; ++i)
+				indices[i] = mesh.GetIndex(i);
+
+			std::vector<Vector3f> positions(header.m_VertexCount);
+			std::vector<Vector3f> normals(header.m_VertexCount);
+			for(uint32 v = 0; v < header.m_VertexCount; ++v)
+			{
+				const MeshVertex vertex = mesh.DecodeVertex(v);
+				positions[v] = Vector3f(vertex.position.x, vertex.position.y, vertex.position.z);
+				normals[v] = Vector3f(vertex.normal.x, vertex.normal.y, vertex.normal.z);
+			}
+
+			const bool hasNormals = mesh.FindAttribute(VertexAttribute::Normal) != nullptr;
+			const MeshletData meshlets = BuildMeshlets(indices.data(), indexCount, positions.data(),
+													   hasNormals ? normals.data() : nullptr, header.m_VertexCount);
+
+			// the meshlet section replaces whatever followed the index buffer
+			const uint32 indexEnd = header.m_IndexOffset + header.m_IndexCount * header.m_IndexSize;
+			header.m_MeshletOffset = Align(indexEnd, 4);
+			header.m_MeshletCount = static_cast<uint32>(meshlets.m_Meshlets.size());
+			header.m_MeshletVertexCount = static_cast<uint32>(meshlets.m_Vertices.size());
+			header.m_MeshletTriangleCount = static_cast<uint32>(meshlets.m_Triangles.size() / 3);
+
+			const size_t meshletBytes = meshlets.m_Meshlets.size() * sizeof(Meshlet);
+			const size_t vertexBytes = meshlets.m_Vertices.size() * sizeof(uint32);
+			const size_t sectionEnd = header.m_MeshletOffset + meshletBytes + vertexBytes + meshlets.m_Triangles.size();
+			meshFile.resize(header.m_MeshletOffset);
+			meshFile.resize(Align(static_cast<uint32>(sectionEnd), 4), 0);
+
+			char* out = &meshFile[header.m_MeshletOffset];
+			memcpy(out, meshlets.m_Meshlets.data(), meshletBytes);
+			memcpy(out + meshletBytes, meshlets.m_Vertices.data(), vertexBytes);
+			memcpy(out + meshletBytes + vertexBytes, meshlets.m_Triangles.data(), meshlets.m_Triangles.size());
+
+			memcpy(meshFile.data(), &header, sizeof(header));
+			for(uint32 i = 0; i < indexCount; ++i)
+			{
+				char* index = &meshFile[header.m_IndexOffset + uint64(i) * header.m_IndexSize];
+				if(header.m_IndexSize == 2)
+				{
+					const uint16 value = static_cast<uint16>(indices[i]);
+					memcpy(index, &value, sizeof(value));
+				}
+				else
+					memcpy(index, &indices[i], sizeof(uint32));
+			}
+			return true;
+		}
+
+	}; // namespace Mesh
+}; // namespace Core
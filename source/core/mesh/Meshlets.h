@@ -0,0 +1,35 @@
+#pragma once
+#include "core/Types.h"
+#include "core/math/Vector3.h"
+#include "MeshFormat.h"
+
+#include <vector>
+
+namespace Core
+{
+	namespace Mesh
+	{
+		struct MeshletData
+		{
+			std::vector<Meshlet> m_Meshlets;
+			std::vector<uint32> m_Vertices;
+			std::vector<uint8> m_Triangles;
+		};
+
+		/*
+			Splits the triangles into meshlets of at most s_MaxMeshletVertices and s_MaxMeshletTriangles. Each
+			meshlet grows over shared vertices, preferring triangles that face the same way so the normal cones
+			stay narrow, and when nothing connected fits it continues in index order, so run the vertex cache
+			optimisation first. indices are reordered in place so every meshlet is a contiguous range.
+
+			normals are optional, they only decide which side of a triangle is the front. Without them the front
+			is where Cross(b - a, c - a) points.
+		*/
+		MeshletData BuildMeshlets(uint32* indices, uint32 indexCount, const Vector3f* positions,
+								  const Vector3f* normals, uint32 vertexCount);
+
+		// (Re)builds the meshlets of a .mesh in place from LOD 0, which ends up in meshlet order in the index buffer.
+		bool AddMeshlets(std::vector<char>& meshFile);
+
+	}; // namespace Mesh
+}; // namespace Core
@@ -0,0 +1,130 @@
+#include "Quantize.h"
+
+#include <cmath>
+#include <cstring>
+
+namespace Core
+{
+	namespace Quantize
+	{
+		uint16 FloatToHalf(float value)
+		{
+			uint32 bits;
+			memcpy(&bits, &value, sizeof(bits));
+
+			const uint16 sign = static_cast<uint16>((bits >> 16) & 0x8000);
+			const uint32 exponent = (bits >> 23) & 0xFF;
+			uint32 mantissa = bits & 0x7FFFFF;
+
+			// NaN stays NaN, infinity and anything too large for a half become infinity
+			if(exponent == 0xFF)
+				return sign | 0x7C00 | (mantissa ? 0x200 : 0);
+
+			const int32 halfExponent = static_cast<int32>(exponent) - 127 + 15;
+			if(halfExponent >= 0x1F)
+				return sign | 0x7C00;
+
+			if(halfExponent <= 0)
+			{
+				// subnormal half, or zero when even the implicit bit shifts out
+				if(halfExponent < -10)
+					return sign;
+
+				mantissa |= 0x800000;
+				const uint32 shift = static_cast<uint32>(14 - halfExponent);
+				uint32 half = mantissa >> shift;
+				const uint32 remainder = mantissa & ((1u << shift) - 1);
+				const uint32 halfway = 1u << (shift - 1);
+				if(remainder > halfway || (remainder == halfway && (half & 1)))
+					++half;
+				return sign | static_cast<uint16>(half);
+			}
+
+			// a carry out of the mantissa bumps the exponent, which is exactly right, up to infinity
+			uint32 half = (static_cast<uint32>(halfExponent) << 10) | (mantissa >> 13);
+			const uint32 remainder = mantissa & 0x1FFF;
+			if(remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+				++half;
+			return sign | static_cast<uint16>(half);
+		}
+
+		float HalfToFloat(uint16 value)
+		{
+			const uint32 sign = static_cast<uint32>(value & 0x8000) << 16;
+			const uint32 exponent = (value >> 10) & 0x1F;
+			uint32 mantissa = value & 0x3FF;
+
+			uint32 bits;
+			if(exponent == 0x1F)
+				bits = sign | 0x7F800000 | (mantissa << 13);
+			else if(exponent != 0)
+				bits = sign | ((exponent - 15 + 127) << 23) | (mantissa << 13);
+			else if(mantissa == 0)
+				bits = sign;
+			else
+			{
+				// subnormal, normalise it for the float
+				int32 shift = 0;
+				while((mantissa & 0x400) == 0)
+				{
+					mantissa <<= 1;
+					++shift;
+				}
+				bits = sign | (static_cast<uint32>(127 - 15 + 1 - shift) << 23) | ((mantissa & 0x3FF) << 13);
+			}
+
+			float result;
+			memcpy(&result, &bits, sizeof(result));
+			return result;
+		}
+
+		int16 ToSnorm16(float value)
+		{
+			const float clamped = value < -1.f ? -1.f : (value > 1.f ? 1.f : value);
+			return static_cast<int16>(std::lround(clamped * 32767.f));
+		}
+
+		// -32768 also maps to -1, like the GPU does it
+		float FromSnorm16(int16 value) { return value <= -32767 ? -1.f : static_cast<float>(value) / 32767.f; }
+
+		uint8 ToUnorm8(float value)
+		{
+			const float clamped = value < 0.f ? 0.f : (value > 1.f ? 1.f : value);
+			return static_cast<uint8>(std::lround(clamped * 255.f));
+		}
+
+		float FromUnorm8(uint8 value) { return static_cast<float>(value) / 255.f; }
+
+		void OctEncode(const Vector3f& normal, int16 out[2])
+		{
+			const float sum = fabsf(normal.x) + fabsf(normal.y) + fabsf(normal.z);
+			float x = sum > 0.f ? normal.x / sum : 0.f;
+			float y = sum > 0.f ? normal.y / sum : 0.f;
+
+			// the lower half is folded over the diagonals
+			if(normal.z < 0.f)
+			{
+				const float foldedX = (1.f - fabsf(y)) * (x >= 0.f ? 1.f : -1.f);
+				const float foldedY = (1.f - fabsf(x)) * (y >= 0.f ? 1.f : -1.f);
+				x = foldedX;
+				y = foldedY;
+			}
+
+			out[0] = ToSnorm16(x);
+			out[1] = ToSnorm16(y);
+		}
+
+		Vector3f OctDecode(const int16 encoded[2])
+		{
+			Vector3f normal(FromSnorm16(encoded[0]), FromSnorm16(encoded[1]), 0.f);
+			normal.z = 1.f - fabsf(normal.x) - fabsf(normal.y);
+
+			const float fold = normal.z < 0.f ? -normal.z : 0.f;
+			normal.x += normal.x >= 0.f ? -fold : fold;
+			normal.y += normal.y >= 0.f ? -fold : fold;
+			normal.Normalize();
+			return normal;
+		}
+
+	}; // namespace Quantize
+}; // namespace Core
@@ -0,0 +1,33 @@
+#pragma once
+#include "core/Types.h"
+#include "core/math/Vector3.h"
+
+namespace Core
+{
+	/*
+		Conversions between floats and the compact vertex formats, each one matches the Vulkan format the GPU reads
+		it back with (VK_FORMAT_*_SFLOAT, _SNORM, _UNORM) so decoding on the CPU gives what the shader sees.
+	*/
+	namespace Quantize
+	{
+		// IEEE half, round to nearest even, overflow goes to infinity.
+		uint16 FloatToHalf(float value);
+		float HalfToFloat(uint16 value);
+
+		// [-1, 1] <-> -32767..32767, values outside are clamped.
+		int16 ToSnorm16(float value);
+		float FromSnorm16(int16 value);
+
+		// [0, 1] <-> 0..255
+		uint8 ToUnorm8(float value);
+		float FromUnorm8(uint8 value);
+
+		/*
+			Octahedral unit vector encoding: the vector is projected onto an octahedron which is unfolded into a
+			square, two snorm16 values keep the error under 0.005 degrees. The inverse is in shaders/vertex.vert.
+		*/
+		void OctEncode(const Vector3f& normal, int16 out[2]);
+		Vector3f OctDecode(const int16 encoded[2]);
+
+	}; // namespace Quantize
+}; // namespace Core
@@ -0,0 +1,72 @@
+#include "Cpu.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+namespace Core
+{
+	namespace
+	{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+		void CpuId(int32 leaf, int32 subLeaf, uint32 (&registers)[4])
+		{
+			int info[4];
+			__cpuidex(info, leaf, subLeaf);
+			for(int i = 0; i < 4; ++i)
+				registers[i] = static_cast<uint32>(info[i]);
+		}
+
+		uint64 ReadXCR0() { return _xgetbv(0); }
+#elif defined(__x86_64__) || defined(__i386__)
+		void CpuId(int32 leaf, int32 subLeaf, uint32 (&registers)[4])
+		{
+			__cpuid_count(leaf, subLeaf, registers[0], registers[1], registers[2], registers[3]);
+		}
+
+		uint64 ReadXCR0()
+		{
+			uint32 eax = 0;
+			uint32 edx = 0;
+			__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+			return (static_cast<uint64>(edx) << 32) | eax;
+		}
+#endif
+
+		CpuFeatures ReadFeatures()
+		{
+			CpuFeatures features;
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+			uint32 registers[4] = {}; // eax, ebx, ecx, edx
+			CpuId(0, 0, registers);
+			const uint32 maxLeaf = registers[0];
+
+			CpuId(1, 0, registers);
+			const uint32 ecx = registers[2];
+			features.m_SSE41 = (ecx & (1u << 19)) != 0;
+
+			// the OS has to have xsave enabled and save both xmm and ymm state, otherwise AVX faults
+			const bool osxsave = (ecx & (1u << 27)) != 0;
+			const bool ymmSaved = osxsave && (ReadXCR0() & 0x6) == 0x6;
+			features.m_AVX = ymmSaved && (ecx & (1u << 28)) != 0;
+			features.m_FMA = features.m_AVX && (ecx & (1u << 12)) != 0;
+
+			if(maxLeaf >= 7)
+			{
+				CpuId(7, 0, registers);
+				features.m_AVX2 = features.m_AVX && (registers[1] & (1u << 5)) != 0;
+			}
+#endif
+			return features;
+		}
+	}; // namespace
+
+	const CpuFeatures& GetCpuFeatures()
+	{
+		static const CpuFeatures features = ReadFeatures();
+		return features;
+	}
+
+}; // namespace Core
@@ -0,0 +1,20 @@
+#pragma once
+#include "core/Types.h"
+
+namespace Core
+{
+	/*
+		What the CPU we are running on can do, read once with cpuid. AVX is only reported when the OS also saves the
+		ymm registers, so a set flag means the instructions are safe to run.
+	*/
+	struct CpuFeatures
+	{
+		bool m_SSE41 = false;
+		bool m_AVX = false;
+		bool m_AVX2 = false;
+		bool m_FMA = false;
+	};
+
+	const CpuFeatures& GetCpuFeatures();
+
+}; // namespace Core
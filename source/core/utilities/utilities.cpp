@@ -1,5 +1,6 @@
 #include "utilities.h"
-#include "Core/hash/Murmur3.h"
+#include "core/hash/Murmur3.h"
+#include <cstdarg>
 #ifdef _WIN32
 #include <Windows.h>
 #endif
@@ -28,14 +29,14 @@ namespace Core
 
 	uint64 Hash(const std::string& str)
 	{
-		uint64 result;
+		uint64 result = 0; // x86_32 only writes the low 32 bits
 		MurmurHash3_x86_32(str.c_str(), (int32)str.length(), 0, &result);
 		return result;
 	}
 
 	uint64 Hash(const std::string& str, uint32 seed)
 	{
-		uint64 result;
+		uint64 result = 0; // x86_32 only writes the low 32 bits
 		MurmurHash3_x86_32(str.c_str(), (int32)str.length(), seed, &result);
 		return result;
 	}
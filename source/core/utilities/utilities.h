@@ -1,5 +1,5 @@
 #pragma once
-#include "Core/Types.h"
+#include "core/Types.h"
 #include <string>
 
 namespace Core
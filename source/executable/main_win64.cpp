@@ -1,7 +1,10 @@
 #include "graphics/Window.h"
 #include "graphics/GraphicsEngine.h"
 
+#include "core/AsyncIO.h"
+#include "core/JobSystem.h"
 #include "core/Timer.h"
+#include "core/memory/MemoryTracker.h"
 #include "input/InputManager.h"
 #include "Logger/Debug.h"
 
@@ -26,6 +29,9 @@ int WINAPI WinMain(HINSTANCE instance, HINSTANCE /*prevInstance*/, LPSTR /*lpCmd
 	Window window(createInfo);
 	window.SetText("Kaffe b�nan");
 
+	Core::AsyncIO::Create();
+	Core::JobSystem::Create(0, 128);
+
 	Graphics::GraphicsEngine::Create();
 	Graphics::GraphicsEngine& graphics_engine = Graphics::GraphicsEngine::Get();
 	Graphics::CreateImGuiContext();
@@ -48,9 +54,12 @@ int WINAPI WinMain(HINSTANCE instance, HINSTANCE /*prevInstance*/, LPSTR /*lpCmd
 	do
 	{
 		timer.Update();
+		Core::MemoryTracker::Update(timer.GetTime());
 
-		char temp[100] = { 0 };
-		sprintf_s(temp, "FPS : %.3f dt: %.3f", 1.f / timer.GetTime(), timer.GetTime());
+		const Core::MemoryStats heap = Core::MemoryTracker::GetTotal();
+		char temp[128] = { 0 };
+		sprintf_s(temp, "FPS : %.3f dt: %.3f heap: %.1f kb %.0f allocs/s", 1.f / timer.GetTime(), timer.GetTime(),
+				  (float)heap.m_LiveBytes / 1024.f, heap.m_AllocationsPerSecond);
 		window.SetText(temp);
 
 		/* Windows Specific */
@@ -66,6 +75,8 @@ int WINAPI WinMain(HINSTANCE instance, HINSTANCE /*prevInstance*/, LPSTR /*lpCmd
 		}
 		/* Windows Specific */
 
+		Core::AsyncIO::Get().DispatchCompletions();
+		Core::JobSystem::Get().ProcessMainThreadJobs();
 		state_stack.UpdateCurrentState(timer.GetTime());
 		input.Update();
 		// graphics_engine.Update();
@@ -74,6 +85,8 @@ int WINAPI WinMain(HINSTANCE instance, HINSTANCE /*prevInstance*/, LPSTR /*lpCmd
 	} while(true);
 
 	Input::InputManager::Destroy();
+	Core::JobSystem::Destroy();
+	Core::AsyncIO::Destroy();
 
 	Log::Debug::Destroy();
 
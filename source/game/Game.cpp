@@ -6,16 +6,18 @@
 
 #include "game/camera/Camera.h"
 
+#include "core/memory/Allocator.h"
+
 void Game::InitState(StateStack* state_stack)
 {
 	m_StateStack = state_stack;
 
-	m_Camera = new Camera;
+	m_Camera = Core::New<Camera>(Core::MemoryTag::Game);
 }
 
 void Game::EndState()
 {
-	delete m_Camera;
+	Core::Delete(Core::MemoryTag::Game, m_Camera);
 	m_Camera = nullptr;
 }
 
@@ -1,6 +1,11 @@
 #include "StateStack.h"
 #include "State.h"
 
+StateStack::StateStack()
+	: m_GameStates( 4, Core::GetAllocator( Core::MemoryTag::Game ) )
+{
+}
+
 void StateStack::PopCurrentMainState()
 {
 	while( m_GameStates[m_MainIndex].Size() > 0 )
@@ -34,7 +39,7 @@ void StateStack::PushState( State* game_state, EGameStateType game_state_type )
 {
 	if( game_state_type == MAIN )
 	{
-		m_GameStates.Add( SubStateContainer( 4 ) );
+		m_GameStates.Add( SubStateContainer( 4, m_GameStates.GetAllocator() ) );
 		m_MainIndex = m_GameStates.Size() - 1; // what happens at size 0? state -1?
 		m_GameStates[m_MainIndex].Add( game_state );
 		State* state = m_GameStates[m_MainIndex].GetLast();
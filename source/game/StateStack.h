@@ -8,7 +8,7 @@ typedef Core::GrowingArray<SubStateContainer> MainStateContainer;
 class StateStack
 {
 public:
-	StateStack() = default;
+	StateStack();
 
 	enum EGameStateType
 	{
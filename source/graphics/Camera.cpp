@@ -1,5 +1,8 @@
 #include "Camera.h"
 
+#include "Core/math/MatrixKernels.h"
+#include "Core/mesh/LodSelection.h"
+
 void Camera::InitOrthographicProjection(float width, float height, float near_plane, float far_plane)
 {
 	m_ProjectionMatrix = Core::Matrix44f::CreateOrthogonalMatrixLH(width, height, near_plane, far_plane);
@@ -14,11 +17,13 @@ void Camera::InitPerspectiveProjection(float width, float height, float near_pla
 {
 	// m_ProjectionMatrix = Core::Matrix44f::CreateProjectionMatrixLH(near_plane, far_plane, width / height, fov);
 	m_ProjectionMatrix = Core::VKCreatePerspectiveMatrix(near_plane, far_plane, width / height, fov);
+	m_LodScale = Core::Mesh::GetLodScale(m_ProjectionMatrix, height);
 }
 
 void Camera::Update() // called once per frame
 {
-	m_ViewProjection = m_ProjectionMatrix * Core::FastInverse(m_ViewMatrix);
+	Core::Math::Inverse(m_ViewMatrix, m_ViewMatrixInverse);
+	Core::Math::Multiply(m_ProjectionMatrix, m_ViewMatrixInverse, m_ViewProjection);
 }
 
 Core::Matrix44f* Camera::GetViewProjectionPointer()
@@ -35,27 +40,13 @@ void Camera::OrientCamera(const Core::Vector2f& cursor_pos)
 	m_Pitch = Core::Quaternion(Core::Vector3f(1.f, 0, 0), m_CenterPoint.y);
 	m_Yaw = Core::Quaternion(Core::Vector3f(0, 1.f, 0), m_CenterPoint.x);
 
-	Core::Vector3f axisX(1.f, 0, 0);
-	Core::Vector3f axisY(0, 1.f, 0);
-	Core::Vector3f axisZ(0, 0, 1.f);
-
-	axisX = m_Yaw * m_Pitch * axisX;
-	axisY = m_Yaw * m_Pitch * axisY;
-	axisZ = m_Yaw * m_Pitch * axisZ;
-
-	// m_Rotation2 = m_Rotation;
-
-	m_ViewMatrix[0] = axisX.x;
-	m_ViewMatrix[1] = axisX.y;
-	m_ViewMatrix[2] = axisX.z;
-
-	m_ViewMatrix[4] = axisY.x;
-	m_ViewMatrix[5] = axisY.y;
-	m_ViewMatrix[6] = axisY.z;
-
-	m_ViewMatrix[8] = axisZ.x;
-	m_ViewMatrix[9] = axisZ.y;
-	m_ViewMatrix[10] = axisZ.z;
+	// the rotated x, y and z axes are the rows of the rotation matrix, one product instead of six
+	const Core::Matrix44f rotation = (m_Yaw * m_Pitch).ConvertToRotationMatrix();
+	for(int row = 0; row < 3; ++row)
+	{
+		for(int column = 0; column < 3; ++column)
+			m_ViewMatrix[row * 4 + column] = rotation[row * 4 + column];
+	}
 }
 
 void Camera::Forward(float distance)
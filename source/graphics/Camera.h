@@ -30,11 +30,15 @@ public:
 
 	const Core::Vector4f& GetPosition() { return m_ViewMatrix.GetTranslation(); }
 
+	// pixels per unit at distance 1 for LOD selection, set by InitPerspectiveProjection
+	float GetLodScale() const { return m_LodScale; }
+
 private:
 	Core::Matrix44f m_ProjectionMatrix = Core::Matrix44f::Identity();
 	Core::Matrix44f m_ViewMatrix = Core::Matrix44f::Identity();
 	Core::Matrix44f m_ViewMatrixInverse = Core::Matrix44f::Identity();
 	Core::Matrix44f m_ViewProjection = Core::Matrix44f::Identity();
+	float m_LodScale = 1.f;
 
 	Core::Vector2f m_CenterPoint;
 	Core::Quaternion m_Pitch;
@@ -1,49 +1,30 @@
 #include "ConstantBuffer.h"
 
-#include "VlkDevice.h"
-#include "VlkPhysicalDevice.h"
+#include "VlkUniformRing.h"
 
-#include <vulkan/vulkan_core.h>
+#include "logger/Debug.h"
 
-ConstantBuffer::ConstantBuffer() = default;
-void ConstantBuffer::Init(VlkDevice* device, VlkPhysicalDevice* physDevice)
-{
-	if(m_Vars.Size() <= 0)
-	{
-		ASSERT(false, "You have to Register some variables before initializing the constant buffer!");
-		return;
-	}
-
-	VkBufferCreateInfo createInfo = {};
-	createInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-	createInfo.size = m_BufferSize;
-	createInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
-	createInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-
-	auto [buffer, memReq] = device->CreateBuffer(createInfo);
-	m_Buffer = buffer;
-	m_DeviceMemory = device->AllocateMemory(memReq, physDevice);
-	Bind(device);
-}
+#include <cstring>
 
-void ConstantBuffer::Bind(VlkDevice* device)
+ConstantBuffer::ConstantBuffer()
+	: m_Vars(4, Core::GetAllocator(Core::MemoryTag::Graphics))
 {
-	device->BindBuffer(m_Buffer, m_DeviceMemory);
 }
 
-void ConstantBuffer::Map(VlkDevice* device)
+bool ConstantBuffer::Write(VlkUniformRing& ring, uint32& offset) const
 {
-	int8* data = (int8*)device->MapMemory(m_DeviceMemory, 0, m_BufferSize, 0);
-	memcpy(data, &m_Vars[0], m_BufferSize);
-	device->UnmapMemory(m_DeviceMemory);
-}
+	ASSERT(m_Vars.Size() > 0, "You have to Register some variables before writing the constant buffer!");
 
-void ConstantBuffer::Destroy(VkDevice device)
-{
-	vkDestroyBuffer(device, m_Buffer, nullptr);
-}
+	const VlkUniformRing::Allocation allocation = ring.Allocate(m_BufferSize);
+	if(!allocation.m_Data)
+		return false;
 
-VkDescriptorBufferInfo ConstantBuffer::GetBufferDesc()
-{
-	return VkDescriptorBufferInfo{ .buffer = m_Buffer, .offset = 0, .range = m_BufferSize };
+	int8* data = static_cast<int8*>(allocation.m_Data);
+	for(const Var& var : m_Vars)
+	{
+		memcpy(data, var.m_Data, var.m_Size);
+		data += var.m_Size;
+	}
+	offset = allocation.m_Offset;
+	return true;
 }
@@ -3,33 +3,40 @@
 #include "Core/Defines.h"
 #include "Core/containers/GrowingArray.h"
 
-#include <vulkan/vulkan_core.h>
+class VlkUniformRing;
 
-class VlkDevice;
-class VlkPhysicalDevice;
+// The layout of a uniform block, the registered variables back to back. Its memory comes from a VlkUniformRing.
 class ConstantBuffer
 {
 public:
 	ConstantBuffer();
-	void Init(VlkDevice* device, VlkPhysicalDevice* physDevice);
-	void Bind(VlkDevice* device);
-	void Map(VlkDevice* physDevice);
-	void Destroy(VkDevice device);
 
 	template <typename T>
 	void RegVar(T* var);
-	VkDescriptorBufferInfo GetBufferDesc();
+
+	/*
+		Copies the current value of every variable into this frame's region and sets offset to the dynamic offset
+		to bind. Returns false when the ring has no room left, nothing is written and offset is left alone.
+	*/
+	bool Write(VlkUniformRing& ring, uint32& offset) const;
+
+	// the descriptor range
+	uint32 GetSize() const { return m_BufferSize; }
 
 private:
+	struct Var
+	{
+		const void* m_Data = nullptr;
+		uint32 m_Size = 0;
+	};
+
 	uint32 m_BufferSize = 0;
-	Core::GrowingArray<void*> m_Vars;
-	VkBuffer m_Buffer;
-	VkDeviceMemory m_DeviceMemory;
+	Core::GrowingArray<Var> m_Vars;
 };
 
 template <typename T>
 void ConstantBuffer::RegVar(T* var)
 {
-	m_Vars.Add(var);
+	m_Vars.Add(Var{ var, sizeof(T) });
 	m_BufferSize += sizeof(T);
 }
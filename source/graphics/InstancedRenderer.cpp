@@ -0,0 +1,129 @@
+#include "InstancedRenderer.h"
+
+#include "VlkDevice.h"
+#include "VlkCommandBuffer.h"
+#include "VlkUploadContext.h"
+
+#include "Core/JobSystem.h"
+
+#include "Logger/Debug.h"
+
+#include <vulkan/vulkan_core.h>
+
+void InstancedRenderer::Init(VlkDevice* device, uint32 maxInstances)
+{
+	ASSERT(!m_InstanceBuffer, "InstancedRenderer is already initialized");
+	m_MaxInstances = maxInstances;
+
+	const uint64 size = uint64(FrameCount) * maxInstances * sizeof(Core::Matrix44f);
+	VkBufferCreateInfo createInfo = {};
+	createInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	createInfo.size = size;
+	createInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+	createInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	auto [buffer, memReq] = device->CreateBuffer(createInfo);
+	m_InstanceBuffer = buffer;
+	// host coherent, the matrices written in Prepare are visible to the next submit without a flush
+	m_InstanceMemory = device->GetMemoryAllocator().AllocateBuffer(
+		buffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	m_Instances = static_cast<Core::Matrix44f*>(m_InstanceMemory.m_Mapped);
+}
+
+void InstancedRenderer::Destroy(VlkDevice* device)
+{
+	VlkMemoryAllocator& allocator = device->GetMemoryAllocator();
+	for(Mesh& mesh : m_Meshes)
+	{
+		vkDestroyBuffer(device->GetDevice(), mesh.m_VertexBuffer.m_Buffer, nullptr);
+		allocator.Free(mesh.m_VertexBuffer.m_Memory);
+		vkDestroyBuffer(device->GetDevice(), mesh.m_IndexBuffer.m_Buffer, nullptr);
+		allocator.Free(mesh.m_IndexBuffer.m_Memory);
+	}
+	m_Meshes.clear();
+	m_Batcher.Clear();
+
+	if(m_InstanceBuffer)
+	{
+		vkDestroyBuffer(device->GetDevice(), m_InstanceBuffer, nullptr);
+		allocator.Free(m_InstanceMemory);
+	}
+	m_InstanceBuffer = nullptr;
+	m_InstanceMemory = Core::GpuAllocation();
+	m_Instances = nullptr;
+}
+
+uint32 InstancedRenderer::AddMesh(VlkUploadContext& uploads, const Core::Mesh::MeshView& meshView)
+{
+	const Core::MeshHeader& header = meshView.GetHeader();
+
+	m_Meshes.emplace_back();
+	Mesh& mesh = m_Meshes.back();
+	mesh.m_VertexBuffer.m_Stride = static_cast<int32>(header.m_VertexStride);
+	mesh.m_VertexBuffer.m_VertexCount = static_cast<int32>(header.m_VertexCount);
+	mesh.m_VertexBuffer.m_Offset = 0;
+	mesh.m_VertexBuffer.m_Buffer = uploads.CreateBuffer(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, meshView.GetVertexData(),
+														mesh.m_VertexBuffer.m_Memory);
+
+	mesh.m_IndexBuffer.m_IndexCount = static_cast<int32>(header.m_IndexCount);
+	mesh.m_IndexBuffer.m_IndexType = header.m_IndexSize == 2 ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+	mesh.m_IndexBuffer.m_Buffer = uploads.CreateBuffer(VK_BUFFER_USAGE_INDEX_BUFFER_BIT, meshView.GetIndexData(),
+													   mesh.m_IndexBuffer.m_Memory);
+
+	mesh.m_Dequantize = meshView.GetDequantizeMatrix();
+
+	Core::InstancedMesh instanced;
+	instanced.m_BoundsCenter =
+		Core::Vector3f(header.m_BoundsCenter[0], header.m_BoundsCenter[1], header.m_BoundsCenter[2]);
+	instanced.m_BoundsRadius = header.m_BoundsRadius;
+	// the batcher keeps its own copy, the view can go away
+	instanced.m_Lods = meshView.GetLods();
+	return m_Batcher.AddMesh(instanced);
+}
+
+void InstancedRenderer::Prepare(uint32 frame, Core::JobSystem& jobs, const Core::Matrix44f* world,
+								const Core::Frustum& frustum, const Core::Vector3f& cameraPosition, float lodScale)
+{
+	ASSERT(frame < FrameCount, "Frame out of range");
+	ASSERT(m_Batcher.GetInstanceCount() <= m_MaxInstances, "More instances than the instance buffer holds");
+	m_Frame = frame;
+	m_Batches = m_Batcher.Build(jobs, world, frustum, cameraPosition, lodScale,
+								m_Instances + uint64(frame) * m_MaxInstances);
+
+	// the batches come sorted by mesh
+	m_MeshBatches.assign(m_Meshes.size(), BatchRange());
+	for(uint32 i = 0; i < m_Batches.Size(); ++i)
+	{
+		BatchRange& range = m_MeshBatches[m_Batches[i].m_Mesh];
+		range.m_First = range.m_Count == 0 ? i : range.m_First;
+		++range.m_Count;
+	}
+}
+
+void InstancedRenderer::Draw(VlkCommandBuffer* commandBuffer, VkPipelineLayout pipelineLayout, uint32 meshIndex) const
+{
+	const BatchRange& range = m_MeshBatches[meshIndex];
+	if(range.m_Count == 0)
+		return;
+
+	const Mesh& mesh = m_Meshes[meshIndex];
+	const Core::Span<const Core::MeshLod> lods = m_Batcher.GetLods(meshIndex);
+	// vkCmdPushConstants copies the values when recording
+	commandBuffer->PushConstants(pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(Core::Matrix44f),
+								 &mesh.m_Dequantize[0]);
+
+	VkBuffer buffers[] = { mesh.m_VertexBuffer.m_Buffer, m_InstanceBuffer };
+	VkDeviceSize offsets[] = { 0, VkDeviceSize(m_Frame) * m_MaxInstances * sizeof(Core::Matrix44f) };
+	commandBuffer->BindVertexBuffers(0, ARRSIZE(buffers), buffers, offsets);
+	commandBuffer->BindIndexBuffer(mesh.m_IndexBuffer.m_Buffer, 0,
+								   static_cast<VkIndexType>(mesh.m_IndexBuffer.m_IndexType));
+
+	for(uint32 i = range.m_First; i < range.m_First + range.m_Count; ++i)
+	{
+		const Core::InstanceBatch& batch = m_Batches[i];
+		const Core::MeshLod& lod = lods[batch.m_Lod];
+		commandBuffer->DrawIndexed(lod.m_IndexCount, batch.m_InstanceCount, lod.m_IndexOffset, 0,
+								   batch.m_FirstInstance);
+	}
+}
@@ -0,0 +1,117 @@
+#pragma once
+#include "Core/Types.h"
+#include "Core/Defines.h"
+
+#include "Core/containers/Span.h"
+#include "Core/math/Matrix44.h"
+#include "Core/math/Frustum.h"
+#include "Core/memory/GpuMemoryAllocator.h"
+#include "Core/mesh/InstanceBatcher.h"
+#include "Core/mesh/MeshFormat.h"
+
+#include <vector>
+
+namespace Core
+{
+	class JobSystem;
+};
+
+class VlkDevice;
+class VlkCommandBuffer;
+class VlkUploadContext;
+
+DEFINE_HANDLE(VkBuffer);
+DEFINE_HANDLE(VkPipelineLayout);
+
+struct VertexBuffer
+{
+	VkBuffer m_Buffer;
+	Core::GpuAllocation m_Memory;
+	int32 m_VertexCount = 0;
+	int32 m_Stride = 0;
+	int32 m_Offset = 0;
+};
+
+struct IndexBuffer
+{
+	VkBuffer m_Buffer;
+	Core::GpuAllocation m_Memory;
+	int32 m_IndexCount = 0;
+	int32 m_IndexType = 0; // VkIndexType
+};
+
+/*
+	Draws every copy of a mesh with one instanced draw per LOD in use instead of one draw per copy. A mesh's vertices
+	and indices are uploaded to device local memory once and shared, the world matrices of the visible copies go to
+	a host visible instance buffer every frame, read through the per instance binding from AddInstanceTransform.
+	The pipeline has to be built from shaders/vertex_instanced.vert.
+
+	Instances are stored densely in the same order as the TransformBatch with their transforms, removing one moves
+	the last instance into its place in both.
+*/
+class InstancedRenderer
+{
+public:
+	static constexpr uint32 FrameCount = 2;
+
+	InstancedRenderer() = default;
+	~InstancedRenderer() = default;
+
+	InstancedRenderer(const InstancedRenderer&) = delete;
+	InstancedRenderer& operator=(const InstancedRenderer&) = delete;
+
+	// room for maxInstances in every frame in flight
+	void Init(VlkDevice* device, uint32 maxInstances);
+	void Destroy(VlkDevice* device);
+
+	/*
+		The vertices and indices of mesh are queued for upload into device local buffers, the view can go away
+		afterwards. The mesh can be drawn once the uploads have been flushed.
+	*/
+	uint32 AddMesh(VlkUploadContext& uploads, const Core::Mesh::MeshView& mesh);
+
+	uint32 AddInstance(uint32 mesh) { return m_Batcher.AddInstance(mesh); }
+	void RemoveCyclicAtIndex(uint32 index) { m_Batcher.RemoveCyclicAtIndex(index); }
+	uint32 GetInstanceCount() const { return m_Batcher.GetInstanceCount(); }
+	uint32 GetMeshCount() const { return static_cast<uint32>(m_Meshes.size()); }
+
+	/*
+		Culls the instances, picks their LODs and writes the visible ones to frame's part of the instance buffer,
+		on all job threads. lodScale is Camera::GetLodScale. The GPU has to be done with what was drawn for frame
+		the last time around.
+	*/
+	void Prepare(uint32 frame, Core::JobSystem& jobs, const Core::Matrix44f* world, const Core::Frustum& frustum,
+				 const Core::Vector3f& cameraPosition, float lodScale);
+
+	/*
+		Records the draws of mesh from the last Prepare, one per LOD that has visible instances. The pipeline and
+		descriptor sets have to be bound already. Meshes can be recorded from different threads at the same time.
+	*/
+	void Draw(VlkCommandBuffer* commandBuffer, VkPipelineLayout pipelineLayout, uint32 mesh) const;
+
+private:
+	struct Mesh
+	{
+		VertexBuffer m_VertexBuffer;
+		IndexBuffer m_IndexBuffer;
+		Core::Matrix44f m_Dequantize; // quantized positions to model space, pushed once per mesh
+	};
+
+	struct BatchRange
+	{
+		uint32 m_First = 0;
+		uint32 m_Count = 0;
+	};
+
+	std::vector<Mesh> m_Meshes;
+	Core::InstanceBatcher m_Batcher{ Core::GetAllocator(Core::MemoryTag::Graphics) };
+
+	VkBuffer m_InstanceBuffer = nullptr;
+	Core::GpuAllocation m_InstanceMemory;
+	Core::Matrix44f* m_Instances = nullptr; // mapped for as long as the buffer lives, FrameCount * m_MaxInstances
+	uint32 m_MaxInstances = 0;
+
+	uint32 m_Frame = 0;
+	Core::Span<const Core::InstanceBatch> m_Batches; // from the last Prepare
+	std::vector<BatchRange> m_MeshBatches; // per mesh, its part of m_Batches
+};
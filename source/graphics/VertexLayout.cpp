@@ -0,0 +1,97 @@
+#include "VertexLayout.h"
+
+#include "Core/math/Matrix44.h"
+#include "logger/Debug.h"
+
+VkFormat GetVkFormat(Core::VertexFormat format)
+{
+	switch(format)
+	{
+		case Core::VertexFormat::Float4:
+			return VK_FORMAT_R32G32B32A32_SFLOAT;
+		case Core::VertexFormat::Half4:
+			return VK_FORMAT_R16G16B16A16_SFLOAT;
+		case Core::VertexFormat::Snorm16x4:
+			return VK_FORMAT_R16G16B16A16_SNORM;
+		case Core::VertexFormat::Oct16:
+			return VK_FORMAT_R16G16_SNORM;
+		case Core::VertexFormat::Unorm8x4:
+			return VK_FORMAT_R8G8B8A8_UNORM;
+	}
+
+	ASSERT(false, "Unknown vertex format");
+	return VK_FORMAT_UNDEFINED;
+}
+
+uint32 GetShaderLocation(Core::VertexAttribute attribute)
+{
+	switch(attribute)
+	{
+		case Core::VertexAttribute::Position:
+			return 0;
+		case Core::VertexAttribute::Color:
+			return 1;
+		case Core::VertexAttribute::Normal:
+			return 2;
+		default:
+			break;
+	}
+
+	ASSERT(false, "Unknown vertex attribute");
+	return 0;
+}
+
+namespace
+{
+	// the shaders declare float4 positions and colours, any format widens to that, but normals are float2 octahedral
+	bool MatchesShaderInput(Core::VertexAttribute attribute, Core::VertexFormat format)
+	{
+		if(attribute == Core::VertexAttribute::Normal)
+			return format == Core::VertexFormat::Oct16;
+		return format != Core::VertexFormat::Oct16;
+	}
+}; // namespace
+
+VertexInputDesc CreateVertexInputDesc(const Core::MeshHeader& header, uint32 binding)
+{
+	VertexInputDesc desc;
+	VkVertexInputBindingDescription& vertexBinding = desc.m_Bindings[desc.m_BindingCount++];
+	vertexBinding.binding = binding;
+	vertexBinding.stride = header.m_VertexStride;
+	vertexBinding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+	for(uint32 i = 0; i < header.m_AttributeCount && i < ARRSIZE(header.m_Attributes); ++i)
+	{
+		const Core::MeshAttribute& attribute = header.m_Attributes[i];
+		VERIFY(MatchesShaderInput(attribute.m_Attribute, attribute.m_Format),
+			   "Attribute %u of the mesh is stored in a format the shaders don't read, cook it with the defaults",
+			   (uint32)attribute.m_Attribute);
+		VkVertexInputAttributeDescription& out = desc.m_Attributes[desc.m_AttributeCount++];
+		out.binding = binding;
+		out.location = GetShaderLocation(attribute.m_Attribute);
+		out.format = GetVkFormat(attribute.m_Format);
+		out.offset = attribute.m_Offset;
+	}
+
+	return desc;
+}
+
+void AddInstanceTransform(VertexInputDesc& desc, uint32 binding)
+{
+	ASSERT(desc.m_BindingCount < ARRSIZE(desc.m_Bindings), "No room for another binding");
+	ASSERT(desc.m_AttributeCount + 4 <= ARRSIZE(desc.m_Attributes), "No room for the instance transform");
+
+	VkVertexInputBindingDescription& instanceBinding = desc.m_Bindings[desc.m_BindingCount++];
+	instanceBinding.binding = binding;
+	instanceBinding.stride = sizeof(Core::Matrix44f);
+	instanceBinding.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+	for(uint32 row = 0; row < 4; ++row)
+	{
+		VkVertexInputAttributeDescription& out = desc.m_Attributes[desc.m_AttributeCount++];
+		out.binding = binding;
+		out.location = s_InstanceWorldLocation + row;
+		out.format = VK_FORMAT_R32G32B32A32_SFLOAT;
+		out.offset = row * sizeof(Core::Vector4f);
+	}
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include "Core/Types.h"
+#include "Core/Defines.h"
+#include "Core/mesh/MeshFormat.h"
+
+#include <vulkan/vulkan_core.h>
+
+// Vertex input state for a .mesh, built from its header instead of being hard coded next to the pipeline.
+struct VertexInputDesc
+{
+	VkVertexInputBindingDescription m_Bindings[2] = {};
+	uint32 m_BindingCount = 0;
+	VkVertexInputAttributeDescription m_Attributes[8] = {};
+	uint32 m_AttributeCount = 0;
+};
+
+VkFormat GetVkFormat(Core::VertexFormat format);
+
+// The shader location of an attribute, these match the inputs in shaders/vertex.vert and vertex_instanced.vert.
+uint32 GetShaderLocation(Core::VertexAttribute attribute);
+
+// VERIFYs that every attribute is in a format the shaders above read, normals have to be Oct16.
+VertexInputDesc CreateVertexInputDesc(const Core::MeshHeader& header, uint32 binding = 0);
+
+/*
+	Adds a per instance binding holding one row major Core::Matrix44f per instance, read as four float4 rows at
+	s_InstanceWorldLocation and the three locations after it, like shaders/vertex_instanced.vert expects.
+*/
+static constexpr uint32 s_InstanceWorldLocation = 3;
+void AddInstanceTransform(VertexInputDesc& desc, uint32 binding);
@@ -33,6 +33,22 @@ void VlkCommandBuffer::Begin()
 	VERIFY(vkBeginCommandBuffer(m_Buffer, &m_BeginInfo) == VK_SUCCESS, "vkBeginCommandBuffer failed!");
 }
 
+void VlkCommandBuffer::BeginSecondary(VkRenderPass renderPass, uint32 subpass, VkFramebuffer framebuffer)
+{
+	ASSERT(m_BufferLevel == CommandBufferLevel::E_SECONDARY, "BeginSecondary on a primary command buffer");
+
+	VkCommandBufferInheritanceInfo inheritance = {};
+	inheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+	inheritance.renderPass = renderPass;
+	inheritance.subpass = subpass;
+	inheritance.framebuffer = framebuffer;
+
+	VkCommandBufferBeginInfo beginInfo = m_BeginInfo;
+	beginInfo.flags |= VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+	beginInfo.pInheritanceInfo = &inheritance;
+	VERIFY(vkBeginCommandBuffer(m_Buffer, &beginInfo) == VK_SUCCESS, "vkBeginCommandBuffer failed!");
+}
+
 VkSubmitInfo VlkCommandBuffer::End()
 {
 	VERIFY(vkEndCommandBuffer(m_Buffer) == VK_SUCCESS, "vkEndCommandBuffer failed!");
@@ -51,6 +67,11 @@ void VlkCommandBuffer::CopyBuffer(VkBuffer src, VkBuffer dst, VkDeviceSize size)
 	vkCmdCopyBuffer(m_Buffer, src, dst, 1, &copyRegion);
 }
 
+void VlkCommandBuffer::CopyBuffer(VkBuffer src, VkBuffer dst, const VkBufferCopy* regions, uint32 regionCount)
+{
+	vkCmdCopyBuffer(m_Buffer, src, dst, regionCount, regions);
+}
+
 void VlkCommandBuffer::SetPipelineBarriers(PipelineBarrierSetupInfo info)
 {
 	vkCmdPipelineBarrier(m_Buffer, info.srcStageMask, info.dstStageMask, info.dependencyFlags, info.memoryBarrierCount,
@@ -82,11 +103,22 @@ void VlkCommandBuffer::EndRenderPass()
 	vkCmdEndRenderPass(m_Buffer);
 }
 
+void VlkCommandBuffer::ExecuteCommands(const VkCommandBuffer* buffers, uint32 count)
+{
+	vkCmdExecuteCommands(m_Buffer, count, buffers);
+}
+
 void VlkCommandBuffer::DrawDirect(uint32 vertexCount, uint32 instanceCount, uint32 vertexStart, uint32 instanceStart)
 {
 	vkCmdDraw(m_Buffer, vertexCount, instanceCount, vertexStart, instanceStart);
 }
 
+void VlkCommandBuffer::DrawIndexed(uint32 indexCount, uint32 instanceCount, uint32 indexStart, int32 vertexOffset,
+								   uint32 instanceStart)
+{
+	vkCmdDrawIndexed(m_Buffer, indexCount, instanceCount, indexStart, vertexOffset, instanceStart);
+}
+
 void VlkCommandBuffer::PushConstants(VkPipelineLayout pipelineLayout, uint32 stageBit, uint32 offset, uint32 size, const void* pValues)
 {
 	vkCmdPushConstants(m_Buffer, pipelineLayout, stageBit, offset, size, pValues);
@@ -95,4 +127,9 @@ void VlkCommandBuffer::PushConstants(VkPipelineLayout pipelineLayout, uint32 sta
 void VlkCommandBuffer::BindVertexBuffers(uint32 startBindingPos, uint32 nofBindings, const VkBuffer* buffer, VkDeviceSize* offset)
 {
 	vkCmdBindVertexBuffers(m_Buffer, startBindingPos, nofBindings, buffer, offset);
+}
+
+void VlkCommandBuffer::BindIndexBuffer(VkBuffer buffer, VkDeviceSize offset, VkIndexType indexType)
+{
+	vkCmdBindIndexBuffer(m_Buffer, buffer, offset, indexType);
 }
\ No newline at end of file
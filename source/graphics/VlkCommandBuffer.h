@@ -47,9 +47,15 @@ public:
 	void Init(VlkCommandPool* pool, CommandBufferUsage usage, CommandBufferLevel bufferLevel, VkCommandBuffer buffer);
 
 	void Begin();
+	// Secondary buffers only, records commands that a primary buffer runs inside that subpass of renderPass.
+	void BeginSecondary(VkRenderPass renderPass, uint32 subpass, VkFramebuffer framebuffer);
 	VkSubmitInfo End();
 
+	// Primary buffers only, inside a render pass begun with VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS.
+	void ExecuteCommands(const VkCommandBuffer* buffers, uint32 count);
+
 	void CopyBuffer(VkBuffer src, VkBuffer dst, VkDeviceSize size);
+	void CopyBuffer(VkBuffer src, VkBuffer dst, const VkBufferCopy* regions, uint32 regionCount);
 
 	void SetPipelineBarriers(PipelineBarrierSetupInfo info);
 	void BindPipeline(VkPipelineBindPoint pipelineBindPoint, VkPipeline pipeline);
@@ -61,9 +67,14 @@ public:
 
 	void PushConstants(VkPipelineLayout pipelineLayout, uint32 stageBit, uint32 offset, uint32 size, const void* pValues);
 	void BindVertexBuffers(uint32 startBindingPos, uint32 nofBindings, const VkBuffer* buffer, VkDeviceSize* offset);
+	void BindIndexBuffer(VkBuffer buffer, VkDeviceSize offset, VkIndexType indexType);
 	void DrawDirect(uint32 vertexCount, uint32 instanceCount, uint32 vertexStart, uint32 instanceStart);
+	void DrawIndexed(uint32 indexCount, uint32 instanceCount, uint32 indexStart, int32 vertexOffset,
+					 uint32 instanceStart);
 	// void DrawDirect(uint32 startBindingPos, uint32 nofBindings, VkBuffer buffer, VkDeviceSize* offset);
 
+	VkCommandBuffer GetHandle() const { return m_Buffer; }
+
 private:
 	VlkCommandPool* m_Owner = nullptr;
 	VkCommandBuffer m_Buffer = nullptr;
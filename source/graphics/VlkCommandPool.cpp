@@ -14,6 +14,8 @@ VlkCommandPool::~VlkCommandPool()
 void VlkCommandPool::Init(VkDevice device, int32 queueFamilyIndex)
 {
 	m_Device = device;
+	m_BufferAllocator.Init(16, Core::GetAllocator(Core::MemoryTag::Graphics));
+
 	VkCommandPoolCreateInfo poolCreateInfo = {};
 	poolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
 	poolCreateInfo.pNext = nullptr;
@@ -24,10 +26,12 @@ void VlkCommandPool::Init(VkDevice device, int32 queueFamilyIndex)
 		   "Failed to create VkCommandPool");
 }
 
-Core::GrowingArray<VlkCommandBuffer*> VlkCommandPool::CreateCommandBuffers(CommandBufferLevel bufferLevel,
-																		  CommandBufferUsage usage, int32 bufferCount)
+VlkCommandBufferList VlkCommandPool::CreateCommandBuffers(CommandBufferLevel bufferLevel, CommandBufferUsage usage,
+														  int32 bufferCount)
 {
-	Core::GrowingArray<VlkCommandBuffer*> buffers(bufferCount);
+	Core::IAllocator* allocator = Core::GetAllocator(Core::MemoryTag::Graphics);
+	VlkCommandBufferList buffers(allocator);
+	buffers.Reserve(bufferCount);
 
 	VkCommandBufferAllocateInfo info = {};
 	info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -35,13 +39,14 @@ Core::GrowingArray<VlkCommandBuffer*> VlkCommandPool::CreateCommandBuffers(Comma
 	info.commandBufferCount = bufferCount;
 	info.level = (VkCommandBufferLevel)bufferLevel;
 
-	auto vkBuffers = std::make_unique<VkCommandBuffer[]>(bufferCount);
-	VERIFY(vkAllocateCommandBuffers(m_Device, &info, vkBuffers.get()) == VK_SUCCESS,
+	Core::InlineArray<VkCommandBuffer, 2> vkBuffers(allocator);
+	vkBuffers.Resize(bufferCount);
+	VERIFY(vkAllocateCommandBuffers(m_Device, &info, vkBuffers.GetData()) == VK_SUCCESS,
 		   "Failed to create VkCommandBuffer");
 
 	for(int32 i = 0; i < bufferCount; ++i)
 	{
-		buffers.Add(new VlkCommandBuffer());
+		buffers.Add(new(m_BufferAllocator.Allocate()) VlkCommandBuffer());
 		VlkCommandBuffer* buffer = buffers[i];
 		buffer->Init(this, usage, bufferLevel, vkBuffers[i]);
 	}
@@ -49,7 +54,21 @@ Core::GrowingArray<VlkCommandBuffer*> VlkCommandPool::CreateCommandBuffers(Comma
 	return buffers;
 }
 
+void VlkCommandPool::DestroyCommandBuffer(VlkCommandBuffer* commandBuffer)
+{
+	if(!commandBuffer)
+		return;
+
+	commandBuffer->~VlkCommandBuffer();
+	m_BufferAllocator.Free(commandBuffer);
+}
+
 void VlkCommandPool::DestroyBuffer(VkCommandBuffer commandBuffer)
 {
 	vkFreeCommandBuffers(m_Device, m_CommandPool, 1, &commandBuffer);
 }
+
+void VlkCommandPool::Reset()
+{
+	VERIFY(vkResetCommandPool(m_Device, m_CommandPool, 0) == VK_SUCCESS, "Failed to reset VkCommandPool");
+}
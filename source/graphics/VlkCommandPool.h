@@ -4,7 +4,8 @@
 
 #include "VlkCommandBuffer.h"
 
-#include "Core/containers/GrowingArray.h"
+#include "Core/containers/InlineArray.h"
+#include "Core/memory/PoolAllocator.h"
 
 #ifndef VkCommandPool
 DEFINE_HANDLE(VkCommandPool);
@@ -15,6 +16,10 @@ DEFINE_HANDLE(VkDevice);
 #endif
 
 class VlkCommandBuffer;
+
+// Frames only ever ask for a couple of buffers at a time, keep those off the heap
+typedef Core::InlineArray<VlkCommandBuffer*, 2> VlkCommandBufferList;
+
 class VlkCommandPool
 {
 public:
@@ -23,10 +28,17 @@ public:
 
 	void Init(VkDevice device, int32 queueFamilyIndex);
 
-	Core::GrowingArray<VlkCommandBuffer*> CreateCommandBuffers(CommandBufferLevel bufferLevel, CommandBufferUsage usage, int32 bufferCount);
+	VlkCommandBufferList CreateCommandBuffers(CommandBufferLevel bufferLevel, CommandBufferUsage usage, int32 bufferCount);
+	// Frees the VkCommandBuffer and hands the VlkCommandBuffer back to the pool, use this instead of delete.
+	void DestroyCommandBuffer(VlkCommandBuffer* commandBuffer);
 	void DestroyBuffer(VkCommandBuffer commandBuffer);
 
+	// Puts every buffer of the pool back in the initial state, cheaper than resetting them one by one.
+	void Reset();
+
 private:
+	// one time command buffers come and go all the time, keep their wrappers out of the general heap
+	Core::PoolAllocator<sizeof(VlkCommandBuffer), alignof(VlkCommandBuffer)> m_BufferAllocator;
 	VkCommandPool m_CommandPool = nullptr;
 	VkDevice m_Device = nullptr;
 };
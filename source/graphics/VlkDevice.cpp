@@ -14,6 +14,7 @@ const char* deviceExt[] = { "VK_KHR_swapchain" };
 
 VlkDevice::~VlkDevice()
 {
+	m_MemoryAllocator.Destroy();
 	vkDestroyDevice(m_Device, nullptr);
 }
 
@@ -108,6 +109,7 @@ void VlkDevice::CopyBuffer(VkBuffer src, VkBuffer dst, VkDeviceSize size, VlkCom
 
 	vkQueueSubmit(m_Queue, 1, &submitInfo, VK_NULL_HANDLE);
 	vkQueueWaitIdle(m_Queue);
+	commandPool->DestroyCommandBuffer(buffer[0]);
 }
 
 VkShaderModule VlkDevice::CreateShaderModule(const char* data, uint32 dataLength)
@@ -141,13 +143,19 @@ void* VlkDevice::MapMemory(VkDeviceMemory memory, uint32 offset, uint32 size, ui
 
 void VlkDevice::Init(VlkPhysicalDevice* physicalDevice)
 {
-	// queue create info
+	m_QueueFamilyIndex = physicalDevice->GetQueueFamilyIndex();
+	const int32 transferFamily = physicalDevice->FindTransferQueueFamily();
+	m_TransferQueueFamilyIndex = transferFamily >= 0 ? (uint32)transferFamily : m_QueueFamilyIndex;
+
+	// queue create info, a second queue for uploads when there is a transfer only family
 	const float queue_priorities[] = { 1.f };
-	VkDeviceQueueCreateInfo queueCreateInfo = {};
-	queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-	queueCreateInfo.queueFamilyIndex = physicalDevice->GetQueueFamilyIndex();
-	queueCreateInfo.queueCount = 1;
-	queueCreateInfo.pQueuePriorities = queue_priorities;
+	VkDeviceQueueCreateInfo queueCreateInfo[2] = {};
+	queueCreateInfo[0].sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+	queueCreateInfo[0].queueFamilyIndex = m_QueueFamilyIndex;
+	queueCreateInfo[0].queueCount = 1;
+	queueCreateInfo[0].pQueuePriorities = queue_priorities;
+	queueCreateInfo[1] = queueCreateInfo[0];
+	queueCreateInfo[1].queueFamilyIndex = m_TransferQueueFamilyIndex;
 
 	// Physical device features
 	VkPhysicalDeviceFeatures enabled_features = {};
@@ -156,8 +164,8 @@ void VlkDevice::Init(VlkPhysicalDevice* physicalDevice)
 	// device create info
 	VkDeviceCreateInfo createInfo = {};
 	createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-	createInfo.queueCreateInfoCount = 1;
-	createInfo.pQueueCreateInfos = &queueCreateInfo;
+	createInfo.queueCreateInfoCount = m_TransferQueueFamilyIndex != m_QueueFamilyIndex ? 2 : 1;
+	createInfo.pQueueCreateInfos = queueCreateInfo;
 #ifdef _DEBUG
 	createInfo.enabledLayerCount = ARRSIZE(debugLayers);
 	createInfo.ppEnabledLayerNames = debugLayers;
@@ -168,5 +176,7 @@ void VlkDevice::Init(VlkPhysicalDevice* physicalDevice)
 
 	m_Device = physicalDevice->CreateDevice(createInfo);
 
-	vkGetDeviceQueue(m_Device, physicalDevice->GetQueueFamilyIndex(), 0, &m_Queue);
+	vkGetDeviceQueue(m_Device, m_QueueFamilyIndex, 0, &m_Queue);
+	vkGetDeviceQueue(m_Device, m_TransferQueueFamilyIndex, 0, &m_TransferQueue);
+	m_MemoryAllocator.Init(m_Device, physicalDevice->GetDevice());
 }
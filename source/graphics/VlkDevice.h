@@ -1,6 +1,7 @@
 #pragma once
 #include "Core/Defines.h"
 #include "Core/Types.h"
+#include "VlkMemoryAllocator.h"
 
 #include <vulkan/vulkan_core.h>
 #include <vector>
@@ -24,6 +25,12 @@ public:
 
 	VkDevice GetDevice() const { return m_Device; }
 	VkQueue GetQueue() const { return m_Queue; }
+	uint32 GetQueueFamilyIndex() const { return m_QueueFamilyIndex; }
+	// a queue of its own for copies when the device has one, the graphics queue otherwise
+	VkQueue GetTransferQueue() const { return m_TransferQueue; }
+	uint32 GetTransferQueueFamilyIndex() const { return m_TransferQueueFamilyIndex; }
+	// buffers and images should get their memory from here, AllocateMemory costs a device allocation every time
+	VlkMemoryAllocator& GetMemoryAllocator() { return m_MemoryAllocator; }
 
 	VkSwapchainKHR CreateSwapchain(const VkSwapchainCreateInfoKHR& createInfo) const;
 	void DestroySwapchain(VkSwapchainKHR pSwapchain);
@@ -48,4 +55,8 @@ public:
 private:
 	VkDevice m_Device = nullptr;
 	VkQueue m_Queue = nullptr;
+	VkQueue m_TransferQueue = nullptr;
+	uint32 m_QueueFamilyIndex = 0;
+	uint32 m_TransferQueueFamilyIndex = 0;
+	VlkMemoryAllocator m_MemoryAllocator;
 };
@@ -0,0 +1,124 @@
+#include "VlkMemoryAllocator.h"
+
+#include "logger/Debug.h"
+
+VlkMemoryAllocator::~VlkMemoryAllocator()
+{
+	Destroy();
+}
+
+void VlkMemoryAllocator::Init(VkDevice device, VkPhysicalDevice physicalDevice)
+{
+	ASSERT(!m_Device, "VlkMemoryAllocator is already initialized");
+	m_Device = device;
+
+	VkPhysicalDeviceMemoryProperties memoryProperties;
+	vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+	VkPhysicalDeviceProperties deviceProperties;
+	vkGetPhysicalDeviceProperties(physicalDevice, &deviceProperties);
+
+	Core::GpuMemoryProperties properties;
+	properties.m_TypeCount = memoryProperties.memoryTypeCount;
+	for(uint32 i = 0; i < memoryProperties.memoryTypeCount; ++i)
+	{
+		properties.m_Types[i].m_Flags = memoryProperties.memoryTypes[i].propertyFlags;
+		properties.m_Types[i].m_Heap = memoryProperties.memoryTypes[i].heapIndex;
+	}
+	properties.m_HeapCount = memoryProperties.memoryHeapCount;
+	for(uint32 i = 0; i < memoryProperties.memoryHeapCount; ++i)
+		properties.m_HeapSizes[i] = memoryProperties.memoryHeaps[i].size;
+	properties.m_BufferImageGranularity = deviceProperties.limits.bufferImageGranularity;
+
+	m_Allocator.Init(this, properties);
+}
+
+void VlkMemoryAllocator::Destroy()
+{
+	if(!m_Device)
+		return;
+
+	m_Allocator.Destroy();
+	m_Device = nullptr;
+}
+
+Core::GpuAllocation VlkMemoryAllocator::AllocateBuffer(VkBuffer buffer, VkMemoryPropertyFlags requiredFlags,
+													   VkMemoryPropertyFlags preferredFlags, bool dedicated)
+{
+	VkMemoryRequirements requirements;
+	vkGetBufferMemoryRequirements(m_Device, buffer, &requirements);
+
+	Core::GpuAllocationDesc desc;
+	desc.m_RequiredFlags = requiredFlags;
+	desc.m_PreferredFlags = preferredFlags;
+	desc.m_Dedicated = dedicated;
+	const Core::GpuAllocation allocation = Allocate(requirements, desc);
+	if(allocation.IsValid())
+		VERIFY(vkBindBufferMemory(m_Device, buffer, GetMemory(allocation), allocation.m_Offset) == VK_SUCCESS,
+			   "Failed to bind buffer memory!");
+	return allocation;
+}
+
+Core::GpuAllocation VlkMemoryAllocator::AllocateImage(VkImage image, VkImageTiling tiling,
+													  VkMemoryPropertyFlags requiredFlags,
+													  VkMemoryPropertyFlags preferredFlags, bool dedicated)
+{
+	VkMemoryRequirements requirements;
+	vkGetImageMemoryRequirements(m_Device, image, &requirements);
+
+	Core::GpuAllocationDesc desc;
+	desc.m_RequiredFlags = requiredFlags;
+	desc.m_PreferredFlags = preferredFlags;
+	desc.m_Dedicated = dedicated;
+	desc.m_Resource = tiling == VK_IMAGE_TILING_OPTIMAL ? Core::GpuAllocationDesc::Resource::OptimalImage
+														: Core::GpuAllocationDesc::Resource::Linear;
+	const Core::GpuAllocation allocation = Allocate(requirements, desc);
+	if(allocation.IsValid())
+		VERIFY(vkBindImageMemory(m_Device, image, GetMemory(allocation), allocation.m_Offset) == VK_SUCCESS,
+			   "Failed to bind image memory!");
+	return allocation;
+}
+
+void VlkMemoryAllocator::Free(const Core::GpuAllocation& allocation)
+{
+	m_Allocator.Free(allocation);
+}
+
+Core::GpuAllocation VlkMemoryAllocator::Allocate(const VkMemoryRequirements& requirements,
+												 Core::GpuAllocationDesc& desc)
+{
+	desc.m_Size = requirements.size;
+	desc.m_Alignment = requirements.alignment;
+	desc.m_MemoryTypeBits = requirements.memoryTypeBits;
+
+	const Core::GpuAllocation allocation = m_Allocator.Allocate(desc);
+	ASSERT(allocation.IsValid(), "Failed to allocate memory on GPU!");
+	return allocation;
+}
+
+uint64 VlkMemoryAllocator::AllocateBlock(uint32 memoryType, uint64 size)
+{
+	VkMemoryAllocateInfo allocInfo = {};
+	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocInfo.allocationSize = size;
+	allocInfo.memoryTypeIndex = memoryType;
+
+	// running out is expected here, the allocator moves on to a smaller allocation or another memory type
+	VkDeviceMemory memory = VK_NULL_HANDLE;
+	if(vkAllocateMemory(m_Device, &allocInfo, nullptr, &memory) != VK_SUCCESS)
+		return 0;
+	return reinterpret_cast<uint64>(memory);
+}
+
+void VlkMemoryAllocator::FreeBlock(uint64 block)
+{
+	// freeing unmaps as well
+	vkFreeMemory(m_Device, reinterpret_cast<VkDeviceMemory>(block), nullptr);
+}
+
+void* VlkMemoryAllocator::MapBlock(uint64 block)
+{
+	void* data = nullptr;
+	VERIFY(vkMapMemory(m_Device, reinterpret_cast<VkDeviceMemory>(block), 0, VK_WHOLE_SIZE, 0, &data) == VK_SUCCESS,
+		   "Failed to map vulkan memory!");
+	return data;
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include "Core/Defines.h"
+#include "Core/Types.h"
+#include "Core/memory/GpuMemoryAllocator.h"
+
+#include <vulkan/vulkan_core.h>
+
+/*
+	Places buffers and images in large blocks of device memory through a Core::GpuMemoryAllocator instead of a
+	vkAllocateMemory each. Flags are VkMemoryPropertyFlags, the memory type is picked from the resource's
+	memoryTypeBits. Host visible memory is mapped already, see GpuAllocation::m_Mapped, and stays mapped until it
+	is freed.
+*/
+class VlkMemoryAllocator : private Core::IGpuMemoryBackend
+{
+public:
+	VlkMemoryAllocator() = default;
+	~VlkMemoryAllocator();
+
+	VlkMemoryAllocator(const VlkMemoryAllocator&) = delete;
+	VlkMemoryAllocator& operator=(const VlkMemoryAllocator&) = delete;
+
+	void Init(VkDevice device, VkPhysicalDevice physicalDevice);
+	// every allocation has to be freed, before the device is destroyed
+	void Destroy();
+
+	// allocates and binds memory for buffer, invalid (and asserts) when there is none with requiredFlags left
+	Core::GpuAllocation AllocateBuffer(VkBuffer buffer, VkMemoryPropertyFlags requiredFlags,
+									   VkMemoryPropertyFlags preferredFlags = 0, bool dedicated = false);
+	Core::GpuAllocation AllocateImage(VkImage image, VkImageTiling tiling, VkMemoryPropertyFlags requiredFlags,
+									  VkMemoryPropertyFlags preferredFlags = 0, bool dedicated = false);
+	void Free(const Core::GpuAllocation& allocation);
+
+	static VkDeviceMemory GetMemory(const Core::GpuAllocation& allocation)
+	{
+		return reinterpret_cast<VkDeviceMemory>(allocation.m_Memory);
+	}
+
+	Core::GpuMemoryStats GetStats() const { return m_Allocator.GetStats(); }
+	Core::GpuMemoryStats GetStats(uint32 memoryType) const { return m_Allocator.GetStats(memoryType); }
+
+private:
+	uint64 AllocateBlock(uint32 memoryType, uint64 size) override;
+	void FreeBlock(uint64 block) override;
+	void* MapBlock(uint64 block) override;
+
+	Core::GpuAllocation Allocate(const VkMemoryRequirements& requirements, Core::GpuAllocationDesc& desc);
+
+	VkDevice m_Device = nullptr;
+	Core::GpuMemoryAllocator m_Allocator;
+};
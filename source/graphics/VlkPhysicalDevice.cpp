@@ -108,13 +108,26 @@ QueueProperties VlkPhysicalDevice::FindFamilyIndices(VlkSurface* pSurface)
 	return properties;
 }
 
+int32 VlkPhysicalDevice::FindTransferQueueFamily() const
+{
+	for(size_t i = 0; i < m_QueueProperties.size(); ++i)
+	{
+		const VkQueueFamilyProperties& property = m_QueueProperties[i];
+		const VkQueueFlags flags = property.queueFlags;
+		if(property.queueCount > 0 && (flags & VK_QUEUE_TRANSFER_BIT) &&
+		   !(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)))
+			return (int32)i;
+	}
+	return -1;
+}
+
 VkFormat VlkPhysicalDevice::FindDepthFormat()
 {
 	return FindSupportedFormat({ VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT }, VK_IMAGE_TILING_OPTIMAL,
 							   VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
 }
 
-VkFormat VlkPhysicalDevice::FindSupportedFormat(Core::GrowingArray<VkFormat> candidates, VkImageTiling tiling, VkFormatFeatureFlags featFlags)
+VkFormat VlkPhysicalDevice::FindSupportedFormat(const Core::InlineArray<VkFormat, 4>& candidates, VkImageTiling tiling, VkFormatFeatureFlags featFlags)
 {
 
 	for(VkFormat format : candidates)
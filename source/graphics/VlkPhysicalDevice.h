@@ -2,7 +2,7 @@
 
 #include "Core/Defines.h"
 #include "Core/Types.h"
-#include "Core/containers/GrowingArray.h"
+#include "Core/containers/InlineArray.h"
 
 #include <vector>
 #include <vulkan/vulkan_core.h>
@@ -29,6 +29,8 @@ public:
 	void Init(VlkInstance* instance);
 
 	uint32 GetQueueFamilyIndex() const { return m_QueueFamilyIndex; }
+	// a family that can only copy, usually the DMA engines running next to the graphics queue. -1 when there is none
+	int32 FindTransferQueueFamily() const;
 
 	VkDevice CreateDevice(const VkDeviceCreateInfo& createInfo) const;
 
@@ -40,7 +42,7 @@ public:
 
 
 	VkFormat FindDepthFormat();
-	VkFormat FindSupportedFormat(Core::GrowingArray<VkFormat> candidates, VkImageTiling tiling, VkFormatFeatureFlags featFlags);
+	VkFormat FindSupportedFormat(const Core::InlineArray<VkFormat, 4>& candidates, VkImageTiling tiling, VkFormatFeatureFlags featFlags);
 
 	uint32 FindMemoryType(uint32 typeFilter, VkMemoryPropertyFlags flags);
 
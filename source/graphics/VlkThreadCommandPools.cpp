@@ -0,0 +1,61 @@
+#include "VlkThreadCommandPools.h"
+
+#include "VlkCommandBuffer.h"
+#include "logger/Debug.h"
+
+VlkThreadCommandPools::~VlkThreadCommandPools()
+{
+	Destroy();
+}
+
+void VlkThreadCommandPools::Init(VkDevice device, int32 queueFamilyIndex, uint32 threadCount)
+{
+	ASSERT(!m_Pools, "VlkThreadCommandPools is already initialized");
+	m_ThreadCount = threadCount;
+	m_Pools.reset(new ThreadPool[FrameCount * threadCount]);
+	for(uint32 i = 0; i < FrameCount * threadCount; ++i)
+		m_Pools[i].m_Pool.Init(device, queueFamilyIndex);
+}
+
+void VlkThreadCommandPools::Destroy()
+{
+	if(!m_Pools)
+		return;
+
+	// the wrappers free their VkCommandBuffer, that has to happen before the pool itself goes
+	for(uint32 i = 0; i < FrameCount * m_ThreadCount; ++i)
+	{
+		for(VlkCommandBuffer* buffer : m_Pools[i].m_Secondaries)
+			m_Pools[i].m_Pool.DestroyCommandBuffer(buffer);
+	}
+	m_Pools.reset();
+	m_ThreadCount = 0;
+}
+
+void VlkThreadCommandPools::BeginFrame(uint32 frame)
+{
+	ASSERT(frame < FrameCount, "Frame out of range");
+	m_Frame = frame;
+	for(uint32 i = 0; i < m_ThreadCount; ++i)
+	{
+		ThreadPool& pool = m_Pools[frame * m_ThreadCount + i];
+		if(pool.m_Used == 0)
+			continue;
+
+		pool.m_Pool.Reset();
+		pool.m_Used = 0;
+	}
+}
+
+VlkCommandBuffer* VlkThreadCommandPools::AcquireSecondary(uint32 threadIndex)
+{
+	ASSERT(threadIndex < m_ThreadCount, "Only job threads record into the thread command pools");
+	ThreadPool& pool = m_Pools[m_Frame * m_ThreadCount + threadIndex];
+	if(pool.m_Used == pool.m_Secondaries.size())
+	{
+		VlkCommandBufferList buffers =
+			pool.m_Pool.CreateCommandBuffers(CommandBufferLevel::E_SECONDARY, CommandBufferUsage::E_ONE_TIME, 1);
+		pool.m_Secondaries.push_back(buffers[0]);
+	}
+	return pool.m_Secondaries[pool.m_Used++];
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include "Core/Defines.h"
+#include "Core/Types.h"
+
+#include "VlkCommandPool.h"
+
+#include <memory>
+#include <vector>
+
+/*
+	A VlkCommandPool for every job thread and frame in flight, so draws can be recorded into secondary command
+	buffers from all threads at once: a pool and the buffers from it may only be used by one thread at a time.
+	Buffers are kept and recorded again the next time their frame comes around, BeginFrame resets the whole pool
+	instead of the buffers one by one.
+*/
+class VlkThreadCommandPools
+{
+public:
+	static constexpr uint32 FrameCount = 2;
+
+	VlkThreadCommandPools() = default;
+	~VlkThreadCommandPools();
+
+	VlkThreadCommandPools(const VlkThreadCommandPools&) = delete;
+	VlkThreadCommandPools& operator=(const VlkThreadCommandPools&) = delete;
+
+	// threadCount is Core::JobSystem::GetThreadCount, threads are told apart by their job thread index
+	void Init(VkDevice device, int32 queueFamilyIndex, uint32 threadCount);
+	void Destroy();
+
+	// The GPU has to be done with everything recorded for frame the last time around.
+	void BeginFrame(uint32 frame);
+
+	// The next unused secondary buffer of the calling thread in the current frame, from its own pool.
+	VlkCommandBuffer* AcquireSecondary(uint32 threadIndex);
+
+	uint32 GetThreadCount() const { return m_ThreadCount; }
+
+private:
+	// a cache line each, the threads bump their own m_Used all the time
+	struct alignas(64) ThreadPool
+	{
+		VlkCommandPool m_Pool;
+		std::vector<VlkCommandBuffer*> m_Secondaries;
+		uint32 m_Used = 0;
+	};
+
+	std::unique_ptr<ThreadPool[]> m_Pools; // FrameCount * m_ThreadCount, one frame after the other
+	uint32 m_ThreadCount = 0;
+	uint32 m_Frame = 0;
+};
@@ -0,0 +1,57 @@
+#include "VlkUniformRing.h"
+
+#include "VlkDevice.h"
+#include "VlkPhysicalDevice.h"
+
+#include "logger/Debug.h"
+
+VlkUniformRing::~VlkUniformRing()
+{
+	Destroy();
+}
+
+void VlkUniformRing::Init(VlkDevice* device, VlkPhysicalDevice* physicalDevice, uint64 bytesPerFrame)
+{
+	ASSERT(!m_Device, "VlkUniformRing is already initialized");
+	m_Device = device;
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(physicalDevice->GetDevice(), &properties);
+	m_Ring.Init(bytesPerFrame, properties.limits.minUniformBufferOffsetAlignment);
+
+	VkBufferCreateInfo createInfo = {};
+	createInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	createInfo.size = m_Ring.GetSize();
+	createInfo.usage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+	createInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	auto [buffer, memReq] = device->CreateBuffer(createInfo);
+	m_Buffer = buffer;
+	// device local as well where the device has such memory, the shaders then read it without crossing the bus
+	m_Memory = device->GetMemoryAllocator().AllocateBuffer(
+		buffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+}
+
+void VlkUniformRing::Destroy()
+{
+	if(!m_Device)
+		return;
+
+	vkDestroyBuffer(m_Device->GetDevice(), m_Buffer, nullptr);
+	m_Device->GetMemoryAllocator().Free(m_Memory);
+	m_Buffer = nullptr;
+	m_Memory = Core::GpuAllocation();
+	m_Device = nullptr;
+}
+
+VlkUniformRing::Allocation VlkUniformRing::Allocate(uint64 size)
+{
+	Allocation allocation;
+	const uint64 offset = m_Ring.Allocate(size);
+	if(offset == Core::UniformRing::InvalidOffset || !m_Memory.m_Mapped)
+		return allocation;
+
+	allocation.m_Data = static_cast<int8*>(m_Memory.m_Mapped) + offset;
+	allocation.m_Offset = static_cast<uint32>(offset);
+	return allocation;
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include "Core/Defines.h"
+#include "Core/Types.h"
+#include "Core/memory/GpuMemoryAllocator.h"
+#include "Core/memory/UniformRing.h"
+
+#include <vulkan/vulkan_core.h>
+
+class VlkDevice;
+class VlkPhysicalDevice;
+
+/*
+	One uniform buffer for the constants of every frame in flight, a region each, bound through
+	VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC. The buffer is mapped once for its whole lifetime, writing a frame's
+	constants is a memcpy into its region and the offset goes to BindDescriptorSets. The memory is coherent, nothing
+	has to be flushed before the submit.
+*/
+class VlkUniformRing
+{
+public:
+	static constexpr uint32 FrameCount = Core::UniformRing::FrameCount;
+	static constexpr uint64 DefaultFrameSize = 64 * 1024;
+
+	struct Allocation
+	{
+		void* m_Data = nullptr; // nullptr when the frame budget is exhausted or the ring isn't initialized
+		uint32 m_Offset = 0; // the dynamic offset
+	};
+
+	VlkUniformRing() = default;
+	~VlkUniformRing();
+
+	VlkUniformRing(const VlkUniformRing&) = delete;
+	VlkUniformRing& operator=(const VlkUniformRing&) = delete;
+
+	void Init(VlkDevice* device, VlkPhysicalDevice* physicalDevice, uint64 bytesPerFrame = DefaultFrameSize);
+	// the GPU has to be done with the buffer
+	void Destroy();
+
+	// The GPU has to be done with everything written for frameIndex the last time around.
+	void BeginFrame(uint32 frameIndex) { m_Ring.BeginFrame(frameIndex); }
+	Allocation Allocate(uint64 size);
+
+	// for the descriptor, the dynamic offset is added to offset 0
+	VkDescriptorBufferInfo GetBufferDesc(uint64 range) const
+	{
+		VkDescriptorBufferInfo info = {};
+		info.buffer = m_Buffer;
+		info.range = range;
+		return info;
+	}
+
+	const Core::UniformRing& GetRing() const { return m_Ring; }
+
+private:
+	VlkDevice* m_Device = nullptr;
+	VkBuffer m_Buffer = nullptr;
+	Core::GpuAllocation m_Memory;
+	Core::UniformRing m_Ring;
+};
@@ -0,0 +1,224 @@
+#include "VlkUploadContext.h"
+
+#include "VlkDevice.h"
+#include "VlkCommandPool.h"
+#include "VlkCommandBuffer.h"
+
+#include "logger/Debug.h"
+
+static constexpr uint64 s_StagingAlignment = 16;
+
+VlkUploadContext::~VlkUploadContext()
+{
+	Destroy();
+}
+
+void VlkUploadContext::Init(VlkDevice* device, uint64 stagingSize)
+{
+	ASSERT(!m_Device, "VlkUploadContext is already initialized");
+	m_Device = device;
+
+	m_CommandPool = std::make_unique<VlkCommandPool>();
+	m_CommandPool->Init(device->GetDevice(), device->GetTransferQueueFamilyIndex());
+
+	VkBufferCreateInfo createInfo = {};
+	createInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	createInfo.size = stagingSize;
+	createInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+	createInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	auto [buffer, memReq] = device->CreateBuffer(createInfo);
+	m_StagingBuffer = buffer;
+	// coherent, what is written through the mapping needs no flush before the copy
+	m_StagingMemory = device->GetMemoryAllocator().AllocateBuffer(
+		buffer, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	m_Ring.Init(stagingSize);
+
+	VkSemaphoreCreateInfo semaphoreInfo = {};
+	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	for(VkSemaphore& semaphore : m_Semaphores)
+		VERIFY(vkCreateSemaphore(device->GetDevice(), &semaphoreInfo, nullptr, &semaphore) == VK_SUCCESS,
+			   "Failed to create VkSemaphore");
+}
+
+void VlkUploadContext::Destroy()
+{
+	if(!m_Device)
+		return;
+
+	VkDevice device = m_Device->GetDevice();
+	while(!m_InFlight.empty())
+		Retire(true);
+
+	for(VkFence fence : m_FreeFences)
+		vkDestroyFence(device, fence, nullptr);
+	m_FreeFences.clear();
+	for(VkSemaphore& semaphore : m_Semaphores)
+	{
+		vkDestroySemaphore(device, semaphore, nullptr);
+		semaphore = nullptr;
+	}
+
+	vkDestroyBuffer(device, m_StagingBuffer, nullptr);
+	m_Device->GetMemoryAllocator().Free(m_StagingMemory);
+	m_StagingBuffer = nullptr;
+	m_StagingMemory = Core::GpuAllocation();
+
+	m_CopyBuffers.clear();
+	m_CopyRegions.clear();
+	m_CommandPool.reset();
+	m_Device = nullptr;
+}
+
+VkBuffer VlkUploadContext::CreateBuffer(VkBufferUsageFlags usage, Core::Span<const char> data,
+										Core::GpuAllocation& memory)
+{
+	const uint32 families[] = { m_Device->GetQueueFamilyIndex(), m_Device->GetTransferQueueFamilyIndex() };
+
+	VkBufferCreateInfo createInfo = {};
+	createInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	createInfo.size = data.Size();
+	createInfo.usage = usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+	// concurrent, the copy and the draws can use it without handing it from one family to the other
+	createInfo.sharingMode = families[0] != families[1] ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE;
+	createInfo.queueFamilyIndexCount = families[0] != families[1] ? ARRSIZE(families) : 0;
+	createInfo.pQueueFamilyIndices = families;
+
+	auto [buffer, memReq] = m_Device->CreateBuffer(createInfo);
+	memory = m_Device->GetMemoryAllocator().AllocateBuffer(buffer, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+	Upload(buffer, 0, data);
+	return buffer;
+}
+
+void VlkUploadContext::Upload(VkBuffer buffer, uint64 offset, Core::Span<const char> data)
+{
+	int8* staging = static_cast<int8*>(m_StagingMemory.m_Mapped);
+	uint64 uploaded = 0;
+	while(uploaded < data.Size())
+	{
+		// anything larger than half the ring goes in pieces, a piece always fits once the ring has drained
+		const uint64 remaining = data.Size() - uploaded;
+		const uint64 size = remaining < m_Ring.GetSize() / 2 ? remaining : m_Ring.GetSize() / 2;
+		const uint64 stagingOffset = AllocateStaging(size);
+		memcpy(staging + stagingOffset, data.GetData() + uploaded, size);
+
+		VkBufferCopy region = {};
+		region.srcOffset = stagingOffset;
+		region.dstOffset = offset + uploaded;
+		region.size = size;
+		m_CopyBuffers.push_back(buffer);
+		m_CopyRegions.push_back(region);
+		uploaded += size;
+	}
+}
+
+VkSemaphore VlkUploadContext::Flush()
+{
+	Retire(false);
+	if(m_CopyRegions.empty() && !m_SubmittedSinceFlush)
+		return VK_NULL_HANDLE;
+
+	// a signal after earlier submissions on the queue waits for those as well
+	VkSemaphore semaphore = m_Semaphores[m_FlushCount++ % FrameCount];
+	Submit(semaphore);
+	m_SubmittedSinceFlush = false;
+	return semaphore;
+}
+
+void VlkUploadContext::FlushAndWait()
+{
+	if(!m_CopyRegions.empty())
+		Submit(VK_NULL_HANDLE);
+	while(!m_InFlight.empty())
+		Retire(true);
+	m_SubmittedSinceFlush = false;
+}
+
+uint64 VlkUploadContext::AllocateStaging(uint64 size)
+{
+	Retire(false);
+	for(;;)
+	{
+		const uint64 offset = m_Ring.Allocate(size, s_StagingAlignment);
+		if(offset != Core::StagingRing::InvalidOffset)
+			return offset;
+
+		// the ring is full, get what is queued going and wait for the oldest copies to be done with their part
+		if(m_Ring.HasOpenAllocations())
+		{
+			Submit(VK_NULL_HANDLE);
+			m_SubmittedSinceFlush = true;
+		}
+		ASSERT(!m_InFlight.empty(), "Staging ring is full without anything in flight");
+		Retire(true);
+	}
+}
+
+void VlkUploadContext::Submit(VkSemaphore signal)
+{
+	VkSubmitInfo submitInfo = {};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+
+	Submission submission;
+	if(!m_CopyRegions.empty())
+	{
+		submission.m_CommandBuffer =
+			m_CommandPool->CreateCommandBuffers(CommandBufferLevel::E_PRIMARY, CommandBufferUsage::E_ONE_TIME, 1)[0];
+		submission.m_CommandBuffer->Begin();
+
+		// one vkCmdCopyBuffer for every run of copies into the same buffer
+		const uint32 copyCount = static_cast<uint32>(m_CopyRegions.size());
+		for(uint32 begin = 0, end = 0; begin < copyCount; begin = end)
+		{
+			for(end = begin + 1; end < copyCount && m_CopyBuffers[end] == m_CopyBuffers[begin];)
+				++end;
+			submission.m_CommandBuffer->CopyBuffer(m_StagingBuffer, m_CopyBuffers[begin], &m_CopyRegions[begin],
+												   end - begin);
+		}
+		submitInfo = submission.m_CommandBuffer->End();
+	}
+
+	if(signal)
+	{
+		submitInfo.signalSemaphoreCount = 1;
+		submitInfo.pSignalSemaphores = &signal;
+	}
+
+	if(m_FreeFences.empty())
+	{
+		VkFenceCreateInfo fenceInfo = {};
+		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+		VkFence fence = nullptr;
+		VERIFY(vkCreateFence(m_Device->GetDevice(), &fenceInfo, nullptr, &fence) == VK_SUCCESS,
+			   "Failed to create fence!");
+		m_FreeFences.push_back(fence);
+	}
+	submission.m_Fence = m_FreeFences.back();
+	m_FreeFences.pop_back();
+
+	VERIFY(vkQueueSubmit(m_Device->GetTransferQueue(), 1, &submitInfo, submission.m_Fence) == VK_SUCCESS,
+		   "Failed to submit uploads!");
+
+	submission.m_Id = m_NextSubmission++;
+	m_Ring.EndSubmission(submission.m_Id);
+	m_InFlight.push_back(submission);
+	m_CopyBuffers.clear();
+	m_CopyRegions.clear();
+}
+
+void VlkUploadContext::Retire(bool wait)
+{
+	VkDevice device = m_Device->GetDevice();
+	if(wait && !m_InFlight.empty())
+		vkWaitForFences(device, 1, &m_InFlight.front().m_Fence, VK_TRUE, UINT64_MAX);
+
+	// the transfer queue runs submissions in order, the first one not done yet ends the search
+	while(!m_InFlight.empty() && vkGetFenceStatus(device, m_InFlight.front().m_Fence) == VK_SUCCESS)
+	{
+		const Submission& done = m_InFlight.front();
+		m_Ring.Retire(done.m_Id);
+		m_CommandPool->DestroyCommandBuffer(done.m_CommandBuffer);
+		vkResetFences(device, 1, &done.m_Fence);
+		m_FreeFences.push_back(done.m_Fence);
+		m_InFlight.pop_front();
+	}
+}
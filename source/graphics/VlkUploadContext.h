@@ -0,0 +1,87 @@
+#pragma once
+#include "Core/Defines.h"
+#include "Core/Types.h"
+#include "Core/containers/Span.h"
+#include "Core/memory/GpuMemoryAllocator.h"
+#include "Core/memory/StagingRing.h"
+
+#include <deque>
+#include <memory>
+#include <vector>
+#include <vulkan/vulkan_core.h>
+
+class VlkDevice;
+class VlkCommandPool;
+class VlkCommandBuffer;
+
+/*
+	Gets data into device local memory. Upload writes into a persistently mapped staging ring and queues the copy,
+	Flush records everything queued since the last one into a single command buffer for the transfer queue, so a
+	frame costs one submit however many uploads it made. A submission's part of the ring is taken back once its
+	fence has signaled, which is polled on every call. Only when the ring is full does an Upload wait.
+
+	Buffers have to be usable from the graphics and the transfer queue family, CreateBuffer creates them that way.
+	Only to be used from one thread.
+*/
+class VlkUploadContext
+{
+public:
+	static constexpr uint32 FrameCount = 2;
+	static constexpr uint64 DefaultStagingSize = 32ull << 20;
+
+	VlkUploadContext() = default;
+	~VlkUploadContext();
+
+	VlkUploadContext(const VlkUploadContext&) = delete;
+	VlkUploadContext& operator=(const VlkUploadContext&) = delete;
+
+	void Init(VlkDevice* device, uint64 stagingSize = DefaultStagingSize);
+	// waits for the uploads still in flight
+	void Destroy();
+
+	// a device local buffer with data queued for upload, it can be drawn from after the next Flush
+	VkBuffer CreateBuffer(VkBufferUsageFlags usage, Core::Span<const char> data, Core::GpuAllocation& memory);
+	void Upload(VkBuffer buffer, uint64 offset, Core::Span<const char> data);
+
+	/*
+		Submits the uploads queued since the last Flush, once per frame. The frame's graphics submit has to wait on
+		the semaphore at the stages reading the data, VK_NULL_HANDLE when there was nothing to upload. The semaphore
+		is used again FrameCount flushes later, the frame that waited on it has to be done by then.
+	*/
+	VkSemaphore Flush();
+	// for loading outside of frames, everything is on the GPU when it returns
+	void FlushAndWait();
+
+	uint64 GetStagingUsed() const { return m_Ring.GetUsed(); }
+
+private:
+	struct Submission
+	{
+		uint64 m_Id = 0;
+		VkFence m_Fence = nullptr;
+		VlkCommandBuffer* m_CommandBuffer = nullptr; // null when there was nothing to copy, only a signal
+	};
+
+	uint64 AllocateStaging(uint64 size);
+	void Submit(VkSemaphore signal);
+	// takes back the ring and fences of finished submissions, waiting for the oldest one when wait is set
+	void Retire(bool wait);
+
+	VlkDevice* m_Device = nullptr;
+	std::unique_ptr<VlkCommandPool> m_CommandPool; // on the transfer family, has to go before the device
+
+	VkBuffer m_StagingBuffer = nullptr;
+	Core::GpuAllocation m_StagingMemory;
+	Core::StagingRing m_Ring;
+
+	// queued copies, m_CopyRegions[i] goes into m_CopyBuffers[i]
+	std::vector<VkBuffer> m_CopyBuffers;
+	std::vector<VkBufferCopy> m_CopyRegions;
+
+	std::deque<Submission> m_InFlight;
+	std::vector<VkFence> m_FreeFences;
+	VkSemaphore m_Semaphores[FrameCount] = {};
+	uint64 m_NextSubmission = 1;
+	uint32 m_FlushCount = 0;
+	bool m_SubmittedSinceFlush = false; // the ring filled up in between, the next Flush has to signal anyway
+};
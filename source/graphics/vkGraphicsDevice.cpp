@@ -10,10 +10,20 @@
 #include "ConstantBuffer.h"
 
 #include "Utilities.h"
+#include "VertexLayout.h"
 #include "Window.h"
 
-#include "Core/File.h"
+#include "Core/Archive.h"
+#include "Core/AsyncIO.h"
+#include "Core/JobSystem.h"
+#include "Core/Timer.h"
+#include "Core/containers/Span.h"
 #include "Core/math/Matrix44.h"
+#include "Core/math/TransformBatch.h"
+#include "Core/math/Frustum.h"
+#include "Core/mesh/MeshFormat.h"
+#include "Core/mesh/Meshlets.h"
+#include "Core/mesh/MeshSimplifier.h"
 #include "Core/utilities/Randomizer.h"
 #include "Input/InputManager.h"
 #include "input/InputDeviceMouse_Win32.h"
@@ -27,7 +37,7 @@
 #include <vulkan/vulkan_win32.h>
 #endif 
 
-#include "Cube.h"
+#include "InstancedRenderer.h"
 
 #define IMGUI_DISABLE_OBSOLETE_FUNCTIONS
 #include "imgui/imgui.h"
@@ -50,7 +60,7 @@ VkDescriptorSet _descriptorSet = nullptr;
 // I will assume these are components for a rendertarget
 VkImage _depthImage = nullptr;
 VkImageView _depthView = nullptr;
-VkDeviceMemory _depthImageMemory = nullptr;
+Core::GpuAllocation _depthImageMemory;
 
 Camera _Camera;
 
@@ -62,7 +72,11 @@ Core::Matrix44f _LightObject = Core::Matrix44f::Identity();
 VkShaderModule _vertexShader;
 VkShaderModule _fragmentShader;
 
-std::vector<Cube> _Cubes;
+static constexpr uint32 s_CubeCount = 100000;
+InstancedRenderer _CubeRenderer; // every cube is an instance of the same mesh
+// same dense order as the instances in _CubeRenderer
+Core::TransformBatch _CubeTransforms(s_CubeCount, Core::GetAllocator(Core::MemoryTag::Graphics));
+VertexInputDesc _CubeVertexInput;
 
 ConstantBuffer _ViewProjection;
 
@@ -73,8 +87,10 @@ vkGraphicsDevice::~vkGraphicsDevice()
 
 	auto device = m_LogicalDevice->GetDevice();
 
-	for(Cube& cube : _Cubes)
-		cube.Destroy(m_LogicalDevice->GetDevice());
+	// copies into the buffers below may still be running
+	m_UploadContext.Destroy();
+	_CubeRenderer.Destroy(m_LogicalDevice);
+	m_UniformRing.Destroy();
 
 	m_LogicalDevice->DestroyShaderModule(&_vertexShader);
 	m_LogicalDevice->DestroyShaderModule(&_fragmentShader);
@@ -88,6 +104,14 @@ vkGraphicsDevice::~vkGraphicsDevice()
 	for(VkFramebuffer buffer : m_FrameBuffers)
 		vkDestroyFramebuffer(device, buffer, nullptr);
 
+	vkDestroyImageView(device, _depthView, nullptr);
+	vkDestroyImage(device, _depthImage, nullptr);
+	m_LogicalDevice->GetMemoryAllocator().Free(_depthImageMemory);
+
+	for(VlkCommandBuffer* buffer : m_Buffers)
+		m_CommandPool.DestroyCommandBuffer(buffer);
+	m_ThreadCommandPools.Destroy();
+
 	/*ImGui_ImplVulkan_DestroyFontUploadObjects();
 	ImGui::DestroyContext();
 	ImGui_ImplWin32_Shutdown();
@@ -101,6 +125,57 @@ vkGraphicsDevice::~vkGraphicsDevice()
 
 bool vkGraphicsDevice::Init(const Window& window)
 {
+	// scene load time. Shaders and models come from data.pak when there is one, otherwise the loose files are read on
+	// the I/O thread while the device is being set up
+	Core::Timer loadTimer;
+	loadTimer.Init();
+
+	enum SceneFile
+	{
+		VERTEX_SHADER,
+		FRAGMENT_SHADER,
+		CUBE_MODEL,
+		SCENE_FILE_COUNT
+	};
+	const char* scenePaths[SCENE_FILE_COUNT] = { "Data/Shaders/vertex_instanced.vert", "Data/Shaders/frag.hlsl",
+												 "cube.mdl" };
+	Core::Span<const char> sceneFiles[SCENE_FILE_COUNT];
+	std::vector<char> sceneData[SCENE_FILE_COUNT];
+	std::future<Core::ReadResult> sceneReads[SCENE_FILE_COUNT];
+
+	Core::Archive sceneArchive;
+	if(sceneArchive.Open("data.pak"))
+	{
+		for(int i = 0; i < SCENE_FILE_COUNT; ++i)
+		{
+			const Core::ArchiveEntry* entry = sceneArchive.Find(scenePaths[i]);
+			VERIFY(entry != nullptr, "%s is missing from data.pak", scenePaths[i]);
+			sceneFiles[i] = sceneArchive.GetView(scenePaths[i]);
+			if(entry && entry->m_Compression != Core::Compression::None)
+			{
+				sceneData[i].resize(entry->m_Size);
+				VERIFY(sceneArchive.Read(*entry, sceneData[i].data(), sceneData[i].size()),
+					   "Failed to decompress %s from data.pak", scenePaths[i]);
+				sceneFiles[i] = Core::Span<const char>(sceneData[i].data(), sceneData[i].size());
+			}
+		}
+	}
+	else
+	{
+		Core::ReadRequest requests[SCENE_FILE_COUNT];
+		for(int i = 0; i < SCENE_FILE_COUNT; ++i)
+		{
+			const uint64 size = Core::AsyncIO::GetFileSize(scenePaths[i]);
+			VERIFY(size > 0, "%s is missing or empty", scenePaths[i]);
+			sceneData[i].resize(size);
+			sceneFiles[i] = Core::Span<const char>(sceneData[i].data(), sceneData[i].size());
+			requests[i].m_Path = scenePaths[i];
+			requests[i].m_Buffer = sceneData[i].data();
+			requests[i].m_BufferSize = sceneData[i].size();
+			requests[i].m_Priority = Core::IOPriority::High;
+		}
+		Core::AsyncIO::Get().ReadBatch(requests, SCENE_FILE_COUNT, sceneReads);
+	}
 
 	_size = window.GetInnerSize();
 	_Camera.InitPerspectiveProjection(_size.m_Width, _size.m_Height, 0.1f, 1000.f, 90.f);
@@ -115,12 +190,14 @@ bool vkGraphicsDevice::Init(const Window& window)
 	m_LogicalDevice = new VlkDevice();
 	m_LogicalDevice->Init(m_PhysicalDevice);
 
+	m_UploadContext.Init(m_LogicalDevice);
+
 	m_Swapchain = new VlkSwapchain();
 	m_Swapchain->Init(m_VlkInstance, m_LogicalDevice, m_PhysicalDevice, window);
 
 	_ViewProjection.RegVar(_Camera.GetViewProjectionPointer());
 	_ViewProjection.RegVar(&_LightDir);
-	_ViewProjection.Init(m_LogicalDevice, m_PhysicalDevice);
+	m_UniformRing.Init(m_LogicalDevice, m_PhysicalDevice);
 
 	m_CommandPool.Init(m_LogicalDevice->GetDevice(), m_PhysicalDevice->GetQueueFamilyIndex());
 
@@ -128,6 +205,15 @@ bool vkGraphicsDevice::Init(const Window& window)
 		m_CommandPool.CreateCommandBuffers(CommandBufferLevel::E_PRIMARY, CommandBufferUsage::E_SIMULTANEOUS, 2);
 	m_Buffers.Add(buffers[0]);
 	m_Buffers.Add(buffers[1]);
+	static_assert(Core::FrameArena::FrameCount == 2, "FrameArena regions have to match the command buffers in flight");
+	static_assert(VlkThreadCommandPools::FrameCount == 2, "Thread pools have to match the command buffers in flight");
+	static_assert(InstancedRenderer::FrameCount == 2, "Instance buffers have to match the command buffers in flight");
+	static_assert(VlkUploadContext::FrameCount == 2, "Upload semaphores have to match the command buffers in flight");
+	static_assert(VlkUniformRing::FrameCount == 2, "Uniform regions have to match the command buffers in flight");
+	m_ThreadCommandPools.Init(m_LogicalDevice->GetDevice(), m_PhysicalDevice->GetQueueFamilyIndex(),
+							  Core::JobSystem::Get().GetThreadCount());
+	m_FrameArena.Init(s_CubeCount * sizeof(Core::Matrix44f) + 256 * 1024,
+					  Core::GetAllocator(Core::MemoryTag::Graphics));
 	// m_CmdBuffers.push_back(std::move(buffers));
 
 	CreateDepthResources();
@@ -145,18 +231,30 @@ bool vkGraphicsDevice::Init(const Window& window)
 		m_FrameBuffers[i] = CreateFramebuffer(views, ARRSIZE(views), window);
 	}
 
-	Core::File vtx("Data/Shaders/vertex.vert");
-	_vertexShader = m_LogicalDevice->CreateShaderModule(vtx.GetBuffer(), vtx.GetSize());
+	for(int i = 0; i < SCENE_FILE_COUNT; ++i)
+	{
+		if(!sceneReads[i].valid())
+			continue;
+
+		// a file that shrank or went away since GetFileSize would leave part of the buffer unread
+		const Core::ReadResult result = sceneReads[i].get();
+		VERIFY(result.m_Status == Core::IOStatus::Ok && result.m_BytesRead == sceneData[i].size(),
+			   "Failed to read %s, got %llu of %llu bytes", scenePaths[i], (unsigned long long)result.m_BytesRead,
+			   (unsigned long long)sceneData[i].size());
+	}
+
+	const Core::Span<const char> vtx = sceneFiles[VERTEX_SHADER];
+	_vertexShader = m_LogicalDevice->CreateShaderModule(vtx.GetData(), (uint32)vtx.Size());
 
-	Core::File frag("Data/Shaders/frag.hlsl");
-	_fragmentShader = m_LogicalDevice->CreateShaderModule(frag.GetBuffer(), frag.GetSize());
+	const Core::Span<const char> frag = sceneFiles[FRAGMENT_SHADER];
+	_fragmentShader = m_LogicalDevice->CreateShaderModule(frag.GetData(), (uint32)frag.Size());
 
 	CreateViewport(0.f, 0.f, _size.m_Width, _size.m_Height, 0.f, 1.f, &_Viewport);
 	SetupScissorArea((uint32)_size.m_Width, (uint32)_size.m_Height, 0, 0, &_Scissor);
 
 	VkDescriptorSetLayoutBinding uboLayoutBinding = {};
 	uboLayoutBinding.binding = 0;
-	uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	uboLayoutBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
 	uboLayoutBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
 	uboLayoutBinding.descriptorCount = 1;
 
@@ -176,31 +274,54 @@ bool vkGraphicsDevice::Init(const Window& window)
 
 	_pipelineLayout =
 		CreatePipelineLayout(descriptorLayouts, ARRSIZE(descriptorLayouts), pushRangeList, ARRSIZE(pushRangeList));
+
+	// every cube shares the model, the pipeline's vertex input comes from its header
+	std::vector<char> convertedModel;
+	Core::Mesh::MeshView cubeMesh;
+	const Core::Mesh::ParseResult parsed = cubeMesh.Parse(sceneFiles[CUBE_MODEL]);
+	VERIFY(parsed != Core::Mesh::ParseResult::WrongVersion,
+		   "%s was cooked for another version of the .mesh format, run MeshCooker on it again", scenePaths[CUBE_MODEL]);
+	VERIFY(parsed != Core::Mesh::ParseResult::Corrupt, "%s is a damaged .mesh", scenePaths[CUBE_MODEL]);
+	if(parsed == Core::Mesh::ParseResult::NotAMesh)
+	{
+		// an old .mdl, a raw array of MeshVertex, convert it here until the data is cooked again
+		const Core::Span<const char> legacy = sceneFiles[CUBE_MODEL];
+		VERIFY(legacy.Size() > 0 && legacy.Size() % sizeof(Core::MeshVertex) == 0,
+			   "%s is neither a .mesh nor a MeshVertex array", scenePaths[CUBE_MODEL]);
+		std::vector<Core::MeshVertex> vertices(legacy.Size() / sizeof(Core::MeshVertex));
+		memcpy(vertices.data(), legacy.GetData(), vertices.size() * sizeof(Core::MeshVertex));
+		convertedModel = Core::Mesh::Encode(vertices.data(), static_cast<uint32>(vertices.size()));
+		Core::MeshSimplifier::AddLods(convertedModel, {});
+		Core::Mesh::AddMeshlets(convertedModel);
+		VERIFY(cubeMesh.Parse(Core::Span<const char>(convertedModel.data(), convertedModel.size())) ==
+				   Core::Mesh::ParseResult::Ok,
+			   "Failed to convert the cube model");
+	}
+
+	_CubeVertexInput = CreateVertexInputDesc(cubeMesh.GetHeader());
+	AddInstanceTransform(_CubeVertexInput, 1);
 	_pipeline = CreateGraphicsPipeline();
 
 	m_AcquireNextImageSemaphore = CreateVkSemaphore(m_LogicalDevice->GetDevice());
 	m_DrawDone = CreateVkSemaphore(m_LogicalDevice->GetDevice());
 
-	const float xValue = -22.f;
-	const float yValue = -12.f;
-	const float zValue = 0.f;
-	Core::Vector4f position{ xValue, yValue, zValue, 1.f };
-
-	for(int i = 0; i < 128; i++)
+	// a 50 x 50 grid of cubes in every layer, the layers going away from the camera
+	_CubeRenderer.Init(m_LogicalDevice, s_CubeCount);
+	const uint32 cubeMeshIndex = _CubeRenderer.AddMesh(m_UploadContext, cubeMesh);
+	for(uint32 i = 0; i < s_CubeCount; i++)
 	{
-		_Cubes.push_back(Cube());
-		Cube& last = _Cubes.back();
-		last.Init(m_LogicalDevice, m_PhysicalDevice);
-		last.SetPosition(position);
-
-		position.x += 5.f;
-		if(i % 10 == 0 && i != 0)
-		{
-			position.y += 5.f;
-			position.x = xValue;
-		}
+		_CubeRenderer.AddInstance(cubeMeshIndex);
+		const Core::Vector4f position{ -122.f + (float)(i % 50) * 5.f, -122.f + (float)(i / 50 % 50) * 5.f,
+									   (float)(i / 2500) * 5.f, 1.f };
+		_CubeTransforms.Add(position, { 0.f, 0.f, 0.f, 1.f }, { 1.f, 1.f, 1.f, 0.f });
 	}
 
+	// every mesh of the scene in one submit
+	m_UploadContext.FlushAndWait();
+
+	loadTimer.Update();
+	LOG_MESSAGE("Scene loaded in %.2f ms", loadTimer.GetTotalTime() * 1000.f);
+
 	VkFenceCreateInfo fenceCreateInfo = {};
 	fenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
 
@@ -252,16 +373,15 @@ void vkGraphicsDevice::DrawFrame(float dt)
 
 	UpdateCamera(dt);
 
-	// BindConstantBuffer(&_ViewProjection, 0);
-	_ViewProjection.Map(m_LogicalDevice);
-
-	const VkPipelineStageFlags waitDstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT; // associated with
-																								 // having
-																								 // semaphores
+	// the uploads made since the last frame have to land before the vertex input reads them
+	const VkSemaphore uploadsDone = m_UploadContext.Flush();
+	const VkSemaphore waitSemaphores[] = { m_AcquireNextImageSemaphore, uploadsDone };
+	const VkPipelineStageFlags waitDstStageMask[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+													  VK_PIPELINE_STAGE_VERTEX_INPUT_BIT };
 	static VkSubmitInfo submitInfo[2] = { {}, {} };
 
 	// submitInfo[m_Index].sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-	submitInfo[m_Index].pWaitDstStageMask = &waitDstStageMask;
+	submitInfo[m_Index].pWaitDstStageMask = waitDstStageMask;
 
 	// submitInfo[m_Index].commandBufferCount = 1;
 	// submitInfo[m_Index].pCommandBuffers = &m_Buffers[m_Index]; /* ISSUE */
@@ -269,8 +389,8 @@ void vkGraphicsDevice::DrawFrame(float dt)
 	submitInfo[m_Index].pSignalSemaphores = &m_DrawDone;
 	submitInfo[m_Index].signalSemaphoreCount = 1;
 
-	submitInfo[m_Index].pWaitSemaphores = &m_AcquireNextImageSemaphore;
-	submitInfo[m_Index].waitSemaphoreCount = 1;
+	submitInfo[m_Index].pWaitSemaphores = waitSemaphores;
+	submitInfo[m_Index].waitSemaphoreCount = uploadsDone ? 2 : 1;
 
 	if(vkQueueSubmit(m_LogicalDevice->GetQueue(), 1, &submitInfo[m_Index], m_CommandFence) != VK_SUCCESS)
 		ASSERT(false, "Failed to submit the queue!");
@@ -288,9 +408,6 @@ void vkGraphicsDevice::DrawFrame(float dt)
 	if(vkQueuePresentKHR(m_LogicalDevice->GetQueue(), &presentInfo) != VK_SUCCESS)
 		ASSERT(false, "Failed to present!");
 
-	for(Cube& cube : _Cubes)
-		cube.Update(dt);
-
 	submitInfo[m_Index ^ 1] = SetupRenderCommands(m_Index ^ 1);
 }
 
@@ -449,37 +566,28 @@ VkPipeline vkGraphicsDevice::CreateGraphicsPipeline()
 	blendCreateInfo.attachmentCount = 1;
 	blendCreateInfo.pAttachments = &blendAttachState;
 
-	// Input Assembler
-	auto bindDesc = CreateBindDesc();	 // Define the size of the input assembler
-	auto attrDesc = CreateAttrDesc(0, 0); // Define each attribute of the input assembler
-	auto attrDesc2 = CreateAttrDesc(1, 16);
-	auto attrDesc3 = CreateAttrDesc(2, 32);
-	// This is 100% based on the vertex and not something that should be manually setup.
-	// Vertex Description should be on the model
-
-	VkVertexInputBindingDescription bindDescArr[] = { bindDesc };
-	VkVertexInputAttributeDescription descriptions[] = { attrDesc, attrDesc2, attrDesc3 };
-
+	// Input Assembler, described by the mesh header
 	VkPipelineVertexInputStateCreateInfo vertexInputInfo = {};
 	vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
 
-	vertexInputInfo.vertexBindingDescriptionCount = ARRSIZE(bindDescArr);
-	vertexInputInfo.vertexAttributeDescriptionCount = ARRSIZE(descriptions);
+	vertexInputInfo.vertexBindingDescriptionCount = _CubeVertexInput.m_BindingCount;
+	vertexInputInfo.vertexAttributeDescriptionCount = _CubeVertexInput.m_AttributeCount;
 
-	vertexInputInfo.pVertexBindingDescriptions = bindDescArr;
-	vertexInputInfo.pVertexAttributeDescriptions = descriptions;
+	vertexInputInfo.pVertexBindingDescriptions = _CubeVertexInput.m_Bindings;
+	vertexInputInfo.pVertexAttributeDescriptions = _CubeVertexInput.m_Attributes;
 
 	CreateDescriptorPool();
 	CreateDescriptorSet();
 
-	VkDescriptorBufferInfo bInfo2 = _ViewProjection.GetBufferDesc();
+	// the frame's region is picked by the dynamic offset when the set is bound
+	VkDescriptorBufferInfo bInfo2 = m_UniformRing.GetBufferDesc(_ViewProjection.GetSize());
 
 	VkWriteDescriptorSet descWrite = {};
 	descWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
 	descWrite.dstSet = _descriptorSet;
 	descWrite.dstBinding = 0;
 	descWrite.dstArrayElement = 0;
-	descWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	descWrite.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
 	descWrite.descriptorCount = 1;
 	descWrite.pBufferInfo = &bInfo2;
 
@@ -538,7 +646,7 @@ VkDescriptorSetLayout vkGraphicsDevice::CreateDescriptorLayout(VkDescriptorSetLa
 void vkGraphicsDevice::CreateDescriptorPool()
 {
 	VkDescriptorPoolSize poolSize = {};
-	poolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+	poolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
 	poolSize.descriptorCount = 1; // (uint32_t)m_Swapchain->GetNofImages();
 
 	VkDescriptorPoolCreateInfo createInfo = {};
@@ -634,25 +742,6 @@ VkFramebuffer vkGraphicsDevice::CreateFramebuffer(VkImageView* view, int32 attac
 	return framebuffer;
 }
 
-VkVertexInputBindingDescription vkGraphicsDevice::CreateBindDesc()
-{
-	VkVertexInputBindingDescription bindingDescription = {};
-	bindingDescription.binding = 0;
-	bindingDescription.stride = sizeof(Vertex);
-	bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-	return bindingDescription;
-}
-
-VkVertexInputAttributeDescription vkGraphicsDevice::CreateAttrDesc(int location, int offset)
-{
-	VkVertexInputAttributeDescription attrDesc = {};
-	attrDesc.binding = 0;
-	attrDesc.location = location;
-	attrDesc.format = VK_FORMAT_R32G32B32A32_SFLOAT;
-	attrDesc.offset = offset;
-	return attrDesc;
-}
-
 VkSemaphore vkGraphicsDevice::CreateVkSemaphore(VkDevice pDevice)
 {
 	VkSemaphore semaphore = nullptr;
@@ -669,25 +758,63 @@ VkSubmitInfo vkGraphicsDevice::SetupRenderCommands(int index)
 	vkWaitForFences(m_LogicalDevice->GetDevice(), 1, &m_CommandFence, VK_TRUE, UINT64_MAX);
 	vkResetFences(m_LogicalDevice->GetDevice(), 1, &m_CommandFence);
 
+	m_FrameArena.BeginFrame(index);
+
 	VkFramebuffer& frameBuffer = m_FrameBuffers[index];
 	VlkCommandBuffer& commandBuffer = *m_Buffers[index];
 
+	// every cube's world matrix in one pass over the SoA transforms
+	const uint32 cubeCount = _CubeTransforms.Size();
+	Core::Matrix44f* world = m_FrameArena.Alloc<Core::Matrix44f>(cubeCount);
+	_CubeTransforms.ComposeWorld(world);
+
+	const Core::Frustum frustum = Core::Frustum::FromViewProjection(*_Camera.GetViewProjection());
+	const Core::Vector4f& eye = _Camera.GetPosition();
+	const Core::Vector3f cameraPosition(eye.x, eye.y, eye.z);
+
+	// culling and LOD selection run on all job threads, what is left is a draw per mesh and LOD
+	Core::JobSystem& jobs = Core::JobSystem::Get();
+	_CubeRenderer.Prepare(index, jobs, world, frustum, cameraPosition, _Camera.GetLodScale());
+
+	// the constants are taken with the camera the culling used, into the region of the frame being recorded
+	m_UniformRing.BeginFrame(index);
+	uint32 constantsOffset = 0;
+	const bool constantsWritten = _ViewProjection.Write(m_UniformRing, constantsOffset);
+	ASSERT(constantsWritten, "The uniform ring is out of room for this frame, raise the budget passed to Init");
+
+	/*
+		Every mesh is recorded into a secondary buffer on the job threads, each from the pool of the thread
+		recording it, and run from the primary in mesh order.
+	*/
+	m_ThreadCommandPools.BeginFrame(index);
+	// without constants the draws would read another frame's region, the pass still runs so the frame clears
+	const uint32 meshCount = constantsWritten ? _CubeRenderer.GetMeshCount() : 0;
+	VkCommandBuffer* secondaries = m_FrameArena.Alloc<VkCommandBuffer>(meshCount);
+
+	jobs.ParallelFor(
+		meshCount,
+		[&](uint32 begin, uint32 end) {
+			for(uint32 mesh = begin; mesh < end; ++mesh)
+			{
+				VlkCommandBuffer& secondary = *m_ThreadCommandPools.AcquireSecondary(jobs.GetThreadIndex());
+				secondary.BeginSecondary(_renderPass, 0, frameBuffer);
+				// nothing is inherited from the primary but the render pass
+				secondary.BindPipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, _pipeline);
+				secondary.BindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout, 0, 1, &_descriptorSet,
+											 1, &constantsOffset);
+				_CubeRenderer.Draw(&secondary, _pipelineLayout, mesh);
+				secondary.End();
+				secondaries[mesh] = secondary.GetHandle();
+			}
+		},
+		1);
+
 	commandBuffer.Begin();
 	VkRenderPassBeginInfo pass_info = {};
 	PrepareRenderPass(&pass_info, frameBuffer, _size.m_Width, _size.m_Height);
-	commandBuffer.BeginRenderPass(pass_info, VK_SUBPASS_CONTENTS_INLINE);
-	commandBuffer.BindPipeline(VK_PIPELINE_BIND_POINT_GRAPHICS, _pipeline);
-	commandBuffer.BindDescriptorSets(VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout, 0, 1, &_descriptorSet, 0,
-									 nullptr);
-
-	/* This thing right here is what I'm looking for */
-
-	for(Cube& cube : _Cubes)
-	{
-		cube.Draw(&commandBuffer, _pipelineLayout);
-	}
-
-	/* This is what draws the cubes */
+	commandBuffer.BeginRenderPass(pass_info, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+	if(meshCount > 0)
+		commandBuffer.ExecuteCommands(secondaries, meshCount);
 
 	// ImGui_ImplVulkan_RenderDrawData(ImGui::GetDrawData(), commandBuffer);
 
@@ -706,7 +833,7 @@ void vkGraphicsDevice::CreateDepthResources()
 	VkFormat depthFormat = m_PhysicalDevice->FindDepthFormat();
 	const VkExtent2D extent = m_Swapchain->GetExtent();
 	CreateImage(extent.width, extent.height, depthFormat, VK_IMAGE_TILING_OPTIMAL,
-				VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _depthImage,
+				VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, true, _depthImage,
 				_depthImageMemory);
 	_depthView = CreateImageView(depthFormat, _depthImage, VK_IMAGE_ASPECT_DEPTH_BIT);
 
@@ -715,8 +842,8 @@ void vkGraphicsDevice::CreateDepthResources()
 }
 
 void vkGraphicsDevice::CreateImage(uint32 width, uint32 height, VkFormat format, VkImageTiling imageTiling,
-								   VkImageUsageFlags usage, VkMemoryPropertyFlags properties, VkImage& image,
-								   VkDeviceMemory& imageMemory)
+								   VkImageUsageFlags usage, VkMemoryPropertyFlags properties, bool renderTarget,
+								   VkImage& image, Core::GpuAllocation& imageMemory)
 {
 	VkDevice device = m_LogicalDevice->GetDevice();
 
@@ -740,20 +867,11 @@ void vkGraphicsDevice::CreateImage(uint32 width, uint32 height, VkFormat format,
 		throw std::runtime_error("failed to create image!");
 	}
 
-	VkMemoryRequirements memRequirements;
-	vkGetImageMemoryRequirements(device, image, &memRequirements);
-
-	VkMemoryAllocateInfo allocInfo = {};
-	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-	allocInfo.allocationSize = memRequirements.size;
-	allocInfo.memoryTypeIndex = m_PhysicalDevice->FindMemoryType(memRequirements.memoryTypeBits, properties);
-
-	if(vkAllocateMemory(device, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS)
+	imageMemory = m_LogicalDevice->GetMemoryAllocator().AllocateImage(image, imageTiling, properties, 0, renderTarget);
+	if(!imageMemory.IsValid())
 	{
 		throw std::runtime_error("failed to allocate image memory!");
 	}
-
-	vkBindImageMemory(device, image, imageMemory, 0);
 }
 
 // Need to look into what this function actually does
@@ -834,7 +952,7 @@ void vkGraphicsDevice::transitionImageLayout(VkImage image, VkFormat format, VkI
 
 VlkCommandBuffer* vkGraphicsDevice::BeginSingleTimeCommands()
 {
-	Core::GrowingArray<VlkCommandBuffer*> buffer =
+	VlkCommandBufferList buffer =
 		m_CommandPool.CreateCommandBuffers(CommandBufferLevel::E_PRIMARY, CommandBufferUsage::E_ONE_TIME, 1);
 	// the buffer I just created is a local object.
 	// auto returnValue = std::make_unique<VlkCommandBuffer>(buffer[0]);
@@ -847,7 +965,7 @@ void vkGraphicsDevice::EndSingleTimeCommands(VlkCommandBuffer* commandBuffer)
 	VkSubmitInfo submitInfo = commandBuffer->End();
 	vkQueueSubmit(m_LogicalDevice->GetQueue(), 1, &submitInfo, VK_NULL_HANDLE);
 	vkQueueWaitIdle(m_LogicalDevice->GetQueue());
-	delete commandBuffer;
+	m_CommandPool.DestroyCommandBuffer(commandBuffer);
 }
 
 VkPipelineShaderStageCreateInfo vkGraphicsDevice::CreateShaderStageInfo(VkShaderStageFlagBits stageFlags,
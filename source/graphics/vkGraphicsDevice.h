@@ -4,8 +4,13 @@
 
 #include "Core/utilities/utilities.h"
 #include "Core/containers/Array.h"
+#include "Core/memory/FrameArena.h"
+#include "Core/memory/GpuMemoryAllocator.h"
 #include "Core/Defines.h"
 #include "VlkCommandPool.h"
+#include "VlkThreadCommandPools.h"
+#include "VlkUniformRing.h"
+#include "VlkUploadContext.h"
 
 #include <memory>
 #include <vector>
@@ -39,6 +44,7 @@ public:
 
 	VlkInstance& GetVlkInstance() { return *m_VlkInstance; }
 	VlkDevice& GetVlkDevice() { return *m_LogicalDevice; }
+	Core::FrameArena& GetFrameArena() { return m_FrameArena; }
 
 private:
 	vkGraphicsDevice();
@@ -50,9 +56,13 @@ private:
 	VlkDevice* m_LogicalDevice = nullptr;
 	VlkSwapchain* m_Swapchain = nullptr;
 	VlkCommandPool m_CommandPool;
+	VlkThreadCommandPools m_ThreadCommandPools; // the secondary buffers the draws are recorded into
+	VlkUploadContext m_UploadContext; // flushed once per frame, the frame's submit waits for it
+	VlkUniformRing m_UniformRing; // the constants, one region per entry in m_Buffers
 
 	std::vector<VkFramebuffer> m_FrameBuffers;
 	Core::Array<VlkCommandBuffer*, 2> m_Buffers;
+	Core::FrameArena m_FrameArena; // one region per entry in m_Buffers, reset when that buffer is recorded
 
 	VkSemaphore m_AcquireNextImageSemaphore = nullptr;
 
@@ -73,11 +83,10 @@ private:
 	VkImageView CreateImageView(VkFormat format, VkImage image, VkImageAspectFlags aspectFlag);
 	VkFramebuffer CreateFramebuffer(VkImageView* view, int32 attachmentCount, const Window& window);
 
+	// render targets get memory of their own, see GpuAllocationDesc::m_Dedicated
 	void CreateImage(uint32 width, uint32 height, VkFormat format, VkImageTiling imageTiling, VkImageUsageFlags usage,
-					 VkMemoryPropertyFlags properties, VkImage& image, VkDeviceMemory& imageMemory);
-
-	VkVertexInputBindingDescription CreateBindDesc();
-	VkVertexInputAttributeDescription CreateAttrDesc(int location, int offset);
+					 VkMemoryPropertyFlags properties, bool renderTarget, VkImage& image,
+					 Core::GpuAllocation& imageMemory);
 
 	void CreateDepthResources();
 
@@ -3,6 +3,8 @@
 #include "InputDeviceKeyboard_Win32.h"
 #include "InputDeviceMouse_Win32.h"
 
+#include "core/memory/Allocator.h"
+
 #include <cassert>
 
 namespace Input
@@ -28,14 +30,14 @@ namespace Input
 	InputManager& InputManager::Get()
 	{
 		if( !m_Instance )
-			m_Instance = new InputManager;
+			m_Instance = Core::New<InputManager>(Core::MemoryTag::Input);
 
 		return *m_Instance;
 	}
 
 	void InputManager::Destroy()
 	{
-		delete m_Instance;
+		Core::Delete(Core::MemoryTag::Input, m_Instance);
 		m_Instance = nullptr;
 	}
 
@@ -1,31 +1,51 @@
 #include "Debug.h"
 #include <cassert>
 #include <cstdarg>
-//#include <cstdio>
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
 #include <sstream>
 #include <ctime>
 #include "StackWalker.h"
+#include "core/memory/Allocator.h"
 #include <sys/types.h>
-#include <sys/timeb.h>
-#ifndef DEBUG
+#include <sys/stat.h>
+#if defined(_WIN32) && !defined(DEBUG)
 #include <ShlObj.h>
 #endif
 
 namespace Log
 {
+	namespace
+	{
+		// localtime_s on Windows and localtime_r elsewhere take their arguments the other way around
+		void LocalTime(time_t time, tm& result)
+		{
+#ifdef _WIN32
+			localtime_s(&result, &time);
+#else
+			localtime_r(&time, &result);
+#endif
+		}
+	}; // namespace
+
 	Debug* Debug::m_Instance = nullptr;
 	void Debug::Create()
 	{
 #ifdef DEBUG
-		m_Instance = new Debug();
+		// the constructor is private, so no Core::New
+		void* memory = Core::GetAllocator(Core::MemoryTag::Logger)->Allocate(sizeof(Debug), alignof(Debug));
+		m_Instance = new(memory) Debug();
 		time_t now = time(0);
 		struct tm tstruct;
 		char buf[30];
-		localtime_s(&tstruct, &now);
+		LocalTime(now, tstruct);
 		strftime(buf, sizeof(buf), "%Y-%m-%d_%H_%M_%S", &tstruct);
-		std::string logFolder = "log\\";
+		std::string logFolder = "log/";
 #ifdef _WIN32
 		CreateDirectory(L"log", NULL);
+#else
+		mkdir("log", 0755);
 #endif
 		std::stringstream ss;
 		ss << logFolder << buf << "_log.txt";
@@ -36,10 +56,15 @@ namespace Log
 
 	void Debug::Destroy()
 	{
+		// Create only makes an instance in Debug builds
+		if(!m_Instance)
+			return;
+
 		if(m_Instance->m_Stream.is_open())
 			m_Instance->m_Stream.close();
 
-		delete m_Instance;
+		m_Instance->~Debug();
+		Core::GetAllocator(Core::MemoryTag::Logger)->Free(m_Instance, sizeof(Debug), alignof(Debug));
 		m_Instance = nullptr;
 	}
 
@@ -54,30 +79,28 @@ namespace Log
 		time_t now = time(0);
 		struct tm tstruct;
 		char buf[30];
-		localtime_s(&tstruct, &now);
+		LocalTime(now, tstruct);
 
 		strftime(buf, sizeof(buf), "%H:%M:%S:", &tstruct);
 
-		// Get Miliseconds and store in tStructMilli
-		struct _timeb tstructMilli;
-		char bufMilli[128];
-
-		_strtime_s(bufMilli);
-		_ftime_s(&tstructMilli);
+		// Get Miliseconds
+		const auto sinceEpoch = std::chrono::system_clock::now().time_since_epoch();
+		const unsigned milliseconds =
+			(unsigned)(std::chrono::duration_cast<std::chrono::milliseconds>(sinceEpoch).count() % 1000);
 
 		// Get VA_ARGS and store as string in buffer
 		char buffer[4096];
 		va_list args;
 		va_start(args, fmt);
-		vsprintf_s(buffer, fmt, args);
+		vsnprintf(buffer, sizeof(buffer), fmt, args);
 		perror(buffer);
 		va_end(args);
 
-		// Merge time and VA_ARGS into string and print to log-file
-		std::stringstream ss;
-		ss << "[" << buf << tstructMilli.millitm << "] " << buffer;
+		// Merge time and VA_ARGS into string and print to log-file, formatted on the stack to keep the heap out of it
+		char line[4096 + 64];
+		snprintf(line, sizeof(line), "[%s%u] %s\n", buf, milliseconds, buffer);
 
-		m_Stream << ss.str().c_str() << std::endl;
+		m_Stream << line;
 		m_Stream.flush();
 	}
 
@@ -86,7 +109,7 @@ namespace Log
 		char buffer[1024];
 		va_list args;
 		va_start(args, fmt);
-		vsprintf_s(buffer, fmt, args);
+		vsnprintf(buffer, sizeof(buffer), fmt, args);
 		perror(buffer);
 		va_end(args);
 #ifdef _WIN32
@@ -108,7 +131,7 @@ namespace Log
 		char buffer[1024];
 		va_list args;
 		va_start(args, fmt);
-		vsprintf_s(buffer, fmt, args);
+		vsnprintf(buffer, sizeof(buffer), fmt, args);
 		perror(buffer);
 		va_end(args);
 
@@ -131,12 +154,19 @@ namespace Log
 		StackWalker sw;
 		sw.ShowCallstack();
 		m_Stream.flush();
+#ifdef _WIN32
 		const size_t len = ss.str().length() + 1;
-		wchar_t* wc = new wchar_t[len];
+		Core::IAllocator* allocator = Core::GetAllocator(Core::MemoryTag::Logger);
+		wchar_t* wc = static_cast<wchar_t*>(allocator->Allocate(sizeof(wchar_t) * len, alignof(wchar_t)));
 		size_t tempSize;
 		mbstowcs_s(&tempSize, wc, len, ss.str().c_str(), len);
 		_wassert(wc, _CRT_WIDE(__FILE__), __LINE__);
-		delete[] wc;
+		allocator->Free(wc, sizeof(wchar_t) * len, alignof(wchar_t));
+#else
+		// what _wassert does, minus the dialog
+		fprintf(stderr, "Assertion failed: %s", ss.str().c_str());
+		abort();
+#endif
 	}
 
 	void Debug::DebugMessage(const char* fileName, int line, const char* fncName, const char* fmt, ...)
@@ -145,7 +175,7 @@ namespace Log
 		char buffer[1024];
 		va_list args;
 		va_start(args, fmt);
-		vsprintf_s(buffer, fmt, args);
+		vsnprintf(buffer, sizeof(buffer), fmt, args);
 		perror(buffer);
 		va_end(args);
 
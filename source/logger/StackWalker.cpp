@@ -1,8 +1,14 @@
 #include "StackWalker.h"
 #include "Debug.h"
 
+#ifndef _WIN32
+#include <cstdlib>
+#include <execinfo.h>
+#endif
+
 namespace Log
 {
+#ifdef _WIN32
 	StackWalker::StackWalker()
 		: BaseStackWalker()
 	{
@@ -13,4 +19,18 @@ namespace Log
 	{
 	}
 	void StackWalker::OnOutput(char* aString) { LOG_MESSAGE("%s", aString); }
+#else
+	void StackWalker::ShowCallstack()
+	{
+		void* frames[64];
+		const int count = backtrace(frames, 64);
+		char** symbols = backtrace_symbols(frames, count);
+		if(!symbols)
+			return;
+
+		for(int i = 0; i < count; ++i)
+			LOG_MESSAGE("%s", symbols[i]);
+		free(symbols);
+	}
+#endif
 } // namespace Log
@@ -1,11 +1,12 @@
 #pragma once
 #ifdef _WIN32
 #include <windows.h>
+#include "StackWalker/StackWalker.h"
 #endif
-#include "StackWalker\StackWalker.h"
 
 namespace Log
 {
+#ifdef _WIN32
 	class StackWalker : public BaseStackWalker
 	{
 	public:
@@ -13,5 +14,13 @@ namespace Log
 		StackWalker( unsigned int aProcessId, HANDLE aProcess );
 		virtual void OnOutput( char* aString );
 	};
+#else
+	// the Win32 walker needs dbghelp, elsewhere backtrace() does the same for the current thread
+	class StackWalker
+	{
+	public:
+		void ShowCallstack();
+	};
+#endif
 
 }; // namespace Log
@@ -117,6 +117,31 @@ if _OPTIONS["project"] ~= nil then
             links { "Graphics", "Core", "Input", "Logger", "Game" } --libraries to link
 
             files { "executable/*.cpp" }
+
+        project "PakBuilder"
+            kind "ConsoleApp"
+            location ("./tools/pak_builder")
+            targetdir "%{wks.location}/../bin"
+            dependson { "Core", "Logger" }
+            links { "Core", "Logger" }
+            files { "tools/pak_builder/*.cpp" }
+
+        project "MeshCooker"
+            kind "ConsoleApp"
+            location ("./tools/mesh_cooker")
+            targetdir "%{wks.location}/../bin"
+            dependson { "Core", "Logger" }
+            links { "Core", "Logger" }
+            files { "tools/mesh_cooker/*.cpp" }
+
+        project "RecordBench"
+            kind "ConsoleApp"
+            location ("./tools/record_bench")
+            targetdir "%{wks.location}/../bin"
+            dependson { "Graphics", "Core", "Logger" }
+            links { "Graphics", "Core", "Logger", "$(VULKAN_SDK)/lib/vulkan-1.lib" }
+            includedirs { "./external_libs/", "$(VULKAN_SDK)/Include/" }
+            files { "tools/record_bench/*.cpp" }
     elseif _OPTIONS["project"] == "unit_test" then
         startproject "UnitTest"
         project "UnitTest" --project name
@@ -176,6 +201,10 @@ end
         links { "Core" }
         dependson { "Core" }
         files{"logger/**.cpp", "logger/**.h", "logger/**.hpp", "logger/**.c"}
+        -- the vendored StackWalker is Win32 only, StackWalker.cpp falls back to backtrace elsewhere
+        filter "platforms:Linux or OSX"
+            removefiles { "logger/StackWalker/**" }
+        filter {}
     
     -- project "ImGui"
     --     kind "StaticLib"
@@ -13,11 +13,12 @@ cbuffer viewProjection : register (b0)
     float4 lightDir; 
 };
 
+// matches the default Core::Mesh::EncodeOptions, see graphics/VertexLayout.cpp for the locations
 struct VSInput 
 {
-    float4 position : POSITION;
-    float4 color : COLOR;
-    float4 normal : NORMAL;
+    float4 position : POSITION; // snorm16, pc.world also carries the dequantize scale and offset
+    float4 color : COLOR;       // unorm8
+    float2 normal : NORMAL;     // octahedral snorm16
 };
 
 struct VSOutput 
@@ -28,6 +29,15 @@ struct VSOutput
     float4 lightDir : LIGHT;
 };
 
+// inverse of Core::Quantize::OctEncode
+float3 OctDecode(float2 e)
+{
+    float3 n = float3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = saturate(-n.z);
+    n.xy += select(n.xy >= 0.0, -t, t);
+    return normalize(n);
+}
+
 VSOutput main(VSInput input, uint vertex_id : SV_VertexID) 
 {
     VSOutput output = (VSOutput)0;
@@ -37,7 +47,7 @@ VSOutput main(VSInput input, uint vertex_id : SV_VertexID)
     output.lightDir = lightDir;
 
     // output.normal = mul(input.normal, pc.world);
-    output.normal = input.normal;
+    output.normal = float4(OctDecode(input.normal), 0.0);
     output.color = input.color; //float4(1,1,1,1);
     return output;
 }
\ No newline at end of file
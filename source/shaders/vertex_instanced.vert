@@ -0,0 +1,58 @@
+// -E main -T vs_6_0
+
+// one per mesh, every instance of it shares the dequantize step
+struct PushConstants
+{
+    row_major float4x4 dequantize;
+};
+
+[[vk::push_constant]] PushConstants pc;
+
+cbuffer viewProjection : register (b0)
+{
+    row_major float4x4 viewProj;
+    float4 lightDir;
+};
+
+// the mesh inputs match vertex.vert, the world matrix comes per instance, see AddInstanceTransform
+struct VSInput
+{
+    [[vk::location(0)]] float4 position : POSITION; // snorm16
+    [[vk::location(1)]] float4 color : COLOR;       // unorm8
+    [[vk::location(2)]] float2 normal : NORMAL;     // octahedral snorm16
+    [[vk::location(3)]] float4 world0 : WORLD0;     // rows of the instance's Core::Matrix44f
+    [[vk::location(4)]] float4 world1 : WORLD1;
+    [[vk::location(5)]] float4 world2 : WORLD2;
+    [[vk::location(6)]] float4 world3 : WORLD3;
+};
+
+struct VSOutput
+{
+    float4 position : SV_POSITION;
+    float4 color : COLOR;
+    float4 normal : NORMAL;
+    float4 lightDir : LIGHT;
+};
+
+// inverse of Core::Quantize::OctEncode
+float3 OctDecode(float2 e)
+{
+    float3 n = float3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = saturate(-n.z);
+    n.xy += select(n.xy >= 0.0, -t, t);
+    return normalize(n);
+}
+
+VSOutput main(VSInput input)
+{
+    VSOutput output = (VSOutput)0;
+
+    const float4x4 world = float4x4(input.world0, input.world1, input.world2, input.world3);
+    output.position = mul(mul(input.position, pc.dequantize), world);
+    output.position = mul(output.position, viewProj);
+    output.lightDir = lightDir;
+
+    output.normal = float4(OctDecode(input.normal), 0.0);
+    output.color = input.color;
+    return output;
+}
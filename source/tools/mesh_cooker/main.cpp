@@ -0,0 +1,258 @@
+#include "core/File.h"
+#include "core/FileWriter.h"
+#include "core/mesh/MeshFormat.h"
+#include "core/mesh/MeshOptimizer.h"
+#include "core/mesh/MeshSimplifier.h"
+#include "core/mesh/Meshlets.h"
+#include "logger/Debug.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+/*
+	Cooks a mesh into an optimised .mesh for the renderer, runs without a window or GPU.
+
+		MeshCooker [options] <input> <output.mesh>
+
+	The input is either a .mesh, which is re-optimised as is, or an old .mdl (a raw array of Core::MeshVertex)
+	which is welded, quantized and indexed first. Then a chain of LODs is simplified from it, the triangles of every
+	LOD are reordered for the post-transform cache (Forsyth), clusters are sorted against overdraw, the vertices
+	are reordered for fetch and finally LOD 0 is split into meshlets with bounds and normal cones for cluster
+	culling.
+
+	--position snorm16|half|float	position storage for .mdl input, snorm16 by default
+	--normal oct|float				normal storage for .mdl input, oct by default, the engine's shaders only read oct
+	--color unorm8|float			colour storage for .mdl input, unorm8 by default
+	--lods N						LODs including the full one, 4 by default, 1 for none
+	--lod-ratio R					triangles each LOD keeps of the one before, 0.5 by default
+	--lod-error E					error budget of the coarsest LOD relative to the mesh radius, 0.02 by default
+	--overdraw T					how much worse the ACMR may get for overdraw sorting, 1.05 by default
+	--no-optimize					only convert, keep the triangle order
+	--no-meshlets					leave out the meshlet section
+*/
+
+static void PrintUsage()
+{
+	printf("usage: MeshCooker [--position snorm16|half|float] [--normal oct|float] [--color unorm8|float]\n"
+		   "                  [--lods N] [--lod-ratio R] [--lod-error E] [--overdraw T] [--no-optimize]\n"
+		   "                  [--no-meshlets] <input> <output.mesh>\n");
+}
+
+static bool ParseFormat(const char* name, Core::VertexFormat& format)
+{
+	struct Named
+	{
+		const char* m_Name;
+		Core::VertexFormat m_Format;
+	};
+	static const Named formats[] = { { "snorm16", Core::VertexFormat::Snorm16x4 },
+									 { "half", Core::VertexFormat::Half4 },
+									 { "float", Core::VertexFormat::Float4 },
+									 { "oct", Core::VertexFormat::Oct16 },
+									 { "unorm8", Core::VertexFormat::Unorm8x4 } };
+	for(const Named& named : formats)
+	{
+		if(strcmp(name, named.m_Name) == 0)
+		{
+			format = named.m_Format;
+			return true;
+		}
+	}
+	return false;
+}
+
+static void PrintStats(const char* label, const Core::MeshOptimizer::MeshStats& stats)
+{
+	printf("%-8s ACMR %.3f  ATVR %.3f  overfetch %.3f\n", label, stats.m_Cache.m_Acmr, stats.m_Cache.m_Atvr,
+		   stats.m_Overfetch);
+}
+
+static int Cook(int argc, char** argv)
+{
+	Core::Mesh::EncodeOptions options;
+	Core::MeshSimplifier::LodOptions lodOptions;
+	float overdrawThreshold = 1.05f;
+	bool optimize = true;
+	bool meshlets = true;
+
+	int arg = 1;
+	for(; arg < argc && strncmp(argv[arg], "--", 2) == 0; ++arg)
+	{
+		if(strcmp(argv[arg], "--no-optimize") == 0)
+		{
+			optimize = false;
+			continue;
+		}
+
+		if(strcmp(argv[arg], "--no-meshlets") == 0)
+		{
+			meshlets = false;
+			continue;
+		}
+
+		const char* value = arg + 1 < argc ? argv[arg + 1] : "";
+		bool valid = false;
+		if(strcmp(argv[arg], "--position") == 0)
+			valid = ParseFormat(value, options.m_Position);
+		else if(strcmp(argv[arg], "--normal") == 0)
+			valid = ParseFormat(value, options.m_Normal);
+		else if(strcmp(argv[arg], "--color") == 0)
+			valid = ParseFormat(value, options.m_Color);
+		else if(strcmp(argv[arg], "--lods") == 0)
+		{
+			lodOptions.m_LodCount = static_cast<uint32>(atoi(value));
+			valid = lodOptions.m_LodCount >= 1 && lodOptions.m_LodCount <= Core::Mesh::s_MaxLods;
+		}
+		else if(strcmp(argv[arg], "--lod-ratio") == 0)
+		{
+			lodOptions.m_Ratio = static_cast<float>(atof(value));
+			valid = lodOptions.m_Ratio > 0.f && lodOptions.m_Ratio < 1.f;
+		}
+		else if(strcmp(argv[arg], "--lod-error") == 0)
+		{
+			lodOptions.m_ErrorBudget = static_cast<float>(atof(value));
+			valid = lodOptions.m_ErrorBudget > 0.f;
+		}
+		else if(strcmp(argv[arg], "--overdraw") == 0)
+		{
+			overdrawThreshold = static_cast<float>(atof(value));
+			valid = overdrawThreshold >= 1.f;
+		}
+
+		if(!valid)
+		{
+			printf("bad option %s %s\n", argv[arg], value);
+			PrintUsage();
+			return 1;
+		}
+		++arg;
+	}
+
+	if(arg + 2 != argc)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	const char* input = argv[arg];
+	const char* output = argv[arg + 1];
+
+	// File can't tell a missing file from an empty one
+	FILE* probe = fopen(input, "rb");
+	if(!probe)
+	{
+		printf("can't open %s\n", input);
+		return 1;
+	}
+	fclose(probe);
+
+	Core::File file(input, Core::File::READ_FILE);
+	const Core::Span<const char> data = file.GetView();
+
+	std::vector<char> mesh;
+	Core::Mesh::MeshView view;
+	const Core::Mesh::ParseResult parsed = view.Parse(data);
+	if(parsed == Core::Mesh::ParseResult::WrongVersion)
+	{
+		printf("%s was cooked for another version of the .mesh format, cook it again from its source\n", input);
+		return 1;
+	}
+	if(parsed == Core::Mesh::ParseResult::Corrupt)
+	{
+		printf("%s is a damaged .mesh\n", input);
+		return 1;
+	}
+
+	if(parsed == Core::Mesh::ParseResult::Ok)
+		mesh.assign(data.begin(), data.end());
+	else
+	{
+		// no magic, a raw MeshVertex array from before .mesh existed
+		if(data.Size() == 0 || data.Size() % sizeof(Core::MeshVertex) != 0)
+		{
+			printf("%s is neither a .mesh nor a vertex dump\n", input);
+			return 1;
+		}
+
+		std::vector<Core::MeshVertex> vertices(data.Size() / sizeof(Core::MeshVertex));
+		memcpy(vertices.data(), data.GetData(), data.Size());
+		mesh = Core::Mesh::Encode(vertices.data(), static_cast<uint32>(vertices.size()), options);
+		if(view.Parse(Core::Span<const char>(mesh.data(), mesh.size())) != Core::Mesh::ParseResult::Ok)
+		{
+			printf("that format doesn't fit the attribute, see the usage for which ones do\n");
+			PrintUsage();
+			return 1;
+		}
+
+		if(options.m_Normal != Core::VertexFormat::Oct16)
+			printf("warning: the engine's shaders only read oct normals, it will refuse this mesh\n");
+
+		printf("%u vertices welded to %u, %u bit indices, %u -> %u bytes per vertex\n",
+			   static_cast<uint32>(vertices.size()), view.GetHeader().m_VertexCount, view.GetHeader().m_IndexSize * 8,
+			   static_cast<uint32>(sizeof(Core::MeshVertex)), view.GetHeader().m_VertexStride);
+	}
+
+	if(view.GetHeader().m_IndexCount > 0)
+	{
+		Core::MeshSimplifier::AddLods(mesh, lodOptions);
+		view.Parse(Core::Span<const char>(mesh.data(), mesh.size()));
+
+		const Core::Span<const Core::MeshLod> lods = view.GetLods();
+		for(uint32 i = 0; i < lods.Size(); ++i)
+		{
+			printf("LOD %u: %u triangles, error %g (%.2f%% of the radius)\n", i, lods[i].m_IndexCount / 3,
+				   lods[i].m_Error, 100.f * lods[i].m_Error / view.GetHeader().m_BoundsRadius);
+		}
+	}
+
+	if(optimize)
+	{
+		Core::MeshOptimizer::MeshStats before;
+		Core::MeshOptimizer::MeshStats after;
+		Core::MeshOptimizer::OptimizeMesh(mesh, overdrawThreshold, &before, &after);
+		PrintStats("before", before);
+		PrintStats("after", after);
+	}
+
+	if(meshlets && view.GetHeader().m_IndexCount > 0)
+	{
+		Core::Mesh::AddMeshlets(mesh);
+		view.Parse(Core::Span<const char>(mesh.data(), mesh.size()));
+
+		uint32 coneCount = 0;
+		for(const Core::Meshlet& meshlet : view.GetMeshlets())
+			coneCount += meshlet.m_ConeCutoff < 1.f ? 1 : 0;
+
+		const uint32 meshletCount = view.GetHeader().m_MeshletCount;
+		printf("%u meshlets, %.1f vertices and %.1f triangles on average, %u with a usable normal cone\n",
+			   meshletCount, (float)view.GetHeader().m_MeshletVertexCount / meshletCount,
+			   (float)view.GetHeader().m_MeshletTriangleCount / meshletCount, coneCount);
+	}
+
+	Core::FileWriter writer;
+	if(!writer.Open(output))
+	{
+		printf("failed to write %s\n", output);
+		return 1;
+	}
+	writer.Write(mesh.data(), mesh.size());
+	if(!writer.Close())
+	{
+		printf("failed to write %s\n", output);
+		return 1;
+	}
+
+	printf("%s: %llu bytes\n", output, (unsigned long long)mesh.size());
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	// asserts and log messages in Debug builds go through the logger
+	Log::Debug::Create();
+	const int result = Cook(argc, argv);
+	Log::Debug::Destroy();
+	return result;
+}
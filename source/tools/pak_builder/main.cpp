@@ -0,0 +1,79 @@
+#include "core/ArchiveBuilder.h"
+#include "core/File.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+/*
+	Packs loose files into a .pak for Core::Archive.
+
+		PakBuilder [--align N] <output.pak> [--lz4 | --store] <file> ...
+
+	Files are stored under the path given on the command line, with '\' turned into '/', so "Data/Shaders/frag.hlsl"
+	is found the same way it was opened before. --lz4 and --store switch compression for the files after them.
+*/
+
+static void PrintUsage() { printf("usage: PakBuilder [--align N] <output.pak> [--lz4 | --store] <file> ...\n"); }
+
+int main(int argc, char** argv)
+{
+	uint32 alignment = 64;
+	int arg = 1;
+	if(arg + 1 < argc && strcmp(argv[arg], "--align") == 0)
+	{
+		alignment = static_cast<uint32>(strtoul(argv[arg + 1], nullptr, 10));
+		arg += 2;
+	}
+
+	if(arg >= argc)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	const char* output = argv[arg++];
+	Core::ArchiveBuilder builder;
+	Core::Compression compression = Core::Compression::None;
+	uint64 inputSize = 0;
+	for(; arg < argc; ++arg)
+	{
+		if(strcmp(argv[arg], "--lz4") == 0)
+		{
+			compression = Core::Compression::Lz4;
+			continue;
+		}
+
+		if(strcmp(argv[arg], "--store") == 0)
+		{
+			compression = Core::Compression::None;
+			continue;
+		}
+
+		std::string name = argv[arg];
+		for(char& c : name)
+			c = c == '\\' ? '/' : c;
+
+		const uint64 storedBefore = builder.GetStoredSize();
+		if(!builder.AddFile(name.c_str(), argv[arg], compression))
+		{
+			printf("failed to add %s, missing or its name hash is already taken\n", argv[arg]);
+			return 1;
+		}
+
+		Core::File file(argv[arg], Core::File::READ_FILE);
+		inputSize += file.GetSize();
+		printf("%-48s %10llu -> %10llu\n", name.c_str(), (unsigned long long)file.GetSize(),
+			   (unsigned long long)(builder.GetStoredSize() - storedBefore));
+	}
+
+	if(!builder.Save(output, alignment))
+	{
+		printf("failed to write %s\n", output);
+		return 1;
+	}
+
+	printf("%u entries, %llu bytes packed into %llu\n", builder.GetEntryCount(), (unsigned long long)inputSize,
+		   (unsigned long long)builder.GetStoredSize());
+	return 0;
+}
@@ -0,0 +1,377 @@
+#include "core/JobSystem.h"
+#include "core/math/Matrix44.h"
+#include "graphics/VlkCommandBuffer.h"
+#include "graphics/VlkCommandPool.h"
+#include "graphics/VlkThreadCommandPools.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+/*
+	Times recording draws into VlkThreadCommandPools the way vkGraphicsDevice::SetupRenderCommands does, partitions
+	recorded into secondary command buffers on the job threads and run from one primary, for 1 up to every hardware
+	thread. Runs without a window.
+
+		RecordBench [--draws N] [--frames N] [--any-device]
+
+	A CPU device is picked when there is one, so the numbers are about the engine and not one GPU's driver: run it
+	with VK_ICD_FILENAMES pointing at lavapipe's lvp_icd json. Every draw is its own object like before the scene
+	was instanced: push constants, vertex and index buffer and the indexed draw. The buffers are only recorded and
+	never submitted, so no pipeline or shaders are needed.
+
+	--draws N		draws per frame, runs 10000, 50000 and 100000 by default
+	--frames N		frames recorded per thread count, the best one is reported, 20 by default
+	--any-device	take the first device even when it is a GPU
+*/
+
+namespace
+{
+	constexpr uint32 s_MinDrawsPerPartition = 32;
+
+	struct Context
+	{
+		VkInstance m_Instance = nullptr;
+		VkPhysicalDevice m_PhysicalDevice = nullptr;
+		VkDevice m_Device = nullptr;
+		int32 m_QueueFamily = -1;
+		VkRenderPass m_RenderPass = VK_NULL_HANDLE;
+		VkImage m_Image = VK_NULL_HANDLE;
+		VkImageView m_View = VK_NULL_HANDLE;
+		VkFramebuffer m_Framebuffer = VK_NULL_HANDLE;
+		VkDeviceMemory m_ImageMemory = VK_NULL_HANDLE;
+		VkBuffer m_Buffer = VK_NULL_HANDLE;
+		VkDeviceMemory m_BufferMemory = VK_NULL_HANDLE;
+		VkPipelineLayout m_PipelineLayout = VK_NULL_HANDLE;
+	};
+
+	void PrintUsage() { printf("usage: RecordBench [--draws N] [--frames N] [--any-device]\n"); }
+
+	uint32 FindMemoryType(VkPhysicalDevice device, uint32 typeFilter, VkMemoryPropertyFlags flags)
+	{
+		VkPhysicalDeviceMemoryProperties properties;
+		vkGetPhysicalDeviceMemoryProperties(device, &properties);
+		for(uint32 i = 0; i < properties.memoryTypeCount; ++i)
+		{
+			if((typeFilter & (1u << i)) && (properties.memoryTypes[i].propertyFlags & flags) == flags)
+				return i;
+		}
+		return ~0u;
+	}
+
+	VkDeviceMemory Allocate(const Context& context, const VkMemoryRequirements& requirements)
+	{
+		VkMemoryAllocateInfo info = {};
+		info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		info.allocationSize = requirements.size;
+		info.memoryTypeIndex = FindMemoryType(context.m_PhysicalDevice, requirements.memoryTypeBits, 0);
+
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+		if(info.memoryTypeIndex == ~0u || vkAllocateMemory(context.m_Device, &info, nullptr, &memory) != VK_SUCCESS)
+			return VK_NULL_HANDLE;
+		return memory;
+	}
+
+	bool CreateDevice(Context& context, bool anyDevice)
+	{
+		VkApplicationInfo appInfo = {};
+		appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+		appInfo.pApplicationName = "RecordBench";
+		appInfo.apiVersion = VK_API_VERSION_1_0;
+
+		VkInstanceCreateInfo instanceInfo = {};
+		instanceInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+		instanceInfo.pApplicationInfo = &appInfo;
+		if(vkCreateInstance(&instanceInfo, nullptr, &context.m_Instance) != VK_SUCCESS)
+			return false;
+
+		uint32 deviceCount = 0;
+		vkEnumeratePhysicalDevices(context.m_Instance, &deviceCount, nullptr);
+		std::vector<VkPhysicalDevice> devices(deviceCount);
+		vkEnumeratePhysicalDevices(context.m_Instance, &deviceCount, devices.data());
+		for(VkPhysicalDevice device : devices)
+		{
+			VkPhysicalDeviceProperties properties;
+			vkGetPhysicalDeviceProperties(device, &properties);
+			if(!anyDevice && properties.deviceType != VK_PHYSICAL_DEVICE_TYPE_CPU)
+				continue;
+
+			uint32 familyCount = 0;
+			vkGetPhysicalDeviceQueueFamilyProperties(device, &familyCount, nullptr);
+			std::vector<VkQueueFamilyProperties> families(familyCount);
+			vkGetPhysicalDeviceQueueFamilyProperties(device, &familyCount, families.data());
+			for(uint32 i = 0; i < familyCount && context.m_QueueFamily < 0; ++i)
+			{
+				if(families[i].queueFlags & VK_QUEUE_GRAPHICS_BIT)
+					context.m_QueueFamily = static_cast<int32>(i);
+			}
+			if(context.m_QueueFamily >= 0)
+			{
+				context.m_PhysicalDevice = device;
+				printf("device: %s\n", properties.deviceName);
+				break;
+			}
+		}
+		if(!context.m_PhysicalDevice)
+			return false;
+
+		const float priority = 1.f;
+		VkDeviceQueueCreateInfo queueInfo = {};
+		queueInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+		queueInfo.queueFamilyIndex = static_cast<uint32>(context.m_QueueFamily);
+		queueInfo.queueCount = 1;
+		queueInfo.pQueuePriorities = &priority;
+
+		VkDeviceCreateInfo deviceInfo = {};
+		deviceInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+		deviceInfo.queueCreateInfoCount = 1;
+		deviceInfo.pQueueCreateInfos = &queueInfo;
+		return vkCreateDevice(context.m_PhysicalDevice, &deviceInfo, nullptr, &context.m_Device) == VK_SUCCESS;
+	}
+
+	// a small colour target to begin the render pass on and the buffers every draw binds
+	bool CreateResources(Context& context)
+	{
+		VkAttachmentDescription attachment = {};
+		attachment.format = VK_FORMAT_R8G8B8A8_UNORM;
+		attachment.samples = VK_SAMPLE_COUNT_1_BIT;
+		attachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		attachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+		attachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+		attachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		attachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		attachment.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+		VkAttachmentReference reference = { 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+		VkSubpassDescription subpass = {};
+		subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+		subpass.colorAttachmentCount = 1;
+		subpass.pColorAttachments = &reference;
+
+		VkRenderPassCreateInfo passInfo = {};
+		passInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+		passInfo.attachmentCount = 1;
+		passInfo.pAttachments = &attachment;
+		passInfo.subpassCount = 1;
+		passInfo.pSubpasses = &subpass;
+		if(vkCreateRenderPass(context.m_Device, &passInfo, nullptr, &context.m_RenderPass) != VK_SUCCESS)
+			return false;
+
+		VkImageCreateInfo imageInfo = {};
+		imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+		imageInfo.extent = { 64, 64, 1 };
+		imageInfo.mipLevels = 1;
+		imageInfo.arrayLayers = 1;
+		imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+		imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		if(vkCreateImage(context.m_Device, &imageInfo, nullptr, &context.m_Image) != VK_SUCCESS)
+			return false;
+
+		VkMemoryRequirements requirements;
+		vkGetImageMemoryRequirements(context.m_Device, context.m_Image, &requirements);
+		context.m_ImageMemory = Allocate(context, requirements);
+		if(context.m_ImageMemory == VK_NULL_HANDLE ||
+		   vkBindImageMemory(context.m_Device, context.m_Image, context.m_ImageMemory, 0) != VK_SUCCESS)
+			return false;
+
+		VkImageViewCreateInfo viewInfo = {};
+		viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		viewInfo.image = context.m_Image;
+		viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		viewInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+		viewInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+		if(vkCreateImageView(context.m_Device, &viewInfo, nullptr, &context.m_View) != VK_SUCCESS)
+			return false;
+
+		VkFramebufferCreateInfo framebufferInfo = {};
+		framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		framebufferInfo.renderPass = context.m_RenderPass;
+		framebufferInfo.attachmentCount = 1;
+		framebufferInfo.pAttachments = &context.m_View;
+		framebufferInfo.width = 64;
+		framebufferInfo.height = 64;
+		framebufferInfo.layers = 1;
+		if(vkCreateFramebuffer(context.m_Device, &framebufferInfo, nullptr, &context.m_Framebuffer) != VK_SUCCESS)
+			return false;
+
+		VkBufferCreateInfo bufferInfo = {};
+		bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bufferInfo.size = 64 * 1024;
+		bufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+		bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		if(vkCreateBuffer(context.m_Device, &bufferInfo, nullptr, &context.m_Buffer) != VK_SUCCESS)
+			return false;
+
+		vkGetBufferMemoryRequirements(context.m_Device, context.m_Buffer, &requirements);
+		context.m_BufferMemory = Allocate(context, requirements);
+		if(context.m_BufferMemory == VK_NULL_HANDLE ||
+		   vkBindBufferMemory(context.m_Device, context.m_Buffer, context.m_BufferMemory, 0) != VK_SUCCESS)
+			return false;
+
+		// the same push constant range as the engine's pipeline layout
+		VkPushConstantRange pushRange = { VK_SHADER_STAGE_VERTEX_BIT, 0,
+										  sizeof(Core::Matrix44f) + sizeof(Core::Vector4f) };
+		VkPipelineLayoutCreateInfo layoutInfo = {};
+		layoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		layoutInfo.pushConstantRangeCount = 1;
+		layoutInfo.pPushConstantRanges = &pushRange;
+		return vkCreatePipelineLayout(context.m_Device, &layoutInfo, nullptr, &context.m_PipelineLayout) ==
+			   VK_SUCCESS;
+	}
+
+	void DestroyContext(Context& context)
+	{
+		if(context.m_Device)
+		{
+			vkDestroyPipelineLayout(context.m_Device, context.m_PipelineLayout, nullptr);
+			vkDestroyBuffer(context.m_Device, context.m_Buffer, nullptr);
+			vkFreeMemory(context.m_Device, context.m_BufferMemory, nullptr);
+			vkDestroyFramebuffer(context.m_Device, context.m_Framebuffer, nullptr);
+			vkDestroyImageView(context.m_Device, context.m_View, nullptr);
+			vkDestroyImage(context.m_Device, context.m_Image, nullptr);
+			vkFreeMemory(context.m_Device, context.m_ImageMemory, nullptr);
+			vkDestroyRenderPass(context.m_Device, context.m_RenderPass, nullptr);
+			vkDestroyDevice(context.m_Device, nullptr);
+		}
+		if(context.m_Instance)
+			vkDestroyInstance(context.m_Instance, nullptr);
+	}
+
+	// best frame in milliseconds
+	double RecordFrames(const Context& context, uint32 threadCount, uint32 drawCount, uint32 frames)
+	{
+		Core::JobSystem jobs(threadCount);
+		VlkThreadCommandPools threadPools;
+		threadPools.Init(context.m_Device, context.m_QueueFamily, threadCount);
+		VlkCommandPool primaryPool;
+		primaryPool.Init(context.m_Device, context.m_QueueFamily);
+		VlkCommandBuffer* primary =
+			primaryPool.CreateCommandBuffers(CommandBufferLevel::E_PRIMARY, CommandBufferUsage::E_ONE_TIME, 1)[0];
+
+		std::vector<Core::Matrix44f> world(drawCount, Core::Matrix44f::Identity());
+		for(uint32 i = 0; i < drawCount; ++i)
+			world[i].SetTranslation((float)(i % 100), (float)(i / 100), 0.f, 1.f);
+
+		const uint32 grain = jobs.GetGrainSize(drawCount);
+		const uint32 partitionSize = grain > s_MinDrawsPerPartition ? grain : s_MinDrawsPerPartition;
+		const uint32 partitionCount = (drawCount + partitionSize - 1) / partitionSize;
+		std::vector<VkCommandBuffer> secondaries(partitionCount);
+
+		VkRenderPassBeginInfo passInfo = {};
+		passInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+		passInfo.renderPass = context.m_RenderPass;
+		passInfo.framebuffer = context.m_Framebuffer;
+		passInfo.renderArea.extent = { 64, 64 };
+		VkClearValue clear = {};
+		passInfo.clearValueCount = 1;
+		passInfo.pClearValues = &clear;
+
+		double best = 1e30;
+		for(uint32 frame = 0; frame < frames; ++frame)
+		{
+			const auto start = std::chrono::steady_clock::now();
+
+			// nothing was submitted, the pools can be reset right away
+			threadPools.BeginFrame(frame % VlkThreadCommandPools::FrameCount);
+			jobs.ParallelFor(
+				partitionCount,
+				[&](uint32 begin, uint32 end) {
+					for(uint32 partition = begin; partition < end; ++partition)
+					{
+						VlkCommandBuffer& secondary = *threadPools.AcquireSecondary(jobs.GetThreadIndex());
+						secondary.BeginSecondary(context.m_RenderPass, 0, context.m_Framebuffer);
+
+						VkBuffer buffer = context.m_Buffer;
+						VkDeviceSize offset = 0;
+						const uint32 first = partition * partitionSize;
+						const uint32 last = first + partitionSize < drawCount ? first + partitionSize : drawCount;
+						for(uint32 i = first; i < last; ++i)
+						{
+							secondary.PushConstants(context.m_PipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0,
+													sizeof(Core::Matrix44f), &world[i][0]);
+							secondary.BindVertexBuffers(0, 1, &buffer, &offset);
+							secondary.BindIndexBuffer(buffer, 0, VK_INDEX_TYPE_UINT16);
+							secondary.DrawIndexed(36, 1, 0, 0, 0);
+						}
+						secondary.End();
+						secondaries[partition] = secondary.GetHandle();
+					}
+				},
+				1);
+
+			primary->Begin();
+			primary->BeginRenderPass(passInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+			primary->ExecuteCommands(secondaries.data(), partitionCount);
+			primary->EndRenderPass();
+			primary->End();
+
+			const std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - start;
+			best = ms.count() < best ? ms.count() : best;
+		}
+
+		primaryPool.DestroyCommandBuffer(primary);
+		threadPools.Destroy();
+		return best;
+	}
+}; // namespace
+
+int main(int argc, char** argv)
+{
+	std::vector<uint32> drawCounts;
+	uint32 frames = 20;
+	bool anyDevice = false;
+	for(int arg = 1; arg < argc; ++arg)
+	{
+		if(strcmp(argv[arg], "--draws") == 0 && arg + 1 < argc)
+			drawCounts.push_back(static_cast<uint32>(atoi(argv[++arg])));
+		else if(strcmp(argv[arg], "--frames") == 0 && arg + 1 < argc)
+			frames = static_cast<uint32>(atoi(argv[++arg]));
+		else if(strcmp(argv[arg], "--any-device") == 0)
+			anyDevice = true;
+		else
+		{
+			PrintUsage();
+			return 1;
+		}
+	}
+	if(drawCounts.empty())
+		drawCounts = { 10000, 50000, 100000 };
+	frames = frames > 0 ? frames : 1;
+
+	Context context;
+	if(!CreateDevice(context, anyDevice) || !CreateResources(context))
+	{
+		printf("no usable Vulkan device%s\n", anyDevice ? "" : ", --any-device allows GPUs");
+		DestroyContext(context);
+		return 1;
+	}
+
+	const uint32 hardwareThreads = std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1;
+	std::vector<uint32> threadCounts;
+	for(uint32 threads = 1; threads < hardwareThreads; threads *= 2)
+		threadCounts.push_back(threads);
+	threadCounts.push_back(hardwareThreads);
+
+	printf("%8s %8s %10s %8s\n", "draws", "threads", "ms", "speedup");
+	for(const uint32 drawCount : drawCounts)
+	{
+		double baseline = 0.0;
+		for(const uint32 threads : threadCounts)
+		{
+			const double ms = RecordFrames(context, threads, drawCount, frames);
+			baseline = threads == 1 ? ms : baseline;
+			printf("%8u %8u %10.3f %7.2fx\n", drawCount, threads, ms, baseline / ms);
+		}
+	}
+
+	DestroyContext(context);
+	return 0;
+}
@@ -0,0 +1,966 @@
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "gtest/gtest.h"
+
+#include "Core/containers/GrowingArray.h"
+#include "Core/containers/HashMap.h"
+#include "Core/math/Vector4.h"
+#include "Core/math/MatrixKernels.h"
+#include "Core/math/Quaternion.h"
+#include "Core/Archive.h"
+#include "Core/AsyncIO.h"
+#include "Core/ArchiveBuilder.h"
+#include "Core/Fiber.h"
+#include "Core/File.h"
+#include "Core/JobSystem.h"
+#include "Core/math/Frustum.h"
+#include "Core/memory/MemoryTracker.h"
+#include "Core/math/TransformBatch.h"
+#include "Core/mesh/InstanceBatcher.h"
+#include "Core/mesh/LodSelection.h"
+
+/*
+	Rough timing comparisons, not hard pass / fail tests.
+	Run with --gtest_filter=Benchmark* to only get these, numbers are only meaningful in Release.
+*/
+
+namespace
+{
+	template <typename Fn>
+	double Measure(Fn&& fn, int iterations = 5)
+	{
+		double best = 1e30;
+		for(int i = 0; i < iterations; ++i)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			fn();
+			const std::chrono::duration<double, std::milli> diff = std::chrono::steady_clock::now() - start;
+			best = diff.count() < best ? diff.count() : best;
+		}
+		return best;
+	}
+
+	void Report(const char* name, double ms, double baseline)
+	{
+		printf("%-40s %8.3f ms (%.2fx)\n", name, ms, baseline / ms);
+	}
+
+	struct Payload
+	{
+		float data[4];
+		std::vector<int>* owner = nullptr;
+	};
+}; // namespace
+
+TEST(Benchmark, GrowingArrayPush)
+{
+	static constexpr int count = 1000000;
+
+	const double vec = Measure([] {
+		std::vector<Payload> v;
+		for(int i = 0; i < count; ++i)
+			v.push_back({ { (float)i, 0.f, 0.f, 1.f } });
+		ASSERT_EQ(v.size(), count);
+	});
+
+	const double arr = Measure([] {
+		Core::GrowingArray<Payload> a;
+		for(int i = 0; i < count; ++i)
+			a.Add({ { (float)i, 0.f, 0.f, 1.f } });
+		ASSERT_EQ(a.Size(), count);
+	});
+
+	const double nested = Measure([] {
+		Core::GrowingArray<Core::GrowingArray<int>> a;
+		for(int i = 0; i < count / 10; ++i)
+			a.EmplaceBack(4).Add(i);
+		ASSERT_EQ(a.Size(), count / 10);
+	});
+
+	const double nestedVec = Measure([] {
+		std::vector<std::vector<int>> v;
+		for(int i = 0; i < count / 10; ++i)
+		{
+			v.emplace_back().reserve(4);
+			v.back().push_back(i);
+		}
+		ASSERT_EQ(v.size(), count / 10);
+	});
+
+	Report("std::vector<Payload> push 1M", vec, vec);
+	Report("GrowingArray<Payload> push 1M", arr, vec);
+	Report("std::vector<std::vector> push 100k", nestedVec, nestedVec);
+	Report("GrowingArray<GrowingArray> push 100k", nested, nestedVec);
+}
+
+TEST(Benchmark, HashMapVsUnorderedMap)
+{
+	for(const uint32 count : { 10000u, 100000u, 1000000u })
+	{
+		Core::GrowingArray<Core::HashString> keys(count);
+		for(uint32 i = 0; i < count; ++i)
+			keys.Add(Core::HashString(("asset_" + std::to_string(i)).c_str()));
+
+		uint64 sum = 0;
+		const double stdMap = Measure(
+			[&] {
+				std::unordered_map<uint64, uint32> map;
+				for(uint32 i = 0; i < count; ++i)
+					map[keys[i].GetHash()] = i;
+				for(uint32 i = 0; i < count; ++i)
+					sum += map.find(keys[i].GetHash())->second;
+				for(uint32 i = 0; i < count; i += 2)
+					map.erase(keys[i].GetHash());
+			},
+			3);
+
+		const double coreMap = Measure(
+			[&] {
+				Core::HashMap<Core::HashString, uint32> map;
+				for(uint32 i = 0; i < count; ++i)
+					map.Insert(keys[i], i);
+				for(uint32 i = 0; i < count; ++i)
+					sum += *map.Find(keys[i]);
+				for(uint32 i = 0; i < count; i += 2)
+					map.Remove(keys[i]);
+			},
+			3);
+
+		printf("%u entries, insert + find + remove half (sum %llu)\n", count, (unsigned long long)sum);
+		Report("  std::unordered_map<uint64, uint32>", stdMap, stdMap);
+		Report("  Core::HashMap<HashString, uint32>", coreMap, stdMap);
+	}
+}
+
+namespace
+{
+	// what Vector4<T> does for every component, kept here so the float specialization has something to race
+	struct ScalarVector4
+	{
+		float x, y, z, w;
+	};
+
+	float ScalarDot(const ScalarVector4& a, const ScalarVector4& b)
+	{
+		return (a.x * b.x) + (a.y * b.y) + (a.z * b.z) + (a.w * b.w);
+	}
+
+	ScalarVector4 ScalarNormalized(const ScalarVector4& v)
+	{
+		const float length = sqrtf(ScalarDot(v, v));
+		return { v.x / length, v.y / length, v.z / length, v.w / length };
+	}
+}; // namespace
+
+TEST(Benchmark, Vector4fNormalize)
+{
+	// small enough to stay in cache, this is about the math and not memory bandwidth
+	static constexpr uint32 count = 4096;
+	static constexpr uint32 passes = 256;
+	Core::GrowingArray<ScalarVector4> scalar(count);
+	Core::GrowingArray<Core::Vector4f> simd(count);
+	for(uint32 i = 0; i < count; ++i)
+	{
+		const float f = (float)i;
+		scalar.Add({ f + 1.f, f * 0.5f, 3.f - f, 1.f });
+		simd.Add({ f + 1.f, f * 0.5f, 3.f - f, 1.f });
+	}
+
+	float sink = 0.f;
+	const double scalarMs = Measure([&] {
+		for(uint32 pass = 0; pass < passes; ++pass)
+		{
+			for(uint32 i = 0; i < count; ++i)
+				scalar[i] = ScalarNormalized(scalar[i]);
+		}
+		sink += scalar[count / 2].x;
+	});
+
+	const double simdMs = Measure([&] {
+		for(uint32 pass = 0; pass < passes; ++pass)
+		{
+			for(uint32 i = 0; i < count; ++i)
+				Core::Normalize(simd[i]);
+		}
+		sink += simd[count / 2].x;
+	});
+
+	const double fastMs = Measure([&] {
+		for(uint32 pass = 0; pass < passes; ++pass)
+		{
+			for(uint32 i = 0; i < count; ++i)
+				Core::FastNormalize(simd[i]);
+		}
+		sink += simd[count / 2].x;
+	});
+
+	const double addScalarMs = Measure([&] {
+		for(uint32 pass = 0; pass < passes; ++pass)
+		{
+			for(uint32 i = 1; i < count; ++i)
+			{
+				const ScalarVector4& a = scalar[i - 1];
+				ScalarVector4& b = scalar[i];
+				b = { (a.x + b.x) * 0.5f, (a.y + b.y) * 0.5f, (a.z + b.z) * 0.5f, (a.w + b.w) * 0.5f };
+			}
+		}
+		sink += scalar[count - 1].y;
+	});
+
+	const double addSimdMs = Measure([&] {
+		for(uint32 pass = 0; pass < passes; ++pass)
+		{
+			for(uint32 i = 1; i < count; ++i)
+				simd[i] = (simd[i - 1] + simd[i]) * 0.5f;
+		}
+		sink += simd[count - 1].y;
+	});
+
+	printf("(sink %f)\n", sink);
+	Report("scalar normalize 4k x 256", scalarMs, scalarMs);
+	Report("Vector4f Normalize 4k x 256", simdMs, scalarMs);
+	Report("Vector4f FastNormalize 4k x 256", fastMs, scalarMs);
+	Report("scalar add + scale chain 4k x 256", addScalarMs, addScalarMs);
+	Report("Vector4f add + scale chain 4k x 256", addSimdMs, addScalarMs);
+}
+
+TEST(Benchmark, Matrix44Kernels)
+{
+	static constexpr uint32 count = 4096;
+	static constexpr uint32 passes = 64;
+
+	Core::GrowingArray<Core::Matrix44f> matrices(count);
+	Core::GrowingArray<Core::Matrix44f> results(count);
+	Core::GrowingArray<Core::Vector4f> vectors(count);
+	Core::GrowingArray<Core::Vector4f> transformed(count);
+	for(uint32 i = 0; i < count; ++i)
+	{
+		Core::Matrix44f matrix = Core::Matrix44f::CreateRotateAroundY((float)i * 0.01f);
+		matrix.SetPosition({ (float)i, 2.f, -3.f, 1.f });
+		matrix[0] += 0.5f; // keep it general, not just a rigid transform
+		matrices.Add(matrix);
+		results.Add(matrix);
+		vectors.Add({ (float)i, 1.f, 2.f, 1.f });
+		transformed.Add(vectors.GetLast());
+	}
+
+	float sink = 0.f;
+	const double scalarInverse = Measure([&] {
+		for(uint32 pass = 0; pass < passes; ++pass)
+		{
+			for(uint32 i = 0; i < count; ++i)
+				results[i] = Core::InverseReal(matrices[i]);
+		}
+		sink += results[count / 2][3];
+	});
+
+	const double simdInverse = Measure([&] {
+		for(uint32 pass = 0; pass < passes; ++pass)
+		{
+			for(uint32 i = 0; i < count; ++i)
+				Core::Math::Inverse(matrices[i], results[i]);
+		}
+		sink += results[count / 2][3];
+	});
+
+	const double scalarTranspose = Measure([&] {
+		for(uint32 pass = 0; pass < passes; ++pass)
+		{
+			for(uint32 i = 0; i < count; ++i)
+			{
+				const Core::Matrix44f& m = matrices[i];
+				Core::Matrix44f& r = results[i];
+				for(int row = 0; row < 4; ++row)
+				{
+					for(int column = 0; column < 4; ++column)
+						r.mat[row][column] = m.mat[column][row];
+				}
+			}
+		}
+		sink += results[count / 2][3];
+	});
+
+	const double simdTranspose = Measure([&] {
+		for(uint32 pass = 0; pass < passes; ++pass)
+		{
+			for(uint32 i = 0; i < count; ++i)
+				results[i] = Core::Transpose(matrices[i]);
+		}
+		sink += results[count / 2][3];
+	});
+
+	const double scalarTransform = Measure([&] {
+		const Core::Matrix44f& m = matrices[1];
+		for(uint32 pass = 0; pass < passes * 4; ++pass)
+		{
+			for(uint32 i = 0; i < count; ++i)
+				transformed[i] = vectors[i] * m;
+		}
+		sink += transformed[count / 2].x;
+	});
+
+	const double simdTransform = Measure([&] {
+		for(uint32 pass = 0; pass < passes * 4; ++pass)
+			Core::Math::TransformBatch(matrices[1], vectors.GetData(), transformed.GetData(), count);
+		sink += transformed[count / 2].x;
+	});
+
+	printf("(sink %f)\n", sink);
+	Report("InverseReal 4k x 64", scalarInverse, scalarInverse);
+	Report("Math::Inverse 4k x 64", simdInverse, scalarInverse);
+	Report("scalar transpose 4k x 64", scalarTranspose, scalarTranspose);
+	Report("Transpose (SSE) 4k x 64", simdTranspose, scalarTranspose);
+	Report("v * m 4k x 256", scalarTransform, scalarTransform);
+	Report("Math::TransformBatch 4k x 256", simdTransform, scalarTransform);
+}
+
+TEST(Benchmark, TransformBatchCompose)
+{
+	static constexpr uint32 count = 4096;
+	static constexpr uint32 passes = 64;
+
+	Core::TransformBatch batch(count);
+	Core::GrowingArray<Core::Matrix44f> world(count);
+	Core::GrowingArray<Core::Matrix44f> combined(count);
+	for(uint32 i = 0; i < count; ++i)
+	{
+		const float half = (float)i * 0.005f;
+		batch.Add({ (float)i, 2.f, -3.f, 1.f }, { 0.f, sinf(half), 0.f, cosf(half) }, { 1.f, 2.f, 1.f, 0.f });
+		world.Add(Core::Matrix44f::Identity());
+		combined.Add(Core::Matrix44f::Identity());
+	}
+	Core::Matrix44f viewProjection = Core::Matrix44f::CreateRotateAroundX(0.3f);
+	viewProjection.SetPosition({ 0.f, 0.f, 10.f, 1.f });
+
+	// what every object does on its own today, a matrix per object and one multiply with the camera
+	float sink = 0.f;
+	const double aosMs = Measure([&] {
+		for(uint32 pass = 0; pass < passes; ++pass)
+		{
+			for(uint32 i = 0; i < count; ++i)
+			{
+				const Core::Vector4f scale = batch.GetScale(i);
+				Core::Matrix44f matrix = Core::Matrix44f::CreateRotateAroundY((float)i * 0.01f);
+				matrix = Core::Matrix44f::CreateScaleMatrix(scale.x, scale.y, scale.z, 1.f) * matrix;
+				matrix.SetPosition(batch.GetPosition(i));
+				world[i] = matrix;
+				combined[i] = viewProjection * matrix;
+			}
+		}
+		sink += combined[count / 2][13];
+	});
+	Report("AoS Matrix44f compose + mul 4k x 64", aosMs, aosMs);
+
+	for(const Core::TransformBatch::Path path :
+		{ Core::TransformBatch::Path::Scalar, Core::TransformBatch::Path::SSE, Core::TransformBatch::Path::AVX2 })
+	{
+		if(!Core::TransformBatch::IsSupported(path))
+			continue;
+
+		batch.SetPath(path);
+		const double ms = Measure([&] {
+			for(uint32 pass = 0; pass < passes; ++pass)
+				batch.ComposeWorldViewProjection(viewProjection, world.GetData(), combined.GetData());
+			sink += combined[count / 2][13];
+		});
+
+		const std::string name = std::string("TransformBatch ") + Core::TransformBatch::GetPathName(path) + " 4k x 64";
+		Report(name.c_str(), ms, aosMs);
+	}
+	printf("(sink %f)\n", sink);
+}
+
+TEST(Benchmark, QuaternionBatch)
+{
+	static constexpr uint32 count = 4096;
+	static constexpr uint32 passes = 64;
+
+	Core::GrowingArray<Core::Quaternion> from(count);
+	Core::GrowingArray<Core::Quaternion> to(count);
+	Core::GrowingArray<Core::Quaternion> blended(count);
+	Core::GrowingArray<Core::Matrix44f> matrices(count);
+	for(uint32 i = 0; i < count; ++i)
+	{
+		const float angle = (float)i * 0.001f;
+		from.Add(Core::Quaternion(Core::Vector3f(0.f, 1.f, 0.f), angle));
+		to.Add(Core::Quaternion(Core::Vector3f(0.6f, 0.8f, 0.f), 1.f - angle));
+		blended.Add(Core::Quaternion());
+		matrices.Add(Core::Matrix44f::Identity());
+	}
+
+	float sink = 0.f;
+	const double slerp = Measure([&] {
+		for(uint32 pass = 0; pass < passes; ++pass)
+		{
+			for(uint32 i = 0; i < count; ++i)
+				blended[i] = Core::Slerp(from[i], to[i], 0.3f);
+		}
+		sink += blended[count / 2].x;
+	});
+
+	const double slerpBatch = Measure([&] {
+		for(uint32 pass = 0; pass < passes; ++pass)
+			Core::Math::SlerpBatch(from.GetData(), to.GetData(), 0.3f, blended.GetData(), count);
+		sink += blended[count / 2].x;
+	});
+
+	const double nlerp = Measure([&] {
+		for(uint32 pass = 0; pass < passes; ++pass)
+		{
+			for(uint32 i = 0; i < count; ++i)
+				blended[i] = Core::Nlerp(from[i], to[i], 0.3f);
+		}
+		sink += blended[count / 2].x;
+	});
+
+	const double nlerpBatch = Measure([&] {
+		for(uint32 pass = 0; pass < passes; ++pass)
+			Core::Math::NlerpBatch(from.GetData(), to.GetData(), 0.3f, blended.GetData(), count);
+		sink += blended[count / 2].x;
+	});
+
+	const double multiply = Measure([&] {
+		for(uint32 pass = 0; pass < passes; ++pass)
+		{
+			for(uint32 i = 0; i < count; ++i)
+				blended[i] = from[i] * to[i];
+		}
+		sink += blended[count / 2].x;
+	});
+
+	const double multiplyBatch = Measure([&] {
+		for(uint32 pass = 0; pass < passes; ++pass)
+			Core::Math::MultiplyBatch(from.GetData(), to.GetData(), blended.GetData(), count);
+		sink += blended[count / 2].x;
+	});
+
+	const double toMatrix = Measure([&] {
+		for(uint32 pass = 0; pass < passes; ++pass)
+		{
+			for(uint32 i = 0; i < count; ++i)
+				matrices[i] = from[i].ConvertToRotationMatrix();
+		}
+		sink += matrices[count / 2][2];
+	});
+
+	const double toMatrixBatch = Measure([&] {
+		for(uint32 pass = 0; pass < passes; ++pass)
+			Core::Math::ToMatrixBatch(from.GetData(), matrices.GetData(), count);
+		sink += matrices[count / 2][2];
+	});
+
+	printf("(sink %f)\n", sink);
+	Report("Slerp 4k x 64", slerp, slerp);
+	Report("Math::SlerpBatch 4k x 64", slerpBatch, slerp);
+	Report("Nlerp 4k x 64", nlerp, nlerp);
+	Report("Math::NlerpBatch 4k x 64", nlerpBatch, nlerp);
+	Report("Quaternion * 4k x 64", multiply, multiply);
+	Report("Math::MultiplyBatch 4k x 64", multiplyBatch, multiply);
+	Report("ConvertToRotationMatrix 4k x 64", toMatrix, toMatrix);
+	Report("Math::ToMatrixBatch 4k x 64", toMatrixBatch, toMatrix);
+}
+
+TEST(Benchmark, FileReadMappedVsBuffered)
+{
+	const auto writeFile = [](const char* name, uint32 size) {
+		const std::string path = testing::TempDir() + name;
+		std::vector<char> contents(size);
+		for(uint32 i = 0; i < size; ++i)
+			contents[i] = (char)(i * 31);
+		FILE* file = fopen(path.c_str(), "wb");
+		fwrite(contents.data(), 1, size, file);
+		fclose(file);
+		return path;
+	};
+
+	// the scene at startup, 128 cubes each copying the same 36 vertex model into their vertex buffer
+	const std::string model = writeFile("bench_cube.mdl", 36 * 48);
+	std::vector<char> vertexBuffer(36 * 48);
+	uint64 sink = 0;
+
+	const double perCube = Measure([&] {
+		for(int i = 0; i < 128; ++i)
+		{
+			Core::File file(model.c_str(), Core::File::READ_FILE);
+			memcpy(vertexBuffer.data(), file.GetBuffer(), file.GetSize());
+			sink += vertexBuffer[i];
+		}
+	});
+
+	const double mappedOnce = Measure([&] {
+		Core::File file(model.c_str(), Core::File::READ_MAPPED);
+		for(int i = 0; i < 128; ++i)
+		{
+			memcpy(vertexBuffer.data(), file.GetView().GetData(), file.GetSize());
+			sink += vertexBuffer[i];
+		}
+	});
+
+	// one large asset read front to back
+	const std::string large = writeFile("bench_large.bin", 64 << 20);
+	const auto touch = [&](const Core::File& file) {
+		for(const char c : file.GetView())
+			sink += (uint8)c;
+	};
+
+	const double largeBuffered = Measure([&] { touch(Core::File(large.c_str(), Core::File::READ_FILE)); }, 3);
+	const double largeMapped = Measure([&] { touch(Core::File(large.c_str(), Core::File::READ_MAPPED)); }, 3);
+
+	remove(model.c_str());
+	remove(large.c_str());
+
+	printf("(sink %llu)\n", (unsigned long long)sink);
+	Report("scene load, File per cube (128)", perCube, perCube);
+	Report("scene load, one mapped File", mappedOnce, perCube);
+	Report("64MB read + touch, buffered", largeBuffered, largeBuffered);
+	Report("64MB read + touch, mapped", largeMapped, largeBuffered);
+}
+
+TEST(Benchmark, FileWriteStreamingVsWholeBuffer)
+{
+	static constexpr uint64 total = 256ull << 20;
+	const std::string path = testing::TempDir() + "bench_write.bin";
+	std::vector<char> chunk(64 << 10);
+	for(size_t i = 0; i < chunk.size(); ++i)
+		chunk[i] = (char)(i * 13);
+
+	// what write mode used to do, grow one buffer to the whole file and write it out at the end
+	uint64 wholePeak = 0;
+	const double whole = Measure(
+		[&] {
+			std::vector<char> buffer;
+			buffer.reserve(1024);
+			for(uint64 written = 0; written < total; written += chunk.size())
+			{
+				if(buffer.size() + chunk.size() > buffer.capacity())
+					buffer.reserve((buffer.size() + chunk.size()) * 3 / 2);
+				buffer.insert(buffer.end(), chunk.begin(), chunk.end());
+			}
+			wholePeak = buffer.capacity();
+			FILE* file = fopen(path.c_str(), "wb");
+			fwrite(buffer.data(), 1, buffer.size(), file);
+			fclose(file);
+		},
+		3);
+
+	Core::MemoryTracker::Reset();
+	const double streaming = Measure(
+		[&] {
+			Core::File file(path.c_str(), Core::File::WRITE_FILE);
+			for(uint64 written = 0; written < total; written += chunk.size())
+				file.Write(chunk.data(), 1, chunk.size());
+			file.Close();
+		},
+		3);
+	const uint64 streamingPeak = Core::MemoryTracker::GetStats(Core::MemoryTag::Core).m_PeakBytes;
+	remove(path.c_str());
+
+	printf("peak memory, whole buffer %llu KB, streaming %llu KB\n", (unsigned long long)(wholePeak >> 10),
+		   (unsigned long long)(streamingPeak >> 10));
+	Report("256MB write, whole file buffer", whole, whole);
+	Report("256MB write, File streaming", streaming, whole);
+}
+
+TEST(Benchmark, ArchiveVsLooseFiles)
+{
+	static constexpr uint32 count = 256;
+	std::vector<std::string> paths;
+	std::vector<std::string> names;
+	Core::ArchiveBuilder builder;
+	for(uint32 i = 0; i < count; ++i)
+	{
+		std::string contents;
+		while(contents.size() < 8192)
+			contents += "v " + std::to_string(i) + " " + std::to_string(contents.size()) + "\n";
+
+		names.push_back("asset_" + std::to_string(i) + ".txt");
+		paths.push_back(testing::TempDir() + "bench_" + names.back());
+		FILE* file = fopen(paths.back().c_str(), "wb");
+		fwrite(contents.data(), 1, contents.size(), file);
+		fclose(file);
+		builder.AddFile(names.back().c_str(), paths.back().c_str());
+	}
+
+	const std::string pack = testing::TempDir() + "bench_assets.pak";
+	builder.Save(pack.c_str());
+
+	Core::ArchiveBuilder packedBuilder;
+	for(uint32 i = 0; i < count; ++i)
+		packedBuilder.AddFile(names[i].c_str(), paths[i].c_str(), Core::Compression::Lz4);
+	const std::string compressedPack = testing::TempDir() + "bench_assets_lz4.pak";
+	packedBuilder.Save(compressedPack.c_str());
+
+	uint64 sink = 0;
+	const double loose = Measure([&] {
+		for(const std::string& path : paths)
+		{
+			Core::File file(path.c_str(), Core::File::READ_FILE);
+			sink += file.GetBuffer()[file.GetSize() - 1];
+		}
+	});
+
+	const double packed = Measure([&] {
+		Core::Archive archive;
+		archive.Open(pack.c_str());
+		for(const std::string& name : names)
+		{
+			const Core::Span<const char> view = archive.GetView(name.c_str());
+			sink += view[view.Size() - 1];
+		}
+	});
+
+	std::vector<char> buffer(16384);
+	const double compressed = Measure([&] {
+		Core::Archive archive;
+		archive.Open(compressedPack.c_str());
+		for(const std::string& name : names)
+		{
+			const Core::ArchiveEntry* entry = archive.Find(name.c_str());
+			archive.Read(*entry, buffer.data(), buffer.size());
+			sink += buffer[entry->m_Size - 1];
+		}
+	});
+
+	for(const std::string& path : paths)
+		remove(path.c_str());
+	remove(pack.c_str());
+	remove(compressedPack.c_str());
+
+	printf("(sink %llu) packed %llu -> %llu bytes with lz4\n", (unsigned long long)sink,
+		   (unsigned long long)builder.GetStoredSize(), (unsigned long long)packedBuilder.GetStoredSize());
+	Report("256 loose files, File per asset", loose, loose);
+	Report("256 assets, one mapped pak", packed, loose);
+	Report("256 assets, lz4 pak, decompressed", compressed, loose);
+}
+
+TEST(Benchmark, JobSystemScaling)
+{
+	static constexpr uint32 transformCount = 256 * 1024;
+	static constexpr uint32 sphereCount = 1024 * 1024;
+
+	std::vector<Core::Quaternion> rotations(transformCount);
+	std::vector<Core::Vector4f> positions(transformCount);
+	std::vector<Core::Matrix44f> combined(transformCount);
+	for(uint32 i = 0; i < transformCount; ++i)
+	{
+		const float half = (float)i * 0.005f;
+		rotations[i] = Core::Quaternion(0.f, sinf(half), 0.f, cosf(half));
+		positions[i] = Core::Vector4f((float)(i % 512), 2.f, (float)(i / 512), 1.f);
+	}
+	Core::Matrix44f viewProjection = Core::Matrix44f::CreateRotateAroundX(0.3f);
+	viewProjection.SetPosition({ 0.f, 0.f, 10.f, 1.f });
+
+	std::vector<Core::Vector4f> spheres(sphereCount);
+	std::vector<uint8> visible(sphereCount);
+	for(uint32 i = 0; i < sphereCount; ++i)
+	{
+		// a slab of spheres in front of the camera that pokes out of the frustum on every side
+		const float x = (float)(i % 1024) * 0.1f - 51.2f;
+		const float y = (float)(i / 1024 % 64) - 32.f;
+		spheres[i] = Core::Vector4f(x, y, (float)(i / 65536) * 6.f, 0.5f);
+	}
+	Core::Matrix44f viewInverse = Core::Matrix44f::Identity();
+	viewInverse.SetTranslation(0.f, 0.f, 10.f, 1.f);
+	const Core::Frustum frustum =
+		Core::Frustum::FromViewProjection(Core::VKCreatePerspectiveMatrix(0.1f, 100.f, 1.f, 90.f) * viewInverse);
+
+	const uint32 hardwareThreads = std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1;
+	std::vector<uint32> threadCounts;
+	for(uint32 threads = 1; threads < hardwareThreads; threads *= 2)
+		threadCounts.push_back(threads);
+	threadCounts.push_back(hardwareThreads);
+
+	float sink = 0.f;
+	uint32 visibleCount = 0;
+	double transformBaseline = 0.0;
+	double cullBaseline = 0.0;
+	for(const uint32 threads : threadCounts)
+	{
+		Core::JobSystem jobs(threads);
+
+		const double transformMs = Measure([&] {
+			jobs.ParallelFor(transformCount, [&](uint32 begin, uint32 end) {
+				for(uint32 i = begin; i < end; ++i)
+				{
+					Core::Matrix44f matrix = rotations[i].ConvertToRotationMatrix();
+					matrix = Core::Matrix44f::CreateScaleMatrix(1.f, 2.f, 1.f, 1.f) * matrix;
+					matrix.SetPosition(positions[i]);
+					combined[i] = viewProjection * matrix;
+				}
+			});
+			sink += combined[transformCount / 2][13];
+		});
+
+		const double cullMs = Measure([&] {
+			jobs.ParallelFor(sphereCount, [&](uint32 begin, uint32 end) {
+				for(uint32 i = begin; i < end; ++i)
+				{
+					const Core::Vector4f& sphere = spheres[i];
+					visible[i] = frustum.IsSphereVisible(Core::Vector3f(sphere.x, sphere.y, sphere.z), sphere.w);
+				}
+			});
+		});
+		visibleCount = 0;
+		for(const uint8 isVisible : visible)
+			visibleCount += isVisible;
+
+		transformBaseline = threads == 1 ? transformMs : transformBaseline;
+		cullBaseline = threads == 1 ? cullMs : cullBaseline;
+		const std::string suffix = " " + std::to_string(threads) + (threads == 1 ? " thread" : " threads");
+		Report(("compose + mul 256k," + suffix).c_str(), transformMs, transformBaseline);
+		Report(("cull spheres 1M," + suffix).c_str(), cullMs, cullBaseline);
+	}
+	printf("(sink %f) %u of %u spheres visible\n", sink, visibleCount, sphereCount);
+}
+
+namespace
+{
+	struct FiberBounce
+	{
+		Core::Fiber* m_Thread = nullptr;
+		uint64 m_Count = 0;
+	};
+
+	void FiberBounceMain(Core::Fiber* fiber)
+	{
+		FiberBounce& bounce = *static_cast<FiberBounce*>(fiber->GetUserData());
+		for(;;)
+		{
+			++bounce.m_Count;
+			fiber->SwitchTo(*bounce.m_Thread);
+		}
+	}
+}; // namespace
+
+TEST(Benchmark, FiberSwitch)
+{
+	static constexpr uint32 switches = 1000000;
+
+	Core::Fiber thread;
+	thread.ConvertThread();
+	FiberBounce bounce;
+	bounce.m_Thread = &thread;
+	Core::Fiber fiber;
+	ASSERT_TRUE(fiber.Create(16 * 1024, &FiberBounceMain, &bounce));
+
+	// there and back is two switches
+	const double fiberMs = Measure([&] {
+		for(uint32 i = 0; i < switches / 2; ++i)
+			thread.SwitchTo(fiber);
+	});
+	fiber.Destroy();
+	thread.RevertThread();
+
+	// what blocking a thread and waking another costs for the same hand over
+	static constexpr uint32 handOvers = 20000;
+	const double threadMs = Measure(
+		[&] {
+			std::mutex mutex;
+			std::condition_variable turn;
+			bool ping = true;
+			std::thread other([&] {
+				for(uint32 i = 0; i < handOvers / 2; ++i)
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					turn.wait(lock, [&] { return !ping; });
+					ping = true;
+					turn.notify_one();
+				}
+			});
+			for(uint32 i = 0; i < handOvers / 2; ++i)
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				ping = false;
+				turn.notify_one();
+				turn.wait(lock, [&] { return ping; });
+			}
+			other.join();
+		},
+		3);
+
+	printf("fiber switch %.1f ns, thread hand over %.1f ns (count %llu)\n", fiberMs * 1e6 / switches,
+		   threadMs * 1e6 / handOvers, (unsigned long long)bounce.m_Count);
+	const double threadPerMillion = threadMs * switches / handOvers;
+	Report("thread hand over x 1M (from 20k)", threadPerMillion, threadPerMillion);
+	Report("fiber switch x 1M", fiberMs, threadPerMillion);
+
+	// jobs that wait on children of their own, parked on fibers or helping out on their thread's stack
+	static constexpr uint32 parents = 512;
+	static constexpr uint32 children = 16;
+	double helpingMs = 0.0;
+	for(const uint32 fiberCount : { 0u, 128u })
+	{
+		Core::JobSystem jobs(0, fiberCount);
+		std::atomic<uint64> sum{ 0 };
+		const double ms = Measure([&] {
+			Core::JobCounter all;
+			for(uint32 parent = 0; parent < parents; ++parent)
+			{
+				jobs.Run(
+					[&] {
+						Core::JobCounter counter;
+						for(uint32 child = 0; child < children; ++child)
+							jobs.Run([&sum, child] { sum.fetch_add(child); }, &counter);
+						jobs.Wait(counter);
+					},
+					&all);
+			}
+			jobs.Wait(all);
+		});
+
+		helpingMs = fiberCount == 0 ? ms : helpingMs;
+		const Core::JobFiberStats stats = jobs.GetFiberStats();
+		printf("(sum %llu) %llu switches, %llu parked, %llu inline, peak %u fibers\n", (unsigned long long)sum.load(),
+			   (unsigned long long)stats.m_Switches, (unsigned long long)stats.m_Suspends,
+			   (unsigned long long)stats.m_InlineJobs, stats.m_Pool.m_PeakInUse);
+		Report(fiberCount == 0 ? "512 x 16 nested waits, no fibers" : "512 x 16 nested waits, 128 fibers", ms,
+			   helpingMs);
+	}
+}
+
+TEST(Benchmark, InstanceBatching)
+{
+	// the 100k cube scene: a 50 x 50 x 40 grid in front of the camera, partly outside the frustum
+	static constexpr uint32 instanceCount = 100000;
+	std::vector<Core::Matrix44f> world(instanceCount, Core::Matrix44f::Identity());
+	for(uint32 i = 0; i < instanceCount; ++i)
+		world[i].SetTranslation((float)(i % 50) * 5.f - 125.f, (float)(i / 50 % 50) * 5.f - 125.f,
+								(float)(i / 2500) * 5.f, 1.f);
+
+	Core::Matrix44f viewInverse = Core::Matrix44f::Identity();
+	viewInverse.SetTranslation(0.f, 0.f, 25.f, 1.f);
+	const Core::Matrix44f projection = Core::VKCreatePerspectiveMatrix(0.1f, 1000.f, 16.f / 9.f, 90.f);
+	const Core::Frustum frustum = Core::Frustum::FromViewProjection(projection * viewInverse);
+	const Core::Vector3f cameraPosition(0.f, 0.f, -25.f);
+	const float lodScale = Core::Mesh::GetLodScale(projection, 1080.f);
+
+	const Core::MeshLod lodTable[4] = { { 0, 36, 0.f }, { 36, 24, 0.01f }, { 60, 12, 0.04f }, { 72, 6, 0.16f } };
+	const Core::Span<const Core::MeshLod> lods(lodTable, 4);
+	const Core::Matrix44f dequantize = Core::Matrix44f::CreateScaleMatrix(1.f, 1.f, 1.f, 1.f);
+
+	// what every cube did on its own before: cull, pick the LOD and fold in the dequantize for its push constant
+	std::vector<Core::Matrix44f> pushed(instanceCount);
+	std::vector<uint32> currentLod(instanceCount, 0);
+	uint32 perObjectVisible = 0;
+	const double perObjectMs = Measure([&] {
+		perObjectVisible = 0;
+		for(uint32 i = 0; i < instanceCount; ++i)
+		{
+			const Core::Vector4f center = Core::Vector4f(0.f, 0.f, 0.f, 1.f) * world[i];
+			if(!frustum.IsSphereVisible(Core::Vector3f(center.x, center.y, center.z), 1.f))
+				continue;
+			const float pixelsPerUnit =
+				Core::Mesh::GetPixelsPerUnit(Core::Vector3f(0.f, 0.f, 0.f), 1.f, world[i], cameraPosition, lodScale);
+			currentLod[i] = Core::Mesh::SelectLod(lods, pixelsPerUnit, currentLod[i]);
+			pushed[perObjectVisible++] = world[i] * dequantize;
+		}
+	});
+	Report("per object 100k", perObjectMs, perObjectMs);
+
+	const uint32 hardwareThreads = std::thread::hardware_concurrency() > 0 ? std::thread::hardware_concurrency() : 1;
+	std::vector<uint32> threadCounts;
+	for(uint32 threads = 1; threads < hardwareThreads; threads *= 2)
+		threadCounts.push_back(threads);
+	threadCounts.push_back(hardwareThreads);
+
+	std::vector<Core::Matrix44f> instances(instanceCount);
+	uint32 batchCount = 0;
+	uint32 visible = 0;
+	for(const uint32 threads : threadCounts)
+	{
+		Core::InstanceBatcher batcher;
+		Core::InstancedMesh cube;
+		cube.m_BoundsRadius = 1.f;
+		cube.m_Lods = lods;
+		const uint32 mesh = batcher.AddMesh(cube);
+		for(uint32 i = 0; i < instanceCount; ++i)
+			batcher.AddInstance(mesh);
+
+		Core::JobSystem jobs(threads);
+		const double batchMs = Measure([&] {
+			const Core::Span<const Core::InstanceBatch> batches =
+				batcher.Build(jobs, world.data(), frustum, cameraPosition, lodScale, instances.data());
+			batchCount = static_cast<uint32>(batches.Size());
+			visible = 0;
+			for(const Core::InstanceBatch& batch : batches)
+				visible += batch.m_InstanceCount;
+		});
+
+		const std::string suffix = " " + std::to_string(threads) + (threads == 1 ? " thread" : " threads");
+		Report(("instance batches 100k," + suffix).c_str(), batchMs, perObjectMs);
+	}
+	EXPECT_EQ(visible, perObjectVisible);
+	printf("%u of %u visible in %u draws, one per LOD in use\n", visible, instanceCount, batchCount);
+}
+
+TEST(Benchmark, AsyncIOStreamingFrameTimes)
+{
+	static constexpr uint32 fileCount = 1000;
+	static constexpr uint32 fileSize = 4096;
+	static constexpr uint32 requestsPerFrame = 100;
+	const std::chrono::milliseconds frameTime(16);
+
+	std::vector<std::string> paths;
+	for(uint32 i = 0; i < fileCount; ++i)
+	{
+		paths.push_back(testing::TempDir() + "bench_async_stream_" + std::to_string(i) + ".bin");
+		const std::string contents(fileSize, (char)('a' + i % 26));
+		FILE* file = fopen(paths.back().c_str(), "wb");
+		fwrite(contents.data(), 1, contents.size(), file);
+		fclose(file);
+	}
+
+	Core::AsyncIO io;
+	std::vector<char> buffers(fileCount * fileSize);
+	uint32 completed = 0;
+	uint32 submitted = 0;
+
+	// the frame loop only submits and dispatches, what it costs per frame is the number of interest
+	double worstFrameWorkMs = 0.0;
+	uint32 hitches = 0;
+	uint32 frames = 0;
+	while(completed < fileCount && frames < 1000)
+	{
+		const auto frameStart = std::chrono::steady_clock::now();
+
+		const uint32 batch = std::min(requestsPerFrame, fileCount - submitted);
+		if(batch > 0)
+		{
+			Core::ReadRequest requests[requestsPerFrame];
+			for(uint32 i = 0; i < batch; ++i)
+			{
+				const uint32 file = submitted + i;
+				requests[i].m_Path = paths[file];
+				requests[i].m_Buffer = &buffers[file * fileSize];
+				requests[i].m_BufferSize = fileSize;
+				requests[i].m_OnComplete = [&](const Core::ReadResult&) { ++completed; };
+			}
+			io.ReadBatch(requests, batch);
+			submitted += batch;
+		}
+		io.DispatchCompletions();
+
+		const std::chrono::duration<double, std::milli> work = std::chrono::steady_clock::now() - frameStart;
+		worstFrameWorkMs = std::max(worstFrameWorkMs, work.count());
+		std::this_thread::sleep_until(frameStart + frameTime);
+
+		const std::chrono::duration<double, std::milli> frame = std::chrono::steady_clock::now() - frameStart;
+		if(frame.count() > 16.0 + 4.0)
+			++hitches;
+		++frames;
+	}
+
+	for(const std::string& path : paths)
+		remove(path.c_str());
+
+	EXPECT_EQ(completed, fileCount);
+	printf("%u files in %u frames, worst frame work %.3f ms, %u frames over 20 ms\n", completed, frames,
+		   worstFrameWorkMs, hitches);
+}
@@ -1,11 +1,61 @@
 #include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <random>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <new>
+#include <set>
+#include <thread>
+#include <vector>
 #include "gtest/gtest.h"
 
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
 #include "Core/math/Vector4.h"
 #include "Core/math/Vector3.h"
 #include "Core/math/Vector2.h"
 #include "Core/containers/GrowingArray.h"
 #include "Core/containers/Array.h"
+#include "Core/containers/InlineArray.h"
+#include "Core/containers/HashMap.h"
+#include "Core/containers/SlotMap.h"
+#include "Core/containers/WorkStealingDeque.h"
+#include "Core/memory/FrameArena.h"
+#include "Core/memory/GpuMemoryAllocator.h"
+#include "Core/memory/PoolAllocator.h"
+#include "Core/memory/StagingRing.h"
+#include "Core/memory/MemoryTracker.h"
+#include "Core/memory/TlsfAllocator.h"
+#include "Core/memory/UniformRing.h"
+#include "Core/File.h"
+#include "Core/FileWriter.h"
+#include "Core/AsyncIO.h"
+#include "Core/Fiber.h"
+#include "Core/JobSystem.h"
+#include "Core/Archive.h"
+#include "Core/ArchiveBuilder.h"
+#include "Core/compression/Lz4.h"
+#include "Core/mesh/MeshFormat.h"
+#include "Core/mesh/InstanceBatcher.h"
+#include "Core/mesh/LodSelection.h"
+#include "Core/mesh/MeshOptimizer.h"
+#include "Core/mesh/MeshSimplifier.h"
+#include "Core/mesh/Meshlets.h"
+#include "Core/mesh/MeshletCulling.h"
+#include "Core/math/Frustum.h"
+#include "Core/mesh/Quantize.h"
+#include "Core/math/Matrix44.h"
+#include "Core/math/MatrixKernels.h"
+#include "Core/math/Quaternion.h"
+#include "Core/math/TransformBatch.h"
 /*
 	different macros for unit tests
 
@@ -22,6 +72,84 @@
 	ASSERT_FALSE //fatal
 */
 
+/*
+	Allocation counting hook, every global new in the test binary goes through here so tests can check that a code
+	path stays off the heap.
+*/
+static std::atomic<uint64> s_HeapAllocations{ 0 };
+
+/*
+	Every new and delete below goes through this pair. CountedFree stays out of line, inlined into a delete g++
+	sees free called on what operator new returned and warns about the mismatch.
+*/
+#ifdef __GNUC__
+#define HOOK_NOINLINE __attribute__((noinline))
+#else
+#define HOOK_NOINLINE __declspec(noinline)
+#endif
+
+static void* CountedAllocate(size_t size, size_t alignment)
+{
+	++s_HeapAllocations;
+	size = size > 0 ? size : 1;
+	if(alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+		return malloc(size);
+#ifdef _WIN32
+	return _aligned_malloc(size, alignment);
+#else
+	return aligned_alloc(alignment, (size + alignment - 1) & ~(alignment - 1));
+#endif
+}
+
+static HOOK_NOINLINE void CountedFree(void* data, size_t alignment)
+{
+#ifdef _WIN32
+	if(alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+	{
+		_aligned_free(data);
+		return;
+	}
+#else
+	(void)alignment;
+#endif
+	free(data);
+}
+
+void* operator new(size_t size)
+{
+	if(void* data = CountedAllocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__))
+		return data;
+	throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	if(void* data = CountedAllocate(size, static_cast<size_t>(alignment)))
+		return data;
+	throw std::bad_alloc();
+}
+
+// std::stable_sort takes its temporary buffer through the nothrow forms
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	return CountedAllocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void operator delete(void* data) noexcept { CountedFree(data, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void operator delete(void* data, size_t) noexcept { CountedFree(data, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void operator delete(void* data, const std::nothrow_t&) noexcept
+{
+	CountedFree(data, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+void operator delete(void* data, std::align_val_t alignment) noexcept
+{
+	CountedFree(data, static_cast<size_t>(alignment));
+}
+void operator delete(void* data, size_t, std::align_val_t alignment) noexcept
+{
+	CountedFree(data, static_cast<size_t>(alignment));
+}
+
 TEST(Vector4, Length)
 {
 	constexpr float a = 193.f, b = 284.f, c = 321.f, d = 461.f;
@@ -50,6 +178,404 @@ TEST(Vector4, dot)
 	ASSERT_EQ(Core::Dot(first, second), dot_result);
 }
 
+TEST(Vector4, SimdMatchesScalar)
+{
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> dist(-100.f, 100.f);
+
+	for(uint32 i = 0; i < 1000; ++i)
+	{
+		const float a[4] = { dist(rng), dist(rng), dist(rng), dist(rng) };
+		const float b[4] = { dist(rng), dist(rng), dist(rng), dist(rng) };
+		const Core::Vector4f first(a);
+		const Core::Vector4f second(b);
+
+		const Core::Vector4f sum = first + second;
+		const Core::Vector4f quotient = first / second;
+		Core::Vector4f scaled = first;
+		scaled *= 3.f;
+		for(uint32 j = 0; j < 4; ++j)
+		{
+			ASSERT_EQ(sum.vector[j], a[j] + b[j]);
+			ASSERT_EQ(quotient.vector[j], a[j] / b[j]);
+			ASSERT_EQ(scaled.vector[j], a[j] * 3.f);
+		}
+
+		const float dot = (a[0] * b[0]) + (a[1] * b[1]) + (a[2] * b[2]) + (a[3] * b[3]);
+		ASSERT_EQ(Core::Dot(first, second), dot);
+
+		const Core::Vector4f cross = Core::Cross(first, second);
+		ASSERT_EQ(cross.x, (a[1] * b[2]) - (a[2] * b[1]));
+		ASSERT_EQ(cross.y, (a[2] * b[0]) - (a[0] * b[2]));
+		ASSERT_EQ(cross.z, (a[0] * b[1]) - (a[1] * b[0]));
+		ASSERT_EQ(cross.w, 1.f);
+
+		const float length = sqrtf((a[0] * a[0]) + (a[1] * a[1]) + (a[2] * a[2]) + (a[3] * a[3]));
+		const Core::Vector4f normalized = Core::GetNormalized(first);
+		const Core::Vector4f fast = Core::GetFastNormalized(first);
+		for(uint32 j = 0; j < 4; ++j)
+		{
+			ASSERT_EQ(normalized.vector[j], a[j] / length);
+			ASSERT_NEAR(fast.vector[j], a[j] / length, 1e-5f);
+		}
+	}
+}
+
+static Core::Matrix44f RandomMatrix(std::mt19937& rng)
+{
+	std::uniform_real_distribution<float> dist(-10.f, 10.f);
+	Core::Matrix44f matrix;
+	for(int i = 0; i < 16; ++i)
+		matrix[i] = dist(rng);
+	return matrix;
+}
+
+TEST(MatrixKernels, InverseMatchesScalar)
+{
+	std::mt19937 rng(11);
+	for(uint32 i = 0; i < 1000; ++i)
+	{
+		const Core::Matrix44f matrix = RandomMatrix(rng);
+		const Core::Matrix44f reference = Core::InverseReal(matrix);
+
+		Core::Matrix44f inverse;
+		const float determinant = Core::Math::Inverse(matrix, inverse);
+		ASSERT_NE(determinant, 0.f);
+		ASSERT_NEAR(determinant, Core::Math::Determinant(matrix), 0.f);
+
+		// badly conditioned random matrices lose precision in both versions, compare against M * M^-1 = I too
+		const Core::Matrix44f identity = matrix * inverse;
+		for(int j = 0; j < 16; ++j)
+		{
+			ASSERT_NEAR(inverse[j], reference[j], 1e-3f * (1.f + fabsf(reference[j])));
+			ASSERT_NEAR(identity[j], (j % 5 == 0) ? 1.f : 0.f, 1e-3f);
+		}
+	}
+
+	// rigid transforms have to agree with FastInverse
+	Core::Matrix44f rigid = Core::Matrix44f::CreateRotateAroundY(0.7f) * Core::Matrix44f::CreateRotateAroundX(-1.2f);
+	rigid.SetPosition({ 3.f, -4.f, 12.f, 1.f });
+	const Core::Matrix44f fast = Core::FastInverse(rigid);
+	Core::Matrix44f inverse;
+	ASSERT_NEAR(Core::Math::Inverse(rigid, inverse), 1.f, 1e-5f);
+	for(int j = 0; j < 16; ++j)
+		ASSERT_NEAR(inverse[j], fast[j], 1e-5f);
+}
+
+TEST(MatrixKernels, SingularMatrixIsLeftAlone)
+{
+	Core::Matrix44f singular = Core::Matrix44f::Identity();
+	singular.rows[2] = singular.rows[1];
+
+	Core::Matrix44f out = Core::Matrix44f::CreateScaleMatrix(2.f, 2.f, 2.f, 2.f);
+	ASSERT_EQ(Core::Math::Inverse(singular, out), 0.f);
+	ASSERT_EQ(out[0], 2.f);
+	ASSERT_EQ(Core::Math::Determinant(Core::Matrix44f::CreateScaleMatrix(1.f, 2.f, 3.f, 4.f)), 24.f);
+}
+
+TEST(MatrixKernels, ExactOpsMatchScalar)
+{
+	std::mt19937 rng(5);
+	for(uint32 i = 0; i < 100; ++i)
+	{
+		const Core::Matrix44f a = RandomMatrix(rng);
+		const Core::Matrix44f b = RandomMatrix(rng);
+
+		const Core::Matrix44f transposed = Core::Transpose(a);
+		const Core::Matrix44f sum = a + b;
+		const Core::Matrix44f difference = a - b;
+		Core::Matrix44f product;
+		Core::Math::Multiply(a, b, product);
+		const Core::Matrix44f expected = a * b;
+
+		for(int row = 0; row < 4; ++row)
+		{
+			for(int column = 0; column < 4; ++column)
+			{
+				const int index = row * 4 + column;
+				ASSERT_EQ(transposed.mat[row][column], a.mat[column][row]);
+				ASSERT_EQ(sum[index], a[index] + b[index]);
+				ASSERT_EQ(difference[index], a[index] - b[index]);
+				ASSERT_EQ(product[index], expected[index]);
+			}
+		}
+
+		// out aliasing an input
+		Core::Matrix44f aliased = b;
+		Core::Math::Multiply(a, aliased, aliased);
+		ASSERT_EQ(memcmp(&aliased[0], &product[0], sizeof(product)), 0);
+
+		Core::Vector4f vectors[7];
+		Core::Vector4f transformed[7];
+		std::uniform_real_distribution<float> dist(-10.f, 10.f);
+		for(Core::Vector4f& v : vectors)
+			v = Core::Vector4f(dist(rng), dist(rng), dist(rng), dist(rng));
+
+		Core::Math::TransformBatch(a, vectors, transformed, 7);
+		for(uint32 j = 0; j < 7; ++j)
+		{
+			const Core::Vector4f scalar = vectors[j] * a;
+			const Core::Vector4f single = Core::Math::Transform(vectors[j], a);
+			for(int k = 0; k < 4; ++k)
+			{
+				ASSERT_EQ(single.vector[k], scalar.vector[k]);
+				ASSERT_EQ(transformed[j].vector[k], scalar.vector[k]);
+			}
+		}
+	}
+}
+
+static Core::Quaternion RandomRotation(std::mt19937& rng)
+{
+	std::uniform_real_distribution<float> dist(-1.f, 1.f);
+	Core::Quaternion rotation(dist(rng), dist(rng), dist(rng), dist(rng));
+	Core::Normalize(rotation);
+	return rotation;
+}
+
+static void ExpectNear(const Core::Quaternion& a, const Core::Quaternion& b, float tolerance)
+{
+	for(int i = 0; i < 4; ++i)
+		EXPECT_NEAR(a.data[i], b.data[i], tolerance) << "component " << i;
+}
+
+TEST(Quaternion, ProductAndRotationMatchScalar)
+{
+	std::mt19937 rng(23);
+	for(uint32 i = 0; i < 100; ++i)
+	{
+		const Core::Quaternion a = RandomRotation(rng);
+		const Core::Quaternion b = RandomRotation(rng);
+
+		// w = w1w2 - v1.v2, v = v1 w2 + v2 w1 + v1 x v2
+		const Core::Quaternion product = a * b;
+		EXPECT_NEAR(product.w, a.w * b.w - (a.x * b.x + a.y * b.y + a.z * b.z), 1e-6f);
+		EXPECT_NEAR(product.x, a.x * b.w + b.x * a.w + (a.y * b.z - a.z * b.y), 1e-6f);
+		EXPECT_NEAR(product.y, a.y * b.w + b.y * a.w + (a.z * b.x - a.x * b.z), 1e-6f);
+		EXPECT_NEAR(product.z, a.z * b.w + b.z * a.w + (a.x * b.y - a.y * b.x), 1e-6f);
+
+		// q * v, the q v q^-1 sandwich and the rotation matrix all agree
+		const Core::Vector4f v(1.f, -2.f, 0.5f, 0.f);
+		const Core::Vector4f rotated = a * v;
+		const Core::Quaternion sandwich = a * Core::Quaternion(v.x, v.y, v.z, 0.f) * a.Inverted();
+		const Core::Vector4f viaMatrix = v * a.ConvertToRotationMatrix();
+		const Core::Vector3f rotated3 = a * Core::Vector3f(v.x, v.y, v.z);
+		for(int j = 0; j < 3; ++j)
+		{
+			EXPECT_NEAR(rotated.vector[j], sandwich.data[j], 1e-5f);
+			EXPECT_NEAR(rotated.vector[j], viaMatrix.vector[j], 1e-5f);
+		}
+		EXPECT_EQ(rotated.w, 0.f);
+		EXPECT_EQ(rotated3.x, rotated.x);
+		EXPECT_EQ(rotated3.z, rotated.z);
+	}
+
+	// the matrix matches the existing rotation helpers
+	const Core::Matrix44f fromQuaternion = Core::Quaternion(Core::Vector3f(0.f, 1.f, 0.f), 0.9f).ConvertToRotationMatrix();
+	const Core::Matrix44f expected = Core::Matrix44f::CreateRotateAroundY(0.9f);
+	for(int i = 0; i < 16; ++i)
+		EXPECT_NEAR(fromQuaternion[i], expected[i], 1e-6f);
+}
+
+TEST(Quaternion, SubtractTouchesEveryComponent)
+{
+	Core::Quaternion a(1.f, 2.f, 3.f, 4.f);
+	a -= Core::Quaternion(0.5f, 0.5f, 0.5f, 1.f);
+	EXPECT_EQ(a.x, 0.5f);
+	EXPECT_EQ(a.y, 1.5f);
+	EXPECT_EQ(a.z, 2.5f);
+	EXPECT_EQ(a.w, 3.f);
+}
+
+TEST(Quaternion, SlerpAndNlerp)
+{
+	const Core::Vector3f axis(0.f, 0.f, 1.f);
+	const Core::Quaternion from(axis, 0.2f);
+	const Core::Quaternion to(axis, 1.4f);
+
+	// constant angular speed around one axis
+	ExpectNear(Core::Slerp(from, to, 0.25f), Core::Quaternion(axis, 0.5f), 1e-6f);
+	ExpectNear(from.Slerp(to, 0.5f), Core::Quaternion(axis, 0.8f), 1e-6f);
+	ExpectNear(Core::Slerp(from, to, 0.f), from, 1e-6f);
+	ExpectNear(Core::Slerp(from, to, 1.f), to, 1e-6f);
+
+	// -q is the same rotation, both take the short way and land on the same quaternion
+	Core::Quaternion negated = to;
+	negated.simd = Core::Simd::Sub(Core::Simd::Zero(), negated.simd);
+	ExpectNear(Core::Slerp(from, negated, 0.3f), Core::Slerp(from, to, 0.3f), 1e-6f);
+	ExpectNear(Core::Nlerp(from, negated, 0.3f), Core::Nlerp(from, to, 0.3f), 1e-6f);
+
+	// nlerp ends up on the same arc, only the speed along it differs
+	const Core::Quaternion halfway = Core::Nlerp(from, to, 0.5f);
+	ExpectNear(halfway, Core::Quaternion(axis, 0.8f), 1e-6f);
+	EXPECT_NEAR(Core::Dot(halfway, halfway), 1.f, 1e-6f);
+
+	// nearly parallel falls back to a normalized lerp
+	const Core::Quaternion close(axis, 0.2001f);
+	EXPECT_NEAR(Core::Dot(Core::Slerp(from, close, 0.5f), Core::Quaternion(axis, 0.20005f)), 1.f, 1e-6f);
+}
+
+TEST(Quaternion, BatchesMatchSingle)
+{
+	// not a multiple of 4 so the tail is covered too
+	static constexpr uint32 count = 23;
+	std::mt19937 rng(29);
+	Core::Quaternion a[count];
+	Core::Quaternion b[count];
+	for(uint32 i = 0; i < count; ++i)
+	{
+		a[i] = RandomRotation(rng);
+		b[i] = RandomRotation(rng);
+	}
+
+	Core::Quaternion out[count];
+	Core::Math::MultiplyBatch(a, b, out, count);
+	for(uint32 i = 0; i < count; ++i)
+		ExpectNear(out[i], a[i] * b[i], 1e-6f);
+
+	Core::Math::NlerpBatch(a, b, 0.35f, out, count);
+	for(uint32 i = 0; i < count; ++i)
+		ExpectNear(out[i], Core::Nlerp(a[i], b[i], 0.35f), 1e-6f);
+
+	Core::Math::SlerpBatch(a, b, 0.35f, out, count);
+	for(uint32 i = 0; i < count; ++i)
+		ExpectNear(out[i], Core::Slerp(a[i], b[i], 0.35f), 1e-6f);
+
+	Core::Matrix44f matrices[count];
+	Core::Math::ToMatrixBatch(a, matrices, count);
+	for(uint32 i = 0; i < count; ++i)
+	{
+		const Core::Matrix44f expected = a[i].ConvertToRotationMatrix();
+		for(int j = 0; j < 16; ++j)
+			EXPECT_NEAR(matrices[i][j], expected[j], 1e-6f);
+	}
+
+	// in place, scaled quaternions come back as unit length
+	for(uint32 i = 0; i < count; ++i)
+		out[i].simd = Core::Simd::Mul(a[i].simd, Core::Simd::Splat(1.f + (float)i));
+	Core::Math::NormalizeBatch(out, out, count);
+	for(uint32 i = 0; i < count; ++i)
+		ExpectNear(out[i], a[i], 1e-6f);
+}
+
+TEST(TransformBatch, MatchesMatrix44)
+{
+	// rotation around y as a quaternion against the existing matrix helpers
+	const float angle = 0.7f;
+	Core::TransformBatch batch;
+	batch.Add({ 1.f, -2.f, 3.f, 1.f }, { 0.f, sinf(angle * 0.5f), 0.f, cosf(angle * 0.5f) }, { 2.f, 3.f, 4.f, 0.f });
+
+	Core::Matrix44f expected = Core::Matrix44f::CreateRotateAroundY(angle);
+	for(int column = 0; column < 3; ++column)
+	{
+		expected.mat[0][column] *= 2.f;
+		expected.mat[1][column] *= 3.f;
+		expected.mat[2][column] *= 4.f;
+	}
+	expected.SetPosition({ 1.f, -2.f, 3.f, 1.f });
+
+	std::mt19937 rng(3);
+	const Core::Matrix44f viewProjection = RandomMatrix(rng);
+	Core::Matrix44f expectedCombined;
+	Core::Math::Multiply(viewProjection, expected, expectedCombined);
+
+	Core::Matrix44f world;
+	Core::Matrix44f combined;
+	batch.SetPath(Core::TransformBatch::Path::Scalar);
+	batch.ComposeWorldViewProjection(viewProjection, &world, &combined);
+	for(int i = 0; i < 16; ++i)
+	{
+		EXPECT_NEAR(world[i], expected[i], 1e-6f);
+		EXPECT_NEAR(combined[i], expectedCombined[i], 1e-4f);
+	}
+}
+
+TEST(TransformBatch, PathsMatchScalar)
+{
+	// odd count so the wide paths also run their scalar tail
+	static constexpr uint32 count = 37;
+	std::mt19937 rng(17);
+	std::uniform_real_distribution<float> dist(-10.f, 10.f);
+
+	Core::TransformBatch batch(count);
+	for(uint32 i = 0; i < count; ++i)
+	{
+		Core::Quaternion rotation(dist(rng), dist(rng), dist(rng), dist(rng));
+		Core::Normalize(rotation);
+		batch.Add({ dist(rng), dist(rng), dist(rng), 1.f }, rotation, { dist(rng), dist(rng), dist(rng), 0.f });
+	}
+	const Core::Matrix44f viewProjection = RandomMatrix(rng);
+
+	Core::GrowingArray<Core::Matrix44f> referenceWorld(count);
+	Core::GrowingArray<Core::Matrix44f> referenceCombined(count);
+	for(uint32 i = 0; i < count; ++i)
+	{
+		referenceWorld.Add(Core::Matrix44f());
+		referenceCombined.Add(Core::Matrix44f());
+	}
+	batch.SetPath(Core::TransformBatch::Path::Scalar);
+	batch.ComposeWorldViewProjection(viewProjection, referenceWorld.GetData(), referenceCombined.GetData());
+
+	// the default constructor leaves the elements alone
+	Core::Matrix44f zero;
+	for(int j = 0; j < 16; ++j)
+		zero[j] = 0.f;
+
+	for(const Core::TransformBatch::Path path : { Core::TransformBatch::Path::SSE, Core::TransformBatch::Path::AVX2 })
+	{
+		if(!Core::TransformBatch::IsSupported(path))
+		{
+			printf("skipping %s, not supported here\n", Core::TransformBatch::GetPathName(path));
+			continue;
+		}
+
+		Core::GrowingArray<Core::Matrix44f> world(referenceWorld);
+		Core::GrowingArray<Core::Matrix44f> combined(referenceCombined);
+		std::fill(world.begin(), world.end(), zero);
+		std::fill(combined.begin(), combined.end(), zero);
+
+		batch.SetPath(path);
+		batch.ComposeWorld(world.GetData());
+		for(uint32 i = 0; i < count; ++i)
+		{
+			for(int j = 0; j < 16; ++j)
+				ASSERT_NEAR(world[i][j], referenceWorld[i][j], 1e-5f) << Core::TransformBatch::GetPathName(path);
+		}
+
+		// FMA in the AVX2 path rounds differently, the tolerance follows the magnitude of the result
+		batch.ComposeWorldViewProjection(viewProjection, nullptr, combined.GetData());
+		for(uint32 i = 0; i < count; ++i)
+		{
+			for(int j = 0; j < 16; ++j)
+			{
+				const float expected = referenceCombined[i][j];
+				ASSERT_NEAR(combined[i][j], expected, 1e-5f * (100.f + fabsf(expected)))
+					<< Core::TransformBatch::GetPathName(path);
+			}
+		}
+	}
+}
+
+TEST(TransformBatch, RemoveCyclicMovesLast)
+{
+	Core::TransformBatch batch;
+	for(uint32 i = 0; i < 4; ++i)
+		batch.Add({ (float)i, 0.f, 0.f, 1.f }, { 0.f, 0.f, 0.f, 1.f }, { 1.f, 1.f, 1.f, 0.f });
+
+	batch.RemoveCyclicAtIndex(1);
+	ASSERT_EQ(batch.Size(), 3u);
+	EXPECT_EQ(batch.GetPosition(0).x, 0.f);
+	EXPECT_EQ(batch.GetPosition(1).x, 3.f);
+	EXPECT_EQ(batch.GetPosition(2).x, 2.f);
+
+	batch.SetScale(1, { 2.f, 2.f, 2.f, 0.f });
+	Core::Matrix44f world[3];
+	batch.ComposeWorld(world);
+	EXPECT_EQ(world[1][0], 2.f);
+	EXPECT_EQ(world[1][12], 3.f);
+	EXPECT_EQ(world[2][5], 1.f);
+}
+
 TEST(GrowingArray, create)
 {
 	Core::GrowingArray<float> array;
@@ -121,6 +647,114 @@ TEST(GrowingArray, InitList)
 	ASSERT_EQ(arr.Capacity(), 5);
 }
 
+TEST(GrowingArray, EmplaceBack)
+{
+	struct Pair
+	{
+		Pair(int a_, float b_)
+			: a(a_)
+			, b(b_)
+		{
+		}
+		int a;
+		float b;
+	};
+
+	Core::GrowingArray<Pair> arr(1);
+	arr.EmplaceBack(1, 2.f);
+	Pair& last = arr.EmplaceBack(3, 4.f); // grows
+	ASSERT_EQ(arr.Size(), 2);
+	ASSERT_EQ(last.a, 3);
+	ASSERT_EQ(arr[0].b, 2.f);
+}
+
+TEST(GrowingArray, AddOwnElementWhileGrowing)
+{
+	Core::GrowingArray<std::string> arr(1);
+	arr.Add("a string long enough to not fit in the small string buffer");
+	arr.Add(arr[0]);
+	ASSERT_EQ(arr.Size(), 2);
+	ASSERT_EQ(arr[0], arr[1]);
+}
+
+TEST(GrowingArray, NonTrivialLifetime)
+{
+	static int alive = 0;
+	struct Tracked
+	{
+		Tracked() { ++alive; }
+		Tracked(const Tracked&) { ++alive; }
+		Tracked(Tracked&&) noexcept { ++alive; }
+		Tracked& operator=(const Tracked&) = default;
+		Tracked& operator=(Tracked&&) = default;
+		~Tracked() { --alive; }
+	};
+
+	{
+		Core::GrowingArray<Tracked> arr(2);
+		for(int i = 0; i < 33; ++i)
+			arr.EmplaceBack();
+		ASSERT_EQ(alive, 33);
+
+		arr.RemoveCyclicAtIndex(0);
+		ASSERT_EQ(alive, 32);
+		ASSERT_EQ(arr.Size(), 32);
+
+		arr.ShrinkToFit();
+		ASSERT_EQ(arr.Capacity(), 32);
+		ASSERT_EQ(alive, 32);
+
+		Core::GrowingArray<Tracked> copy(arr);
+		ASSERT_EQ(alive, 64);
+	}
+	ASSERT_EQ(alive, 0);
+}
+
+TEST(GrowingArray, ReserveAndShrink)
+{
+	Core::GrowingArray<int> arr;
+	arr.Reserve(100);
+	ASSERT_EQ(arr.Capacity(), 100);
+	ASSERT_EQ(arr.Size(), 0);
+
+	arr.Reserve(50); // never shrinks
+	ASSERT_EQ(arr.Capacity(), 100);
+
+	for(int i = 0; i < 20; ++i)
+		arr.Add(i);
+
+	arr.ShrinkToFit();
+	ASSERT_EQ(arr.Capacity(), 20);
+	for(int i = 0; i < 20; ++i)
+		ASSERT_EQ(arr[i], i);
+}
+
+TEST(GrowingArray, NestedArraysSurviveGrow)
+{
+	Core::GrowingArray<Core::GrowingArray<int>> arr(1);
+	for(int i = 0; i < 16; ++i)
+	{
+		arr.Add(Core::GrowingArray<int>(4));
+		arr.GetLast().Add(i);
+	}
+
+	ASSERT_EQ(arr.Size(), 16);
+	for(int i = 0; i < 16; ++i)
+		ASSERT_EQ(arr[i][0], i);
+
+	arr.RemoveCyclicAtIndex(0);
+	ASSERT_EQ(arr[0][0], 15);
+}
+
+TEST(GrowingArray, MoveLeavesSourceEmpty)
+{
+	Core::GrowingArray<int> arr({ 1, 2, 3 });
+	Core::GrowingArray<int> moved(std::move(arr));
+	ASSERT_EQ(moved.Size(), 3);
+	ASSERT_EQ(arr.Size(), 0);
+	ASSERT_EQ(arr.GetData(), nullptr);
+}
+
 TEST(Array, InitList) 
 {
 	Core::Array<int> arr({1,2,3,4,5,6,7,8,9, 10 });
@@ -129,6 +763,2825 @@ TEST(Array, InitList)
 	ASSERT_EQ(arr.Capacity(), 10);
 }
 
+TEST(Array, NoHeap)
+{
+	Core::Array<int, 4> arr;
+	ASSERT_EQ(arr.Size(), 0);
+	ASSERT_EQ(arr.Capacity(), 4);
+	ASSERT_EQ((void*)arr.GetData(), (void*)&arr); // storage is the object itself
+
+	arr.Add(1);
+	arr.Add(2);
+	Core::Array<int, 4> copy = arr;
+	ASSERT_EQ(copy.Size(), 2);
+	ASSERT_EQ(copy[1], 2);
+	ASSERT_NE(&copy[0], &arr[0]);
+}
+
+TEST(InlineArray, StaysInline)
+{
+	Core::InlineArray<int, 4> arr;
+	for(int i = 0; i < 4; ++i)
+		arr.Add(i);
+
+	ASSERT_TRUE(arr.IsInline());
+	ASSERT_EQ(arr.Capacity(), 4);
+}
+
+TEST(InlineArray, SpillsToHeap)
+{
+	Core::InlineArray<std::string, 2> arr({ "a", "b" });
+	ASSERT_TRUE(arr.IsInline());
+
+	arr.Add("c");
+	ASSERT_FALSE(arr.IsInline());
+	ASSERT_EQ(arr.Size(), 3);
+	ASSERT_EQ(arr[0], "a");
+	ASSERT_EQ(arr[2], "c");
+}
+
+TEST(InlineArray, MoveAndCopy)
+{
+	Core::InlineArray<std::string, 2> small({ "a" });
+	Core::InlineArray<std::string, 2> big({ "a", "b", "c" });
+
+	Core::InlineArray<std::string, 2> movedSmall(std::move(small));
+	ASSERT_TRUE(movedSmall.IsInline());
+	ASSERT_EQ(movedSmall[0], "a");
+	ASSERT_EQ(small.Size(), 0);
+
+	const std::string* heap = big.GetData();
+	Core::InlineArray<std::string, 2> movedBig(std::move(big));
+	ASSERT_EQ(movedBig.GetData(), heap); // heap block is handed over, not copied
+	ASSERT_TRUE(big.IsInline());
+	ASSERT_EQ(big.Size(), 0);
+
+	Core::InlineArray<std::string, 2> copy(movedBig);
+	ASSERT_EQ(copy.Size(), 3);
+	ASSERT_EQ(copy[2], "c");
+}
+
+TEST(InlineArray, Resize)
+{
+	Core::InlineArray<int, 2> arr;
+	arr.Resize(2);
+	ASSERT_TRUE(arr.IsInline());
+	ASSERT_EQ(arr[1], 0);
+
+	arr.Resize(5);
+	ASSERT_EQ(arr.Size(), 5);
+	arr.Resize(1);
+	ASSERT_EQ(arr.Size(), 1);
+}
+
+TEST(InlineArray, SpilledStorageKeepsAlignment)
+{
+	struct alignas(64) CacheLine
+	{
+		float m_Values[16];
+	};
+
+	Core::InlineArray<CacheLine, 2> arr;
+	for(uint32 i = 0; i < 9; ++i)
+	{
+		arr.Add(CacheLine{ { static_cast<float>(i) } });
+		ASSERT_EQ(reinterpret_cast<uintptr_t>(arr.GetData()) % alignof(CacheLine), 0);
+	}
+
+	ASSERT_FALSE(arr.IsInline());
+	ASSERT_EQ(arr[8].m_Values[0], 8.f);
+	arr.Reserve(64);
+	ASSERT_EQ(reinterpret_cast<uintptr_t>(arr.GetData()) % alignof(CacheLine), 0);
+}
+
+TEST(HashMap, InsertFind)
+{
+	Core::HashMap<int, float> map;
+	ASSERT_EQ(map.Find(1), nullptr);
+
+	map.Insert(1, 1.f);
+	map.Insert(2, 2.f);
+	map.Insert(1, 3.f); // overwrites
+
+	ASSERT_EQ(map.Size(), 2);
+	ASSERT_EQ(*map.Find(1), 3.f);
+	ASSERT_EQ(*map.Find(2), 2.f);
+	ASSERT_FALSE(map.Contains(3));
+
+	map[3] += 4.f;
+	ASSERT_EQ(*map.Find(3), 4.f);
+}
+
+TEST(HashMap, GrowKeepsEntries)
+{
+	Core::HashMap<uint32, uint32> map;
+	for(uint32 i = 0; i < 10000; ++i)
+		map.Insert(i * 7, i);
+
+	ASSERT_EQ(map.Size(), 10000);
+	ASSERT_LE(map.Size() * 8, map.Capacity() * 7);
+	for(uint32 i = 0; i < 10000; ++i)
+		ASSERT_EQ(*map.Find(i * 7), i);
+}
+
+TEST(HashMap, RemoveShiftsBack)
+{
+	// random insert / remove against std::unordered_map, catches broken backward shifting
+	Core::HashMap<uint32, uint32> map;
+	std::unordered_map<uint32, uint32> reference;
+	std::mt19937 random(1234);
+
+	for(int i = 0; i < 50000; ++i)
+	{
+		const uint32 key = random() % 2048;
+		if(random() % 3 == 0)
+		{
+			ASSERT_EQ(map.Remove(key), reference.erase(key) == 1);
+		}
+		else
+		{
+			map.Insert(key, i);
+			reference[key] = i;
+		}
+	}
+
+	ASSERT_EQ(map.Size(), reference.size());
+	for(auto& it : reference)
+		ASSERT_EQ(*map.Find(it.first), it.second);
+
+	uint32 visited = 0;
+	for(auto& pair : map)
+	{
+		ASSERT_EQ(reference[pair.key], pair.value);
+		++visited;
+	}
+	ASSERT_EQ(visited, reference.size());
+}
+
+TEST(HashMap, HashStringKey)
+{
+	Core::HashMap<Core::HashString, std::string> map;
+	map.Insert("vertex.vert", "vertex");
+	map.Insert(Core::HashString("frag.hlsl"), "fragment");
+
+	ASSERT_EQ(*map.Find("vertex.vert"), "vertex");
+	ASSERT_EQ(*map.Find("frag.hlsl"), "fragment");
+	ASSERT_EQ(map.Find("cube.mdl"), nullptr);
+
+	ASSERT_TRUE(map.Remove("vertex.vert"));
+	ASSERT_FALSE(map.Contains("vertex.vert"));
+	ASSERT_EQ(map.Size(), 1);
+}
+
+TEST(HashMap, CopyAndMove)
+{
+	Core::HashMap<std::string, int> map;
+	map.Insert("a", 1);
+	map.Insert("b", 2);
+
+	Core::HashMap<std::string, int> copy(map);
+	ASSERT_EQ(*copy.Find("b"), 2);
+
+	Core::HashMap<std::string, int> moved(std::move(map));
+	ASSERT_EQ(*moved.Find("a"), 1);
+	ASSERT_EQ(map.Size(), 0);
+	ASSERT_EQ(map.Find("a"), nullptr);
+}
+TEST(SlotMap, AddGet)
+{
+	Core::SlotMap<int> map;
+	Core::SlotHandle a = map.Add(1);
+	Core::SlotHandle b = map.Add(2);
+
+	ASSERT_TRUE(a.IsValid());
+	ASSERT_NE(a, b);
+	ASSERT_EQ(*map.Get(a), 1);
+	ASSERT_EQ(*map.Get(b), 2);
+	ASSERT_EQ(map.Get(Core::SlotHandle()), nullptr);
+}
+
+TEST(SlotMap, RemoveKeepsOtherHandlesAndStaysDense)
+{
+	Core::SlotMap<int> map;
+	Core::SlotHandle handles[8];
+	for(int i = 0; i < 8; ++i)
+		handles[i] = map.Add(i);
+
+	ASSERT_TRUE(map.Remove(handles[2]));
+	ASSERT_FALSE(map.Remove(handles[2]));
+	ASSERT_EQ(map.Get(handles[2]), nullptr);
+	ASSERT_EQ(map.Size(), 7);
+
+	for(int i = 0; i < 8; ++i)
+	{
+		if(i != 2)
+		{
+			ASSERT_EQ(*map.Get(handles[i]), i);
+		}
+	}
+
+	int sum = 0;
+	for(int value : map)
+		sum += value;
+	ASSERT_EQ(sum, 28 - 2);
+}
+
+TEST(SlotMap, StaleHandleAfterReuse)
+{
+	Core::SlotMap<int> map;
+	Core::SlotHandle first = map.Add(1);
+	map.Remove(first);
+
+	Core::SlotHandle second = map.Add(2);
+	ASSERT_EQ(first.GetIndex(), second.GetIndex()); // slot is reused
+	ASSERT_NE(first.GetGeneration(), second.GetGeneration());
+	ASSERT_EQ(map.Get(first), nullptr);
+	ASSERT_EQ(*map.Get(second), 2);
+}
+
+TEST(SlotMap, GetHandleWhileIterating)
+{
+	Core::SlotMap<std::string> map;
+	map.Add("a");
+	Core::SlotHandle b = map.Add("b");
+	map.Add("c");
+	map.Remove(map.GetHandle(0));
+
+	for(uint32 i = 0; i < map.Size(); ++i)
+		ASSERT_EQ(map.Get(map.GetHandle(i)), &map.GetData()[i]);
+
+	ASSERT_EQ(*map.Get(b), "b");
+	map.Clear();
+	ASSERT_TRUE(map.Empty());
+	ASSERT_EQ(map.Get(b), nullptr);
+}
+TEST(FrameArena, AllocAlignsAndTracksHighWater)
+{
+	Core::FrameArena arena;
+	arena.Init(1024);
+	arena.BeginFrame(0);
+
+	char* bytes = arena.Alloc<char>(3);
+	Core::Matrix44f* matrix = arena.Alloc<Core::Matrix44f>();
+	ASSERT_NE(bytes, nullptr);
+	ASSERT_EQ((uint64)matrix % alignof(Core::Matrix44f), 0);
+	ASSERT_EQ(arena.GetUsed(), sizeof(Core::Matrix44f) + alignof(Core::Matrix44f));
+
+	arena.BeginFrame(1);
+	ASSERT_EQ(arena.GetUsed(), 0);
+	ASSERT_EQ(arena.GetHighWaterMark(), sizeof(Core::Matrix44f) + alignof(Core::Matrix44f));
+
+	// the two frames never overlap
+	Core::Matrix44f* other = arena.Alloc<Core::Matrix44f>();
+	ASSERT_GE((char*)other, (char*)matrix + arena.GetCapacity() - alignof(Core::Matrix44f));
+}
+
+TEST(FrameArena, SteadyStateFrameDoesNoHeapAllocations)
+{
+	Core::FrameArena arena;
+	arena.Init(64 * 1024);
+	Core::GrowingArray<Core::Matrix44f*> frames(2);
+
+	auto frame = [&](uint32 index) {
+		arena.BeginFrame(index & 1);
+
+		Core::Matrix44f* transforms = arena.Alloc<Core::Matrix44f>(128);
+		for(uint32 i = 0; i < 128; ++i)
+			transforms[i] = Core::Matrix44f::Identity();
+
+		char* text = arena.Alloc<char>(100);
+		snprintf(text, 100, "FPS : %.3f dt: %.3f", 60.f, 1.f / 60.f);
+
+		Core::InlineArray<Core::Matrix44f*, 4> visible;
+		visible.Add(&transforms[0]);
+		visible.Add(&transforms[127]);
+		frames.Add(visible[1]);
+		frames.RemoveLast();
+	};
+
+	frame(0);
+	frame(1);
+
+	const uint64 before = s_HeapAllocations;
+	for(uint32 i = 2; i < 1000; ++i)
+		frame(i);
+
+	ASSERT_EQ(s_HeapAllocations - before, 0);
+	ASSERT_LE(arena.GetHighWaterMark(), arena.GetCapacity());
+}
+
+TEST(PoolAllocator, ReusesBlocksAndOverflows)
+{
+	Core::PoolAllocator<24, 16> pool(4);
+	ASSERT_EQ(pool.Stride, 32);
+
+	void* blocks[5];
+	for(void*& block : blocks)
+		block = pool.Allocate();
+
+	for(uint32 i = 0; i < 4; ++i)
+	{
+		ASSERT_TRUE(pool.Owns(blocks[i]));
+		ASSERT_EQ((uint64)blocks[i] % 16, 0);
+	}
+
+	// the fifth one no longer fits and comes from the upstream allocator
+	ASSERT_FALSE(pool.Owns(blocks[4]));
+	ASSERT_EQ(pool.GetFreeCount(), 0);
+	ASSERT_EQ(pool.GetOverflowCount(), 1);
+
+	pool.Free(blocks[4]);
+	pool.Free(blocks[1]);
+	ASSERT_EQ(pool.Allocate(), blocks[1]);
+
+	pool.Free(blocks[0]);
+	pool.Free(blocks[1]);
+	pool.Free(blocks[2]);
+	pool.Free(blocks[3]);
+	ASSERT_EQ(pool.GetFreeCount(), 4);
+}
+
+TEST(PoolAllocator, ConcurrentAllocateFree)
+{
+	constexpr uint32 threadCount = 4;
+	constexpr uint32 perThread = 64;
+	Core::PoolAllocator<sizeof(uint64)> pool(threadCount * perThread);
+
+	std::atomic<bool> failed{ false };
+	std::vector<std::thread> threads;
+	for(uint32 t = 0; t < threadCount; ++t)
+	{
+		threads.emplace_back([&pool, &failed, t] {
+			uint64* blocks[perThread];
+			for(uint32 round = 0; round < 2000; ++round)
+			{
+				for(uint32 i = 0; i < perThread; ++i)
+				{
+					blocks[i] = static_cast<uint64*>(pool.Allocate());
+					*blocks[i] = ((uint64)t << 32) | i;
+				}
+
+				// any block handed out twice would have been overwritten by the other thread
+				for(uint32 i = 0; i < perThread; ++i)
+				{
+					if(*blocks[i] != (((uint64)t << 32) | i))
+						failed = true;
+					pool.Free(blocks[i]);
+				}
+			}
+		});
+	}
+
+	for(std::thread& thread : threads)
+		thread.join();
+
+	ASSERT_FALSE(failed);
+	ASSERT_EQ(pool.GetFreeCount(), threadCount * perThread);
+	ASSERT_EQ(pool.GetOverflowCount(), 0);
+}
+
+TEST(TlsfAllocator, AlignsSplitsAndMerges)
+{
+	Core::TlsfAllocator ranges(1024);
+
+	const Core::TlsfAllocation a = ranges.Allocate(100);
+	const Core::TlsfAllocation b = ranges.Allocate(10, 256);
+	ASSERT_EQ(a.m_Offset, 0);
+	ASSERT_EQ(b.m_Offset, 256);
+	// the padding in front of b is free again
+	ASSERT_EQ(ranges.GetFreeRangeCount(), 2);
+	ASSERT_EQ(ranges.GetUsed(), 110);
+	ASSERT_EQ(ranges.GetLargestFreeRange(), 1024 - 266);
+
+	ranges.Free(a);
+	ASSERT_EQ(ranges.GetFreeRangeCount(), 2);
+	ASSERT_EQ(ranges.GetAllocationCount(), 1);
+	ranges.Free(b);
+	ASSERT_TRUE(ranges.IsEmpty());
+	ASSERT_EQ(ranges.GetFreeRangeCount(), 1);
+	ASSERT_EQ(ranges.GetLargestFreeRange(), 1024);
+
+	ASSERT_FALSE(ranges.Allocate(1025).IsValid());
+	const Core::TlsfAllocation all = ranges.Allocate(1024);
+	ASSERT_TRUE(all.IsValid());
+	ASSERT_EQ(ranges.GetFree(), 0);
+	ASSERT_FALSE(ranges.Allocate(1).IsValid());
+	ranges.Free(all);
+	ASSERT_EQ(ranges.GetLargestFreeRange(), 1024);
+}
+
+TEST(TlsfAllocator, RandomAllocationsNeverOverlap)
+{
+	constexpr uint64 size = 1 << 20;
+	Core::TlsfAllocator ranges(size);
+	std::mt19937 random(7);
+
+	struct Live
+	{
+		Core::TlsfAllocation m_Allocation;
+		uint64 m_Size;
+	};
+	std::vector<Live> live;
+	std::map<uint64, uint64> used; // offset to end
+
+	for(uint32 i = 0; i < 20000; ++i)
+	{
+		if(live.empty() || random() % 3 != 0)
+		{
+			const uint64 bytes = 1 + random() % 4096;
+			const uint64 alignment = 1ull << (random() % 9);
+			const Core::TlsfAllocation allocation = ranges.Allocate(bytes, alignment);
+			if(!allocation.IsValid())
+				continue;
+
+			ASSERT_EQ(allocation.m_Offset % alignment, 0);
+			ASSERT_LE(allocation.m_Offset + bytes, size);
+			auto next = used.lower_bound(allocation.m_Offset);
+			if(next != used.end())
+			{
+				ASSERT_LE(allocation.m_Offset + bytes, next->first);
+			}
+			if(next != used.begin())
+			{
+				ASSERT_LE(std::prev(next)->second, allocation.m_Offset);
+			}
+
+			used[allocation.m_Offset] = allocation.m_Offset + bytes;
+			live.push_back({ allocation, bytes });
+		}
+		else
+		{
+			const uint32 index = random() % live.size();
+			ranges.Free(live[index].m_Allocation);
+			used.erase(live[index].m_Allocation.m_Offset);
+			live[index] = live.back();
+			live.pop_back();
+		}
+
+		ASSERT_EQ(ranges.GetAllocationCount(), live.size());
+	}
+
+	for(const Live& allocation : live)
+		ranges.Free(allocation.m_Allocation);
+	ASSERT_EQ(ranges.GetUsed(), 0);
+	ASSERT_EQ(ranges.GetFreeRangeCount(), 1);
+	ASSERT_EQ(ranges.GetLargestFreeRange(), size);
+}
+
+// device memory as plain heap memory, with a budget per memory type to run out of
+class MockGpuMemory : public Core::IGpuMemoryBackend
+{
+public:
+	MockGpuMemory()
+	{
+		for(uint64& budget : m_Budget)
+			budget = ~0ull;
+	}
+
+	uint64 AllocateBlock(uint32 memoryType, uint64 size) override
+	{
+		if(size > m_Budget[memoryType])
+			return 0;
+
+		m_Budget[memoryType] -= size;
+		++m_BlockCount[memoryType];
+		const uint64 handle = m_NextHandle++;
+		m_Blocks[handle] = { memoryType, size, nullptr };
+		return handle;
+	}
+
+	void FreeBlock(uint64 block) override
+	{
+		Block& freed = m_Blocks.at(block);
+		m_Budget[freed.m_Type] += freed.m_Size;
+		--m_BlockCount[freed.m_Type];
+		delete[] freed.m_Data;
+		m_Blocks.erase(block);
+	}
+
+	void* MapBlock(uint64 block) override
+	{
+		Block& mapped = m_Blocks.at(block);
+		mapped.m_Data = new int8[mapped.m_Size];
+		return mapped.m_Data;
+	}
+
+	struct Block
+	{
+		uint32 m_Type;
+		uint64 m_Size;
+		int8* m_Data;
+	};
+
+	uint64 m_Budget[Core::GpuMemoryProperties::MaxTypes];
+	uint32 m_BlockCount[Core::GpuMemoryProperties::MaxTypes] = {};
+	std::map<uint64, Block> m_Blocks;
+	uint64 m_NextHandle = 1;
+};
+
+// a discrete GPU: video memory, two kinds of system memory and a small host visible window into video memory
+static Core::GpuMemoryProperties GetMockGpuMemoryProperties()
+{
+	using Properties = Core::GpuMemoryProperties;
+	Properties properties;
+	properties.m_HeapCount = 3;
+	properties.m_HeapSizes[0] = 8ull << 30;
+	properties.m_HeapSizes[1] = 16ull << 30;
+	properties.m_HeapSizes[2] = 256ull << 20;
+	properties.m_TypeCount = 4;
+	properties.m_Types[0] = { Properties::DeviceLocal, 0 };
+	properties.m_Types[1] = { Properties::HostVisible | Properties::HostCoherent, 1 };
+	properties.m_Types[2] = { Properties::HostVisible | Properties::HostCoherent | Properties::HostCached, 1 };
+	properties.m_Types[3] = { Properties::DeviceLocal | Properties::HostVisible | Properties::HostCoherent, 2 };
+	properties.m_BufferImageGranularity = 1024;
+	return properties;
+}
+
+TEST(GpuMemoryAllocator, PicksMemoryTypes)
+{
+	using Properties = Core::GpuMemoryProperties;
+	MockGpuMemory backend;
+	Core::GpuMemoryAllocator allocator;
+	allocator.Init(&backend, GetMockGpuMemoryProperties());
+
+	// the fewest flags nobody asked for
+	ASSERT_EQ(allocator.FindMemoryType(~0u, Properties::DeviceLocal, 0), 0);
+	ASSERT_EQ(allocator.FindMemoryType(~0u, Properties::HostVisible, 0), 1);
+	ASSERT_EQ(allocator.FindMemoryType(~0u, Properties::HostVisible, Properties::HostCached), 2);
+	ASSERT_EQ(allocator.FindMemoryType(~0u, Properties::HostVisible, Properties::DeviceLocal), 3);
+	ASSERT_EQ(allocator.FindMemoryType(~(1u << 3), Properties::HostVisible, Properties::DeviceLocal), 1);
+	ASSERT_EQ(allocator.FindMemoryType(1u << 0, Properties::HostVisible, 0), -1);
+
+	// an eighth of the small heap
+	ASSERT_EQ(allocator.GetBlockSize(0), Core::GpuMemoryAllocator::DefaultBlockSize);
+	ASSERT_EQ(allocator.GetBlockSize(3), 32ull << 20);
+
+	// the host visible video memory is gone, the next best type is used
+	backend.m_Budget[3] = 0;
+	Core::GpuAllocationDesc desc;
+	desc.m_Size = 4096;
+	desc.m_RequiredFlags = Properties::HostVisible;
+	desc.m_PreferredFlags = Properties::DeviceLocal;
+	const Core::GpuAllocation allocation = allocator.Allocate(desc);
+	ASSERT_TRUE(allocation.IsValid());
+	ASSERT_EQ(allocation.m_MemoryType, 1);
+	ASSERT_NE(allocation.m_Mapped, nullptr);
+	allocator.Free(allocation);
+}
+
+TEST(GpuMemoryAllocator, SubAllocatesFromBlocks)
+{
+	using Properties = Core::GpuMemoryProperties;
+	MockGpuMemory backend;
+	Core::GpuMemoryAllocator allocator;
+	allocator.Init(&backend, GetMockGpuMemoryProperties(), 1 << 20);
+
+	Core::GpuAllocationDesc desc;
+	desc.m_Size = 4096;
+	desc.m_Alignment = 256;
+	desc.m_RequiredFlags = Properties::DeviceLocal;
+
+	std::vector<Core::GpuAllocation> allocations;
+	for(uint32 i = 0; i < 100; ++i)
+	{
+		allocations.push_back(allocator.Allocate(desc));
+		ASSERT_EQ(allocations.back().m_Memory, allocations[0].m_Memory);
+		ASSERT_EQ(allocations.back().m_Offset % 256, 0);
+		ASSERT_FALSE(allocations.back().IsDedicated());
+	}
+	ASSERT_EQ(backend.m_BlockCount[0], 1);
+
+	Core::GpuMemoryStats stats = allocator.GetStats();
+	ASSERT_EQ(stats.m_BlockCount, 1);
+	ASSERT_EQ(stats.m_AllocationCount, 100);
+	ASSERT_EQ(stats.m_BlockBytes, 1 << 20);
+	ASSERT_EQ(stats.m_UsedBytes, 100 * 4096);
+
+	// host visible blocks stay mapped, every allocation gets its part of the mapping
+	desc.m_RequiredFlags = Properties::HostVisible | Properties::HostCoherent;
+	const Core::GpuAllocation first = allocator.Allocate(desc);
+	const Core::GpuAllocation second = allocator.Allocate(desc);
+	ASSERT_EQ(first.m_MemoryType, 1);
+	ASSERT_EQ(static_cast<int8*>(second.m_Mapped) - static_cast<int8*>(first.m_Mapped),
+			  int64(second.m_Offset - first.m_Offset));
+	memset(second.m_Mapped, 0xff, 4096);
+	allocator.Free(first);
+	allocator.Free(second);
+
+	for(const Core::GpuAllocation& allocation : allocations)
+		allocator.Free(allocation);
+	// one empty block is kept for the next allocations
+	ASSERT_EQ(backend.m_BlockCount[0], 1);
+	ASSERT_EQ(allocator.GetStats(0).m_AllocationCount, 0);
+
+	// too large to share a block
+	desc.m_Size = 600 << 10;
+	desc.m_RequiredFlags = Properties::DeviceLocal;
+	const Core::GpuAllocation large = allocator.Allocate(desc);
+	ASSERT_TRUE(large.IsDedicated());
+	ASSERT_EQ(allocator.GetStats().m_DedicatedCount, 1);
+	ASSERT_EQ(allocator.GetStats().m_DedicatedBytes, 600 << 10);
+	allocator.Free(large);
+	ASSERT_EQ(allocator.GetStats().m_DedicatedCount, 0);
+
+	allocator.Destroy();
+	ASSERT_TRUE(backend.m_Blocks.empty());
+}
+
+TEST(GpuMemoryAllocator, FallsBackToDedicatedWhenBlocksRunOut)
+{
+	MockGpuMemory backend;
+	Core::GpuMemoryAllocator allocator;
+	allocator.Init(&backend, GetMockGpuMemoryProperties(), 1 << 20);
+	backend.m_Budget[0] = (1 << 20) + (512 << 10);
+
+	Core::GpuAllocationDesc desc;
+	desc.m_Size = 400 << 10;
+	desc.m_MemoryTypeBits = 1u << 0;
+	desc.m_RequiredFlags = Core::GpuMemoryProperties::DeviceLocal;
+
+	const Core::GpuAllocation a = allocator.Allocate(desc);
+	const Core::GpuAllocation b = allocator.Allocate(desc);
+	ASSERT_EQ(a.m_Memory, b.m_Memory);
+
+	// no room for another block, but still for exactly this much
+	const Core::GpuAllocation c = allocator.Allocate(desc);
+	ASSERT_TRUE(c.IsValid());
+	ASSERT_TRUE(c.IsDedicated());
+
+	// and now there is nothing left in the only type allowed
+	ASSERT_FALSE(allocator.Allocate(desc).IsValid());
+
+	allocator.Free(a);
+	allocator.Free(b);
+	allocator.Free(c);
+	ASSERT_EQ(backend.m_Budget[0], 512 << 10);
+}
+
+TEST(GpuMemoryAllocator, KeepsImagesOffBufferPages)
+{
+	MockGpuMemory backend;
+	Core::GpuMemoryAllocator allocator;
+	allocator.Init(&backend, GetMockGpuMemoryProperties(), 1 << 20);
+
+	Core::GpuAllocationDesc buffer;
+	buffer.m_Size = 100;
+	buffer.m_Alignment = 4;
+	buffer.m_RequiredFlags = Core::GpuMemoryProperties::DeviceLocal;
+
+	Core::GpuAllocationDesc image = buffer;
+	image.m_Alignment = 16;
+	image.m_Resource = Core::GpuAllocationDesc::Resource::OptimalImage;
+
+	const Core::GpuAllocation before = allocator.Allocate(buffer);
+	const Core::GpuAllocation texture = allocator.Allocate(image);
+	const Core::GpuAllocation after = allocator.Allocate(buffer);
+	ASSERT_EQ(before.m_Memory, texture.m_Memory);
+	ASSERT_EQ(after.m_Memory, texture.m_Memory);
+
+	// the image has its 1024 byte pages to itself
+	ASSERT_EQ(texture.m_Offset % 1024, 0);
+	ASSERT_EQ(texture.m_Size, 1024);
+	for(const Core::GpuAllocation& other : { before, after })
+	{
+		const bool below = other.m_Offset + other.m_Size <= texture.m_Offset;
+		const bool above = other.m_Offset >= texture.m_Offset + texture.m_Size;
+		ASSERT_TRUE(below || above);
+	}
+
+	allocator.Free(before);
+	allocator.Free(texture);
+	allocator.Free(after);
+}
+
+TEST(GpuMemoryAllocator, ReportsFragmentationAndReleasesEmptyBlocks)
+{
+	MockGpuMemory backend;
+	Core::GpuMemoryAllocator allocator;
+	allocator.Init(&backend, GetMockGpuMemoryProperties(), 1 << 20);
+
+	Core::GpuAllocationDesc desc;
+	desc.m_Size = 64 << 10;
+	desc.m_RequiredFlags = Core::GpuMemoryProperties::DeviceLocal;
+
+	std::vector<Core::GpuAllocation> allocations;
+	for(uint32 i = 0; i < 16; ++i)
+		allocations.push_back(allocator.Allocate(desc));
+	ASSERT_EQ(allocator.GetStats().GetFreeBytes(), 0);
+	ASSERT_EQ(allocator.GetStats().GetFragmentation(), 0.f);
+
+	// every other range free, none of them next to another
+	for(uint32 i = 0; i < 16; i += 2)
+		allocator.Free(allocations[i]);
+	Core::GpuMemoryStats stats = allocator.GetStats();
+	ASSERT_EQ(stats.GetFreeBytes(), 512 << 10);
+	ASSERT_EQ(stats.m_LargestFreeRange, 64 << 10);
+	ASSERT_FLOAT_EQ(stats.GetFragmentation(), 0.875f);
+
+	// the first block is full again, this one needs a second
+	for(uint32 i = 0; i < 16; i += 2)
+		allocations[i] = allocator.Allocate(desc);
+	const Core::GpuAllocation extra = allocator.Allocate(desc);
+	ASSERT_NE(extra.m_Memory, allocations[0].m_Memory);
+	ASSERT_EQ(backend.m_BlockCount[0], 2);
+
+	allocator.Free(extra);
+	ASSERT_EQ(backend.m_BlockCount[0], 2);
+	for(const Core::GpuAllocation& allocation : allocations)
+		allocator.Free(allocation);
+	ASSERT_EQ(backend.m_BlockCount[0], 1);
+
+	stats = allocator.GetStats();
+	ASSERT_EQ(stats.m_BlockCount, 1);
+	ASSERT_EQ(stats.m_LargestFreeRange, 1 << 20);
+	ASSERT_EQ(stats.GetFragmentation(), 0.f);
+}
+
+TEST(StagingRing, WrapsAndRetires)
+{
+	Core::StagingRing ring(1000);
+
+	ASSERT_EQ(ring.Allocate(400), 0);
+	ASSERT_EQ(ring.Allocate(100, 256), 512);
+	ring.EndSubmission(1);
+	ASSERT_EQ(ring.Allocate(300), 612);
+	ring.EndSubmission(2);
+	ASSERT_EQ(ring.GetUsed(), 912);
+
+	// the front is still in use by submission 1
+	ASSERT_EQ(ring.Allocate(200), Core::StagingRing::InvalidOffset);
+	ring.Retire(1);
+	ASSERT_EQ(ring.GetPendingSubmissionCount(), 1);
+
+	// does not fit at the end, the last 88 bytes are skipped
+	ASSERT_EQ(ring.Allocate(200), 0);
+	ASSERT_EQ(ring.GetUsed(), 300 + 88 + 200);
+	ASSERT_EQ(ring.Allocate(400), 200);
+	ASSERT_EQ(ring.Allocate(100), Core::StagingRing::InvalidOffset);
+	ring.EndSubmission(3);
+
+	ring.Retire(3);
+	ASSERT_EQ(ring.GetUsed(), 0);
+	ASSERT_EQ(ring.GetPendingSubmissionCount(), 0);
+	// empty again, the whole ring fits
+	ASSERT_EQ(ring.Allocate(1000), 0);
+	ASSERT_EQ(ring.Allocate(1), Core::StagingRing::InvalidOffset);
+}
+
+TEST(StagingRing, InFlightRangesNeverOverlap)
+{
+	constexpr uint64 size = 64 * 1024;
+	Core::StagingRing ring(size);
+	std::mt19937 random(11);
+
+	struct Range
+	{
+		uint64 m_Submission;
+		uint64 m_Begin;
+		uint64 m_End;
+	};
+	std::deque<Range> inFlight;
+	uint64 submission = 0;
+	uint64 completed = 0;
+
+	for(uint32 frame = 0; frame < 5000; ++frame)
+	{
+		const uint32 uploads = random() % 8;
+		for(uint32 i = 0; i < uploads; ++i)
+		{
+			const uint64 bytes = 1 + random() % 8192;
+			const uint64 alignment = 1ull << (random() % 9);
+			const uint64 offset = ring.Allocate(bytes, alignment);
+			if(offset == Core::StagingRing::InvalidOffset)
+				break;
+
+			ASSERT_EQ(offset % alignment, 0);
+			ASSERT_LE(offset + bytes, size);
+			for(const Range& range : inFlight)
+				ASSERT_TRUE(offset + bytes <= range.m_Begin || offset >= range.m_End);
+			inFlight.push_back({ submission + 1, offset, offset + bytes });
+		}
+		ring.EndSubmission(++submission);
+
+		// the GPU lags a few submissions behind
+		if(submission > 3 && random() % 2 == 0)
+		{
+			completed = submission - 3 + random() % 3;
+			ring.Retire(completed);
+			while(!inFlight.empty() && inFlight.front().m_Submission <= completed)
+				inFlight.pop_front();
+		}
+	}
+
+	ring.Retire(submission);
+	ASSERT_EQ(ring.GetUsed(), 0);
+}
+
+TEST(UniformRing, AlignsOffsetsToTheDeviceLimit)
+{
+	Core::UniformRing ring;
+	ring.Init(1000, 256);
+	ASSERT_EQ(ring.GetFrameSize(), 1024);
+	ASSERT_EQ(ring.GetSize(), 1024 * Core::UniformRing::FrameCount);
+
+	ring.BeginFrame(0);
+	ASSERT_EQ(ring.Allocate(80), 0);
+	ASSERT_EQ(ring.Allocate(4), 256);
+	ASSERT_EQ(ring.Allocate(256), 512);
+	ASSERT_EQ(ring.GetUsed(), 768);
+
+	// the last 256 bytes fit, one more does not
+	// running out is a return value, not an assert, and leaves the frame as it was
+	ASSERT_EQ(ring.Allocate(257), Core::UniformRing::InvalidOffset);
+	ASSERT_EQ(ring.GetUsed(), 768);
+	ASSERT_EQ(ring.Allocate(256), 768);
+	ASSERT_EQ(ring.Allocate(1), Core::UniformRing::InvalidOffset);
+}
+
+TEST(UniformRing, FramesNeverShareARange)
+{
+	Core::UniformRing ring;
+	ring.Init(4096, 64);
+
+	// the same allocations every frame land at the same place in that frame's region
+	uint64 offsets[Core::UniformRing::FrameCount][2];
+	for(uint32 frame = 0; frame < 6; ++frame)
+	{
+		const uint32 index = frame % Core::UniformRing::FrameCount;
+		ring.BeginFrame(index);
+		ASSERT_EQ(ring.GetUsed(), 0);
+
+		const uint64 first = ring.Allocate(sizeof(Core::Matrix44f) + sizeof(Core::Vector4f));
+		const uint64 second = ring.Allocate(sizeof(Core::Matrix44f));
+		ASSERT_GE(first, index * ring.GetFrameSize());
+		ASSERT_LE(second + sizeof(Core::Matrix44f), (index + 1) * ring.GetFrameSize());
+		ASSERT_EQ(first % 64, 0);
+		ASSERT_EQ(second % 64, 0);
+
+		if(frame >= Core::UniformRing::FrameCount)
+		{
+			ASSERT_EQ(first, offsets[index][0]);
+			ASSERT_EQ(second, offsets[index][1]);
+		}
+		offsets[index][0] = first;
+		offsets[index][1] = second;
+	}
+
+	ASSERT_EQ(offsets[1][0] - offsets[0][0], ring.GetFrameSize());
+	ASSERT_EQ(ring.GetHighWaterMark(), 64 + 64 + sizeof(Core::Matrix44f));
+}
+
+TEST(MemoryTracker, TagsLiveAndPeakBytes)
+{
+	Core::MemoryTracker::Reset();
+	Core::IAllocator* game = Core::GetAllocator(Core::MemoryTag::Game);
+
+	void* a = game->Allocate(100, 16);
+	void* b = game->Allocate(300, 64);
+	ASSERT_EQ((uint64)b % 64, 0);
+	game->Free(a, 100, 16);
+
+	Core::MemoryStats stats = Core::MemoryTracker::GetStats(Core::MemoryTag::Game);
+	ASSERT_EQ(stats.m_LiveBytes, 300);
+	ASSERT_EQ(stats.m_PeakBytes, 400);
+	ASSERT_EQ(stats.m_TotalAllocations, 2);
+	ASSERT_EQ(stats.m_LiveAllocations, 1);
+	ASSERT_EQ(Core::MemoryTracker::GetStats(Core::MemoryTag::Graphics).m_LiveBytes, 0);
+
+	Core::MemoryTracker::Update(0.5f);
+	ASSERT_FLOAT_EQ(Core::MemoryTracker::GetStats(Core::MemoryTag::Game).m_AllocationsPerSecond, 4.f);
+	Core::MemoryTracker::Update(0.5f);
+	ASSERT_FLOAT_EQ(Core::MemoryTracker::GetStats(Core::MemoryTag::Game).m_AllocationsPerSecond, 0.f);
+
+	game->Free(b, 300, 64);
+	ASSERT_EQ(Core::MemoryTracker::GetStats(Core::MemoryTag::Game).m_LiveBytes, 0);
+}
+
+TEST(MemoryTracker, ContainersUseGivenAllocator)
+{
+	Core::MemoryTracker::Reset();
+	Core::IAllocator* graphics = Core::GetAllocator(Core::MemoryTag::Graphics);
+	{
+		Core::GrowingArray<Core::Matrix44f> transforms(4, graphics);
+		for(uint32 i = 0; i < 100; ++i)
+			transforms.Add(Core::Matrix44f::Identity());
+
+		Core::GrowingArray<Core::Matrix44f> copy(transforms);
+		ASSERT_EQ(copy.GetAllocator(), graphics);
+
+		Core::HashMap<uint32, uint32> map(16, graphics);
+		for(uint32 i = 0; i < 100; ++i)
+			map.Insert(i, i);
+
+		ASSERT_GT(Core::MemoryTracker::GetStats(Core::MemoryTag::Graphics).m_LiveBytes,
+				  2 * 100 * sizeof(Core::Matrix44f));
+	}
+	ASSERT_EQ(Core::MemoryTracker::GetStats(Core::MemoryTag::Graphics).m_LiveBytes, 0);
+	ASSERT_EQ(Core::MemoryTracker::GetStats(Core::MemoryTag::Graphics).m_LiveAllocations, 0);
+	ASSERT_EQ(Core::MemoryTracker::GetStats(Core::MemoryTag::Core).m_TotalAllocations, 0);
+}
+
+TEST(MemoryTracker, ContainersDefaultToTheCoreTag)
+{
+	Core::MemoryTracker::Reset();
+	{
+		Core::GrowingArray<uint32> values;
+		for(uint32 i = 0; i < 100; ++i)
+			values.Add(i);
+
+		Core::HashMap<uint32, uint32> map;
+		for(uint32 i = 0; i < 100; ++i)
+			map.Insert(i, i);
+
+		ASSERT_EQ(values.GetAllocator(), nullptr);
+		ASSERT_GE(Core::MemoryTracker::GetStats(Core::MemoryTag::Core).m_LiveBytes,
+				  100 * sizeof(uint32) + 100 * 2 * sizeof(uint32));
+	}
+	ASSERT_EQ(Core::MemoryTracker::GetStats(Core::MemoryTag::Core).m_LiveBytes, 0);
+
+	// the per module owners hand their own allocator down
+	Core::TransformBatch transforms(16, Core::GetAllocator(Core::MemoryTag::Graphics));
+	transforms.Add({ 1.f, 2.f, 3.f, 1.f }, { 0.f, 0.f, 0.f, 1.f }, { 1.f, 1.f, 1.f, 0.f });
+	ASSERT_EQ(Core::MemoryTracker::GetStats(Core::MemoryTag::Graphics).m_LiveBytes, 10 * 16 * sizeof(float));
+	ASSERT_EQ(Core::MemoryTracker::GetStats(Core::MemoryTag::Core).m_LiveBytes, 0);
+}
+
+TEST(MemoryTracker, SpilledInlineArraysAndArenasAreTracked)
+{
+	Core::MemoryTracker::Reset();
+	Core::IAllocator* graphics = Core::GetAllocator(Core::MemoryTag::Graphics);
+	{
+		Core::InlineArray<uint32, 4> inlineOnly(graphics);
+		for(uint32 i = 0; i < 4; ++i)
+			inlineOnly.Add(i);
+		ASSERT_EQ(Core::MemoryTracker::GetStats(Core::MemoryTag::Graphics).m_TotalAllocations, 0);
+
+		Core::InlineArray<uint32, 4> spilled(graphics);
+		for(uint32 i = 0; i < 100; ++i)
+			spilled.Add(i);
+		ASSERT_EQ(Core::MemoryTracker::GetStats(Core::MemoryTag::Graphics).m_LiveBytes,
+				  spilled.Capacity() * sizeof(uint32));
+
+		// moving hands the block and its allocator over
+		Core::InlineArray<uint32, 4> moved(std::move(spilled));
+		ASSERT_EQ(moved.GetAllocator(), graphics);
+
+		Core::InlineArray<uint32, 4> untagged;
+		untagged.Resize(10);
+		ASSERT_EQ(Core::MemoryTracker::GetStats(Core::MemoryTag::Core).m_LiveBytes, 10 * sizeof(uint32));
+
+		Core::FrameArena arena;
+		arena.Init(1000, graphics);
+		ASSERT_EQ(Core::MemoryTracker::GetStats(Core::MemoryTag::Graphics).m_LiveBytes,
+				  moved.Capacity() * sizeof(uint32) + arena.GetCapacity() * Core::FrameArena::FrameCount);
+	}
+	ASSERT_EQ(Core::MemoryTracker::GetStats(Core::MemoryTag::Graphics).m_LiveBytes, 0);
+	ASSERT_EQ(Core::MemoryTracker::GetStats(Core::MemoryTag::Core).m_LiveBytes, 0);
+}
+
+static std::string WriteTempFile(const char* name, const std::string& contents)
+{
+	const std::string path = testing::TempDir() + name;
+	FILE* file = fopen(path.c_str(), "wb");
+	fwrite(contents.data(), 1, contents.size(), file);
+	fclose(file);
+	return path;
+}
+
+TEST(File, MappedMatchesBuffered)
+{
+	std::string contents;
+	for(uint32 i = 0; i < 20000; ++i)
+		contents += (char)('a' + i % 26);
+	const std::string path = WriteTempFile("core_file_mapped.bin", contents);
+
+	Core::File buffered(path.c_str(), Core::File::READ_FILE);
+	Core::File mapped(path.c_str(), Core::File::READ_MAPPED);
+	EXPECT_FALSE(buffered.IsMapped());
+	EXPECT_TRUE(mapped.IsMapped());
+	ASSERT_EQ(buffered.GetSize(), contents.size());
+	ASSERT_EQ(mapped.GetSize(), contents.size());
+	EXPECT_EQ(memcmp(buffered.GetBuffer(), contents.data(), contents.size()), 0);
+	EXPECT_EQ(memcmp(mapped.GetBuffer(), contents.data(), contents.size()), 0);
+
+	const Core::Span<const char> view = mapped.GetView();
+	EXPECT_EQ(view.GetData(), mapped.GetBuffer());
+	EXPECT_EQ(view.Size(), contents.size());
+	EXPECT_EQ(view[26], 'a');
+	EXPECT_EQ(view.SubSpan(27, 3)[1], 'c');
+
+	// nothing to map, still opens
+	const std::string emptyPath = WriteTempFile("core_file_empty.bin", "");
+	Core::File empty(emptyPath.c_str(), Core::File::READ_MAPPED);
+	EXPECT_FALSE(empty.IsMapped());
+	EXPECT_EQ(empty.GetSize(), 0u);
+	EXPECT_TRUE(empty.GetView().Empty());
+
+	remove(path.c_str());
+	remove(emptyPath.c_str());
+}
+
+#ifndef _WIN32
+TEST(File, PipeFallsBackToBuffered)
+{
+	const std::string path = testing::TempDir() + "core_file_fifo";
+	remove(path.c_str());
+	ASSERT_EQ(mkfifo(path.c_str(), 0600), 0);
+
+	// more than one read chunk so the growing path is used
+	std::string contents;
+	for(uint32 i = 0; i < 10000; ++i)
+		contents += (char)('0' + i % 10);
+
+	std::thread writer([&] {
+		FILE* file = fopen(path.c_str(), "wb");
+		fwrite(contents.data(), 1, contents.size(), file);
+		fclose(file);
+	});
+
+	Core::File pipe(path.c_str(), Core::File::READ_MAPPED);
+	writer.join();
+
+	EXPECT_FALSE(pipe.IsMapped());
+	ASSERT_EQ(pipe.GetSize(), contents.size());
+	EXPECT_EQ(memcmp(pipe.GetBuffer(), contents.data(), contents.size()), 0);
+	remove(path.c_str());
+}
+#endif
+
+static std::string ReadWholeFile(const std::string& path)
+{
+	Core::File file(path.c_str(), Core::File::READ_FILE);
+	return std::string(file.GetBuffer() ? file.GetBuffer() : "", file.GetSize());
+}
+
+TEST(FileWriter, StreamsThroughRing)
+{
+	const std::string path = testing::TempDir() + "core_file_writer.bin";
+	std::string expected;
+
+	Core::FileWriter::Options options;
+	options.m_BufferSize = 4096;
+	options.m_BufferCount = 3;
+
+	const uint64 liveBefore = Core::MemoryTracker::GetStats(Core::MemoryTag::Core).m_LiveBytes;
+	Core::FileWriter writer;
+	ASSERT_TRUE(writer.Open(path.c_str(), options));
+
+	// odd sized writes so they straddle buffer boundaries, a flush in the middle of a buffer
+	char chunk[9000];
+	for(uint32 i = 0; i < 200; ++i)
+	{
+		const uint32 size = (i * 977) % sizeof(chunk) + 1;
+		for(uint32 j = 0; j < size; ++j)
+			chunk[j] = (char)(i + j * 7);
+		writer.Write(chunk, size);
+		expected.append(chunk, size);
+
+		if(i == 100)
+		{
+			EXPECT_TRUE(writer.Flush());
+			EXPECT_EQ(ReadWholeFile(path), expected);
+		}
+
+		// the ring is all the memory the writer holds on to, however much has been written
+		const uint64 live = Core::MemoryTracker::GetStats(Core::MemoryTag::Core).m_LiveBytes - liveBefore;
+		ASSERT_LE(live, 3 * 4096u + 256u);
+	}
+
+	EXPECT_EQ(writer.GetSize(), expected.size());
+	EXPECT_TRUE(writer.Close());
+	EXPECT_FALSE(writer.IsOpen());
+	EXPECT_EQ(ReadWholeFile(path), expected);
+	remove(path.c_str());
+}
+
+TEST(FileWriter, DirectAndSyncKeepExactSize)
+{
+	const std::string path = testing::TempDir() + "core_file_writer_direct.bin";
+
+	Core::FileWriter::Options options;
+	options.m_BufferSize = 8192;
+	options.m_BufferCount = 2;
+	options.m_Direct = true;
+	options.m_Sync = true;
+
+	Core::FileWriter writer;
+	ASSERT_TRUE(writer.Open(path.c_str(), options));
+
+	std::string expected(10000, 'x');
+	writer.Write(expected.data(), expected.size());
+	EXPECT_TRUE(writer.Flush());
+	EXPECT_EQ(Core::AsyncIO::GetFileSize(path.c_str()), 10000u);
+
+	// the unaligned tail written by the flush is overwritten by the next full buffer
+	const std::string more(30000, 'y');
+	writer.Write(more.data(), more.size());
+	expected += more;
+	EXPECT_TRUE(writer.Close());
+
+	EXPECT_EQ(ReadWholeFile(path), expected);
+	remove(path.c_str());
+}
+
+TEST(File, WriteModeStreamsToDisk)
+{
+	static_assert(sizeof(Core::File().GetSize()) == 8, "File sizes are 64 bit");
+
+	const std::string path = testing::TempDir() + "core_file_write.bin";
+	std::vector<uint32> values(300000);
+	for(uint32 i = 0; i < values.size(); ++i)
+		values[i] = i * 2654435761u;
+
+	Core::File file(path.c_str(), Core::File::WRITE_FILE);
+	file.Write(values.data(), sizeof(uint32), values.size() / 2);
+	file.Write(&values[values.size() / 2], sizeof(uint32), values.size() / 2);
+	EXPECT_EQ(file.GetSize(), values.size() * sizeof(uint32));
+	EXPECT_TRUE(file.Close());
+
+	const std::string written = ReadWholeFile(path);
+	ASSERT_EQ(written.size(), values.size() * sizeof(uint32));
+	EXPECT_EQ(memcmp(written.data(), values.data(), written.size()), 0);
+	remove(path.c_str());
+}
+
+TEST(Lz4, RoundTrips)
+{
+	std::mt19937 rng(7);
+	std::vector<std::string> inputs = { "", "a", "abcdefghijkl", "abcabcabcabca" };
+	inputs.push_back(std::string(100000, '\0'));
+	std::string text;
+	while(text.size() < 200000)
+		text += "vertex " + std::to_string(text.size() % 977) + " 0.5 1.0 -0.25\n";
+	inputs.push_back(text);
+	std::string noise(65536, 0);
+	for(char& c : noise)
+		c = (char)rng();
+	inputs.push_back(noise);
+
+	for(const std::string& input : inputs)
+	{
+		std::vector<char> compressed(Core::Lz4::GetBound(input.size()));
+		const uint64 size = Core::Lz4::Compress(input.data(), input.size(), compressed.data(), compressed.size());
+		ASSERT_GT(size, 0u);
+
+		std::string output(input.size(), 'x');
+		ASSERT_TRUE(Core::Lz4::Decompress(compressed.data(), size, &output[0], output.size()));
+		EXPECT_EQ(output, input);
+
+		if(!input.empty())
+		{
+			EXPECT_FALSE(Core::Lz4::Decompress(compressed.data(), size - 1, &output[0], output.size()));
+			EXPECT_FALSE(Core::Lz4::Decompress(compressed.data(), size, &output[0], output.size() - 1));
+		}
+	}
+
+	// runs compress to almost nothing, and a destination that is too small is reported instead of overrun
+	std::vector<char> compressed(Core::Lz4::GetBound(text.size()));
+	EXPECT_LT(Core::Lz4::Compress(inputs[4].data(), inputs[4].size(), compressed.data(), compressed.size()), 500u);
+	EXPECT_EQ(Core::Lz4::Compress(noise.data(), noise.size(), compressed.data(), noise.size() / 2), 0u);
+}
+
+TEST(Archive, RoundTripsEntries)
+{
+	std::string model;
+	for(uint32 i = 0; i < 5000; ++i)
+		model += "0.0 1.0 0.5 ";
+	const std::string shader = "not very compressible";
+
+	Core::ArchiveBuilder builder;
+	ASSERT_TRUE(builder.Add("cube.mdl", model.data(), model.size(), Core::Compression::Lz4));
+	ASSERT_TRUE(builder.Add("Data/Shaders/frag.hlsl", shader.data(), shader.size(), Core::Compression::Lz4));
+	ASSERT_TRUE(builder.Add("empty", "", 0));
+	EXPECT_FALSE(builder.Add("cube.mdl", "", 0));
+	EXPECT_LT(builder.GetStoredSize(), model.size() / 4);
+
+	const std::string path = testing::TempDir() + "core_archive.pak";
+	ASSERT_TRUE(builder.Save(path.c_str(), 4096));
+
+	Core::Archive archive;
+	ASSERT_TRUE(archive.Open(path.c_str()));
+	EXPECT_EQ(archive.GetEntryCount(), 3u);
+	EXPECT_EQ(archive.Find("missing.mdl"), nullptr);
+	EXPECT_TRUE(archive.GetView("missing.mdl").Empty());
+
+	// too small to shrink, stored as is and handed out straight from the mapping
+	const Core::Span<const char> view = archive.GetView("Data/Shaders/frag.hlsl");
+	ASSERT_EQ(view.Size(), shader.size());
+	EXPECT_EQ(std::string(view.GetData(), view.Size()), shader);
+	EXPECT_EQ((uintptr_t)view.GetData() % 4096, 0u);
+
+	const Core::ArchiveEntry* entry = archive.Find("cube.mdl");
+	ASSERT_NE(entry, nullptr);
+	EXPECT_EQ(entry->m_Compression, Core::Compression::Lz4);
+	EXPECT_STREQ(archive.GetName(*entry), "cube.mdl");
+	EXPECT_TRUE(archive.GetView("cube.mdl").Empty());
+
+	std::string unpacked(entry->m_Size, 0);
+	EXPECT_FALSE(archive.Read(*entry, &unpacked[0], unpacked.size() - 1));
+	ASSERT_TRUE(archive.Read(*entry, &unpacked[0], unpacked.size()));
+	EXPECT_EQ(unpacked, model);
+
+	ASSERT_NE(archive.Find("empty"), nullptr);
+	EXPECT_EQ(archive.Find("empty")->m_Size, 0u);
+	archive.Close();
+	remove(path.c_str());
+}
+
+TEST(Archive, RejectsDamagedPacks)
+{
+	Core::ArchiveBuilder builder;
+	ASSERT_TRUE(builder.Add("a", "first", 5));
+	ASSERT_TRUE(builder.Add("b", "second", 6));
+	const std::string path = testing::TempDir() + "core_archive_damaged.pak";
+	ASSERT_TRUE(builder.Save(path.c_str()));
+
+	std::string pack = ReadWholeFile(path);
+	Core::Archive archive;
+
+	// cut off in the middle of the data
+	WriteTempFile("core_archive_damaged.pak", pack.substr(0, pack.size() - 3));
+	EXPECT_FALSE(archive.Open(path.c_str()));
+
+	std::string badMagic = pack;
+	badMagic[0] = 'X';
+	WriteTempFile("core_archive_damaged.pak", badMagic);
+	EXPECT_FALSE(archive.Open(path.c_str()));
+
+	// an entry pointing past the end of the file
+	std::string badEntry = pack;
+	const uint64 farAway = ~0ull - 2;
+	memcpy(&badEntry[sizeof(Core::ArchiveHeader) + offsetof(Core::ArchiveEntry, m_Offset)], &farAway, 8);
+	WriteTempFile("core_archive_damaged.pak", badEntry);
+	EXPECT_FALSE(archive.Open(path.c_str()));
+	EXPECT_FALSE(archive.IsOpen());
+
+	WriteTempFile("core_archive_damaged.pak", pack);
+	EXPECT_TRUE(archive.Open(path.c_str()));
+	archive.Close();
+	remove(path.c_str());
+}
+
+TEST(Quantize, HalfRoundTripsAndRounds)
+{
+	const float exact[] = { 0.f, 1.f, -2.f, 0.5f, 65504.f, 6.103515625e-05f, 5.960464477539063e-08f, -1024.f };
+	for(float value : exact)
+		EXPECT_EQ(Core::Quantize::HalfToFloat(Core::Quantize::FloatToHalf(value)), value);
+
+	EXPECT_EQ(Core::Quantize::FloatToHalf(1.f), 0x3C00);
+	EXPECT_EQ(Core::Quantize::FloatToHalf(-0.f), 0x8000);
+	// halfway between 1 and the next half goes to the even one, just above it rounds up
+	EXPECT_EQ(Core::Quantize::FloatToHalf(1.f + 1.f / 2048.f), 0x3C00);
+	EXPECT_EQ(Core::Quantize::FloatToHalf(1.f + 3.f / 2048.f), 0x3C02);
+	EXPECT_EQ(Core::Quantize::FloatToHalf(1.f + 1.5f / 2048.f), 0x3C01);
+	EXPECT_EQ(Core::Quantize::FloatToHalf(70000.f), 0x7C00);
+	EXPECT_EQ(Core::Quantize::FloatToHalf(65520.f), 0x7C00);
+	EXPECT_EQ(Core::Quantize::FloatToHalf(1e-9f), 0);
+	EXPECT_EQ(Core::Quantize::FloatToHalf(3e-5f), 0x01F7); // subnormal
+
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> dist(-1000.f, 1000.f);
+	for(int i = 0; i < 10000; ++i)
+	{
+		const float value = dist(rng);
+		const float back = Core::Quantize::HalfToFloat(Core::Quantize::FloatToHalf(value));
+		EXPECT_LE(fabsf(back - value), fabsf(value) / 2048.f);
+	}
+}
+
+TEST(Quantize, OctahedralNormalError)
+{
+	std::mt19937 rng(11);
+	std::normal_distribution<float> dist(0.f, 1.f);
+	float worstDegrees = 0.f;
+	for(int i = 0; i < 100000; ++i)
+	{
+		Core::Vector3f normal(dist(rng), dist(rng), dist(rng));
+		if(i < 6)
+			normal = Core::Vector3f(i == 0 ? 1.f : (i == 1 ? -1.f : 0.f), i == 2 ? 1.f : (i == 3 ? -1.f : 0.f),
+									i == 4 ? 1.f : (i == 5 ? -1.f : 0.f));
+		normal.Normalize();
+
+		int16 encoded[2];
+		Core::Quantize::OctEncode(normal, encoded);
+		Core::Vector3f decoded = Core::Quantize::OctDecode(encoded);
+		EXPECT_NEAR(decoded.Length(), 1.f, 1e-5f);
+
+		// the angle through the cross product, acos is too coarse near 1 to measure this
+		const double cx = (double)normal.y * decoded.z - (double)normal.z * decoded.y;
+		const double cy = (double)normal.z * decoded.x - (double)normal.x * decoded.z;
+		const double cz = (double)normal.x * decoded.y - (double)normal.y * decoded.x;
+		const float degrees = static_cast<float>(asin(sqrt(cx * cx + cy * cy + cz * cz)) * 57.29577951308232);
+		worstDegrees = degrees > worstDegrees ? degrees : worstDegrees;
+	}
+	EXPECT_LT(worstDegrees, 0.005f);
+}
+
+// 36 vertices, 6 per face, the way the old cube.mdl stores them
+static std::vector<Core::MeshVertex> MakeTriangleListCube(float size)
+{
+	std::vector<Core::MeshVertex> vertices;
+	for(int face = 0; face < 6; ++face)
+	{
+		const int axis = face / 2;
+		const float sign = face % 2 ? -1.f : 1.f;
+		float normal[3] = { 0.f, 0.f, 0.f };
+		normal[axis] = sign;
+		const Core::Vector4f color(face & 1 ? 1.f : 0.25f, face & 2 ? 1.f : 0.5f, face & 4 ? 1.f : 0.f, 1.f);
+
+		const float corners[6][2] = { { -1, -1 }, { 1, -1 }, { 1, 1 }, { -1, -1 }, { 1, 1 }, { -1, 1 } };
+		for(const float* corner : corners)
+		{
+			float position[3];
+			position[axis] = sign * size;
+			position[(axis + 1) % 3] = corner[0] * size;
+			position[(axis + 2) % 3] = corner[1] * size + 0.5f;
+			Core::MeshVertex vertex;
+			vertex.position = Core::Vector4f(position[0], position[1], position[2], 1.f);
+			vertex.color = color;
+			vertex.normal = Core::Vector4f(normal[0], normal[1], normal[2], 0.f);
+			vertices.push_back(vertex);
+		}
+	}
+	return vertices;
+}
+
+TEST(Mesh, EncodeWeldsAndQuantizes)
+{
+	const std::vector<Core::MeshVertex> cube = MakeTriangleListCube(2.f);
+	const std::vector<char> file = Core::Mesh::Encode(cube.data(), static_cast<uint32>(cube.size()));
+
+	Core::Mesh::MeshView mesh;
+	ASSERT_EQ(mesh.Parse(Core::Span<const char>(file.data(), file.size())), Core::Mesh::ParseResult::Ok);
+	const Core::MeshHeader& header = mesh.GetHeader();
+	EXPECT_EQ(header.m_VertexCount, 24u);
+	EXPECT_EQ(header.m_IndexCount, 36u);
+	EXPECT_EQ(header.m_IndexSize, 2);
+	EXPECT_EQ(header.m_VertexStride, 16u);
+	ASSERT_NE(mesh.FindAttribute(Core::VertexAttribute::Normal), nullptr);
+	EXPECT_EQ(mesh.FindAttribute(Core::VertexAttribute::Normal)->m_Format, Core::VertexFormat::Oct16);
+
+	// 48 bytes per vertex before, 16 now, and the index buffer takes the duplicates out on top of that
+	const size_t rawSize = cube.size() * sizeof(Core::MeshVertex);
+	const size_t gpuSize = mesh.GetVertexData().Size() + mesh.GetIndexData().Size();
+	EXPECT_EQ(sizeof(Core::MeshVertex) / header.m_VertexStride, 3u);
+	EXPECT_LE(gpuSize * 3, rawSize);
+
+	for(uint32 i = 0; i < header.m_IndexCount; ++i)
+	{
+		const Core::MeshVertex vertex = mesh.DecodeVertex(mesh.GetIndex(i));
+		const Core::MeshVertex& original = cube[i];
+		EXPECT_NEAR(vertex.position.x, original.position.x, 2e-4f);
+		EXPECT_NEAR(vertex.position.y, original.position.y, 2e-4f);
+		EXPECT_NEAR(vertex.position.z, original.position.z, 2e-4f);
+		EXPECT_NEAR(vertex.position.w, 1.f, 1e-6f);
+		EXPECT_NEAR(vertex.normal.x, original.normal.x, 1e-4f);
+		EXPECT_NEAR(vertex.normal.y, original.normal.y, 1e-4f);
+		EXPECT_NEAR(vertex.normal.z, original.normal.z, 1e-4f);
+		EXPECT_NEAR(vertex.color.x, original.color.x, 0.51f / 255.f);
+		EXPECT_NEAR(vertex.color.y, original.color.y, 0.51f / 255.f);
+		EXPECT_NEAR(vertex.color.z, original.color.z, 0.51f / 255.f);
+	}
+
+	// float storage keeps the positions exact and skips the dequantize matrix
+	Core::Mesh::EncodeOptions floats;
+	floats.m_Position = Core::VertexFormat::Float4;
+	floats.m_Normal = Core::VertexFormat::Float4;
+	floats.m_Color = Core::VertexFormat::Float4;
+	const std::vector<char> floatFile = Core::Mesh::Encode(cube.data(), static_cast<uint32>(cube.size()), floats);
+	Core::Mesh::MeshView floatMesh;
+	ASSERT_EQ(floatMesh.Parse(Core::Span<const char>(floatFile.data(), floatFile.size())), Core::Mesh::ParseResult::Ok);
+	EXPECT_EQ(floatMesh.GetHeader().m_VertexStride, 48u);
+	EXPECT_EQ(floatMesh.GetHeader().m_VertexCount, 24u);
+	EXPECT_EQ(floatMesh.DecodeVertex(floatMesh.GetIndex(5)).position.z, cube[5].position.z);
+}
+
+TEST(Mesh, DequantizeFoldsIntoWorld)
+{
+	const std::vector<Core::MeshVertex> cube = MakeTriangleListCube(3.f);
+	const std::vector<char> file = Core::Mesh::Encode(cube.data(), static_cast<uint32>(cube.size()));
+	Core::Mesh::MeshView mesh;
+	ASSERT_EQ(mesh.Parse(Core::Span<const char>(file.data(), file.size())), Core::Mesh::ParseResult::Ok);
+
+	Core::Matrix44f world = Core::Matrix44f::CreateScaleMatrix(2.f, 0.5f, 1.f, 1.f) *
+							Core::Matrix44f::CreateRotateAroundY(0.7f);
+	world.SetTranslation(10.f, -4.f, 3.f, 1.f);
+
+	// the dequantize step and then world, as vertex_instanced.vert applies them to the raw snorm values
+	const Core::Matrix44f pushed = world * mesh.GetDequantizeMatrix();
+	const char* vertexData = mesh.GetVertexData().GetData();
+	for(uint32 i = 0; i < mesh.GetHeader().m_VertexCount; ++i)
+	{
+		int16 stored[4];
+		memcpy(stored, vertexData + i * mesh.GetHeader().m_VertexStride, sizeof(stored));
+		const Core::Vector4f raw(Core::Quantize::FromSnorm16(stored[0]), Core::Quantize::FromSnorm16(stored[1]),
+								 Core::Quantize::FromSnorm16(stored[2]), Core::Quantize::FromSnorm16(stored[3]));
+		const Core::Vector4f expected = mesh.DecodeVertex(i).position * world;
+		const Core::Vector4f actual = raw * pushed;
+		EXPECT_NEAR(actual.x, expected.x, 1e-4f);
+		EXPECT_NEAR(actual.y, expected.y, 1e-4f);
+		EXPECT_NEAR(actual.z, expected.z, 1e-4f);
+		EXPECT_NEAR(actual.w, 1.f, 1e-5f);
+	}
+}
+
+TEST(Mesh, ParseRejectsDamagedFiles)
+{
+	const std::vector<Core::MeshVertex> cube = MakeTriangleListCube(1.f);
+	const std::vector<char> file = Core::Mesh::Encode(cube.data(), static_cast<uint32>(cube.size()));
+	Core::Mesh::MeshView mesh;
+	ASSERT_EQ(mesh.Parse(Core::Span<const char>(file.data(), file.size())), Core::Mesh::ParseResult::Ok);
+	const uint32 indexOffset = mesh.GetHeader().m_IndexOffset;
+
+	// a legacy .mdl is not a mesh
+	EXPECT_EQ(mesh.Parse(Core::Span<const char>(reinterpret_cast<const char*>(cube.data()),
+												cube.size() * sizeof(Core::MeshVertex))),
+			  Core::Mesh::ParseResult::NotAMesh);
+	EXPECT_EQ(mesh.Parse(Core::Span<const char>(file.data(), sizeof(Core::MeshHeader) - 1)),
+			  Core::Mesh::ParseResult::Corrupt);
+	EXPECT_EQ(mesh.Parse(Core::Span<const char>(file.data(), file.size() - 1)), Core::Mesh::ParseResult::Corrupt);
+
+	std::vector<char> badVersion = file;
+	badVersion[offsetof(Core::MeshHeader, m_Version)] = 9;
+	EXPECT_EQ(mesh.Parse(Core::Span<const char>(badVersion.data(), badVersion.size())),
+			  Core::Mesh::ParseResult::WrongVersion);
+
+	std::vector<char> badIndex = file;
+	const uint16 outOfRange = 24;
+	memcpy(&badIndex[indexOffset + 2 * sizeof(uint16)], &outOfRange, sizeof(outOfRange));
+	EXPECT_EQ(mesh.Parse(Core::Span<const char>(badIndex.data(), badIndex.size())), Core::Mesh::ParseResult::Corrupt);
+
+	std::vector<char> badStride = file;
+	const uint32 tinyStride = 4;
+	memcpy(&badStride[offsetof(Core::MeshHeader, m_VertexStride)], &tinyStride, sizeof(tinyStride));
+	EXPECT_EQ(mesh.Parse(Core::Span<const char>(badStride.data(), badStride.size())), Core::Mesh::ParseResult::Corrupt);
+}
+
+TEST(Mesh, OlderVersionsAreNotTakenForLegacyModels)
+{
+	const std::vector<Core::MeshVertex> cube = MakeTriangleListCube(1.f);
+	const std::vector<char> file = Core::Mesh::Encode(cube.data(), static_cast<uint32>(cube.size()));
+	Core::Mesh::MeshView mesh;
+
+	// v1 had no meshlets and v2 no LOD table, their 72 and 88 byte headers start the same way as this one
+	const uint16 versions[] = { 1, 2 };
+	const uint64 headerSizes[] = { 72, 88 };
+	for(uint32 i = 0; i < 2; ++i)
+	{
+		std::vector<char> old = file;
+		memcpy(&old[offsetof(Core::MeshHeader, m_Version)], &versions[i], sizeof(uint16));
+		EXPECT_EQ(mesh.Parse(Core::Span<const char>(old.data(), old.size())), Core::Mesh::ParseResult::WrongVersion);
+		EXPECT_EQ(mesh.Parse(Core::Span<const char>(old.data(), headerSizes[i])),
+				  Core::Mesh::ParseResult::WrongVersion);
+		EXPECT_EQ(mesh.GetHeader().m_VertexCount, 0u);
+	}
+
+	// too short to even hold the version
+	EXPECT_EQ(mesh.Parse(Core::Span<const char>(file.data(), 5)), Core::Mesh::ParseResult::Corrupt);
+	EXPECT_EQ(mesh.Parse(Core::Span<const char>(file.data(), 3)), Core::Mesh::ParseResult::NotAMesh);
+}
+
+// a bumpy size x size quad grid with its triangles shuffled, the worst case for the caches
+static void MakeShuffledGrid(uint32 size, std::vector<Core::Vector3f>& positions, std::vector<uint32>& indices)
+{
+	const uint32 row = size + 1;
+	positions.clear();
+	for(uint32 y = 0; y < row; ++y)
+	{
+		for(uint32 x = 0; x < row; ++x)
+			positions.push_back(Core::Vector3f((float)x, (float)y, sinf(x * 0.3f) * cosf(y * 0.2f)));
+	}
+
+	std::vector<uint32> triangles;
+	for(uint32 y = 0; y < size; ++y)
+	{
+		for(uint32 x = 0; x < size; ++x)
+		{
+			const uint32 v = y * row + x;
+			const uint32 quad[6] = { v, v + 1, v + row, v + 1, v + row + 1, v + row };
+			triangles.insert(triangles.end(), quad, quad + 6);
+		}
+	}
+
+	std::vector<uint32> order(triangles.size() / 3);
+	for(uint32 i = 0; i < order.size(); ++i)
+		order[i] = i;
+	std::shuffle(order.begin(), order.end(), std::mt19937(3));
+
+	indices.clear();
+	for(uint32 t : order)
+		indices.insert(indices.end(), &triangles[t * 3], &triangles[t * 3] + 3);
+}
+
+// triangles as sorted triples of their corners, rotated so the smallest index comes first to keep the winding
+static std::vector<uint64> TriangleSet(const std::vector<uint32>& indices)
+{
+	std::vector<uint64> set;
+	for(size_t i = 0; i < indices.size(); i += 3)
+	{
+		uint32 corner = indices[i] < indices[i + 1] ? (indices[i] < indices[i + 2] ? 0 : 2)
+													: (indices[i + 1] < indices[i + 2] ? 1 : 2);
+		const uint64 a = indices[i + corner];
+		const uint64 b = indices[i + (corner + 1) % 3];
+		const uint64 c = indices[i + (corner + 2) % 3];
+		set.push_back((a << 42) | (b << 21) | c);
+	}
+	std::sort(set.begin(), set.end());
+	return set;
+}
+
+TEST(MeshOptimizer, VertexCacheAndOverdraw)
+{
+	std::vector<Core::Vector3f> positions;
+	std::vector<uint32> indices;
+	MakeShuffledGrid(64, positions, indices);
+	const uint32 vertexCount = static_cast<uint32>(positions.size());
+	const uint32 indexCount = static_cast<uint32>(indices.size());
+	const std::vector<uint64> triangles = TriangleSet(indices);
+
+	const Core::MeshOptimizer::CacheStats shuffled =
+		Core::MeshOptimizer::AnalyzeVertexCache(indices.data(), indexCount, vertexCount);
+	EXPECT_GT(shuffled.m_Acmr, 2.5f);
+
+	Core::MeshOptimizer::OptimizeVertexCache(indices.data(), indexCount, vertexCount);
+	const Core::MeshOptimizer::CacheStats cached =
+		Core::MeshOptimizer::AnalyzeVertexCache(indices.data(), indexCount, vertexCount);
+	EXPECT_LT(cached.m_Acmr, 0.8f);
+	EXPECT_LT(cached.m_Atvr, 1.6f);
+	EXPECT_EQ(TriangleSet(indices), triangles);
+
+	Core::MeshOptimizer::OptimizeOverdraw(indices.data(), indexCount, positions.data(), vertexCount, 1.05f);
+	const Core::MeshOptimizer::CacheStats sorted =
+		Core::MeshOptimizer::AnalyzeVertexCache(indices.data(), indexCount, vertexCount);
+	EXPECT_LT(sorted.m_Acmr, cached.m_Acmr * 1.1f);
+	EXPECT_EQ(TriangleSet(indices), triangles);
+}
+
+TEST(MeshOptimizer, VertexFetchFollowsFirstUse)
+{
+	std::vector<Core::Vector3f> positions;
+	std::vector<uint32> indices;
+	MakeShuffledGrid(32, positions, indices);
+	const uint32 vertexCount = static_cast<uint32>(positions.size()) + 5; // a few nothing references
+	const uint32 indexCount = static_cast<uint32>(indices.size());
+	positions.resize(vertexCount);
+	const uint32 stride = sizeof(Core::Vector3f);
+	Core::MeshOptimizer::OptimizeVertexCache(indices.data(), indexCount, vertexCount);
+
+	const std::vector<Core::Vector3f> original = positions;
+	const std::vector<uint32> originalIndices = indices;
+	const float overfetch = Core::MeshOptimizer::AnalyzeVertexFetch(indices.data(), indexCount, vertexCount, stride);
+
+	const uint32 used = Core::MeshOptimizer::OptimizeVertexFetch(reinterpret_cast<char*>(positions.data()),
+																 indices.data(), indexCount, vertexCount, stride);
+	EXPECT_EQ(used, vertexCount - 5);
+
+	uint32 next = 0;
+	for(uint32 i = 0; i < indexCount; ++i)
+	{
+		ASSERT_LE(indices[i], next);
+		next = indices[i] == next ? next + 1 : next;
+		EXPECT_EQ(memcmp(&positions[indices[i]], &original[originalIndices[i]], stride), 0);
+	}
+
+	const float remapped = Core::MeshOptimizer::AnalyzeVertexFetch(indices.data(), indexCount, used, stride);
+	EXPECT_LE(remapped, overfetch);
+	EXPECT_LT(remapped, 1.5f);
+}
+
+TEST(MeshOptimizer, OptimizeMeshKeepsTriangles)
+{
+	std::vector<Core::Vector3f> positions;
+	std::vector<uint32> indices;
+	MakeShuffledGrid(40, positions, indices);
+
+	std::vector<Core::MeshVertex> vertices;
+	for(uint32 index : indices)
+	{
+		Core::MeshVertex vertex;
+		vertex.position = Core::Vector4f(positions[index].x, positions[index].y, positions[index].z, 1.f);
+		vertex.normal = Core::Vector4f(0.f, 0.f, 1.f, 0.f);
+		vertex.color = Core::Vector4f(1.f, 0.5f, 0.25f, 1.f);
+		vertices.push_back(vertex);
+	}
+
+	std::vector<char> file = Core::Mesh::Encode(vertices.data(), static_cast<uint32>(vertices.size()));
+	Core::Mesh::MeshView mesh;
+	ASSERT_EQ(mesh.Parse(Core::Span<const char>(file.data(), file.size())), Core::Mesh::ParseResult::Ok);
+	const uint32 vertexCount = mesh.GetHeader().m_VertexCount;
+	EXPECT_EQ(vertexCount, 41u * 41u);
+
+	Core::MeshOptimizer::MeshStats before;
+	Core::MeshOptimizer::MeshStats after;
+	ASSERT_TRUE(Core::MeshOptimizer::OptimizeMesh(file, 1.05f, &before, &after));
+	EXPECT_LT(after.m_Cache.m_Acmr, before.m_Cache.m_Acmr * 0.5f);
+	EXPECT_LE(after.m_Overfetch, before.m_Overfetch);
+
+	ASSERT_EQ(mesh.Parse(Core::Span<const char>(file.data(), file.size())), Core::Mesh::ParseResult::Ok);
+	EXPECT_EQ(mesh.GetHeader().m_VertexCount, vertexCount);
+	EXPECT_EQ(mesh.GetHeader().m_IndexCount, indices.size());
+
+	// compare by grid position, the vertex numbering is different now
+	auto gridKey = [](const Core::Vector4f& p) { return static_cast<uint32>(lroundf(p.x) * 64 + lroundf(p.y)); };
+	std::vector<uint32> expected;
+	std::vector<uint32> actual;
+	for(uint32 i = 0; i < mesh.GetHeader().m_IndexCount; ++i)
+	{
+		expected.push_back(gridKey(vertices[i].position));
+		actual.push_back(gridKey(mesh.DecodeVertex(mesh.GetIndex(i)).position));
+	}
+	EXPECT_EQ(TriangleSet(actual), TriangleSet(expected));
+}
+
+TEST(Meshlets, BuildStaysWithinLimits)
+{
+	std::vector<Core::Vector3f> positions;
+	std::vector<uint32> indices;
+	MakeShuffledGrid(64, positions, indices);
+	const uint32 vertexCount = static_cast<uint32>(positions.size());
+	const uint32 indexCount = static_cast<uint32>(indices.size());
+	Core::MeshOptimizer::OptimizeVertexCache(indices.data(), indexCount, vertexCount);
+	const std::vector<uint64> triangles = TriangleSet(indices);
+
+	const Core::Mesh::MeshletData data =
+		Core::Mesh::BuildMeshlets(indices.data(), indexCount, positions.data(), nullptr, vertexCount);
+	EXPECT_EQ(TriangleSet(indices), triangles);
+
+	uint32 nextTriangle = 0;
+	for(const Core::Meshlet& meshlet : data.m_Meshlets)
+	{
+		ASSERT_LE(meshlet.m_VertexCount, Core::Mesh::s_MaxMeshletVertices);
+		ASSERT_LE(meshlet.m_TriangleCount, Core::Mesh::s_MaxMeshletTriangles);
+		ASSERT_GT(meshlet.m_TriangleCount, 0);
+		EXPECT_EQ(meshlet.m_TriangleOffset, nextTriangle);
+		nextTriangle += meshlet.m_TriangleCount;
+
+		const Core::Vector3f center(meshlet.m_Center[0], meshlet.m_Center[1], meshlet.m_Center[2]);
+		const Core::Vector3f axis(meshlet.m_ConeAxis[0], meshlet.m_ConeAxis[1], meshlet.m_ConeAxis[2]);
+		const float cosSpread = sqrtf(1.f - meshlet.m_ConeCutoff * meshlet.m_ConeCutoff);
+		for(uint32 t = 0; t < meshlet.m_TriangleCount; ++t)
+		{
+			Core::Vector3f corners[3];
+			for(uint32 k = 0; k < 3; ++k)
+			{
+				// the local triangle names the same vertex as the index buffer at the meshlet's range
+				const uint8 local = data.m_Triangles[(meshlet.m_TriangleOffset + t) * 3 + k];
+				ASSERT_LT(local, meshlet.m_VertexCount);
+				const uint32 vertex = data.m_Vertices[meshlet.m_VertexOffset + local];
+				ASSERT_EQ(vertex, indices[(meshlet.m_TriangleOffset + t) * 3 + k]);
+
+				corners[k] = positions[vertex];
+				Core::Vector3f offset = corners[k] - center;
+				EXPECT_LE(offset.Length(), meshlet.m_Radius * 1.0001f);
+			}
+
+			if(meshlet.m_ConeCutoff < 1.f)
+			{
+				Core::Vector3f normal = Core::Cross(corners[1] - corners[0], corners[2] - corners[0]);
+				normal.Normalize();
+				EXPECT_GE(Core::Dot(normal, axis), cosSpread - 1e-4f);
+			}
+		}
+	}
+	EXPECT_EQ(nextTriangle, indexCount / 3);
+
+	// a grid is well connected, the meshlets should come out nearly full
+	const float averageTriangles = static_cast<float>(indexCount / 3) / data.m_Meshlets.size();
+	EXPECT_GT(averageTriangles, 80.f);
+}
+
+TEST(Meshlets, StoredInMeshFile)
+{
+	const std::vector<Core::MeshVertex> cube = MakeTriangleListCube(1.f);
+	std::vector<char> file = Core::Mesh::Encode(cube.data(), static_cast<uint32>(cube.size()));
+	ASSERT_TRUE(Core::Mesh::AddMeshlets(file));
+
+	Core::Mesh::MeshView mesh;
+	ASSERT_EQ(mesh.Parse(Core::Span<const char>(file.data(), file.size())), Core::Mesh::ParseResult::Ok);
+	ASSERT_EQ(mesh.GetMeshlets().Size(), 1u);
+	const Core::Meshlet& meshlet = mesh.GetMeshlets()[0];
+	EXPECT_EQ(meshlet.m_VertexCount, 24);
+	EXPECT_EQ(meshlet.m_TriangleCount, 12);
+	EXPECT_EQ(meshlet.m_ConeCutoff, 1.f); // faces all around, nothing to cull by normal
+	float radius = 0.f;
+	for(uint32 v = 0; v < 24; ++v)
+	{
+		const Core::Vector4f p = mesh.DecodeVertex(v).position;
+		Core::Vector3f offset(p.x - meshlet.m_Center[0], p.y - meshlet.m_Center[1], p.z - meshlet.m_Center[2]);
+		radius = fmaxf(radius, offset.Length());
+	}
+	EXPECT_NEAR(meshlet.m_Radius, radius, 1e-4f);
+
+	// running it again replaces the section instead of appending
+	const size_t size = file.size();
+	ASSERT_TRUE(Core::Mesh::AddMeshlets(file));
+	EXPECT_EQ(file.size(), size);
+
+	const uint32 meshletOffset = mesh.GetHeader().m_MeshletOffset;
+	std::vector<char> badLocal = file;
+	badLocal[meshletOffset + sizeof(Core::Meshlet) + 24 * sizeof(uint32) + 5] = 24;
+	EXPECT_EQ(mesh.Parse(Core::Span<const char>(badLocal.data(), badLocal.size())), Core::Mesh::ParseResult::Corrupt);
+
+	std::vector<char> badVertex = file;
+	const uint32 outOfRange = 24;
+	memcpy(&badVertex[meshletOffset + sizeof(Core::Meshlet)], &outOfRange, sizeof(outOfRange));
+	EXPECT_EQ(mesh.Parse(Core::Span<const char>(badVertex.data(), badVertex.size())), Core::Mesh::ParseResult::Corrupt);
+
+	std::vector<char> badCount = file;
+	const uint16 tooMany = 125;
+	memcpy(&badCount[meshletOffset + offsetof(Core::Meshlet, m_TriangleCount)], &tooMany, sizeof(tooMany));
+	EXPECT_EQ(mesh.Parse(Core::Span<const char>(badCount.data(), badCount.size())), Core::Mesh::ParseResult::Corrupt);
+
+	// optimising invalidates the meshlets, they are dropped
+	ASSERT_TRUE(Core::MeshOptimizer::OptimizeMesh(file));
+	ASSERT_EQ(mesh.Parse(Core::Span<const char>(file.data(), file.size())), Core::Mesh::ParseResult::Ok);
+	EXPECT_EQ(mesh.GetMeshlets().Size(), 0u);
+}
+
+TEST(Frustum, SpheresAgainstPerspective)
+{
+	// camera at z = -10 looking down +z, the way Camera builds its view projection
+	Core::Matrix44f viewInverse = Core::Matrix44f::Identity();
+	viewInverse.SetTranslation(0.f, 0.f, 10.f, 1.f);
+	const Core::Matrix44f projection = Core::VKCreatePerspectiveMatrix(0.1f, 100.f, 1.f, 90.f);
+	const Core::Frustum frustum = Core::Frustum::FromViewProjection(projection * viewInverse);
+
+	EXPECT_TRUE(frustum.IsSphereVisible(Core::Vector3f(0.f, 0.f, 0.f), 1.f));
+	EXPECT_TRUE(frustum.IsSphereVisible(Core::Vector3f(5.f, -5.f, 0.f), 0.1f));
+	EXPECT_FALSE(frustum.IsSphereVisible(Core::Vector3f(0.f, 0.f, -20.f), 1.f)); // behind
+	EXPECT_FALSE(frustum.IsSphereVisible(Core::Vector3f(30.f, 0.f, 0.f), 1.f));
+	EXPECT_FALSE(frustum.IsSphereVisible(Core::Vector3f(0.f, -30.f, 0.f), 1.f));
+	EXPECT_FALSE(frustum.IsSphereVisible(Core::Vector3f(0.f, 0.f, 5000.f), 1.f)); // past the far plane
+	EXPECT_TRUE(frustum.IsSphereVisible(Core::Vector3f(30.f, 0.f, 0.f), 25.f)); // touching the side
+
+	// against the projection itself, every point the frustum keeps lands inside the clip volume
+	std::mt19937 rng(5);
+	std::uniform_real_distribution<float> dist(-60.f, 60.f);
+	for(int i = 0; i < 2000; ++i)
+	{
+		const Core::Vector3f point(dist(rng), dist(rng), dist(rng));
+		const Core::Vector4f clip = Core::Vector4f(point.x, point.y, point.z, 1.f) * (projection * viewInverse);
+		const bool inside = fabsf(clip.x) <= clip.w && fabsf(clip.y) <= clip.w && clip.z >= 0.f && clip.z <= clip.w;
+		EXPECT_EQ(frustum.IsSphereVisible(point, 0.f), inside);
+	}
+}
+
+// a closed sphere with outward normals, one vertex per triangle corner like a .mdl
+static std::vector<Core::MeshVertex> MakeSphere(float radius, uint32 rings, uint32 segments)
+{
+	auto at = [&](uint32 ring, uint32 segment) {
+		const float theta = 3.14159265f * ring / rings;
+		const float phi = 2.f * 3.14159265f * segment / segments;
+		Core::MeshVertex vertex;
+		vertex.normal = Core::Vector4f(sinf(theta) * cosf(phi), cosf(theta), sinf(theta) * sinf(phi), 0.f);
+		vertex.position =
+			Core::Vector4f(vertex.normal.x * radius, vertex.normal.y * radius, vertex.normal.z * radius, 1.f);
+		vertex.color = Core::Vector4f(1.f, 1.f, 1.f, 1.f);
+		return vertex;
+	};
+
+	std::vector<Core::MeshVertex> vertices;
+	for(uint32 ring = 0; ring < rings; ++ring)
+	{
+		for(uint32 segment = 0; segment < segments; ++segment)
+		{
+			const Core::MeshVertex quad[6] = { at(ring, segment),		at(ring + 1, segment), at(ring, segment + 1),
+											   at(ring, segment + 1),	at(ring + 1, segment),
+											   at(ring + 1, segment + 1) };
+			vertices.insert(vertices.end(), quad, quad + 6);
+		}
+	}
+	return vertices;
+}
+
+TEST(MeshletCulling, ConservativeAgainstTriangles)
+{
+	const std::vector<Core::MeshVertex> sphere = MakeSphere(2.f, 48, 96);
+	std::vector<char> file = Core::Mesh::Encode(sphere.data(), static_cast<uint32>(sphere.size()));
+	ASSERT_TRUE(Core::MeshOptimizer::OptimizeMesh(file));
+	ASSERT_TRUE(Core::Mesh::AddMeshlets(file));
+	Core::Mesh::MeshView mesh;
+	ASSERT_EQ(mesh.Parse(Core::Span<const char>(file.data(), file.size())), Core::Mesh::ParseResult::Ok);
+	const Core::Span<const Core::Meshlet> meshlets = mesh.GetMeshlets();
+	ASSERT_GT(meshlets.Size(), 10u);
+
+	Core::Matrix44f viewInverse = Core::Matrix44f::Identity();
+	viewInverse.SetTranslation(0.f, 0.f, 10.f, 1.f);
+	const Core::Matrix44f projection = Core::VKCreatePerspectiveMatrix(0.1f, 100.f, 1.f, 60.f);
+	const Core::Frustum frustum = Core::Frustum::FromViewProjection(projection * viewInverse);
+	const Core::Vector3f camera(0.f, 0.f, -10.f);
+
+	Core::Matrix44f worlds[3] = { Core::Matrix44f::Identity(),
+								  Core::Matrix44f::CreateScaleMatrix(1.5f, 1.5f, 1.5f, 1.f),
+								  Core::Matrix44f::CreateScaleMatrix(1.f, 3.f, 1.f, 1.f) };
+	worlds[1].SetTranslation(4.f, 1.f, 2.f, 1.f);
+
+	std::vector<uint32> visible(meshlets.Size());
+	for(const Core::Matrix44f& world : worlds)
+	{
+		const uint32 count = Core::Mesh::CullMeshlets(meshlets, world, frustum, camera, visible.data());
+		std::vector<bool> kept(meshlets.Size(), false);
+		for(uint32 i = 0; i < count; ++i)
+			kept[visible[i]] = true;
+
+		// every triangle of a culled meshlet has to be invisible: outside one plane or facing away
+		uint32 culledByCone = 0;
+		for(uint32 m = 0; m < meshlets.Size(); ++m)
+		{
+			if(kept[m])
+				continue;
+
+			const Core::Meshlet& meshlet = meshlets[m];
+			const Core::Mesh::MeshletBounds bounds = Core::Mesh::TransformBounds(meshlet, world);
+			culledByCone += frustum.IsSphereVisible(bounds.m_Center, bounds.m_Radius) ? 1 : 0;
+			for(uint32 t = meshlet.m_TriangleOffset; t < meshlet.m_TriangleOffset + meshlet.m_TriangleCount; ++t)
+			{
+				Core::Vector3f corners[3];
+				Core::Vector3f normalSum(0.f, 0.f, 0.f);
+				for(uint32 k = 0; k < 3; ++k)
+				{
+					const Core::MeshVertex vertex = mesh.DecodeVertex(mesh.GetIndex(t * 3 + k));
+					const Core::Vector4f p = vertex.position * world;
+					corners[k] = Core::Vector3f(p.x, p.y, p.z);
+					normalSum += Core::Vector3f(vertex.normal.x, vertex.normal.y, vertex.normal.z);
+				}
+
+				bool outside = false;
+				for(const Core::Vector4f& plane : frustum.m_Planes)
+				{
+					bool allOut = true;
+					for(const Core::Vector3f& c : corners)
+						allOut = allOut && plane.x * c.x + plane.y * c.y + plane.z * c.z + plane.w < 0.f;
+					outside = outside || allOut;
+				}
+
+				Core::Vector3f normal = Core::Cross(corners[1] - corners[0], corners[2] - corners[0]);
+				if(Core::Dot(normal, normalSum) < 0.f)
+					normal *= -1.f;
+				const bool backfacing = Core::Dot(normal, corners[0] - camera) >= 0.f;
+				ASSERT_TRUE(outside || backfacing) << "meshlet " << m << " triangle " << t;
+			}
+		}
+
+		if(&world == &worlds[2])
+			EXPECT_EQ(culledByCone, 0u); // non uniform scale, the cones are not trusted
+		else
+			EXPECT_GT(culledByCone, meshlets.Size() / 4); // the far side of the sphere
+	}
+}
+
+// positions and indices of a .mesh's LOD 0, decoded
+static void DecodeMesh(const Core::Mesh::MeshView& mesh, std::vector<Core::Vector3f>& positions,
+					   std::vector<uint32>& indices)
+{
+	positions.resize(mesh.GetHeader().m_VertexCount);
+	for(uint32 v = 0; v < positions.size(); ++v)
+	{
+		const Core::Vector4f p = mesh.DecodeVertex(v).position;
+		positions[v] = Core::Vector3f(p.x, p.y, p.z);
+	}
+	indices.resize(mesh.GetLods()[0].m_IndexCount);
+	for(uint32 i = 0; i < indices.size(); ++i)
+		indices[i] = mesh.GetIndex(i);
+}
+
+TEST(MeshSimplifier, SphereStaysClosedAndClose)
+{
+	const std::vector<Core::MeshVertex> sphere = MakeSphere(2.f, 48, 96);
+	const std::vector<char> file = Core::Mesh::Encode(sphere.data(), static_cast<uint32>(sphere.size()));
+	Core::Mesh::MeshView mesh;
+	ASSERT_EQ(mesh.Parse(Core::Span<const char>(file.data(), file.size())), Core::Mesh::ParseResult::Ok);
+	std::vector<Core::Vector3f> positions;
+	std::vector<uint32> indices;
+	DecodeMesh(mesh, positions, indices);
+	const uint32 vertexCount = static_cast<uint32>(positions.size());
+	const uint32 indexCount = static_cast<uint32>(indices.size());
+
+	// with room in the budget it gets down to the target
+	std::vector<uint32> lod(indexCount);
+	const uint32 target = indexCount / 10 / 3 * 3;
+	float error = 0.f;
+	const uint32 count =
+		Core::MeshSimplifier::Simplify(lod.data(), indices.data(), indexCount, positions.data(), vertexCount, target,
+									   1.f, &error);
+	EXPECT_LE(count, target);
+	EXPECT_GT(count, target / 2);
+	EXPECT_GT(error, 0.f);
+	EXPECT_LT(error, 0.2f);
+
+	// still closed, every edge has a triangle on each side, nothing degenerate or flipped outwards in
+	std::set<std::pair<uint32, uint32>> edges;
+	for(uint32 t = 0; t < count; t += 3)
+	{
+		const Core::Vector3f& a = positions[lod[t]];
+		Core::Vector3f normal = Core::Cross(positions[lod[t + 1]] - a, positions[lod[t + 2]] - a);
+		Core::Vector3f centroid = (a + positions[lod[t + 1]] + positions[lod[t + 2]]) / 3.f;
+		ASSERT_GT(normal.Length(), 0.f);
+		EXPECT_LT(Core::Dot(normal, centroid), 0.f); // MakeSphere winds clockwise seen from outside
+
+		// every vertex is still on the sphere, the flat triangles between them can't sink far below it
+		EXPECT_GT(centroid.Length(), 2.f - 0.4f);
+		for(uint32 k = 0; k < 3; ++k)
+			EXPECT_TRUE(edges.insert({ lod[t + k], lod[t + (k + 1) % 3] }).second);
+	}
+	for(const std::pair<uint32, uint32>& edge : edges)
+		EXPECT_EQ(edges.count({ edge.second, edge.first }), 1u);
+
+	// a tight budget stops it early, the error stays inside it
+	const uint32 tight = Core::MeshSimplifier::Simplify(lod.data(), indices.data(), indexCount, positions.data(),
+														 vertexCount, target, 1e-3f, &error);
+	EXPECT_GT(tight, count);
+	EXPECT_LE(error, 1e-3f);
+}
+
+TEST(MeshSimplifier, KeepsSeamsAndBorders)
+{
+	// a flat grid simplifies to almost nothing but keeps its outline
+	std::vector<Core::Vector3f> grid;
+	std::vector<uint32> indices;
+	MakeShuffledGrid(32, grid, indices);
+	for(Core::Vector3f& p : grid)
+		p.z = 0.f;
+
+	// and a seam down the middle, the right half gets its own copies of the x = 16 vertices
+	const uint32 gridVertexCount = static_cast<uint32>(grid.size());
+	for(uint32 y = 0; y <= 32; ++y)
+		grid.push_back(grid[y * 33 + 16]);
+	for(uint32 t = 0; t < indices.size(); t += 3)
+	{
+		const float x = (grid[indices[t]].x + grid[indices[t + 1]].x + grid[indices[t + 2]].x) / 3.f;
+		for(uint32 k = 0; k < 3 && x > 16.f; ++k)
+		{
+			if(indices[t + k] < gridVertexCount && grid[indices[t + k]].x == 16.f)
+				indices[t + k] = gridVertexCount + indices[t + k] / 33;
+		}
+	}
+
+	std::vector<uint32> lod(indices.size());
+	const uint32 indexCount = static_cast<uint32>(indices.size());
+	float error = 1.f;
+	const uint32 count = Core::MeshSimplifier::Simplify(lod.data(), indices.data(), indexCount, grid.data(),
+														static_cast<uint32>(grid.size()), 0, 1e-3f, &error);
+	EXPECT_LT(count, indexCount / 10);
+	EXPECT_LT(error, 1e-3f);
+
+	float area = 0.f;
+	std::set<float> seam;
+	for(uint32 t = 0; t < count; t += 3)
+	{
+		Core::Vector3f normal =
+			Core::Cross(grid[lod[t + 1]] - grid[lod[t]], grid[lod[t + 2]] - grid[lod[t]]);
+		area += normal.Length() * 0.5f;
+		for(uint32 k = 0; k < 3; ++k)
+		{
+			if(grid[lod[t + k]].x == 16.f)
+				seam.insert(grid[lod[t + k]].y);
+		}
+	}
+	EXPECT_EQ(seam.size(), 33u);
+	EXPECT_NEAR(area, 32.f * 32.f, 1e-2f);
+}
+
+TEST(MeshSimplifier, LodChainInMeshFile)
+{
+	const std::vector<Core::MeshVertex> sphere = MakeSphere(2.f, 48, 96);
+	std::vector<char> file = Core::Mesh::Encode(sphere.data(), static_cast<uint32>(sphere.size()));
+	Core::Mesh::MeshView mesh;
+	ASSERT_EQ(mesh.Parse(Core::Span<const char>(file.data(), file.size())), Core::Mesh::ParseResult::Ok);
+	EXPECT_EQ(mesh.GetLods().Size(), 1u);
+	EXPECT_NEAR(mesh.GetHeader().m_BoundsRadius, 2.f, 1e-3f);
+	const uint32 baseCount = mesh.GetHeader().m_IndexCount;
+
+	Core::MeshSimplifier::LodOptions options;
+	options.m_LodCount = 5;
+	ASSERT_TRUE(Core::MeshSimplifier::AddLods(file, options));
+	ASSERT_TRUE(Core::MeshOptimizer::OptimizeMesh(file));
+	ASSERT_TRUE(Core::Mesh::AddMeshlets(file));
+	ASSERT_EQ(mesh.Parse(Core::Span<const char>(file.data(), file.size())), Core::Mesh::ParseResult::Ok);
+
+	const Core::Span<const Core::MeshLod> lods = mesh.GetLods();
+	ASSERT_GE(lods.Size(), 3u);
+	EXPECT_EQ(lods[0].m_IndexCount, baseCount);
+	EXPECT_EQ(lods[0].m_Error, 0.f);
+	uint32 total = 0;
+	for(uint32 i = 0; i < lods.Size(); ++i)
+	{
+		EXPECT_EQ(lods[i].m_IndexOffset, total);
+		total += lods[i].m_IndexCount;
+		if(i > 0)
+		{
+			EXPECT_LE(lods[i].m_IndexCount, lods[i - 1].m_IndexCount * 0.6f);
+			EXPECT_GE(lods[i].m_Error, lods[i - 1].m_Error);
+			EXPECT_LE(lods[i].m_Error, options.m_ErrorBudget * 2.f);
+		}
+	}
+	EXPECT_EQ(total, mesh.GetHeader().m_IndexCount);
+
+	uint32 meshletTriangles = 0;
+	for(const Core::Meshlet& meshlet : mesh.GetMeshlets())
+		meshletTriangles += meshlet.m_TriangleCount;
+	EXPECT_EQ(meshletTriangles * 3, baseCount);
+
+	// going back to a single LOD gives the same LOD 0
+	options.m_LodCount = 1;
+	ASSERT_TRUE(Core::MeshSimplifier::AddLods(file, options));
+	ASSERT_EQ(mesh.Parse(Core::Span<const char>(file.data(), file.size())), Core::Mesh::ParseResult::Ok);
+	EXPECT_EQ(mesh.GetLods().Size(), 1u);
+	EXPECT_EQ(mesh.GetHeader().m_IndexCount, baseCount);
+	EXPECT_EQ(mesh.GetMeshlets().Size(), 0u);
+
+	std::vector<char> damaged = file;
+	Core::MeshHeader header;
+	memcpy(&header, damaged.data(), sizeof(header));
+	header.m_Lods[0].m_IndexCount += 3;
+	memcpy(damaged.data(), &header, sizeof(header));
+	EXPECT_EQ(mesh.Parse(Core::Span<const char>(damaged.data(), damaged.size())), Core::Mesh::ParseResult::Corrupt);
+	header.m_Lods[0].m_IndexCount -= 3;
+	header.m_LodCount = 0;
+	memcpy(damaged.data(), &header, sizeof(header));
+	EXPECT_EQ(mesh.Parse(Core::Span<const char>(damaged.data(), damaged.size())), Core::Mesh::ParseResult::Corrupt);
+}
+
+TEST(LodSelection, ScreenErrorWithHysteresis)
+{
+	// 90 degrees over 1000 pixels, one unit at distance one covers half the screen
+	const Core::Matrix44f projection = Core::VKCreatePerspectiveMatrix(0.1f, 100.f, 1.f, 90.f);
+	const float lodScale = Core::Mesh::GetLodScale(projection, 1000.f);
+	EXPECT_NEAR(lodScale, 500.f, 0.5f);
+
+	Core::Matrix44f world = Core::Matrix44f::CreateScaleMatrix(2.f, 2.f, 2.f, 1.f);
+	world.SetTranslation(0.f, 0.f, 50.f, 1.f);
+	const float pixelsPerUnit = Core::Mesh::GetPixelsPerUnit(Core::Vector3f(0.f, 0.f, 0.f), 1.f, world,
+															 Core::Vector3f(0.f, 0.f, 0.f), lodScale);
+	EXPECT_NEAR(pixelsPerUnit, lodScale * 2.f / 48.f, 1e-3f);
+	EXPECT_GT(Core::Mesh::GetPixelsPerUnit(Core::Vector3f(0.f, 0.f, 0.f), 1.f, world,
+										   Core::Vector3f(0.5f, 0.f, 50.f), lodScale),
+			  1e5f);
+
+	const Core::MeshLod lodTable[4] = { { 0, 300, 0.f }, { 300, 150, 0.01f }, { 450, 75, 0.04f }, { 525, 36, 0.16f } };
+	const Core::Span<const Core::MeshLod> lods(lodTable, 4);
+
+	// lod 2 covers 0.9 pixels: allowed, but not far enough under the threshold to switch to from a finer one
+	EXPECT_EQ(Core::Mesh::SelectLod(lods, 22.5f, 0), 1u);
+	EXPECT_EQ(Core::Mesh::SelectLod(lods, 22.5f, 1), 1u);
+	EXPECT_EQ(Core::Mesh::SelectLod(lods, 22.5f, 2), 2u);
+	EXPECT_EQ(Core::Mesh::SelectLod(lods, 22.5f, 3), 2u); // lod 3 would cover 3.6 pixels
+	EXPECT_EQ(Core::Mesh::SelectLod(lods, 1e4f, 3), 0u);
+	EXPECT_EQ(Core::Mesh::SelectLod(lods, 0.f, 0), 3u);
+
+	// walking away and back, the switches happen at different distances so there is no flicker in between
+	uint32 lod = 0;
+	std::vector<uint32> away;
+	for(float distance = 1.f; distance < 2000.f; distance *= 1.05f)
+	{
+		lod = Core::Mesh::SelectLod(lods, lodScale / distance, lod);
+		away.push_back(lod);
+	}
+	EXPECT_EQ(lod, 3u);
+	for(size_t i = 1; i < away.size(); ++i)
+		EXPECT_GE(away[i], away[i - 1]);
+
+	float switchBack = 0.f;
+	for(float distance = 2000.f; distance > 1.f; distance /= 1.05f)
+	{
+		const uint32 next = Core::Mesh::SelectLod(lods, lodScale / distance, lod);
+		EXPECT_LE(next, lod);
+		if(next < lod && lod == 3)
+			switchBack = distance;
+		lod = next;
+	}
+	EXPECT_EQ(lod, 0u);
+	EXPECT_NEAR(switchBack, 0.16f * lodScale, 0.16f * lodScale * 0.06f);
+}
+
+TEST(InstanceBatcher, GroupsByMeshAndLod)
+{
+	// camera at z = -10 looking down +z
+	Core::Matrix44f viewInverse = Core::Matrix44f::Identity();
+	viewInverse.SetTranslation(0.f, 0.f, 10.f, 1.f);
+	const Core::Matrix44f projection = Core::VKCreatePerspectiveMatrix(0.1f, 1000.f, 1.f, 90.f);
+	const Core::Frustum frustum = Core::Frustum::FromViewProjection(projection * viewInverse);
+	const Core::Vector3f cameraPosition(0.f, 0.f, -10.f);
+	const float lodScale = Core::Mesh::GetLodScale(projection, 1000.f);
+
+	const Core::MeshLod lodTable[3] = { { 0, 300, 0.f }, { 300, 150, 0.05f }, { 450, 75, 0.5f } };
+	Core::InstanceBatcher batcher;
+	Core::InstancedMesh detailed;
+	detailed.m_BoundsRadius = 1.f;
+	detailed.m_Lods = Core::Span<const Core::MeshLod>(lodTable, 3);
+	Core::InstancedMesh simple;
+	simple.m_BoundsRadius = 1.f;
+	EXPECT_EQ(batcher.AddMesh(detailed), 0u);
+	EXPECT_EQ(batcher.AddMesh(simple), 1u);
+
+	// near, far, behind the camera and very far, alternating between the meshes
+	const float depths[] = { 0.f, 200.f, -50.f, 900.f, 1.f, 5.f, -20.f, 300.f };
+	std::vector<Core::Matrix44f> world;
+	for(uint32 i = 0; i < sizeof(depths) / sizeof(depths[0]); ++i)
+	{
+		EXPECT_EQ(batcher.AddInstance(i % 2), i);
+		world.push_back(Core::Matrix44f::Identity());
+		world.back().SetTranslation((float)i, 0.f, depths[i], 1.f);
+	}
+
+	std::vector<Core::Matrix44f> instances(world.size());
+	Core::JobSystem jobs(2);
+	const Core::Span<const Core::InstanceBatch> batches =
+		batcher.Build(jobs, world.data(), frustum, cameraPosition, lodScale, instances.data());
+
+	// mesh 0: instances 0 and 4 close up, 2 and 6 culled. mesh 1 only has LOD 0: 1, 3, 5 and 7
+	ASSERT_EQ(batches.Size(), 2u);
+	EXPECT_EQ(batches[0].m_Mesh, 0u);
+	EXPECT_EQ(batches[0].m_Lod, 0u);
+	EXPECT_EQ(batches[0].m_FirstInstance, 0u);
+	EXPECT_EQ(batches[0].m_InstanceCount, 2u);
+	EXPECT_EQ(batches[1].m_Mesh, 1u);
+	EXPECT_EQ(batches[1].m_Lod, 0u);
+	EXPECT_EQ(batches[1].m_FirstInstance, 2u);
+	EXPECT_EQ(batches[1].m_InstanceCount, 4u);
+	const uint32 expectedOrder[] = { 0, 4, 1, 3, 5, 7 };
+	for(uint32 i = 0; i < sizeof(expectedOrder) / sizeof(expectedOrder[0]); ++i)
+		EXPECT_EQ(instances[i][12], (float)expectedOrder[i]);
+
+	// far copies of the detailed mesh move to coarser LODs, each its own batch
+	world[2].SetTranslation(2.f, 0.f, 60.f, 1.f);
+	world[6].SetTranslation(6.f, 0.f, 400.f, 1.f);
+	const Core::Span<const Core::InstanceBatch> rebuilt =
+		batcher.Build(jobs, world.data(), frustum, cameraPosition, lodScale, instances.data());
+	ASSERT_EQ(rebuilt.Size(), 4u);
+	EXPECT_EQ(rebuilt[0].m_Lod, 0u);
+	EXPECT_EQ(rebuilt[1].m_Lod, 1u);
+	EXPECT_EQ(rebuilt[2].m_Lod, 2u);
+	EXPECT_EQ(rebuilt[3].m_Mesh, 1u);
+	EXPECT_EQ(batcher.GetLod(2), 1u);
+	EXPECT_EQ(batcher.GetLod(6), 2u);
+	EXPECT_EQ(instances[rebuilt[1].m_FirstInstance][12], 2.f);
+	EXPECT_EQ(instances[rebuilt[2].m_FirstInstance][12], 6.f);
+
+	// removing moves the last instance into the hole, like the TransformBatch next to it
+	batcher.RemoveCyclicAtIndex(1);
+	EXPECT_EQ(batcher.GetInstanceCount(), 7u);
+	EXPECT_EQ(batcher.GetMesh(1), 1u);
+	EXPECT_EQ(batcher.GetMesh(6), 0u);
+	batcher.Clear();
+	EXPECT_EQ(batcher.Build(jobs, world.data(), frustum, cameraPosition, lodScale, instances.data()).Size(), 0u);
+}
+
+TEST(InstanceBatcher, SameOutputOnAnyThreadCount)
+{
+	Core::Matrix44f viewInverse = Core::Matrix44f::Identity();
+	viewInverse.SetTranslation(0.f, 0.f, 10.f, 1.f);
+	const Core::Matrix44f projection = Core::VKCreatePerspectiveMatrix(0.1f, 1000.f, 1.f, 90.f);
+	const Core::Frustum frustum = Core::Frustum::FromViewProjection(projection * viewInverse);
+	const Core::Vector3f cameraPosition(0.f, 0.f, -10.f);
+	const float lodScale = Core::Mesh::GetLodScale(projection, 1000.f);
+
+	const Core::MeshLod lodTable[4] = { { 0, 300, 0.f }, { 300, 150, 0.01f }, { 450, 75, 0.04f }, { 525, 36, 0.16f } };
+	static constexpr uint32 instanceCount = 50000;
+	std::mt19937 random(7);
+	std::uniform_real_distribution<float> spread(-300.f, 300.f);
+	std::vector<Core::Matrix44f> world(instanceCount, Core::Matrix44f::Identity());
+	for(Core::Matrix44f& matrix : world)
+		matrix.SetTranslation(spread(random), spread(random), spread(random) + 300.f, 1.f);
+
+	std::vector<Core::Matrix44f> expected;
+	std::vector<Core::InstanceBatch> expectedBatches;
+	for(const uint32 threads : { 1u, 3u, 4u })
+	{
+		Core::InstanceBatcher batcher;
+		for(uint32 mesh = 0; mesh < 3; ++mesh)
+		{
+			Core::InstancedMesh instanced;
+			instanced.m_BoundsRadius = 1.f + (float)mesh;
+			instanced.m_Lods = Core::Span<const Core::MeshLod>(lodTable, 4 - mesh);
+			batcher.AddMesh(instanced);
+		}
+		for(uint32 i = 0; i < instanceCount; ++i)
+			batcher.AddInstance(i * 7 % 3);
+
+		Core::JobSystem jobs(threads);
+		std::vector<Core::Matrix44f> instances(instanceCount);
+		const Core::Span<const Core::InstanceBatch> batches =
+			batcher.Build(jobs, world.data(), frustum, cameraPosition, lodScale, instances.data());
+
+		uint32 visible = 0;
+		for(const Core::InstanceBatch& batch : batches)
+		{
+			EXPECT_EQ(batch.m_FirstInstance, visible);
+			visible += batch.m_InstanceCount;
+		}
+		EXPECT_GT(visible, instanceCount / 10);
+		EXPECT_LT(visible, instanceCount);
+		instances.resize(visible);
+
+		if(expected.empty())
+		{
+			expected = instances;
+			expectedBatches.assign(batches.begin(), batches.end());
+			EXPECT_GT(expectedBatches.size(), 3u);
+			continue;
+		}
+
+		ASSERT_EQ(batches.Size(), expectedBatches.size());
+		for(uint32 i = 0; i < batches.Size(); ++i)
+		{
+			EXPECT_EQ(batches[i].m_Mesh, expectedBatches[i].m_Mesh);
+			EXPECT_EQ(batches[i].m_Lod, expectedBatches[i].m_Lod);
+			EXPECT_EQ(batches[i].m_InstanceCount, expectedBatches[i].m_InstanceCount);
+		}
+		EXPECT_EQ(memcmp(instances.data(), expected.data(), visible * sizeof(Core::Matrix44f)), 0);
+	}
+}
+
+TEST(InstanceBatcher, KeepsItsOwnLodTables)
+{
+	Core::Matrix44f viewInverse = Core::Matrix44f::Identity();
+	viewInverse.SetTranslation(0.f, 0.f, 10.f, 1.f);
+	const Core::Matrix44f projection = Core::VKCreatePerspectiveMatrix(0.1f, 1000.f, 1.f, 90.f);
+	const Core::Frustum frustum = Core::Frustum::FromViewProjection(projection * viewInverse);
+	const Core::Vector3f cameraPosition(0.f, 0.f, -10.f);
+	const float lodScale = Core::Mesh::GetLodScale(projection, 1000.f);
+
+	// like the renderer adding meshes from views that go away, the tables are gone before the first Build
+	Core::InstanceBatcher batcher;
+	for(uint32 mesh = 0; mesh < 3; ++mesh)
+	{
+		std::vector<Core::MeshLod> lods = { { 0, 300, 0.f }, { 300, 150, 0.05f }, { 450, 75, 0.5f } };
+		lods.resize(3 - mesh);
+		lods[0].m_IndexCount += mesh;
+		Core::InstancedMesh instanced;
+		instanced.m_BoundsRadius = 1.f;
+		instanced.m_Lods = Core::Span<const Core::MeshLod>(lods.data(), lods.size());
+		EXPECT_EQ(batcher.AddMesh(instanced), mesh);
+	}
+
+	for(uint32 mesh = 0; mesh < 3; ++mesh)
+	{
+		const Core::Span<const Core::MeshLod> lods = batcher.GetLods(mesh);
+		ASSERT_EQ(lods.Size(), 3u - mesh);
+		EXPECT_EQ(lods[0].m_IndexCount, 300u + mesh);
+		if(lods.Size() > 1)
+		{
+			EXPECT_EQ(lods[1].m_IndexOffset, 300u);
+		}
+	}
+
+	// a far copy of each mesh, the first two go as coarse as their tables allow
+	std::vector<Core::Matrix44f> world(3, Core::Matrix44f::Identity());
+	for(uint32 i = 0; i < 3; ++i)
+	{
+		batcher.AddInstance(i);
+		world[i].SetTranslation((float)i, 0.f, 400.f, 1.f);
+	}
+	std::vector<Core::Matrix44f> instances(world.size());
+	Core::JobSystem jobs(2);
+	const Core::Span<const Core::InstanceBatch> batches =
+		batcher.Build(jobs, world.data(), frustum, cameraPosition, lodScale, instances.data());
+	ASSERT_EQ(batches.Size(), 3u);
+	EXPECT_EQ(batches[0].m_Lod, 2u);
+	EXPECT_EQ(batches[1].m_Lod, 1u);
+	EXPECT_EQ(batches[2].m_Lod, 0u);
+}
+
+TEST(WorkStealingDeque, OwnerPopsNewestThievesStealOldest)
+{
+	Core::WorkStealingDeque<uint32, 4> deque;
+	uint32 values[5] = { 0, 1, 2, 3, 4 };
+	EXPECT_EQ(deque.Pop(), nullptr);
+	EXPECT_EQ(deque.Steal(), nullptr);
+
+	for(uint32 i = 0; i < 4; ++i)
+		EXPECT_TRUE(deque.Push(&values[i]));
+	EXPECT_FALSE(deque.Push(&values[4]));
+	EXPECT_EQ(deque.Size(), 4u);
+
+	EXPECT_EQ(deque.Pop(), &values[3]);
+	EXPECT_EQ(deque.Steal(), &values[0]);
+	EXPECT_EQ(deque.Steal(), &values[1]);
+	EXPECT_TRUE(deque.Push(&values[4]));
+	EXPECT_EQ(deque.Pop(), &values[4]);
+	EXPECT_EQ(deque.Pop(), &values[2]);
+	EXPECT_EQ(deque.Pop(), nullptr);
+	EXPECT_EQ(deque.Size(), 0u);
+
+	// wraps around the ring
+	for(uint32 round = 0; round < 10; ++round)
+	{
+		EXPECT_TRUE(deque.Push(&values[round % 5]));
+		EXPECT_EQ(deque.Steal(), &values[round % 5]);
+	}
+}
+
+TEST(WorkStealingDeque, EveryItemTakenOnceUnderContention)
+{
+	static constexpr uint32 count = 200000;
+	Core::WorkStealingDeque<uint32, 256> deque;
+	std::vector<uint32> items(count);
+	std::vector<std::atomic<uint32>> taken(count);
+	for(uint32 i = 0; i < count; ++i)
+	{
+		items[i] = i;
+		taken[i].store(0);
+	}
+
+	std::atomic<bool> done{ false };
+	std::vector<std::thread> thieves;
+	for(uint32 t = 0; t < 3; ++t)
+	{
+		thieves.emplace_back([&] {
+			while(!done.load())
+			{
+				if(uint32* item = deque.Steal())
+					taken[*item].fetch_add(1);
+			}
+		});
+	}
+
+	// the owner pushes and pops its own end while the thieves take from the other
+	uint32 next = 0;
+	while(next < count)
+	{
+		for(uint32 i = 0; i < 8 && next < count; ++i)
+		{
+			if(!deque.Push(&items[next]))
+				break;
+			++next;
+		}
+		if(uint32* item = deque.Pop())
+			taken[*item].fetch_add(1);
+	}
+	while(uint32* item = deque.Pop())
+		taken[*item].fetch_add(1);
+	done.store(true);
+	for(std::thread& thief : thieves)
+		thief.join();
+
+	uint32 wrong = 0;
+	for(uint32 i = 0; i < count; ++i)
+		wrong += taken[i].load() != 1 ? 1 : 0;
+	EXPECT_EQ(wrong, 0u);
+}
+
+TEST(JobSystem, CountersWaitForEveryJob)
+{
+	Core::JobSystem jobs(4);
+	EXPECT_EQ(jobs.GetThreadCount(), 4u);
+	EXPECT_TRUE(jobs.IsMainThread());
+
+	std::atomic<uint32> sum{ 0 };
+	Core::JobCounter counter;
+	for(uint32 i = 1; i <= 1000; ++i)
+		jobs.Run([&, i] { sum.fetch_add(i); }, &counter);
+	jobs.Wait(counter);
+	EXPECT_TRUE(counter.IsDone());
+	EXPECT_EQ(sum.load(), 500500u);
+
+	// a chain, every stage starts from the job before it and waits on the stage it adds
+	std::atomic<uint32> depth{ 0 };
+	std::function<void(uint32)> stage = [&](uint32 level) {
+		depth.fetch_add(1);
+		if(level == 0)
+			return;
+		Core::JobCounter inner;
+		jobs.Run([&stage, level] { stage(level - 1); }, &inner);
+		jobs.Wait(inner);
+	};
+	Core::JobCounter chain;
+	jobs.Run([&] { stage(64); }, &chain);
+	jobs.Wait(chain);
+	EXPECT_EQ(depth.load(), 65u);
+}
+
+TEST(JobSystem, ParallelForCoversEveryIndexOnce)
+{
+	Core::JobSystem jobs(4);
+	for(const uint32 count : { 0u, 1u, 7u, 64u, 1000u, 100003u })
+	{
+		for(const uint32 grain : { 0u, 1u, 13u, 4096u })
+		{
+			std::vector<std::atomic<uint32>> hits(count);
+			for(std::atomic<uint32>& hit : hits)
+				hit.store(0);
+
+			jobs.ParallelFor(
+				count,
+				[&](uint32 begin, uint32 end) {
+					EXPECT_LT(begin, end);
+					for(uint32 i = begin; i < end; ++i)
+						hits[i].fetch_add(1);
+				},
+				grain);
+
+			uint32 wrong = 0;
+			for(std::atomic<uint32>& hit : hits)
+				wrong += hit.load() != 1 ? 1 : 0;
+			EXPECT_EQ(wrong, 0u) << count << " indices, grain " << grain;
+		}
+	}
+	EXPECT_EQ(jobs.GetGrainSize(1), 1u);
+	EXPECT_EQ(jobs.GetGrainSize(1600), 100u);
+
+	// nested, every outer range splits its own work again from inside a job
+	std::atomic<uint64> sum{ 0 };
+	jobs.ParallelFor(
+		64,
+		[&](uint32 begin, uint32 end) {
+			for(uint32 outer = begin; outer < end; ++outer)
+			{
+				jobs.ParallelFor(1000, [&, outer](uint32 innerBegin, uint32 innerEnd) {
+					uint64 local = 0;
+					for(uint32 inner = innerBegin; inner < innerEnd; ++inner)
+						local += outer * 1000 + inner;
+					sum.fetch_add(local);
+				});
+			}
+		},
+		1);
+	EXPECT_EQ(sum.load(), 64000ull * 63999ull / 2);
+}
+
+TEST(JobSystem, MainThreadJobsAndOtherThreads)
+{
+	Core::JobSystem jobs(3);
+	const std::thread::id mainThread = std::this_thread::get_id();
+
+	// queued from a worker, only runs once the main thread pumps or waits
+	std::atomic<uint32> ranOnMain{ 0 };
+	Core::JobCounter counter;
+	for(uint32 i = 0; i < 16; ++i)
+	{
+		jobs.Run(
+			[&] {
+				jobs.RunOnMainThread(
+					[&] { ranOnMain.fetch_add(std::this_thread::get_id() == mainThread ? 1 : 0); }, &counter);
+			},
+			&counter);
+	}
+	jobs.Wait(counter);
+	EXPECT_EQ(ranOnMain.load(), 16u);
+
+	uint32 pumped = 0;
+	jobs.RunOnMainThread([&] { ++pumped; });
+	jobs.RunOnMainThread([&] { ++pumped; });
+	EXPECT_EQ(jobs.ProcessMainThreadJobs(), 2u);
+	EXPECT_EQ(pumped, 2u);
+	EXPECT_EQ(jobs.ProcessMainThreadJobs(), 0u);
+
+	// threads that don't belong to the system hand their jobs to the workers
+	std::atomic<uint32> fromOutside{ 0 };
+	std::thread outside([&] {
+		EXPECT_EQ(jobs.GetThreadIndex(), Core::JobSystem::s_NotAJobThread);
+		Core::JobCounter outsideCounter;
+		for(uint32 i = 0; i < 100; ++i)
+			jobs.Run([&] { fromOutside.fetch_add(1); }, &outsideCounter);
+		jobs.Wait(outsideCounter);
+	});
+	outside.join();
+	EXPECT_EQ(fromOutside.load(), 100u);
+}
+
+TEST(JobSystem, SingleThreadRunsEverythingOnMain)
+{
+	Core::JobSystem jobs(1);
+	std::atomic<uint64> sum{ 0 };
+	jobs.ParallelFor(1000, [&](uint32 begin, uint32 end) {
+		EXPECT_TRUE(jobs.IsMainThread());
+		for(uint32 i = begin; i < end; ++i)
+			sum.fetch_add(i);
+	});
+	EXPECT_EQ(sum.load(), 499500u);
+}
+
+namespace
+{
+	struct PingPong
+	{
+		Core::Fiber* m_Thread = nullptr;
+		std::vector<uint32> m_Trace;
+	};
+
+	void PingPongMain(Core::Fiber* fiber)
+	{
+		PingPong& pingPong = *static_cast<PingPong*>(fiber->GetUserData());
+		for(uint32 i = 0;; ++i)
+		{
+			pingPong.m_Trace.push_back(i);
+			fiber->SwitchTo(*pingPong.m_Thread);
+		}
+	}
+
+	uint32 Recurse(uint32 depth)
+	{
+		// the frame is read after the call so the recursion can't become a loop
+		volatile char frame[1024];
+		frame[0] = (char)depth;
+		const uint32 deeper = Recurse(depth + 1);
+		return deeper + frame[0];
+	}
+
+	void OverflowMain(Core::Fiber*) { Recurse(0); }
+}; // namespace
+
+TEST(Fiber, SwitchesBackAndForth)
+{
+	Core::Fiber thread;
+	thread.ConvertThread();
+
+	PingPong pingPong;
+	pingPong.m_Thread = &thread;
+	Core::Fiber fiber;
+	ASSERT_TRUE(fiber.Create(16 * 1024, &PingPongMain, &pingPong));
+	EXPECT_GE(fiber.GetStackSize(), 16u * 1024u);
+
+	// locals and float state on this side survive the other fiber running in between
+	double accumulated = 0.5;
+	for(uint32 i = 0; i < 100; ++i)
+	{
+		thread.SwitchTo(fiber);
+		accumulated = accumulated * 1.5 + 0.25;
+	}
+	ASSERT_EQ(pingPong.m_Trace.size(), 100u);
+	for(uint32 i = 0; i < 100; ++i)
+		EXPECT_EQ(pingPong.m_Trace[i], i);
+	EXPECT_GT(accumulated, 1e17);
+
+	fiber.Destroy();
+	thread.RevertThread();
+}
+
+TEST(Fiber, GuardPageStopsStackOverflow)
+{
+	auto overflow = [] {
+		Core::Fiber thread;
+		thread.ConvertThread();
+		Core::Fiber fiber;
+		if(fiber.Create(16 * 1024, &OverflowMain, nullptr))
+			thread.SwitchTo(fiber);
+	};
+	EXPECT_DEATH(overflow(), "");
+}
+
+TEST(Fiber, PoolHandsOutEveryFiberOnce)
+{
+	Core::FiberPool pool;
+	ASSERT_TRUE(pool.Init(4, 8 * 1024, &OverflowMain, nullptr));
+
+	std::set<Core::Fiber*> taken;
+	for(uint32 i = 0; i < 4; ++i)
+	{
+		Core::Fiber* fiber = pool.Acquire();
+		ASSERT_NE(fiber, nullptr);
+		EXPECT_EQ(pool.GetIndex(fiber), i);
+		taken.insert(fiber);
+	}
+	EXPECT_EQ(taken.size(), 4u);
+	EXPECT_EQ(pool.Acquire(), nullptr);
+
+	Core::FiberPoolStats stats = pool.GetStats();
+	EXPECT_EQ(stats.m_FiberCount, 4u);
+	EXPECT_EQ(stats.m_InUse, 4u);
+	EXPECT_EQ(stats.m_PeakInUse, 4u);
+	EXPECT_EQ(stats.m_Exhausted, 1u);
+	EXPECT_GE(stats.m_StackSize, 8u * 1024u);
+
+	for(Core::Fiber* fiber : taken)
+		pool.Release(fiber);
+	EXPECT_EQ(pool.GetStats().m_InUse, 0u);
+	pool.Destroy();
+}
+
+TEST(JobSystem, FibersParkWaitingJobs)
+{
+	for(const uint32 fiberCount : { 8u, 256u })
+	{
+		Core::JobSystem jobs(4, fiberCount, 32 * 1024);
+
+		// every stage waits on the next from inside its job, each wait parks a fiber instead of a thread
+		std::atomic<uint32> depth{ 0 };
+		std::function<void(uint32)> stage = [&](uint32 level) {
+			depth.fetch_add(1);
+			if(level == 0)
+				return;
+			Core::JobCounter inner;
+			jobs.Run([&stage, level] { stage(level - 1); }, &inner);
+			jobs.Wait(inner);
+		};
+		Core::JobCounter chain;
+		jobs.Run([&] { stage(200); }, &chain);
+		jobs.Wait(chain);
+		EXPECT_EQ(depth.load(), 201u);
+
+		std::atomic<uint64> sum{ 0 };
+		jobs.ParallelFor(
+			64,
+			[&](uint32 begin, uint32 end) {
+				for(uint32 outer = begin; outer < end; ++outer)
+				{
+					jobs.ParallelFor(1000, [&, outer](uint32 innerBegin, uint32 innerEnd) {
+						uint64 local = 0;
+						for(uint32 inner = innerBegin; inner < innerEnd; ++inner)
+							local += outer * 1000 + inner;
+						sum.fetch_add(local);
+					});
+				}
+			},
+			1);
+		EXPECT_EQ(sum.load(), 64000ull * 63999ull / 2);
+
+		// main thread jobs still run on the main thread when the job waiting for them sits on a fiber
+		const std::thread::id mainThread = std::this_thread::get_id();
+		std::atomic<uint32> ranOnMain{ 0 };
+		Core::JobCounter outer;
+		jobs.Run(
+			[&] {
+				Core::JobCounter onMain;
+				jobs.RunOnMainThread([&] { ranOnMain.fetch_add(std::this_thread::get_id() == mainThread ? 1 : 0); },
+									 &onMain);
+				jobs.Wait(onMain);
+			},
+			&outer);
+		jobs.Wait(outer);
+		EXPECT_EQ(ranOnMain.load(), 1u);
+
+		const Core::JobFiberStats stats = jobs.GetFiberStats();
+		EXPECT_EQ(stats.m_Pool.m_FiberCount, fiberCount);
+		EXPECT_EQ(stats.m_Pool.m_InUse, 0u);
+		EXPECT_GT(stats.m_Suspends, 0u);
+		EXPECT_GE(stats.m_Switches, 2 * stats.m_Suspends);
+		EXPECT_LE(stats.m_Pool.m_PeakInUse, fiberCount);
+		if(fiberCount == 8)
+		{
+			EXPECT_GT(stats.m_InlineJobs, 0u); // the chain alone needs more fibers than that
+		}
+	}
+}
+
+TEST(AsyncIO, ReadsIntoCallerBuffers)
+{
+	const std::string path = WriteTempFile("core_async_read.bin", "0123456789abcdef");
+	Core::AsyncIO io;
+
+	char whole[32] = {};
+	char middle[4] = {};
+	char small[8] = {};
+	Core::ReadRequest requests[4];
+	requests[0].m_Path = path;
+	requests[0].m_Buffer = whole;
+	requests[0].m_BufferSize = sizeof(whole);
+	requests[1].m_Path = path;
+	requests[1].m_Buffer = middle;
+	requests[1].m_BufferSize = sizeof(middle);
+	requests[1].m_Offset = 10;
+	requests[2].m_Path = path;
+	requests[2].m_Buffer = small;
+	requests[2].m_BufferSize = sizeof(small);
+	requests[3].m_Path = path + ".missing";
+	requests[3].m_Buffer = small;
+	requests[3].m_BufferSize = sizeof(small);
+
+	std::future<Core::ReadResult> futures[4];
+	io.ReadBatch(requests, 4, futures);
+
+	const Core::ReadResult wholeResult = futures[0].get();
+	EXPECT_EQ(wholeResult.m_Status, Core::IOStatus::Ok);
+	EXPECT_EQ(wholeResult.m_BytesRead, 16u);
+	EXPECT_EQ(memcmp(whole, "0123456789abcdef", 16), 0);
+
+	const Core::ReadResult middleResult = futures[1].get();
+	EXPECT_EQ(middleResult.m_BytesRead, 4u);
+	EXPECT_EQ(memcmp(middle, "abcd", 4), 0);
+
+	// buffer too small, the file size says how much is missing
+	const Core::ReadResult smallResult = futures[2].get();
+	EXPECT_EQ(smallResult.m_BytesRead, 8u);
+	EXPECT_EQ(smallResult.m_FileSize, 16u);
+
+	EXPECT_EQ(futures[3].get().m_Status, Core::IOStatus::NotFound);
+	EXPECT_EQ(io.GetPendingCount(), 0u);
+	EXPECT_EQ(Core::AsyncIO::GetFileSize(path.c_str()), 16u);
+	remove(path.c_str());
+}
+
+TEST(AsyncIO, HighPriorityFirstAndCallbacksOnDispatch)
+{
+	const std::string path = WriteTempFile("core_async_priority.bin", "data");
+	Core::AsyncIO io;
+
+	std::vector<int> order;
+	char buffers[6][4];
+	Core::ReadRequest requests[6];
+	for(int i = 0; i < 6; ++i)
+	{
+		requests[i].m_Path = path;
+		requests[i].m_Buffer = buffers[i];
+		requests[i].m_BufferSize = sizeof(buffers[i]);
+		requests[i].m_Priority = i == 5 ? Core::IOPriority::High : Core::IOPriority::Low;
+		requests[i].m_OnComplete = [&order, i](const Core::ReadResult& result) {
+			EXPECT_EQ(result.m_BytesRead, 4u);
+			order.push_back(i);
+		};
+	}
+
+	// one batch is queued under one lock, the thread sees all of it at once
+	io.ReadBatch(requests, 6);
+	io.WaitIdle();
+	EXPECT_TRUE(order.empty()); // nothing runs until dispatched
+
+	EXPECT_EQ(io.DispatchCompletions(), 6u);
+	ASSERT_EQ(order.size(), 6u);
+	EXPECT_EQ(order[0], 5);
+	for(int i = 1; i < 6; ++i)
+		EXPECT_EQ(order[i], i - 1);
+	EXPECT_EQ(io.DispatchCompletions(), 0u);
+	remove(path.c_str());
+}
+
+#ifndef _WIN32
+TEST(AsyncIO, FrameLoopNeverWaitsOnReads)
+{
+	static constexpr uint32 frameCount = 10;
+	static constexpr uint32 lowPerFrame = 20;
+	static constexpr uint32 fileCount = frameCount * (lowPerFrame + 1);
+	static constexpr uint32 fileSize = 4096;
+
+	std::vector<std::string> paths;
+	for(uint32 i = 0; i < fileCount; ++i)
+	{
+		std::string contents(fileSize, (char)('a' + i % 26));
+		paths.push_back(WriteTempFile(("core_async_stream_" + std::to_string(i) + ".bin").c_str(), contents));
+	}
+
+	// opening a fifo blocks until a writer shows up, the I/O thread is stuck on it like on a slow disk
+	const std::string gatePath = testing::TempDir() + "core_async_gate";
+	remove(gatePath.c_str());
+	ASSERT_EQ(mkfifo(gatePath.c_str(), 0600), 0);
+
+	Core::AsyncIO io;
+	char gateBuffer[4];
+	Core::ReadRequest gate;
+	gate.m_Path = gatePath;
+	gate.m_Buffer = gateBuffer;
+	gate.m_BufferSize = sizeof(gateBuffer);
+	gate.m_Priority = Core::IOPriority::High; // picked before anything the frames queue
+	std::future<Core::ReadResult> gateDone = io.Read(std::move(gate));
+
+	std::vector<char> buffers(fileCount * fileSize);
+	std::vector<uint32> order;
+	uint32 corrupt = 0;
+	uint32 submitted = 0;
+
+	// every frame queues a normal priority read and a batch of low priority ones while no read can finish
+	for(uint32 frame = 0; frame < frameCount; ++frame)
+	{
+		Core::ReadRequest requests[lowPerFrame + 1];
+		for(uint32 i = 0; i <= lowPerFrame; ++i)
+		{
+			const uint32 file = submitted + i;
+			requests[i].m_Path = paths[file];
+			requests[i].m_Buffer = &buffers[file * fileSize];
+			requests[i].m_BufferSize = fileSize;
+			requests[i].m_Priority = i == 0 ? Core::IOPriority::Normal : Core::IOPriority::Low;
+			requests[i].m_OnComplete = [&, file](const Core::ReadResult& result) {
+				order.push_back(file);
+				const char expected = (char)('a' + file % 26);
+				if(result.m_BytesRead != fileSize || buffers[file * fileSize + fileSize - 1] != expected)
+					++corrupt;
+			};
+		}
+		io.ReadBatch(requests, lowPerFrame + 1);
+		submitted += lowPerFrame + 1;
+
+		EXPECT_EQ(io.DispatchCompletions(), 0u);
+		EXPECT_EQ(io.GetPendingCount(), submitted + 1);
+	}
+	EXPECT_EQ(gateDone.wait_for(std::chrono::seconds(0)), std::future_status::timeout);
+
+	FILE* writer = fopen(gatePath.c_str(), "wb");
+	ASSERT_NE(writer, nullptr);
+	fclose(writer);
+	EXPECT_EQ(gateDone.get().m_Status, Core::IOStatus::Ok);
+
+	io.WaitIdle();
+	EXPECT_EQ(io.DispatchCompletions(), fileCount);
+	ASSERT_EQ(order.size(), fileCount);
+	EXPECT_EQ(corrupt, 0u);
+
+	// the normal priority reads of every frame first, then the low priority ones, each in submit order
+	for(uint32 i = 0; i < frameCount; ++i)
+		EXPECT_EQ(order[i], i * (lowPerFrame + 1));
+	uint32 previous = 0;
+	for(uint32 i = frameCount; i < fileCount; ++i)
+	{
+		EXPECT_NE(order[i] % (lowPerFrame + 1), 0u);
+		EXPECT_GT(order[i], previous);
+		previous = order[i];
+	}
+
+	remove(gatePath.c_str());
+	for(const std::string& path : paths)
+		remove(path.c_str());
+}
+#endif
 
 GTEST_API_ int main(int argc, char** argv)
 {